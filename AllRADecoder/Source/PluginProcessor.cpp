@@ -265,6 +265,7 @@ void AllRADecoderAudioProcessor::prepareToPlay (double sampleRate, int samplesPe
     specs.maximumBlockSize = samplesPerBlock;
     specs.numChannels = 64;
 
+    decoder.setInterpolationTime (0.05f);
     decoder.prepare (specs);
     noiseBurst.prepare (specs);
     ambisonicNoiseBurst.prepare (specs);
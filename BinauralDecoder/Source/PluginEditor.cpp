@@ -34,7 +34,7 @@ BinauralDecoderAudioProcessorEditor::BinauralDecoderAudioProcessorEditor (
 {
     // ============== BEGIN: essentials ======================
     // set GUI size and lookAndFeel
-    setSize (450, 140); // use this to create a fixed-size GUI
+    setSize (450, 165); // use this to create a fixed-size GUI
     //setResizeLimits(500, 300, 800, 500); // use this to create a resizable GUI
     setLookAndFeel (&globalLaF);
 
@@ -63,6 +63,16 @@ BinauralDecoderAudioProcessorEditor::BinauralDecoderAudioProcessorEditor (
     cbEq.addItemList (processor.headphoneEQs, 2);
     cbEqAttachment.reset (new ComboBoxAttachment (valueTreeState, "applyHeadphoneEq", cbEq));
 
+    addAndMakeVisible (lbFilters);
+
+    addAndMakeVisible (btLoadFilters);
+    btLoadFilters.setButtonText ("Load filters");
+    btLoadFilters.addListener (this);
+
+    addAndMakeVisible (btDefaultFilters);
+    btDefaultFilters.setButtonText ("Built-in");
+    btDefaultFilters.addListener (this);
+
     // start timer after everything is set up properly
     startTimer (20);
 }
@@ -100,6 +110,14 @@ void BinauralDecoderAudioProcessorEditor::resized()
     auto sliderRow = area.removeFromTop (20);
     lbEq.setBounds (sliderRow.removeFromLeft (150));
     cbEq.setBounds (sliderRow.removeFromLeft (120));
+
+    area.removeFromTop (5);
+    sliderRow = area.removeFromTop (20);
+    btDefaultFilters.setBounds (sliderRow.removeFromRight (60));
+    sliderRow.removeFromRight (5);
+    btLoadFilters.setBounds (sliderRow.removeFromRight (80));
+    sliderRow.removeFromRight (5);
+    lbFilters.setBounds (sliderRow);
 }
 
 void BinauralDecoderAudioProcessorEditor::timerCallback()
@@ -109,4 +127,34 @@ void BinauralDecoderAudioProcessorEditor::timerCallback()
     // ==========================================
 
     // insert stuff you want to do be done at every timer callback
+    const auto filterDescription = processor.getFilterDescription();
+    if (filterDescription != lastFilterDescription)
+    {
+        lastFilterDescription = filterDescription;
+        lbFilters.setText (filterDescription, false, juce::Justification::left);
+    }
+}
+
+void BinauralDecoderAudioProcessorEditor::buttonClicked (juce::Button* button)
+{
+    if (button == &btLoadFilters)
+        loadFilterFile();
+    else if (button == &btDefaultFilters)
+        processor.loadCustomFilters (juce::File());
+}
+
+void BinauralDecoderAudioProcessorEditor::loadFilterFile()
+{
+    juce::FileChooser myChooser (
+        "Select a multichannel audio file with one filter per Ambisonic channel...",
+        processor.getLastDir().exists()
+            ? processor.getLastDir()
+            : juce::File::getSpecialLocation (juce::File::userHomeDirectory),
+        "*.wav;*.aif;*.aiff;*.flac");
+    if (myChooser.browseForFileToOpen())
+    {
+        juce::File filterFile (myChooser.getResult());
+        processor.setLastDir (filterFile.getParentDirectory());
+        processor.loadCustomFilters (filterFile);
+    }
 }
@@ -41,7 +41,9 @@ typedef juce::AudioProcessorValueTreeState::ButtonAttachment ButtonAttachment;
 //==============================================================================
 /**
 */
-class BinauralDecoderAudioProcessorEditor : public juce::AudioProcessorEditor, private juce::Timer
+class BinauralDecoderAudioProcessorEditor : public juce::AudioProcessorEditor,
+                                            private juce::Timer,
+                                            private juce::Button::Listener
 {
 public:
     BinauralDecoderAudioProcessorEditor (BinauralDecoderAudioProcessor&,
@@ -53,6 +55,8 @@ public:
     void resized() override;
 
     void timerCallback() override;
+    void buttonClicked (juce::Button* button) override;
+    void loadFilterFile();
 
 private:
     // ====================== begin essentials ==================
@@ -83,5 +87,9 @@ private:
     juce::ComboBox cbEq;
     std::unique_ptr<ComboBoxAttachment> cbEqAttachment;
 
+    SimpleLabel lbFilters;
+    juce::String lastFilterDescription;
+    juce::TextButton btLoadFilters, btDefaultFilters;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (BinauralDecoderAudioProcessorEditor)
 };
@@ -68,7 +68,8 @@ BinauralDecoderAudioProcessor::BinauralDecoderAudioProcessor() :
     #endif
             ,
 #endif
-        createParameterLayout())
+        createParameterLayout()),
+    juce::Thread ("BinauralDecoderFilters")
 {
     // get pointers to the parameters
     inputOrderSetting = parameters.getRawParameterValue ("inputOrderSetting");
@@ -100,10 +101,29 @@ BinauralDecoderAudioProcessor::BinauralDecoderAudioProcessor() :
         reader->read (&irs[i], 0, irLength, 0, true, false);
         irs[i].applyGain (0.3f);
     }
+
+    juce::PropertiesFile::Options options;
+    options.applicationName = "BinauralDecoder";
+    options.filenameSuffix = "settings";
+    options.folderName = "IEM";
+    options.osxLibrarySubFolder = "Preferences";
+
+    properties.reset (new juce::PropertiesFile (options));
+    lastDir = juce::File (properties->getValue ("filterFolder"));
+
+    startThread();
 }
 
 BinauralDecoderAudioProcessor::~BinauralDecoderAudioProcessor()
 {
+    stopThread (5000);
+}
+
+void BinauralDecoderAudioProcessor::setLastDir (juce::File newLastDir)
+{
+    lastDir = newLastDir;
+    const juce::var v (lastDir.getFullPathName());
+    properties->setValue ("filterFolder", v);
 }
 
 int BinauralDecoderAudioProcessor::getNumPrograms()
@@ -142,6 +162,27 @@ void BinauralDecoderAudioProcessor::prepareToPlay (double sampleRate, int sample
         2; // convolve two channels (which actually point two one and the same input channel)
 
     EQ.prepare (convSpec);
+
+    midSideBuffer.setSize (4, juce::jmax (1, samplesPerBlock));
+
+    // the audio thread isn't running, so the filters are built (or read from the cache) right
+    // away and processing starts with them, instead of waiting for the background thread
+    buildFiltersIfNeeded();
+
+    std::unique_ptr<PartitionedConvolution> previousFilters[3];
+    {
+        const juce::SpinLock::ScopedLockType lock (convolutionLock);
+        if (newConvolution != nullptr)
+        {
+            previousFilters[0] = std::move (convolution);
+            convolution = std::move (newConvolution);
+        }
+        previousFilters[1] = std::move (fadingConvolution);
+        previousFilters[2] = std::move (retiredConvolution);
+    }
+
+    if (convolution != nullptr)
+        convolution->reset();
 }
 
 void BinauralDecoderAudioProcessor::releaseResources()
@@ -164,129 +205,89 @@ void BinauralDecoderAudioProcessor::processBlock (juce::AudioBuffer<float>& buff
 
     const int nCh = juce::jmin (buffer.getNumChannels(), input.getNumberOfChannels());
     const int L = buffer.getNumSamples();
-    const int ergL = overlapBuffer.getNumSamples();
-    const int overlap = irLengthMinusOne;
-    const int copyL = juce::jmin (L, overlap); // copy max L samples of the overlap data
 
-    if (*useSN3D >= 0.5f)
-        for (int ch = 1; ch < nCh; ++ch)
-            buffer.applyGain (ch, 0, buffer.getNumSamples(), sn3d2n3d[ch]);
+    // offline, the filters requested during processing are built before the block is rendered
+    const bool nonRealtime = isNonRealtime();
+    if (nonRealtime)
+        buildFiltersIfNeeded();
 
-    // clear accumulation buffers
-    juce::FloatVectorOperations::clear (reinterpret_cast<float*> (accumMid.data()), fftLength + 2);
-    juce::FloatVectorOperations::clear (reinterpret_cast<float*> (accumSide.data()), fftLength + 2);
+    // take over the filters prepared by the background thread, the previous ones are faded out
+    // with this block and handed back with one of the next ones, the thread deletes them
+    bool fadeFromPreviousFilters = false;
+    if (nonRealtime ? (convolutionLock.enter(), true) : convolutionLock.tryEnter())
+    {
+        if (fadingConvolution != nullptr && retiredConvolution == nullptr)
+        {
+            retiredConvolution = std::move (fadingConvolution);
+            notify();
+        }
+
+        if (newConvolution != nullptr && fadingConvolution == nullptr)
+        {
+            fadingConvolution = std::move (convolution);
+            convolution = std::move (newConvolution);
+            fadeFromPreviousFilters = true;
+        }
 
-    const int nZeros = fftLength - L;
+        convolutionLock.exit();
+    }
 
-    //compute mid signal in frequency domain
-    for (int midix = 0; midix < nMidCh; ++midix)
+    // no filters yet, or they have been prepared for more channels than available
+    if (convolution == nullptr || convolution->getNumInputs() > buffer.getNumChannels())
     {
-        const int ch = mix2cix[midix];
+        buffer.clear();
+        return;
+    }
 
-        juce::FloatVectorOperations::copy (reinterpret_cast<float*> (fftBuffer.data()),
-                                           buffer.getReadPointer (ch),
-                                           L);
-        juce::FloatVectorOperations::clear (reinterpret_cast<float*> (fftBuffer.data()) + L,
-                                            nZeros);
+    // filters which have been faded out already but couldn't be handed back yet aren't used
+    PartitionedConvolution* fadeOut = fadeFromPreviousFilters ? fadingConvolution.get() : nullptr;
+    if (fadeOut != nullptr && fadeOut->getNumInputs() > buffer.getNumChannels())
+        fadeOut = nullptr; // fade in from silence
 
-        fft->performRealOnlyForwardTransform (reinterpret_cast<float*> (fftBuffer.data()));
+    if (*useSN3D >= 0.5f)
+        for (int ch = 1; ch < nCh; ++ch)
+            buffer.applyGain (ch, 0, buffer.getNumSamples(), sn3d2n3d[ch]);
 
-        const auto tfMid =
-            reinterpret_cast<const std::complex<float>*> (irsFrequencyDomain.getReadPointer (ch));
-        for (int i = 0; i < fftLength / 2 + 1; ++i)
-            accumMid[i] += fftBuffer[i] * tfMid[i];
-    }
+    // convolve in chunks of the prepared block size, in case the host sends larger blocks
+    const int nConvCh =
+        juce::jmax (convolution->getNumInputs(), fadeOut != nullptr ? fadeOut->getNumInputs() : 0);
+    const int chunkSize = midSideBuffer.getNumSamples();
+    float* mid = midSideBuffer.getWritePointer (0);
+    float* side = midSideBuffer.getWritePointer (1);
+    float* const* fadingMidSide = midSideBuffer.getArrayOfWritePointers() + 2;
 
-    //compute side signal in frequency domain
-    for (int sidix = 0; sidix < nSideCh; ++sidix)
+    for (int start = 0; start < L; start += chunkSize)
     {
-        const int ch = six2cix[sidix];
+        const int n = juce::jmin (chunkSize, L - start);
 
-        juce::FloatVectorOperations::copy (reinterpret_cast<float*> (fftBuffer.data()),
-                                           buffer.getReadPointer (ch),
-                                           L);
-        juce::FloatVectorOperations::clear (reinterpret_cast<float*> (fftBuffer.data()) + L,
-                                            nZeros);
+        const float* inputs[numberOfInputChannels];
+        for (int ch = 0; ch < nConvCh; ++ch)
+            inputs[ch] = buffer.getReadPointer (ch, start);
 
-        fft->performRealOnlyForwardTransform (reinterpret_cast<float*> (fftBuffer.data()));
+        convolution->process (inputs, midSideBuffer.getArrayOfWritePointers(), n);
 
-        const auto tfSide =
-            reinterpret_cast<const std::complex<float>*> (irsFrequencyDomain.getReadPointer (ch));
-        for (int i = 0; i < fftLength / 2 + 1; ++i)
-            accumSide[i] += fftBuffer[i] * tfSide[i];
-    }
+        if (fadeOut != nullptr)
+        {
+            // crossfade from the previous filters over the whole block
+            fadeOut->process (inputs, fadingMidSide, n);
 
-    fft->performRealOnlyInverseTransform (reinterpret_cast<float*> (accumMid.data()));
-    fft->performRealOnlyInverseTransform (reinterpret_cast<float*> (accumSide.data()));
-
-    ///* MS -> LR  */
-    juce::FloatVectorOperations::copy (buffer.getWritePointer (0),
-                                       reinterpret_cast<float*> (accumMid.data()),
-                                       L);
-    juce::FloatVectorOperations::copy (buffer.getWritePointer (1),
-                                       reinterpret_cast<float*> (accumMid.data()),
-                                       L);
-    juce::FloatVectorOperations::add (buffer.getWritePointer (0),
-                                      reinterpret_cast<float*> (accumSide.data()),
-                                      L);
-    juce::FloatVectorOperations::subtract (buffer.getWritePointer (1),
-                                           reinterpret_cast<float*> (accumSide.data()),
-                                           L);
-
-    juce::FloatVectorOperations::add (buffer.getWritePointer (0),
-                                      overlapBuffer.getWritePointer (0),
-                                      copyL);
-    juce::FloatVectorOperations::add (buffer.getWritePointer (1),
-                                      overlapBuffer.getWritePointer (1),
-                                      copyL);
-
-    if (copyL < overlap) // there is some overlap left, want some?
-    {
-        const int howManyAreLeft = overlap - L;
-
-        //shift the overlap buffer to the left
-        juce::FloatVectorOperations::copy (overlapBuffer.getWritePointer (0),
-                                           overlapBuffer.getReadPointer (0, L),
-                                           howManyAreLeft);
-        juce::FloatVectorOperations::copy (overlapBuffer.getWritePointer (1),
-                                           overlapBuffer.getReadPointer (1, L),
-                                           howManyAreLeft);
-
-        //clear the tail
-        juce::FloatVectorOperations::clear (overlapBuffer.getWritePointer (0, howManyAreLeft),
-                                            ergL - howManyAreLeft);
-        juce::FloatVectorOperations::clear (overlapBuffer.getWritePointer (1, howManyAreLeft),
-                                            ergL - howManyAreLeft);
+            const float gainStart = static_cast<float> (start) / L;
+            const float gainEnd = static_cast<float> (start + n) / L;
+            for (int ch = 0; ch < 2; ++ch)
+            {
+                midSideBuffer.applyGainRamp (ch, 0, n, gainStart, gainEnd);
+                midSideBuffer.addFromWithRamp (ch,
+                                               0,
+                                               fadingMidSide[ch],
+                                               n,
+                                               1.0f - gainStart,
+                                               1.0f - gainEnd);
+            }
+        }
 
         /* MS -> LR  */
-        juce::FloatVectorOperations::add (overlapBuffer.getWritePointer (0),
-                                          reinterpret_cast<float*> (accumMid.data()) + L,
-                                          irLengthMinusOne);
-        juce::FloatVectorOperations::add (overlapBuffer.getWritePointer (1),
-                                          reinterpret_cast<float*> (accumMid.data()) + L,
-                                          irLengthMinusOne);
-        juce::FloatVectorOperations::add (overlapBuffer.getWritePointer (0),
-                                          reinterpret_cast<float*> (accumSide.data()) + L,
-                                          irLengthMinusOne);
-        juce::FloatVectorOperations::subtract (overlapBuffer.getWritePointer (1),
-                                               reinterpret_cast<float*> (accumSide.data()) + L,
-                                               irLengthMinusOne);
-    }
-    else
-    {
-        /* MS -> LR  */
-        juce::FloatVectorOperations::copy (overlapBuffer.getWritePointer (0),
-                                           reinterpret_cast<float*> (accumMid.data()) + L,
-                                           irLengthMinusOne);
-        juce::FloatVectorOperations::copy (overlapBuffer.getWritePointer (1),
-                                           reinterpret_cast<float*> (accumMid.data()) + L,
-                                           irLengthMinusOne);
-        juce::FloatVectorOperations::add (overlapBuffer.getWritePointer (0),
-                                          reinterpret_cast<float*> (accumSide.data()) + L,
-                                          irLengthMinusOne);
-        juce::FloatVectorOperations::subtract (overlapBuffer.getWritePointer (1),
-                                               reinterpret_cast<float*> (accumSide.data()) + L,
-                                               irLengthMinusOne);
+        juce::FloatVectorOperations::add (buffer.getWritePointer (0, start), mid, side, n);
+        juce::FloatVectorOperations::subtract (buffer.getWritePointer (1, start), mid, side, n);
     }
 
     if (*applyHeadphoneEq >= 0.5f)
@@ -317,6 +318,10 @@ void BinauralDecoderAudioProcessor::getStateInformation (juce::MemoryBlock& dest
 {
     auto state = parameters.copyState();
 
+    state.setProperty ("customFilterFile",
+                       juce::var (getCustomFilterFile().getFullPathName()),
+                       nullptr);
+
     auto oscConfig = state.getOrCreateChildWithName ("OSCConfig", nullptr);
     oscConfig.copyPropertiesFrom (oscParameterInterface.getConfig(), nullptr);
 
@@ -331,6 +336,12 @@ void BinauralDecoderAudioProcessor::setStateInformation (const void* data, int s
         if (xmlState->hasTagName (parameters.state.getType()))
         {
             parameters.replaceState (juce::ValueTree::fromXml (*xmlState));
+
+            const juce::String customFilterPath =
+                parameters.state.getProperty ("customFilterFile", "").toString();
+            loadCustomFilters (customFilterPath.isNotEmpty() ? juce::File (customFilterPath)
+                                                             : juce::File());
+
             if (parameters.state.hasProperty ("OSCPort")) // legacy
             {
                 oscParameterInterface.getOSCReceiver().connect (
@@ -391,79 +402,267 @@ void BinauralDecoderAudioProcessor::updateBuffers()
         order = tmpOrder;
     }
 
-    //get number of mid- and side-channels
-    nSideCh = order * (order + 1) / 2;
-    nMidCh = juce::square (order + 1)
-             - nSideCh; //nMidCh = nCh - nSideCh; //nCh should be equalt to (order+1)^2
+    // the filters are prepared on the background thread, see createConvolution(), as this
+    // might be called from the audio thread, only atomics are set here
+    requestedOrder = order;
+    requestedNumChannels = nCh;
+    requestedSampleRate = sampleRate;
+    requestedPartitionSize =
+        juce::jlimit (minPartitionSize, maxPartitionSize, juce::nextPowerOfTwo (blockSize));
+    filtersNeedUpdate = true;
+    notify();
+}
+
+//==============================================================================
+void BinauralDecoderAudioProcessor::loadCustomFilters (const juce::File& file)
+{
+    {
+        const juce::SpinLock::ScopedLockType lock (settingsLock);
+        requestedCustomFile = file;
+    }
+    filtersNeedUpdate = true;
+    notify();
+}
+
+juce::File BinauralDecoderAudioProcessor::getCustomFilterFile()
+{
+    const juce::SpinLock::ScopedLockType lock (settingsLock);
+    return requestedCustomFile;
+}
+
+juce::String BinauralDecoderAudioProcessor::getFilterDescription()
+{
+    const juce::SpinLock::ScopedLockType lock (settingsLock);
+    return filterDescription;
+}
+
+void BinauralDecoderAudioProcessor::setFilterDescription (const juce::String& newDescription)
+{
+    const juce::SpinLock::ScopedLockType lock (settingsLock);
+    filterDescription = newDescription;
+}
+
+void BinauralDecoderAudioProcessor::run()
+{
+    while (! threadShouldExit())
+    {
+        wait (-1);
+
+        if (threadShouldExit())
+            break;
+
+        releaseRetiredConvolution();
+        buildFiltersIfNeeded();
+    }
+}
+
+void BinauralDecoderAudioProcessor::releaseRetiredConvolution()
+{
+    // deleted when leaving this scope, outside of the lock
+    std::unique_ptr<PartitionedConvolution> previousFilters;
+    const juce::SpinLock::ScopedLockType lock (convolutionLock);
+    previousFilters = std::move (retiredConvolution);
+}
+
+void BinauralDecoderAudioProcessor::buildFiltersIfNeeded()
+{
+    // callers wait for a build in progress, so its filters are available afterwards
+    const juce::ScopedLock buildScopedLock (buildLock);
+
+    if (! filtersNeedUpdate.exchange (false))
+        return;
+
+    FilterSettings settings;
+    settings.order = requestedOrder;
+    settings.numChannels = requestedNumChannels;
+    settings.sampleRate = requestedSampleRate;
+    settings.partitionSize = requestedPartitionSize;
+    {
+        const juce::SpinLock::ScopedLockType lock (settingsLock);
+        settings.customFile = requestedCustomFile;
+    }
+
+    if (settings.sampleRate <= 0.0) // not prepared yet
+        return;
+
+    auto filters = createConvolution (settings);
+
+    // the previous filters are deleted when leaving this scope, outside of the lock
+    std::unique_ptr<PartitionedConvolution> previousFilters[2];
+    {
+        const juce::SpinLock::ScopedLockType lock (convolutionLock);
+        previousFilters[0] = std::move (retiredConvolution);
+        previousFilters[1] = std::move (newConvolution); // not taken over yet
+        newConvolution = std::move (filters);
+    }
+}
+
+std::unique_ptr<PartitionedConvolution>
+    BinauralDecoderAudioProcessor::createConvolution (const FilterSettings& settings)
+{
+    // the content of the custom file is hashed, so changed files won't use outdated spectra
+    juce::String sourceHash = "builtIn";
+    juce::String description = "Built-in filters";
+    if (settings.customFile != juce::File())
+    {
+        if (settings.customFile.existsAsFile())
+        {
+            sourceHash = juce::MD5 (settings.customFile).toHexString();
+            description = "Custom filters: " + settings.customFile.getFileName();
+        }
+        else
+            description = "ERROR: " + settings.customFile.getFullPathName()
+                          + " not found, using built-in filters.";
+    }
+
+    auto filters = std::make_unique<PartitionedConvolution>();
+
+    const juce::File cacheFile = getCacheFile (settings, sourceHash);
+    if (cacheFile.existsAsFile())
+    {
+        juce::FileInputStream stream (cacheFile);
+        if (stream.openedOk() && filters->readFilters (stream)
+            && filters->getNumInputs() == settings.numChannels
+            && filters->getPartitionSize() == settings.partitionSize)
+        {
+            DBG ("Using cached filters " << cacheFile.getFileName());
+            setFilterDescription (description);
+            return filters;
+        }
+    }
 
-    if (order < 1)
-        order = 1; // just use first order filters
+    int order = settings.order;
+    juce::AudioBuffer<float>* sourceIRs = &irs[juce::jmax (order, 1) - 1];
+    double sourceSampleRate = irsSampleRate;
+
+    juce::AudioBuffer<float> customIRs;
+    if (sourceHash != "builtIn")
+    {
+        auto result = readCustomIRs (settings.customFile, customIRs, sourceSampleRate);
+        if (result.wasOk())
+        {
+            sourceIRs = &customIRs;
+            const int customOrder = juce::roundToInt (std::sqrt (customIRs.getNumChannels())) - 1;
+            order = juce::jmin (order, customOrder);
+        }
+        else
+        {
+            sourceHash = "builtIn";
+            sourceSampleRate = irsSampleRate;
+            description = "ERROR: " + result.getErrorMessage() + " Using built-in filters.";
+        }
+    }
 
     juce::AudioBuffer<float> resampledIRs;
-    bool useResampled = false;
-    irLength = 236;
+    int length = sourceIRs->getNumSamples();
 
-    if (sampleRate != irsSampleRate && order != 0) // do resampling!
+    if (settings.sampleRate != sourceSampleRate) // do resampling!
     {
-        useResampled = true;
-        double factorReading = irsSampleRate / sampleRate;
-        irLength = juce::roundToInt (irLength / factorReading + 0.49);
+        const int nCh = sourceIRs->getNumChannels();
+        double factorReading = sourceSampleRate / settings.sampleRate;
+        length = juce::roundToInt (length / factorReading + 0.49);
 
-        juce::MemoryAudioSource memorySource (irs[order - 1], false);
+        juce::MemoryAudioSource memorySource (*sourceIRs, false);
         juce::ResamplingAudioSource resamplingSource (&memorySource, false, nCh);
 
         resamplingSource.setResamplingRatio (factorReading);
-        resamplingSource.prepareToPlay (irLength, sampleRate);
+        resamplingSource.prepareToPlay (length, settings.sampleRate);
 
-        resampledIRs.setSize (nCh, irLength);
+        resampledIRs.setSize (nCh, length);
         juce::AudioSourceChannelInfo info;
         info.startSample = 0;
-        info.numSamples = irLength;
+        info.numSamples = length;
         info.buffer = &resampledIRs;
 
         resamplingSource.getNextAudioBlock (info);
 
         // compensate for more (correlated) samples contributing to output signal
-        resampledIRs.applyGain (irsSampleRate / sampleRate);
+        resampledIRs.applyGain (sourceSampleRate / settings.sampleRate);
+        sourceIRs = &resampledIRs;
     }
 
-    irLengthMinusOne = irLength - 1;
+    //get number of mid- and side-channels
+    const int nSideCh = order * (order + 1) / 2;
+    const int nMidCh = juce::square (order + 1) - nSideCh;
 
-    const int prevFftLength = fftLength;
+    filters->prepare (settings.numChannels, 2, settings.partitionSize, length);
 
-    const int ergL = blockSize + irLength - 1; //max number of nonzero output samples
-    fftLength = juce::nextPowerOfTwo (ergL); //fftLength >= ergL
+    for (int midix = 0; midix < nMidCh; ++midix)
+    {
+        const int ch = mix2cix[midix];
+        filters->setFilter (ch, 0, sourceIRs->getReadPointer (ch), length);
+    }
 
-    overlapBuffer.setSize (2, irLengthMinusOne);
-    overlapBuffer.clear();
+    for (int sidix = 0; sidix < nSideCh; ++sidix)
+    {
+        const int ch = six2cix[sidix];
+        filters->setFilter (ch, 1, sourceIRs->getReadPointer (ch), length);
+    }
 
-    if (prevFftLength != fftLength)
+    // write to a temporary file first, as other instances might read the cache at the same time
+    const juce::File targetFile = getCacheFile (settings, sourceHash);
+    if (targetFile.getParentDirectory().createDirectory().wasOk())
     {
-        const int fftOrder = std::log2 (fftLength);
+        juce::TemporaryFile tempFile (targetFile);
+        bool written = false;
+        {
+            juce::FileOutputStream stream (tempFile.getFile());
+            written = stream.openedOk() && filters->writeFilters (stream);
+            stream.flush();
+            written = written && stream.getStatus().wasOk();
+        }
 
-        fft = std::make_unique<juce::dsp::FFT> (fftOrder);
+        if (written)
+            tempFile.overwriteTargetFileWithTemporary();
+    }
 
-        fftBuffer.resize (fftLength);
+    setFilterDescription (description);
+    return filters;
+}
 
-        accumMid.resize (fftLength);
-        accumSide.resize (fftLength);
-    }
+juce::Result BinauralDecoderAudioProcessor::readCustomIRs (const juce::File& file,
+                                                           juce::AudioBuffer<float>& customIRs,
+                                                           double& sampleRate)
+{
+    juce::AudioFormatManager formatManager;
+    formatManager.registerBasicFormats();
 
-    irsFrequencyDomain.setSize (nCh, 2 * (fftLength / 2 + 1));
-    irsFrequencyDomain.clear();
+    std::unique_ptr<juce::AudioFormatReader> reader (formatManager.createReaderFor (file));
+    if (reader == nullptr)
+        return juce::Result::fail ("Unable to read " + file.getFileName() + ".");
 
-    for (int i = 0; i < nCh; ++i)
-    {
-        float* inOut = reinterpret_cast<float*> (fftBuffer.data());
-        const float* src =
-            useResampled ? resampledIRs.getReadPointer (i) : irs[order - 1].getReadPointer (i);
-        juce::FloatVectorOperations::copy (inOut, src, irLength);
-        juce::FloatVectorOperations::clear (inOut + irLength, fftLength - irLength); // zero padding
-        fft->performRealOnlyForwardTransform (inOut);
-        juce::FloatVectorOperations::copy (irsFrequencyDomain.getWritePointer (i),
-                                           inOut,
-                                           2 * (fftLength / 2 + 1));
-    }
+    const int nCh = static_cast<int> (reader->numChannels);
+    const int order = juce::roundToInt (std::sqrt (nCh)) - 1;
+    if (order < 1 || order > 7 || juce::square (order + 1) != nCh)
+        return juce::Result::fail ("The file has " + juce::String (nCh)
+                                   + " channels, (N+1)^2 channels with N = 1...7 are needed.");
+
+    const int length =
+        static_cast<int> (juce::jmin (reader->lengthInSamples, (juce::int64) maxCustomIRLength));
+    if (length == 0)
+        return juce::Result::fail ("The file is empty.");
+
+    customIRs.setSize (nCh, length);
+    reader->read (&customIRs, 0, length, 0, true, true);
+    sampleRate = reader->sampleRate;
+
+    return juce::Result::ok();
+}
+
+juce::File BinauralDecoderAudioProcessor::getCacheFile (const FilterSettings& settings,
+                                                        const juce::String& sourceHash)
+{
+    // increase the version if the way the filters are computed changes
+    const juce::String name = "v1_" + sourceHash + "_" + juce::String (settings.order) + "_"
+                              + juce::String (settings.numChannels) + "_"
+                              + juce::String (juce::roundToInt (settings.sampleRate)) + "_"
+                              + juce::String (settings.partitionSize) + ".filters";
+
+    return juce::File::getSpecialLocation (juce::File::userApplicationDataDirectory)
+        .getChildFile ("IEM")
+        .getChildFile ("BinauralDecoder")
+        .getChildFile ("FilterCache")
+        .getChildFile (name);
 }
 
 //==============================================================================
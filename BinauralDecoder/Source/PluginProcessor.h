@@ -23,12 +23,14 @@
 #pragma once
 
 #include "../../resources/AudioProcessorBase.h"
+#include "../../resources/PartitionedConvolution.h"
 #include <JuceHeader.h>
 
 #define ProcessorClass BinauralDecoderAudioProcessor
 
 class BinauralDecoderAudioProcessor
-    : public AudioProcessorBase<IOTypes::Ambisonics<>, IOTypes::AudioChannels<2>>
+    : public AudioProcessorBase<IOTypes::Ambisonics<>, IOTypes::AudioChannels<2>>,
+      private juce::Thread
 {
 public:
     constexpr static int numberOfInputChannels = 64;
@@ -69,6 +71,18 @@ public:
 
     static const juce::StringArray headphoneEQs;
 
+    /**
+     Loads custom filters from a multichannel audio file, holding one impulse response per
+     Ambisonic channel (ACN order). The filters are prepared on a background thread and cached
+     on disk. An empty file restores the built-in filters.
+     */
+    void loadCustomFilters (const juce::File& file);
+    juce::File getCustomFilterFile();
+    juce::String getFilterDescription();
+
+    juce::File getLastDir() { return lastDir; }
+    void setLastDir (juce::File newLastDir);
+
 private:
     // list of used audio parameters
     std::atomic<float>* inputOrderSetting;
@@ -77,20 +91,63 @@ private:
 
     juce::dsp::Convolution EQ;
 
-    int fftLength = -1;
-    int irLength = 236;
-    int irLengthMinusOne = irLength - 1;
-
-    std::vector<std::complex<float>> fftBuffer;
-    std::vector<std::complex<float>> accumMid;
-    std::vector<std::complex<float>> accumSide;
+    const int irLength = 236; // length of the built-in filters
+
+    // partition size is the next power of two of the block size, limited to this range
+    static constexpr int minPartitionSize = 32;
+    static constexpr int maxPartitionSize = 256;
+
+    static constexpr int maxCustomIRLength = 65536;
+
+    struct FilterSettings
+    {
+        int order = 0;
+        int numChannels = 0;
+        double sampleRate = 0.0; // not prepared yet
+        int partitionSize = minPartitionSize;
+        juce::File customFile;
+    };
+
+    void run() override;
+    /** Builds the requested filters if they have changed, on the calling thread. */
+    void buildFiltersIfNeeded();
+    void releaseRetiredConvolution();
+    std::unique_ptr<PartitionedConvolution> createConvolution (const FilterSettings& settings);
+    juce::Result readCustomIRs (const juce::File& file,
+                                juce::AudioBuffer<float>& customIRs,
+                                double& sampleRate);
+    juce::File getCacheFile (const FilterSettings& settings, const juce::String& sourceHash);
+    void setFilterDescription (const juce::String& newDescription);
+
+    // settings requested by updateBuffers() (possibly on the audio thread, so they are atomic)
+    // and by loadCustomFilters(), used by the thread
+    std::atomic<int> requestedOrder { 0 };
+    std::atomic<int> requestedNumChannels { 0 };
+    std::atomic<double> requestedSampleRate { 0.0 }; // not prepared yet
+    std::atomic<int> requestedPartitionSize { minPartitionSize };
+    juce::SpinLock settingsLock;
+    juce::File requestedCustomFile;
+    juce::String filterDescription { "Built-in filters" };
+    std::atomic<bool> filtersNeedUpdate { false };
+
+    // serializes builds of the thread, of prepareToPlay() and of offline processing
+    juce::CriticalSection buildLock;
+
+    // filters prepared by the thread are taken over by the audio thread and crossfaded with the
+    // previous ones for one block, which are then handed back as retiredConvolution and the
+    // thread is woken up to delete them, so they are not deleted on the audio thread
+    juce::SpinLock convolutionLock;
+    std::unique_ptr<PartitionedConvolution> convolution; // all channels to mid and side signal
+    std::unique_ptr<PartitionedConvolution> newConvolution;
+    std::unique_ptr<PartitionedConvolution> fadingConvolution; // faded out with this block
+    std::unique_ptr<PartitionedConvolution> retiredConvolution;
+    juce::AudioBuffer<float> midSideBuffer; // mid and side of the current and fading filters
 
-    std::unique_ptr<juce::dsp::FFT> fft;
-
-    juce::AudioBuffer<float> overlapBuffer;
     juce::AudioBuffer<float> irs[7];
 
-    juce::AudioBuffer<float> irsFrequencyDomain;
+    juce::File lastDir;
+    std::unique_ptr<juce::PropertiesFile> properties;
+
     double irsSampleRate = 44100.0;
     //mapping between mid-channel index and channel index
     const int mix2cix[36] = { 0,  2,  3,  6,  7,  8,  12, 13, 14, 15, 20, 21,
@@ -99,8 +156,6 @@ private:
     //mapping between side-channel index and channel index
     const int six2cix[28] = { 1,  4,  5,  9,  10, 11, 16, 17, 18, 19, 25, 26, 27, 28,
                               29, 36, 37, 38, 39, 40, 41, 49, 50, 51, 52, 53, 54, 55 };
-    int nMidCh;
-    int nSideCh;
 
     //==============================================================================
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (BinauralDecoderAudioProcessor)
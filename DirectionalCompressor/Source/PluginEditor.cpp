@@ -49,6 +49,19 @@ DirectionalCompressorAudioProcessorEditor::DirectionalCompressorAudioProcessorEd
     addAndMakeVisible (&sphere);
     sphere.addElement (&sphereElem);
 
+    for (int i = 2; i <= DirectionalCompressorAudioProcessor::maxNumDirections; ++i)
+    {
+        const juce::String index (i);
+        auto element = additionalDirectionElements.add (
+            new SpherePanner::AzimuthElevationParameterElement (
+                *valueTreeState.getParameter ("azimuth" + index),
+                valueTreeState.getParameterRange ("azimuth" + index),
+                *valueTreeState.getParameter ("elevation" + index),
+                valueTreeState.getParameterRange ("elevation" + index)));
+        element->setColour (globalLaF.ClWidgetColours[0].withMultipliedAlpha (0.6f));
+        element->setLabel (index);
+    }
+
     cbNormalizationAtachement.reset (
         new ComboBoxAttachment (valueTreeState,
                                 "useSN3D",
@@ -117,6 +130,23 @@ DirectionalCompressorAudioProcessorEditor::DirectionalCompressorAudioProcessorEd
     cbListen.addItem ("Unmasked", 3);
     cbListen.setSelectedId (*valueTreeState.getRawParameterValue ("listen") + 1);
 
+    addAndMakeVisible (&cbNumDirections);
+    cbNumDirections.setJustificationType (juce::Justification::centred);
+    cbNumDirections.addSectionHeading ("Number of directions");
+    cbNumDirections.addItem ("1 (mask)", 1);
+    for (int i = 2; i <= DirectionalCompressorAudioProcessor::maxNumDirections; ++i)
+        cbNumDirections.addItem (juce::String (i) + " directions", i);
+    cbNumDirectionsAttachment.reset (
+        new ComboBoxAttachment (valueTreeState, "numDirections", cbNumDirections));
+    cbNumDirections.setTooltip (
+        "With more than one direction, each direction gets its own compressor using the "
+        "settings of compressor 1. Compressor 2 and the apply settings are not used.");
+
+    addAndMakeVisible (&tbTruePeak);
+    tbTruePeakAttachment.reset (new ButtonAttachment (valueTreeState, "truePeak", tbTruePeak));
+    tbTruePeak.setButtonText ("True peak (4x)");
+    tbTruePeak.setColour (juce::ToggleButton::tickColourId, globalLaF.ClWidgetColours[0]);
+
     // ======== compressor 1 components ===========
     bool isOn = *valueTreeState.getRawParameterValue ("c1Enabled");
 
@@ -446,6 +476,26 @@ void DirectionalCompressorAudioProcessorEditor::timerCallback()
         sphere.repaint();
     }
 
+    const int numDirections =
+        juce::roundToInt (valueTreeState.getRawParameterValue ("numDirections")->load());
+    if (numDirections != numVisibleDirections)
+    {
+        for (int i = 0; i < additionalDirectionElements.size(); ++i)
+        {
+            auto element = additionalDirectionElements[i];
+            const bool wasVisible = i + 2 <= numVisibleDirections;
+            const bool isVisible = i + 2 <= numDirections;
+
+            if (wasVisible && ! isVisible)
+                sphere.removeElement (element);
+            else if (isVisible && ! wasVisible)
+                sphere.addElement (element);
+        }
+
+        numVisibleDirections = numDirections;
+        sphere.repaint();
+    }
+
     dbC1RMSmeter.setLevel (processor.c1MaxRMS);
     dbC1GRmeter.setLevel (processor.c1MaxGR);
     dbC2RMSmeter.setLevel (processor.c2MaxRMS);
@@ -614,6 +664,9 @@ void DirectionalCompressorAudioProcessorEditor::resized()
     sliderRow.removeFromLeft (sliderSpacing);
     lbWidth.setBounds (sliderRow.removeFromLeft (sliderWidth));
 
+    temp.removeFromTop (10); //spacing
+    cbNumDirections.setBounds (temp.removeFromTop (15).reduced (5, 0));
+
     area.removeFromLeft (30); //spacing
 
     // GENERAL SETTINGS
@@ -630,4 +683,6 @@ void DirectionalCompressorAudioProcessorEditor::resized()
 
     area.removeFromLeft (15); //spacing
     cbListen.setBounds (area.removeFromTop (15));
+    area.removeFromTop (10); //spacing
+    tbTruePeak.setBounds (area.removeFromTop (20));
 }
@@ -65,6 +65,8 @@ private:
 
     SpherePanner sphere;
     SpherePanner::AzimuthElevationParameterElement sphereElem;
+    juce::OwnedArray<SpherePanner::AzimuthElevationParameterElement> additionalDirectionElements;
+    int numVisibleDirections = 1;
 
     int maxPossibleOrder = -1;
     std::unique_ptr<ComboBoxAttachment> cbNormalizationAtachement;
@@ -79,6 +81,7 @@ private:
 
     juce::ToggleButton tbC1;
     juce::ToggleButton tbC2;
+    juce::ToggleButton tbTruePeak;
 
     ReverseSlider slPreGain, slAzimuth, slElevation, slWidth;
     ReverseSlider slC1Threshold, slC1Knee, slC1Ratio, slC1Attack, slC1Release, slC1Makeup;
@@ -87,6 +90,7 @@ private:
     juce::ComboBox cbC1Driving, cbC1Apply;
     juce::ComboBox cbC2Driving, cbC2Apply;
     juce::ComboBox cbListen;
+    juce::ComboBox cbNumDirections;
 
     std::unique_ptr<SliderAttachment> slPreGainAttachment, slAzimuthAttachment,
         slElevationAttachment, slWidthAttachment;
@@ -102,8 +106,10 @@ private:
     std::unique_ptr<ComboBoxAttachment> cbC1DrivingAttachment, cbC1ApplyAttachment;
     std::unique_ptr<ComboBoxAttachment> cbC2DrivingAttachment, cbC2ApplyAttachment;
     std::unique_ptr<ComboBoxAttachment> cbListenAttachment;
+    std::unique_ptr<ComboBoxAttachment> cbNumDirectionsAttachment;
 
     std::unique_ptr<ButtonAttachment> tbC1Attachment, tbC2Attachment;
+    std::unique_ptr<ButtonAttachment> tbTruePeakAttachment;
 
     LevelMeter dbC1GRmeter, dbC1RMSmeter;
     LevelMeter dbC2GRmeter, dbC2RMSmeter;
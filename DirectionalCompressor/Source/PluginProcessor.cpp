@@ -51,12 +51,20 @@ DirectionalCompressorAudioProcessor::DirectionalCompressorAudioProcessor() :
     Y (tDesignN, 64),
     YH (64, tDesignN),
     tempMat (64, tDesignN),
-    P1 (64, 64)
+    reencodingMatrix (64, 64),
+    previousReencodingMatrix (64, 64)
 {
     parameters.addParameterListener ("azimuth", this);
     parameters.addParameterListener ("elevation", this);
     parameters.addParameterListener ("width", this);
     parameters.addParameterListener ("orderSetting", this);
+    parameters.addParameterListener ("numDirections", this);
+    parameters.addParameterListener ("truePeak", this);
+    for (int k = 1; k < maxNumDirections; ++k)
+    {
+        parameters.addParameterListener ("azimuth" + juce::String (k + 1), this);
+        parameters.addParameterListener ("elevation" + juce::String (k + 1), this);
+    }
 
     orderSetting = parameters.getRawParameterValue ("orderSetting");
     useSN3D = parameters.getRawParameterValue ("useSN3D");
@@ -86,22 +94,41 @@ DirectionalCompressorAudioProcessor::DirectionalCompressorAudioProcessor() :
     elevation = parameters.getRawParameterValue ("elevation");
     width = parameters.getRawParameterValue ("width");
     listen = parameters.getRawParameterValue ("listen");
+    numDirections = parameters.getRawParameterValue ("numDirections");
+    truePeak = parameters.getRawParameterValue ("truePeak");
+
+    azimuths[0] = azimuth;
+    elevations[0] = elevation;
+    for (int k = 1; k < maxNumDirections; ++k)
+    {
+        azimuths[k] = parameters.getRawParameterValue ("azimuth" + juce::String (k + 1));
+        elevations[k] = parameters.getRawParameterValue ("elevation" + juce::String (k + 1));
+    }
+
+    for (int k = 0; k < maxNumDirections; ++k)
+        masks.add (new juce::dsp::Matrix<float> (64, 64));
 
     c1MaxGR = 0.0f;
     c2MaxGR = 0.0f;
     c1GR = 0.0f;
     c2GR = 0.0f;
 
-    // calc Y
-    for (int p = 0; p < tDesignN; ++p)
-        SHEval (7, tDesignX[p], tDesignY[p], tDesignZ[p], Y.getRawDataPointer() + p * 64, false);
+    // calc YH (one row per ambisonic channel) and Y
+    SHEvalBatch (7,
+                 tDesignX,
+                 tDesignY,
+                 tDesignZ,
+                 tDesignN,
+                 YH.getRawDataPointer(),
+                 tDesignN,
+                 false);
 
-    Y *= std::sqrt (4 * juce::MathConstants<float>::pi / tDesignN)
-         / decodeCorrection (7); // reverting 7th order correction
+    YH *= std::sqrt (4 * juce::MathConstants<float>::pi / tDesignN)
+          / decodeCorrection (7); // reverting 7th order correction
 
     for (int r = 0; r < 64; ++r)
         for (int c = 0; c < tDesignN; ++c)
-            YH (r, c) = Y (c, r);
+            Y (c, r) = YH (r, c);
 }
 
 DirectionalCompressorAudioProcessor::~DirectionalCompressorAudioProcessor()
@@ -136,7 +163,8 @@ void DirectionalCompressorAudioProcessor::changeProgramName (int index, const ju
 void DirectionalCompressorAudioProcessor::parameterChanged (const juce::String& parameterID,
                                                             float newValue)
 {
-    if (parameterID == "azimuth" || parameterID == "elevation" || parameterID == "width")
+    if (parameterID.startsWith ("azimuth") || parameterID.startsWith ("elevation")
+        || parameterID == "width" || parameterID == "numDirections")
     {
         updatedPositionData = true;
         paramChanged = true;
@@ -145,6 +173,10 @@ void DirectionalCompressorAudioProcessor::parameterChanged (const juce::String&
     {
         userChangedIOSettings = true;
     }
+    else if (parameterID == "truePeak")
+    {
+        triggerAsyncUpdate();
+    }
 }
 
 //==============================================================================
@@ -159,11 +191,27 @@ void DirectionalCompressorAudioProcessor::prepareToPlay (double sampleRate, int
 
     compressor1.prepare (spec);
     compressor2.prepare (spec);
+    for (auto& compressor : directionCompressors)
+        compressor.prepare (spec);
 
     omniW.setSize (1, samplesPerBlock);
     c1Gains.resize (samplesPerBlock);
     c2Gains.resize (samplesPerBlock);
 
+    beamBuffer.setSize (maxNumDirections, samplesPerBlock);
+    directionGains.setSize (maxNumDirections, samplesPerBlock);
+    crossfadeRamp.resize (samplesPerBlock);
+    matrixKernel.prepare (numberOfInputChannels);
+    resetReencodingMatrix = true;
+
+    juce::dsp::ProcessSpec truePeakDelaySpec = spec;
+    truePeakDelaySpec.numChannels = numberOfInputChannels;
+    truePeakDelay.setDelayTime ((TruePeakDetector::getLatencyInSamples() + 0.5f)
+                                / static_cast<float> (sampleRate));
+    truePeakDelay.prepare (truePeakDelaySpec);
+    truePeakWasActive = false;
+    setLatencySamples (getLatency());
+
     calcParams();
 }
 
@@ -188,6 +236,49 @@ void DirectionalCompressorAudioProcessor::processBlock (juce::AudioSampleBuffer&
     if (numCh == 0)
         return;
 
+    // preGain - can be tweaked by adding gain to compressor gains
+    float preGainLinear = juce::Decibels::decibelsToGain (preGain->load());
+
+    if (*useSN3D >= 0.5f)
+        for (int i = 0; i < numCh; ++i)
+            buffer.applyGain (i, 0, bufferSize, sn3d2n3d[i] * preGainLinear);
+    else
+        buffer.applyGain (juce::Decibels::decibelsToGain (preGain->load()));
+
+    // ------- clear not needed channels
+    for (int i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
+        buffer.clear (i, 0, buffer.getNumSamples());
+
+    const bool useTruePeak = *truePeak >= 0.5f;
+    if (useTruePeak && ! truePeakWasActive)
+    {
+        // clear the history without any allocation
+        for (auto& detector : truePeakDetectors)
+            detector.reset();
+        truePeakDelay.reset();
+    }
+    truePeakWasActive = useTruePeak;
+
+    if (numMasks > 1)
+    {
+        processMultipleDirections (buffer, numCh, numMasks);
+    }
+    else
+    {
+        resetReencodingMatrix = true;
+        processSingleDirection (buffer, numCh);
+    }
+
+    if (*useSN3D >= 0.5f)
+        for (int i = 0; i < numCh; ++i)
+            buffer.applyGain (i, 0, bufferSize, n3d2sn3d[i]);
+}
+
+void DirectionalCompressorAudioProcessor::processSingleDirection (juce::AudioSampleBuffer& buffer,
+                                                                  const int numCh)
+{
+    const int bufferSize = buffer.getNumSamples();
+
     // Compressor 1 settings
     if (*c1Ratio > 15.9f)
         compressor1.setRatio (INFINITY);
@@ -216,38 +307,49 @@ void DirectionalCompressorAudioProcessor::processBlock (juce::AudioSampleBuffer&
     drivingPointers[1] = buffer.getReadPointer (0);
     drivingPointers[2] = omniW.getReadPointer (0);
 
-    // preGain - can be tweaked by adding gain to compressor gains
-    float preGainLinear = juce::Decibels::decibelsToGain (preGain->load());
-
-    if (*useSN3D >= 0.5f)
-        for (int i = 0; i < numCh; ++i)
-            buffer.applyGain (i, 0, bufferSize, sn3d2n3d[i] * preGainLinear);
-    else
-        buffer.applyGain (juce::Decibels::decibelsToGain (preGain->load()));
-
     // --------- make copies of buffer
     omniW.copyFrom (0, 0, buffer, 0, 0, bufferSize);
 
-    maskBuffer.clear();
-    maskBuffer.setSample (0, 0, 0.0f);
-    for (int chIn = 0; chIn < numCh; ++chIn)
+    const float* maskRows[numberOfInputChannels];
+    const float* P1 = masks.getUnchecked (0)->getRawDataPointer();
+    for (int row = 0; row < numCh; ++row)
+        maskRows[row] = P1 + row * numberOfInputChannels;
+
+    if (*truePeak >= 0.5f)
     {
-        const float* readPtr = buffer.getReadPointer (chIn);
-        for (int chOut = 0; chOut < numCh; ++chOut)
-        {
-            maskBuffer.addFrom (chOut, 0, readPtr, bufferSize, P1 (chOut, chIn));
-        }
+        // W channels of the mask and the negative mask, taken before the audio gets delayed
+        float* sideChains[3] = { beamBuffer.getWritePointer (0),
+                                 beamBuffer.getWritePointer (1),
+                                 omniW.getWritePointer (0) };
+        matrixKernel.process (maskRows,
+                              sideChains,
+                              1,
+                              buffer.getArrayOfReadPointers(),
+                              numCh,
+                              bufferSize);
+        juce::FloatVectorOperations::subtract (sideChains[1],
+                                               omniW.getReadPointer (0),
+                                               sideChains[0],
+                                               bufferSize);
+
+        detectTruePeaks (buffer, sideChains, 3);
+        drivingPointers[0] = sideChains[0];
+        drivingPointers[1] = sideChains[1];
     }
+
+    matrixKernel.process (maskRows,
+                          maskBuffer.getArrayOfWritePointers(),
+                          numCh,
+                          buffer.getArrayOfReadPointers(),
+                          numCh,
+                          bufferSize);
+
     /* This makes the buffer containing the negative mask */
     for (int chIn = 0; chIn < numCh; ++chIn)
         juce::FloatVectorOperations::subtract (buffer.getWritePointer (chIn),
                                                maskBuffer.getReadPointer (chIn),
                                                bufferSize);
 
-    // ------- clear not needed channels
-    for (int i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
-        buffer.clear (i, 0, buffer.getNumSamples());
-
     // =============== COMPRESSOR 1 ====================
     {
         // set compressor driving signal
@@ -389,20 +491,209 @@ void DirectionalCompressorAudioProcessor::processBlock (juce::AudioSampleBuffer&
                                               maskBuffer.getReadPointer (chIn),
                                               bufferSize);
     }
+}
 
-    if (*useSN3D >= 0.5f)
-        for (int i = 0; i < numCh; ++i)
-            buffer.applyGain (i, 0, bufferSize, n3d2sn3d[i]);
+void DirectionalCompressorAudioProcessor::processMultipleDirections (
+    juce::AudioSampleBuffer& buffer,
+    const int numCh,
+    const int nDirections)
+{
+    const int bufferSize = buffer.getNumSamples();
+
+    iem::Compressor* compressors[maxNumDirections];
+    const float* beamRows[maxNumDirections];
+    const float* sideChains[maxNumDirections];
+    float* beams[maxNumDirections];
+    float* gains[maxNumDirections];
+
+    // all directions share the settings of compressor 1
+    for (int k = 0; k < nDirections; ++k)
+    {
+        auto& compressor = directionCompressors[k];
+        if (*c1Ratio > 15.9f)
+            compressor.setRatio (INFINITY);
+        else
+            compressor.setRatio (*c1Ratio);
+
+        compressor.setKnee (*c1Knee);
+        compressor.setAttackTime (*c1Attack / 1000.0f);
+        compressor.setReleaseTime (*c1Release / 1000.0f);
+        compressor.setThreshold (*c1Threshold);
+        compressor.setMakeUpGain (*c1Makeup);
+
+        compressors[k] = &compressor;
+        beamRows[k] = masks.getUnchecked (k)->getRawDataPointer(); // W channel of the mask
+        beams[k] = beamBuffer.getWritePointer (k);
+        sideChains[k] = beams[k];
+        gains[k] = directionGains.getWritePointer (k);
+    }
+
+    // =============== BEAMS AND GAINS ====================
+    // one matrix product for all beam signals, one call for all compressors
+    matrixKernel.process (beamRows,
+                          beams,
+                          nDirections,
+                          buffer.getArrayOfReadPointers(),
+                          numCh,
+                          bufferSize);
+
+    if (*truePeak >= 0.5f)
+        detectTruePeaks (buffer, beams, nDirections);
+
+    iem::Compressor::getGainsFromSidechainSignals (compressors,
+                                                   sideChains,
+                                                   gains,
+                                                   nDirections,
+                                                   bufferSize);
+
+    float minGain = 1.0f;
+    c1MaxRMS = juce::Decibels::gainToDecibels (0.0f);
+    for (int k = 0; k < nDirections; ++k)
+    {
+        minGain = juce::jmin (minGain,
+                              juce::FloatVectorOperations::findMinimum (gains[k], bufferSize));
+        c1MaxRMS = juce::jmax (c1MaxRMS, compressors[k]->getMaxLevelInDecibels());
+    }
+    c1MaxGR = juce::Decibels::gainToDecibels (minGain) - *c1Makeup;
+    c2MaxRMS = juce::Decibels::gainToDecibels (0.0f);
+    c2MaxGR = 0.0f;
+
+    // =============== RE-ENCODING MATRIX ====================
+    // full: T = I + sum_k (g_k - 1) P_k, masked: T = sum_k g_k P_k, unmasked: T = I - sum_k P_k
+    const bool enabled = *c1Enabled >= 0.5f;
+    const bool listenToMask = *listen >= 0.5f && *listen < 1.5f;
+    const bool listenToNegativeMask = *listen >= 1.5f;
+
+    reencodingMatrix.clear();
+    float* T = reencodingMatrix.getRawDataPointer();
+
+    if (! listenToMask)
+        for (int ch = 0; ch < numCh; ++ch)
+            T[ch * numberOfInputChannels + ch] = 1.0f;
+
+    for (int k = 0; k < nDirections; ++k)
+    {
+        // block-rate gain, the crossfade below interpolates between the blocks
+        const float gain = enabled ? gains[k][bufferSize - 1] : 1.0f;
+        const float weight = listenToMask ? gain : (listenToNegativeMask ? -1.0f : gain - 1.0f);
+        if (weight == 0.0f)
+            continue;
+
+        const float* P = masks.getUnchecked (k)->getRawDataPointer();
+        for (int row = 0; row < numCh; ++row)
+            juce::FloatVectorOperations::addWithMultiply (T + row * numberOfInputChannels,
+                                                          P + row * numberOfInputChannels,
+                                                          weight,
+                                                          numCh);
+    }
+
+    // both matrices are allocated with the maximum size in the constructor, the elements are
+    // copied, as assigning the matrix would allocate
+    if (resetReencodingMatrix)
+    {
+        juce::FloatVectorOperations::copy (previousReencodingMatrix.getRawDataPointer(),
+                                           T,
+                                           numberOfInputChannels * numberOfInputChannels);
+        resetReencodingMatrix = false;
+    }
+
+    // =============== OUTPUT CALCULATIONS ====================
+    const float* rows[numberOfInputChannels];
+    const float* previousRows[numberOfInputChannels];
+    const float* previousT = previousReencodingMatrix.getRawDataPointer();
+    bool matrixChanged = false;
+    for (int row = 0; row < numCh; ++row)
+    {
+        rows[row] = T + row * numberOfInputChannels;
+        previousRows[row] = previousT + row * numberOfInputChannels;
+        if (! std::equal (rows[row], rows[row] + numCh, previousRows[row]))
+            matrixChanged = true;
+    }
+
+    // maskBuffer holds the output of the previous matrix, which is faded out
+    if (matrixChanged)
+        matrixKernel.process (previousRows,
+                              maskBuffer.getArrayOfWritePointers(),
+                              numCh,
+                              buffer.getArrayOfReadPointers(),
+                              numCh,
+                              bufferSize);
+
+    matrixKernel.process (rows,
+                          buffer.getArrayOfWritePointers(),
+                          numCh,
+                          buffer.getArrayOfReadPointers(),
+                          numCh,
+                          bufferSize);
+
+    if (matrixChanged)
+    {
+        float* ramp = crossfadeRamp.getRawDataPointer();
+        for (int i = 0; i < bufferSize; ++i)
+            ramp[i] = (i + 1) / static_cast<float> (bufferSize);
+
+        for (int ch = 0; ch < numCh; ++ch)
+        {
+            float* out = buffer.getWritePointer (ch);
+            const float* faded = maskBuffer.getReadPointer (ch);
+            juce::FloatVectorOperations::subtract (out, faded, bufferSize);
+            juce::FloatVectorOperations::multiply (out, ramp, bufferSize);
+            juce::FloatVectorOperations::add (out, faded, bufferSize);
+        }
+    }
+
+    std::swap (reencodingMatrix, previousReencodingMatrix);
+}
+
+void DirectionalCompressorAudioProcessor::handleAsyncUpdate()
+{
+    setLatencySamples (getLatency());
+}
+
+void DirectionalCompressorAudioProcessor::detectTruePeaks (juce::AudioSampleBuffer& buffer,
+                                                           float* const* sideChains,
+                                                           const int numSideChains)
+{
+    const int bufferSize = buffer.getNumSamples();
+    for (int k = 0; k < numSideChains; ++k)
+        truePeakDetectors[k].process (sideChains[k], sideChains[k], bufferSize);
+
+    juce::dsp::AudioBlock<float> ab (buffer);
+    juce::dsp::ProcessContextReplacing<float> context (ab);
+    truePeakDelay.process (context);
 }
 
 void DirectionalCompressorAudioProcessor::calcParams()
 {
     paramChanged = false;
 
+    numMasks = juce::jlimit (1, maxNumDirections, juce::roundToInt (numDirections->load()));
+    const float widthInDegrees = width->load();
+
+    // only masks with changed directions are recalculated
+    for (int k = 0; k < numMasks; ++k)
+    {
+        auto& direction = maskDirections[k];
+        const float az = azimuths[k]->load();
+        const float el = elevations[k]->load();
+        if (direction.azimuth == az && direction.elevation == el
+            && direction.width == widthInDegrees)
+            continue;
+
+        direction = { az, el, widthInDegrees };
+        calcMask (*masks.getUnchecked (k), az, el, widthInDegrees);
+    }
+}
+
+void DirectionalCompressorAudioProcessor::calcMask (juce::dsp::Matrix<float>& mask,
+                                                    const float azimuthInDegrees,
+                                                    const float elevationInDegrees,
+                                                    const float widthInDegrees)
+{
     // convert azimuth and elevation to cartesian coordinates
     auto pos = Conversions<float>::sphericalToCartesian (
-        Conversions<float>::degreesToRadians (*azimuth),
-        Conversions<float>::degreesToRadians (*elevation));
+        Conversions<float>::degreesToRadians (azimuthInDegrees),
+        Conversions<float>::degreesToRadians (elevationInDegrees));
     pos = pos.normalised();
 
     for (int point = 0; point < tDesignN; ++point)
@@ -413,7 +704,7 @@ void DirectionalCompressorAudioProcessor::calcParams()
         dist[point] = std::acos (dist[point]);
     }
 
-    float widthHalf = Conversions<float>::degreesToRadians (*width)
+    float widthHalf = Conversions<float>::degreesToRadians (widthInDegrees)
                       * 0.25f; // it's actually width fourth (symmetric mask)
     widthHalf = juce::jmax (widthHalf, juce::FloatVectorOperations::findMinimum (dist, tDesignN));
 
@@ -436,8 +727,8 @@ void DirectionalCompressorAudioProcessor::calcParams()
             float sum = 0.0f;
             for (int i = 0; i < tDesignN; ++i)
                 sum += tempMat (r, i) * YH (c, i);
-            P1 (r, c) = sum;
-            P1 (c, r) = sum;
+            mask (r, c) = sum;
+            mask (c, r) = sum;
         }
 }
 
@@ -814,6 +1105,54 @@ std::vector<std::unique_ptr<juce::RangedAudioParameter>>
         },
         nullptr));
 
+    params.push_back (OSCParameterInterface::createParameterTheOldWay (
+        "numDirections",
+        "Number of directions",
+        "",
+        juce::NormalisableRange<float> (1.0f, maxNumDirections, 1.0f),
+        1.0f,
+        [] (float value)
+        {
+            if (value < 1.5f)
+                return juce::String ("1 (mask)");
+            return juce::String (juce::roundToInt (value));
+        },
+        nullptr));
+
+    params.push_back (OSCParameterInterface::createParameterTheOldWay (
+        "truePeak",
+        "True-Peak Detection",
+        "",
+        juce::NormalisableRange<float> (0.0f, 1.0f, 1.0f),
+        0.0f,
+        [] (float value) { return value >= 0.5f ? "ON (4x)" : "OFF"; },
+        nullptr));
+
+    // additional directions (multiple directions mode), evenly spread along the horizon
+    for (int k = 1; k < maxNumDirections; ++k)
+    {
+        const juce::String index (k + 1);
+        const float defaultAzimuth = k * 360.0f / maxNumDirections;
+
+        params.push_back (OSCParameterInterface::createParameterTheOldWay (
+            "azimuth" + index,
+            "Azimuth of direction " + index,
+            juce::CharPointer_UTF8 (R"(°)"),
+            juce::NormalisableRange<float> (-180.0f, 180.0f, 0.01f),
+            defaultAzimuth > 180.0f ? defaultAzimuth - 360.0f : defaultAzimuth,
+            [] (float value) { return juce::String (value, 2); },
+            nullptr));
+
+        params.push_back (OSCParameterInterface::createParameterTheOldWay (
+            "elevation" + index,
+            "Elevation of direction " + index,
+            juce::CharPointer_UTF8 (R"(°)"),
+            juce::NormalisableRange<float> (-180.0f, 180.0f, 0.01f),
+            0.0,
+            [] (float value) { return juce::String (value, 2); },
+            nullptr));
+    }
+
     return params;
 }
 
@@ -25,6 +25,9 @@
 #include "../../resources/AudioProcessorBase.h"
 #include "../../resources/Compressor.h"
 #include "../../resources/Conversions.h"
+#include "../../resources/DenseMatrixKernel.h"
+#include "../../resources/Delay.h"
+#include "../../resources/TruePeakDetector.h"
 #include "../../resources/ambisonicTools.h"
 #include "../../resources/efficientSHvanilla.h"
 #include "../../resources/tDesignN7.h"
@@ -36,11 +39,13 @@
 /**
 */
 class DirectionalCompressorAudioProcessor
-    : public AudioProcessorBase<IOTypes::Ambisonics<>, IOTypes::Ambisonics<>>
+    : public AudioProcessorBase<IOTypes::Ambisonics<>, IOTypes::Ambisonics<>>,
+      private juce::AsyncUpdater
 {
 public:
     constexpr static int numberOfInputChannels = 64;
     constexpr static int numberOfOutputChannels = 64;
+    constexpr static int maxNumDirections = 8;
     //==============================================================================
     DirectionalCompressorAudioProcessor();
     ~DirectionalCompressorAudioProcessor();
@@ -84,6 +89,31 @@ private:
     //==============================================================================
     void updateBuffers() override;
 
+    /** Calculates the spatial mask (a symmetric projection matrix) for the given direction. */
+    void calcMask (juce::dsp::Matrix<float>& mask,
+                   const float azimuthInDegrees,
+                   const float elevationInDegrees,
+                   const float widthInDegrees);
+
+    /** Processes the mask with compressor 1 and 2 (single direction mode). */
+    void processSingleDirection (juce::AudioSampleBuffer& buffer, const int numCh);
+
+    /** Processes K directions, each with its own compressor, by a single re-encoding matrix. */
+    void processMultipleDirections (juce::AudioSampleBuffer& buffer,
+                                    const int numCh,
+                                    const int nDirections);
+
+    /** Replaces the side chain signals by their true peaks and delays the audio signal by the
+        detector's latency. */
+    void detectTruePeaks (juce::AudioSampleBuffer& buffer,
+                          float* const* sideChains,
+                          const int numSideChains);
+
+    int getLatency() { return *truePeak >= 0.5f ? TruePeakDetector::getLatencyInSamples() : 0; }
+
+    /** Reports the latency of the true-peak detection to the host, on the message thread. */
+    void handleAsyncUpdate() override;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (DirectionalCompressorAudioProcessor)
 
     juce::AudioBuffer<float> omniW;
@@ -92,7 +122,31 @@ private:
     juce::dsp::Matrix<float> Y;
     juce::dsp::Matrix<float> YH;
     juce::dsp::Matrix<float> tempMat;
-    juce::dsp::Matrix<float> P1;
+    struct MaskDirection
+    {
+        float azimuth = NAN;
+        float elevation = NAN;
+        float width = NAN;
+    };
+
+    juce::OwnedArray<juce::dsp::Matrix<float>> masks; // one mask per direction, P1 first
+    MaskDirection maskDirections[maxNumDirections];
+    int numMasks = 1;
+
+    // multiple directions: T = I + sum_k (g_k - 1) * P_k, crossfaded from block to block
+    juce::dsp::Matrix<float> reencodingMatrix;
+    juce::dsp::Matrix<float> previousReencodingMatrix;
+    bool resetReencodingMatrix = true;
+    DenseMatrixKernel matrixKernel;
+    juce::AudioBuffer<float> beamBuffer;
+    juce::AudioBuffer<float> directionGains;
+    juce::Array<float> crossfadeRamp;
+    iem::Compressor directionCompressors[maxNumDirections];
+
+    // true-peak detection, one detector per side chain signal
+    TruePeakDetector truePeakDetectors[maxNumDirections];
+    Delay truePeakDelay;
+    bool truePeakWasActive = false;
 
     float dist[tDesignN];
 
@@ -116,6 +170,10 @@ private:
     std::atomic<float>* elevation;
     std::atomic<float>* width;
     std::atomic<float>* listen;
+    std::atomic<float>* numDirections;
+    std::atomic<float>* truePeak;
+    std::atomic<float>* azimuths[maxNumDirections];
+    std::atomic<float>* elevations[maxNumDirections];
     // compressor 1
     std::atomic<float>* c1Enabled;
     std::atomic<float>* c1DrivingSignal;
@@ -133,10 +133,7 @@ void DualDelayAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBl
                                        * parameters.getParameterRange ("delayMultL").start)
                                 + maxLfoDepth));
 
-    juce::dsp::ProcessSpec specDelay;
-    specDelay.sampleRate = sampleRate;
-    specDelay.numChannels = numberOfOutputChannels;
-    specDelay.maximumBlockSize = samplesPerBlock;
+    delayTimes.setSize (2, samplesPerBlock);
 
     juce::dsp::ProcessSpec specLFO;
     specLFO.sampleRate = sampleRate;
@@ -159,16 +156,13 @@ void DualDelayAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBl
         delayBuffer[i].clear();
         delayOutBuffer[i].clear();
 
-        delayLine[i].reset();
-        delayLine[i].prepare (specDelay);
-
-        delayLine[i].setMaximumDelayInSamples (maxDelay);
-        delayLine[i].setDelay (sampleRate * 60.0f / (*delayBPM[0] * *delayMult[0]));
+        delayLine[i].prepare (numberOfOutputChannels, maxDelay);
 
         delayTimeInterp[i].setFrequency (0.5f, sampleRate);
 
         auto tmp_prdersetting = orderSetting->load();
 
+        rotator[i].prepare (samplesPerBlock);
         rotator[i].updateParams (*yaw[i], *pitch[i], *roll[i], static_cast<int> (*orderSetting));
         warp[i].updateParams (
             AmbisonicWarp<maxOrder>::AzimuthWarpType (juce::roundToInt (warpModeAz[i]->load())),
@@ -283,23 +277,18 @@ void DualDelayAudioProcessor::processBlock (juce::AudioSampleBuffer& buffer,
     {
         LFO[i].setFrequency (*lfoRate[i]);
 
-        // Cycle through it on sample basis for smooth delay time changes
+        // Delay times on sample basis for smooth delay time changes, the delay line
+        // interpolates all channels at once
+        float* currentDelay = delayTimes.getWritePointer (i);
         for (int sample = 0; sample < spb; ++sample)
-        {
-            float currentDelay = delayTimeInterp[i].process()
-                                 + LFO[i].processSample (1.0f) * msToSamples * *lfoDepth[i];
-
-            for (int channel = 0; channel < nCh; ++channel)
-            {
-                // Push samples into delay line
-                delayLine[i].pushSample (channel, delayBuffer[i].getSample (channel, sample));
-
-                // Pop samples from delay line to output buffer
-                delayOutBuffer[i].setSample (channel,
-                                             sample,
-                                             delayLine[i].popSample (channel, currentDelay));
-            }
-        }
+            currentDelay[sample] = delayTimeInterp[i].process()
+                                   + LFO[i].processSample (1.0f) * msToSamples * *lfoDepth[i];
+
+        delayLine[i].process (delayBuffer[i].getArrayOfReadPointers(),
+                              delayOutBuffer[i].getArrayOfWritePointers(),
+                              currentDelay,
+                              nCh,
+                              spb);
     }
 
     // ========== Calculate output ==========
@@ -27,6 +27,7 @@
 #include "../../resources/AmbisonicRotator.h"
 #include "../../resources/AmbisonicWarp.h"
 #include "../../resources/AudioProcessorBase.h"
+#include "../../resources/MultiChannelModulatedDelay.h"
 #include "../../resources/OnePoleFilter.h"
 #include "../../resources/ambisonicTools.h"
 
@@ -109,7 +110,8 @@ private:
     juce::OwnedArray<juce::IIRFilter> lowPassFilters[2];
     juce::OwnedArray<juce::IIRFilter> highPassFilters[2];
 
-    juce::dsp::DelayLine<float, juce::dsp::DelayLineInterpolationTypes::Lagrange3rd> delayLine[2];
+    MultiChannelModulatedDelay delayLine[2];
+    juce::AudioBuffer<float> delayTimes; // per-sample delay of both sides in samples
     juce::AudioBuffer<float> delayBuffer[2];
     juce::AudioBuffer<float> delayOutBuffer[2];
     OnePoleFilter<float> delayTimeInterp[2];
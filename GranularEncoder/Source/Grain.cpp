@@ -29,112 +29,91 @@ Grain::Grain()
     _blockCounter = 0;
 }
 
-void Grain::setBlockSize (int numSampOutBuffer)
-{
-    _outputBuffer.setSize (1, numSampOutBuffer);
-    _outputBuffer.clear();
-}
-
-void Grain::startGrain (const GrainJobParameters& grainParameters) // Type envelopeType)
+void Grain::startGrain (const GrainJobParameters& grainParameters,
+                        const GrainWindowTable& windowTable)
 {
     _params = grainParameters;
+    _fadeIn = windowTable.getFadeIn (_params.windowAttackSamples);
+    _fadeOut = windowTable.getFadeOut (_params.windowDecaySamples);
+    _decayStart = GrainWindowTable::windowResolution - _params.windowDecaySamples;
 
     _isActive = true;
     _currentIndex = 0;
     _blockCounter = 0;
-
-    _outputBuffer.clear();
 }
 
-void Grain::processBlock (juce::AudioBuffer<float>& buffer,
-                          juce::AudioBuffer<float>& circularBuffer)
+void Grain::processBlock (float* output,
+                          const int numSamples,
+                          const juce::AudioBuffer<float>& circularBuffer)
 {
+    juce::FloatVectorOperations::clear (output, numSamples);
+
     if (! _isActive)
         return;
 
-    int numSampCircBuffer = circularBuffer.getNumSamples();
-    int numSampOutBuffer = buffer.getNumSamples();
-    jassert (_outputBuffer.getNumSamples() == numSampOutBuffer);
-
-    _outputBuffer.clear();
-    int nChOut = buffer.getNumChannels();
+    const int numSampCircBuffer = circularBuffer.getNumSamples();
+    const float* circularBuffToSeed =
+        circularBuffer.getReadPointer (_params.seedFromLeftCircBuffer ? 0 : 1);
 
-    const float* circularLeftChannel = circularBuffer.getReadPointer (0);
-    const float* circularRightChannel = circularBuffer.getReadPointer (1);
+    const int windowNumSamples = GrainWindowTable::windowResolution;
 
-    const float* circularBuffToSeed;
-    if (_params.seedFromLeftCircBuffer)
-        circularBuffToSeed = circularLeftChannel;
-    else
-        circularBuffToSeed = circularRightChannel;
+    const int outStart = _blockCounter == 0 ? _params.startOffsetInBlock : 0;
+    const int outEnd =
+        juce::jmin (numSamples, outStart + _params.grainLengthSamples - _currentIndex);
 
-    const float* window_ptr = _params.windowBuffer.getReadPointer (0);
-    const int windowNumSamples = _params.windowBuffer.getNumSamples();
+    int i = outStart;
+    while (i < outEnd)
+    {
+        // The grain is rendered in segments which don't reach the end of the circular buffer,
+        // so the read indices only need to be shifted by a multiple of its length. The
+        // segment ends two samples early to be safe from rounding errors.
+        const float segmentStart =
+            _params.startPositionCircBuffer + (_currentIndex * _params.pitchReadFactor);
+        const int wrapOffset =
+            (static_cast<int> (segmentStart) / numSampCircBuffer) * numSampCircBuffer;
+        const float samplesToEnd =
+            (static_cast<float> (wrapOffset + numSampCircBuffer - 1) - segmentStart)
+            / _params.pitchReadFactor;
+        const int segmentEnd = juce::jmin (outEnd, i + static_cast<int> (samplesToEnd) - 2);
+
+        if (segmentEnd <= i)
+        {
+            // the samples around the end of the circular buffer are read with modulo
+            const int readIndexInt = static_cast<int> (segmentStart);
+            const float sampleFracWeight = segmentStart - readIndexInt;
+            const float sampleIntPart = circularBuffToSeed[readIndexInt % numSampCircBuffer];
+            const float sampleFracPart =
+                circularBuffToSeed[(readIndexInt + 1) % numSampCircBuffer] - sampleIntPart;
 
-    float* outputBufferWritePtr = _outputBuffer.getWritePointer (0);
+            output[i] = (sampleIntPart + sampleFracWeight * sampleFracPart)
+                        * getWindowValue (windowNumSamples);
 
-    int outStart;
-    if (_blockCounter == 0)
-    {
-        outStart = _params.startOffsetInBlock;
-    }
-    else
-    {
-        outStart = 0;
-    }
+            _currentIndex++;
+            i++;
+            continue;
+        }
 
-    // Write samples to internal mono buffer
-    for (int i = outStart; i < numSampOutBuffer; i++)
-    {
-        if (_currentIndex < _params.grainLengthSamples) // grain still needs samples
+        for (; i < segmentEnd; i++)
         {
             // Linear interpolation of buffer samples
             float readIndex =
                 _params.startPositionCircBuffer + (_currentIndex * _params.pitchReadFactor);
             int readIndexInt = static_cast<int> (readIndex);
-            int readIndexIntNext = readIndexInt + 1;
             float sampleFracWeight = readIndex - readIndexInt;
-
-            readIndexInt %= numSampCircBuffer;
-            readIndexIntNext %= numSampCircBuffer;
+            readIndexInt -= wrapOffset;
 
             float sampleIntPart = circularBuffToSeed[readIndexInt];
-            float sampleFracPart = circularBuffToSeed[readIndexIntNext] - sampleIntPart;
+            float sampleFracPart = circularBuffToSeed[readIndexInt + 1] - sampleIntPart;
             float sampleValue = sampleIntPart + sampleFracWeight * sampleFracPart;
 
-            // Linear interpolation for grain window function
-            float windowIndex = static_cast<float> (_currentIndex)
-                                / static_cast<float> (_params.grainLengthSamples)
-                                * (windowNumSamples - 1);
-            int windowIndexInt = static_cast<int> (windowIndex);
-            jassert (windowIndexInt >= 0 && windowIndexInt < (windowNumSamples - 1));
-
-            int windowIndexIntNext = windowIndexInt + 1;
-            float windowFracWeight = windowIndex - windowIndexInt;
-            float windowIntPart = window_ptr[windowIndexInt];
-            float windFracPart = window_ptr[windowIndexIntNext] - windowIntPart;
-            float windowValue = windowIntPart + windowFracWeight * windFracPart;
-            jassert (windowValue >= 0.0f && windowValue <= 1.0f);
-            outputBufferWritePtr[i] = sampleValue * windowValue;
+            output[i] = sampleValue * getWindowValue (windowNumSamples);
 
             _currentIndex++;
         }
-        else
-        {
-            _isActive = false;
-            break;
-        }
     }
 
-    const float* outputBufferReadPtr = _outputBuffer.getReadPointer (0);
-    for (int ch = 0; ch < nChOut; ++ch)
-    {
-        buffer.addFrom (ch,
-                        0,
-                        outputBufferReadPtr,
-                        buffer.getNumSamples(),
-                        _params.channelWeights[ch] * _params.gainFactor);
-    }
+    if (_currentIndex >= _params.grainLengthSamples)
+        _isActive = false;
 
     _blockCounter++;
 };
@@ -143,3 +122,10 @@ bool Grain::isActive() const
 {
     return _isActive;
 };
+
+void Grain::reset()
+{
+    _isActive = false;
+    _currentIndex = 0;
+    _blockCounter = 0;
+}
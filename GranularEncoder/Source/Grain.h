@@ -20,6 +20,7 @@
  ==============================================================================
  */
 
+#include "GrainWindowTable.h"
 #include "JuceHeader.h"
 
 class Grain
@@ -34,21 +35,63 @@ public:
         std::array<float, 64> channelWeights;
         float gainFactor = 1.0f;
         bool seedFromLeftCircBuffer = true;
-        juce::AudioBuffer<float> windowBuffer;
+        int windowAttackSamples = 0; // fade lengths of the window, see GrainWindowTable
+        int windowDecaySamples = 0;
     };
 
     Grain();
 
-    void setBlockSize (int numSampOutBuffer);
-    void startGrain (const GrainJobParameters& grainParameters);
-    void processBlock (juce::AudioBuffer<float>& buffer, juce::AudioBuffer<float>& circularBuffer);
+    /** Starts the grain, the window table has to outlive it. Doesn't allocate. */
+    void startGrain (const GrainJobParameters& grainParameters,
+                     const GrainWindowTable& windowTable);
+
+    /** Renders the windowed mono grain signal into output (numSamples samples, zero where the
+        grain doesn't sound). Encoding with getChannelWeights() and getGainFactor() is left to
+        the caller, so many grains can be encoded at once. */
+    void processBlock (float* output,
+                       const int numSamples,
+                       const juce::AudioBuffer<float>& circularBuffer);
 
     bool isActive() const;
 
+    /** Stops the grain immediately. */
+    void reset();
+
+    const float* getChannelWeights() const { return _params.channelWeights.data(); }
+    float getGainFactor() const { return _params.gainFactor; }
+
 private:
+    float getWindowSample (const int index) const
+    {
+        if (index < _params.windowAttackSamples)
+            return _fadeIn[index];
+        if (index >= _decayStart)
+            return _fadeOut[index - _decayStart];
+        return 1.0f;
+    }
+
+    /** Linear interpolation of the grain window at the current index. */
+    float getWindowValue (const int windowNumSamples) const
+    {
+        float windowIndex = static_cast<float> (_currentIndex)
+                            / static_cast<float> (_params.grainLengthSamples)
+                            * (windowNumSamples - 1);
+        int windowIndexInt = static_cast<int> (windowIndex);
+        jassert (windowIndexInt >= 0 && windowIndexInt < (windowNumSamples - 1));
+
+        float windowFracWeight = windowIndex - windowIndexInt;
+        float windowIntPart = getWindowSample (windowIndexInt);
+        float windFracPart = getWindowSample (windowIndexInt + 1) - windowIntPart;
+        float windowValue = windowIntPart + windowFracWeight * windFracPart;
+        jassert (windowValue >= 0.0f && windowValue <= 1.0f);
+        return windowValue;
+    }
+
     GrainJobParameters _params;
+    const float* _fadeIn = nullptr;
+    const float* _fadeOut = nullptr;
+    int _decayStart = GrainWindowTable::windowResolution;
     int _currentIndex;
     bool _isActive;
     int _blockCounter;
-    juce::AudioBuffer<float> _outputBuffer;
 };
@@ -0,0 +1,99 @@
+/*
+ ==============================================================================
+ This file is part of the IEM plug-in suite.
+ Author: Daniel Rudrich
+ Copyright (c) 2024 - Institute of Electronic Music and Acoustics (IEM)
+ https://iem.at
+
+ The IEM plug-in suite is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ The IEM plug-in suite is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this software.  If not, see <https://www.gnu.org/licenses/>.
+ ==============================================================================
+ */
+
+#pragma once
+
+#include "JuceHeader.h"
+
+/**
+ Precomputed fades of the grain windows. A grain window of windowResolution samples consists of
+ a sine-squared fade-in, a rectangular part and a cosine-squared fade-out, with fade lengths of
+ up to half the window. Instead of rendering the window of each grain into its own buffer, the
+ fades of all possible lengths are computed once, and grains only refer to them.
+
+ The table is constant, so all plug-in instances share one via juce::SharedResourcePointer.
+ */
+class GrainWindowTable
+{
+public:
+    static constexpr int windowResolution = 1024;
+    static constexpr int maxFadeLength = windowResolution / 2;
+
+    GrainWindowTable()
+    {
+        const int numValues = maxFadeLength * (maxFadeLength + 1) / 2;
+        fadeIns.resize (numValues);
+        fadeOuts.resize (numValues);
+
+        const float pi_over_two = juce::MathConstants<float>::pi / 2.0f;
+        for (int length = 1; length <= maxFadeLength; ++length)
+        {
+            float* fadeIn = fadeIns.data() + getOffset (length);
+            float* fadeOut = fadeOuts.data() + getOffset (length);
+            const float lengthFloat = static_cast<float> (length);
+
+            float sumIn = 0.0f;
+            float sumOut = 0.0f;
+            for (int i = 0; i < length; ++i)
+            {
+                const float phase = static_cast<float> (i) / lengthFloat * pi_over_two;
+                fadeIn[i] = std::pow (std::sin (phase), 2);
+                fadeOut[i] = std::pow (std::cos (phase), 2);
+                sumIn += fadeIn[i] * fadeIn[i];
+                sumOut += fadeOut[i] * fadeOut[i];
+            }
+
+            fadeInEnergy[length] = sumIn;
+            fadeOutEnergy[length] = sumOut;
+        }
+    }
+
+    /** Sine-squared fade-in with length samples, rising from zero. */
+    const float* getFadeIn (const int length) const
+    {
+        jassert (length >= 0 && length <= maxFadeLength);
+        return fadeIns.data() + getOffset (length);
+    }
+
+    /** Cosine-squared fade-out with length samples, falling from one. */
+    const float* getFadeOut (const int length) const
+    {
+        jassert (length >= 0 && length <= maxFadeLength);
+        return fadeOuts.data() + getOffset (length);
+    }
+
+    /** Mean of the squared window with the given fade lengths. */
+    float getMeanSquare (const int attackLength, const int decayLength) const
+    {
+        const float sum = fadeInEnergy[attackLength] + fadeOutEnergy[decayLength]
+                          + static_cast<float> (windowResolution - attackLength - decayLength);
+        return sum / static_cast<float> (windowResolution);
+    }
+
+private:
+    /** Fades of length 1 to maxFadeLength are stored one after another. */
+    static int getOffset (const int length) { return length * (length - 1) / 2; }
+
+    std::vector<float> fadeIns, fadeOuts;
+    float fadeInEnergy[maxFadeLength + 1] = {};
+    float fadeOutEnergy[maxFadeLength + 1] = {};
+};
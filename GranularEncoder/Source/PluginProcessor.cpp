@@ -108,6 +108,8 @@ GranularEncoderAudioProcessor::GranularEncoderAudioProcessor() :
     sphericalInput = true; // input from ypr
 
     juce::FloatVectorOperations::clear (SHC, 64);
+
+    randomSeed = juce::Random::getSystemRandom().nextInt64();
 }
 
 GranularEncoderAudioProcessor::~GranularEncoderAudioProcessor() = default;
@@ -162,12 +164,17 @@ void GranularEncoderAudioProcessor::prepareToPlay (double sampleRate, int sample
     writeGainCircBuffer.setCurrentAndTargetValue (1.0f);
 
     lastSampleRate = sampleRate;
-    deltaTimeSamples = 0;
 
-    for (int g = 0; g < maxNumGrains; g++)
-    {
-        grains[g].setBlockSize (samplesPerBlock);
-    }
+    grainSignals.setSize (maxNumGrains, samplesPerBlock);
+    grainEncoder.prepare (maxNumGrains);
+    for (int ch = 0; ch < 64; ++ch)
+        grainEncoderRows[ch] = grainEncoderMatrix[ch];
+
+    // restart the grain cloud and its random sequence, so renders are reproducible
+    grainCloudNeedsRestart = false;
+    restartGrainCloud();
+    grainOnsets.ensureStorageAllocated (samplesPerBlock);
+    grainVariates.setSize (numGrainVariates, samplesPerBlock);
 
     const iem::Quaternion<float> quatC = quaternionDirection;
 
@@ -241,15 +248,13 @@ juce::Vector3D<float> GranularEncoderAudioProcessor::getRandomGrainDirection3D()
 
     // Uniform random distribution in [0,2*pi]
     float rand_phi =
-        juce::Random::getSystemRandom().nextFloat() * 2.0f * juce::MathConstants<float>::pi;
+        random.nextFloat() * 2.0f * juce::MathConstants<float>::pi;
 
     // Beta distribution to control shape of rotationally symmetric distribution around centerDir
     jassert (shape_param >= 1.0f);
-    // beta_distribution<float> dist(shape, shape); // -> realized with std::gamma_distribution
-    std::gamma_distribution<float> dist1 (shape_param, 1.0f);
-    std::gamma_distribution<float> dist2 (shape_param, 1.0f);
-    float gamma1 = dist1 (rng);
-    float gamma2 = dist2 (rng);
+    // beta_distribution<float> dist(shape, shape); // -> realized with two gamma variates
+    float gamma1 = random.nextGamma (shape_param);
+    float gamma2 = random.nextGamma (shape_param);
     float eps = 1e-16f;
     float beta_val = (gamma1 + eps) / (gamma1 + gamma2 + eps);
 
@@ -299,15 +304,13 @@ juce::Vector3D<float> GranularEncoderAudioProcessor::getRandomGrainDirection2D()
     float zen_center = (juce::MathConstants<float>::pi / 2.0f) - ele_center;
 
     // Uniform random distribution in [0,2*pi]
-    // float rand_phi = juce::Random::getSystemRandom().nextFloat() * 2.0f * juce::MathConstants<float>::pi;
+    // float rand_phi = random.nextFloat() * 2.0f * juce::MathConstants<float>::pi;
 
     // Beta distribution to control shape of rotationally symmetric distribution around centerDir
     jassert (shape_param >= 1.0f);
-    // beta_distribution<float> dist(shape, shape); // -> realized with std::gamma_distribution
-    std::gamma_distribution<float> dist1 (shape_param, 1.0f);
-    std::gamma_distribution<float> dist2 (shape_param, 1.0f);
-    float gamma1 = dist1 (rng);
-    float gamma2 = dist2 (rng);
+    // beta_distribution<float> dist(shape, shape); // -> realized with two gamma variates
+    float gamma1 = random.nextGamma (shape_param);
+    float gamma2 = random.nextGamma (shape_param);
     float eps = 1e-16f;
     float beta_val = (gamma1 + eps) / (gamma1 + gamma2 + eps);
 
@@ -323,7 +326,7 @@ juce::Vector3D<float> GranularEncoderAudioProcessor::getRandomGrainDirection2D()
     float beta_sized = sym_beta_sample * size_factor;
 
     // azi_center +- random spread
-    float sign = (juce::Random::getSystemRandom().nextFloat() > 0.5f) * 2.0f - 1.0f;
+    float sign = (random.nextFloat() > 0.5f) * 2.0f - 1.0f;
     float rand_phi = azi_center + juce::MathConstants<float>::pi * beta_sized * sign;
 
     float sinZenith = sin (zen_center);
@@ -335,7 +338,9 @@ juce::Vector3D<float> GranularEncoderAudioProcessor::getRandomGrainDirection2D()
     return vec;
 }
 
-juce::AudioBuffer<float> GranularEncoderAudioProcessor::getWindowBuffer (float modWeight)
+std::pair<int, int> GranularEncoderAudioProcessor::getWindowFadeLengths (float modWeight,
+                                                                        float attackVariate,
+                                                                        float decayVariate)
 {
     const float attackPercentage = *windowAttack;
     const float decayPercentage = *windowDecay;
@@ -344,60 +349,29 @@ juce::AudioBuffer<float> GranularEncoderAudioProcessor::getWindowBuffer (float m
     const float decayModPercentage = *windowDecayMod;
 
     float newAttackPercentage = attackPercentage
-                                + (juce::Random::getSystemRandom().nextFloat() - 0.5f) * 2.0f
+                                + (attackVariate - 0.5f) * 2.0f
                                       * modWeight * attackModPercentage;
     newAttackPercentage = std::min (newAttackPercentage, 50.0f);
     newAttackPercentage = std::max (newAttackPercentage, 0.0f);
 
     float newDecayPercentage = decayPercentage
-                               + (juce::Random::getSystemRandom().nextFloat() - 0.5f) * 2.0f
+                               + (decayVariate - 0.5f) * 2.0f
                                      * modWeight * decayModPercentage;
     newDecayPercentage = std::min (newDecayPercentage, 50.0f);
     newDecayPercentage = std::max (newDecayPercentage, 0.0f);
 
-    const int windowNumSamples = windowResolution;
-    const int windowHalfNumSamples = windowResolution / 2;
+    const int windowNumSamples = GrainWindowTable::windowResolution;
 
     const int windowAttackSamples = newAttackPercentage / 100.0f * windowNumSamples;
     const int windowDecaySamples = newDecayPercentage / 100.0f * windowNumSamples;
 
-    juce::AudioBuffer<float> windowBuffer;
-    windowBuffer.setSize (1, windowResolution);
-
-    float* windowBufferWritePtr = windowBuffer.getWritePointer (0);
-
-    float pi_over_two = (juce::MathConstants<float>::pi / 2.0f);
-
-    float windowAttackSamplesFloat = static_cast<float> (windowAttackSamples);
-    float windowDecaySamplesFloat = static_cast<float> (windowDecaySamples);
-    for (int i = 0; i < windowAttackSamples; i++)
-    {
-        // sine-squared fade-in
-        windowBufferWritePtr[i] =
-            std::pow (std::sin (static_cast<float> (i) / windowAttackSamplesFloat * pi_over_two),
-                      2);
-    }
-    for (int i = windowAttackSamples; i < (windowNumSamples - windowDecaySamples); i++)
-    {
-        // rectangular part
-        windowBufferWritePtr[i] = 1.0f;
-    }
-    int c = 0;
-    for (int i = (windowNumSamples - windowDecaySamples); i < windowNumSamples; i++)
-    {
-        // cosine-squared fade-out
-        windowBufferWritePtr[i] =
-            std::pow (std::cos (static_cast<float> (c) / windowDecaySamplesFloat * pi_over_two), 2);
-        c++;
-    }
-
-    return windowBuffer;
+    return std::make_pair (windowAttackSamples, windowDecaySamples);
 }
 
-int GranularEncoderAudioProcessor::getStartPositionCircBuffer() const
+int GranularEncoderAudioProcessor::getStartPositionCircBuffer (float variate)
 {
     float modulatedPosition =
-        *position + (*positionMod * juce::Random::getSystemRandom().nextFloat());
+        *position + (*positionMod * variate);
 
     //  Unidirectional modulation of seed index parameter
     int startPositionCircBuffer =
@@ -410,11 +384,13 @@ int GranularEncoderAudioProcessor::getStartPositionCircBuffer() const
     return startPositionCircBuffer;
 }
 
-std::pair<int, float> GranularEncoderAudioProcessor::getGrainLengthAndPitchFactor() const
+std::pair<int, float>
+    GranularEncoderAudioProcessor::getGrainLengthAndPitchFactor (float lengthVariate,
+                                                                 float pitchVariate)
 {
     // Bidirectional modulation of grain length
     float grainLengthModSeconds = *grainLengthMod / 100.0f * *grainLength * 2
-                                  * (juce::Random::getSystemRandom().nextFloat() - 0.5f);
+                                  * (lengthVariate - 0.5f);
     float newGrainLengthSeconds = *grainLength + grainLengthModSeconds;
     newGrainLengthSeconds = std::min (newGrainLengthSeconds, MAX_GRAIN_LENGTH);
     newGrainLengthSeconds = std::max (newGrainLengthSeconds, MIN_GRAIN_LENGTH);
@@ -425,7 +401,7 @@ std::pair<int, float> GranularEncoderAudioProcessor::getGrainLengthAndPitchFacto
     // Unidirectional modulation of pitch (due to hard real-time constraint)
     const float maxPitchModulation = 12.0f;
     float pitchModSemitones =
-        *pitchMod * (juce::Random::getSystemRandom().nextFloat() - 0.5f) * 2.0f;
+        *pitchMod * (pitchVariate - 0.5f) * 2.0f;
     float pitchToUse = *pitch - pitchModSemitones;
     if (mode != OperationMode::Freeze)
     {
@@ -443,11 +419,11 @@ std::pair<int, float> GranularEncoderAudioProcessor::getGrainLengthAndPitchFacto
     return std::make_pair (grainLengthSamples, pitchReadFactor);
 }
 
-int GranularEncoderAudioProcessor::getDeltaTimeSamples()
+int GranularEncoderAudioProcessor::getDeltaTimeSamples (float variate)
 {
     // Bidirectional modulation of deltaTime between grains
     float deltaTimeModSeconds = *deltaTimeMod / 100.0f * *deltaTime * 2.0f
-                                * (juce::Random::getSystemRandom().nextFloat() - 0.5f);
+                                * (variate - 0.5f);
     float newDeltaTime = *deltaTime + deltaTimeModSeconds;
     newDeltaTime = std::min (newDeltaTime, MAX_DELTA_T);
     newDeltaTime = std::max (newDeltaTime, MIN_DELTA_T);
@@ -456,13 +432,12 @@ int GranularEncoderAudioProcessor::getDeltaTimeSamples()
     return deltaTimeSamples;
 }
 
-bool GranularEncoderAudioProcessor::getChannelToSeed()
+bool GranularEncoderAudioProcessor::getChannelToSeed (float variate)
 {
     float seedSetting = (*sourceProbability / 2.0f) + 0.5f;
-    float randomNumber = juce::Random::getSystemRandom().nextFloat();
 
     bool seedLeft;
-    if (randomNumber > seedSetting)
+    if (variate > seedSetting)
         seedLeft = true;
     else
         seedLeft = false;
@@ -509,17 +484,8 @@ void GranularEncoderAudioProcessor::finishModeTransition()
 
 float GranularEncoderAudioProcessor::getMeanWindowGain()
 {
-    juce::AudioBuffer<float> meanWindow = getWindowBuffer (0.0f);
-    const float* meanWindowReadPtr = meanWindow.getReadPointer (0);
-    const int numSamplesWindow = meanWindow.getNumSamples();
-    float windowGain = 0.0f;
-    for (int i = 0; i < numSamplesWindow; i++)
-    {
-        windowGain += std::pow (meanWindowReadPtr[i], 2.0f);
-    }
-    windowGain = windowGain / static_cast<float> (numSamplesWindow);
-
-    return windowGain;
+    const auto fadeLengths = getWindowFadeLengths (0.0f, 0.5f, 0.5f);
+    return windowTable->getMeanSquare (fadeLengths.first, fadeLengths.second);
 }
 
 // void GranularEncoderAudioProcessor::writeCircularBufferToDisk(juce::String filename)
@@ -551,6 +517,9 @@ void GranularEncoderAudioProcessor::processBlock (juce::AudioBuffer<float>& buff
     const int L = buffer.getNumSamples();
     const int totalNumInputChannels = getTotalNumInputChannels() < 2 ? 1 : 2;
 
+    if (grainCloudNeedsRestart.exchange (false))
+        restartGrainCloud();
+
     const int ambisonicOrder =
         *orderSetting < 0.5f ? output.getOrder() : juce::roundToInt (orderSetting->load()) - 1;
     const int nChOut = juce::jmin (buffer.getNumChannels(), juce::square (ambisonicOrder + 1));
@@ -609,6 +578,9 @@ void GranularEncoderAudioProcessor::processBlock (juce::AudioBuffer<float>& buff
     bool freeze_gui_state = getFreezeGUIBool();
     initializeModeTransition (freeze_gui_state);
 
+    scheduleGrains (buffer.getNumSamples());
+    int nextOnset = 0;
+
     for (int i = 0; i < buffer.getNumSamples(); i++)
     {
         float nextCircBuffGain = writeGainCircBuffer.getNextValue();
@@ -621,53 +593,10 @@ void GranularEncoderAudioProcessor::processBlock (juce::AudioBuffer<float>& buff
             circularBuffer.setSample (1, circularBufferWriteHead, rightIn[i] * nextCircBuffGain);
         }
 
-        if (grainTimeCounter >= deltaTimeSamples)
+        if (nextOnset < grainOnsets.size() && grainOnsets.getUnchecked (nextOnset) == i)
         {
             // start a grain at this sample time stamp (index i)
-            grainTimeCounter = 0;
-            // reset (possibly modulating) deltaTime after a grain is started
-            deltaTimeSamples = getDeltaTimeSamples();
-            for (int g = 0; g < maxNumGrains; g++)
-            {
-                if (! grains[g].isActive())
-                {
-                    // find the first free grain processor and pass parameters
-                    juce::Vector3D<float> grainDir;
-                    if (*spatialize2D > 0.5f)
-                        grainDir = getRandomGrainDirection2D();
-                    else
-                        grainDir = getRandomGrainDirection3D();
-                    SHEval (ambisonicOrder, grainDir.x, grainDir.y, grainDir.z, _grainSH[g]);
-                    if (*useSN3D > 0.5f)
-                    {
-                        juce::FloatVectorOperations::multiply (_grainSH[g],
-                                                               _grainSH[g],
-                                                               n3d2sn3d,
-                                                               nChOut);
-                    }
-
-                    std::array<float, 64> channelWeights;
-                    std::copy (_grainSH[g], _grainSH[g] + 64, channelWeights.begin());
-                    Grain::GrainJobParameters params;
-                    params.startPositionCircBuffer = getStartPositionCircBuffer();
-                    auto grainLengthAndPitch = getGrainLengthAndPitchFactor();
-                    params.grainLengthSamples = grainLengthAndPitch.first;
-                    params.pitchReadFactor = grainLengthAndPitch.second;
-                    params.startOffsetInBlock = i;
-                    params.channelWeights = channelWeights;
-                    params.gainFactor = gainFactor;
-                    params.seedFromLeftCircBuffer = getChannelToSeed();
-
-                    params.windowBuffer = getWindowBuffer (1.0f);
-                    grains[g].startGrain (params);
-                    break;
-                }
-            }
-        }
-        else
-        {
-            // if it's not time for a grain yet, just increment the counter
-            grainTimeCounter++;
+            startGrain (nextOnset++, ambisonicOrder, nChOut, gainFactor);
         }
 
         if (mode != OperationMode::Freeze)
@@ -681,17 +610,38 @@ void GranularEncoderAudioProcessor::processBlock (juce::AudioBuffer<float>& buff
         }
     }
 
-    // Render all active grains
-    int numActiveGrains = 0;
-    for (int g = 0; g < maxNumGrains; g++)
+    // Render all active grains, finished ones are returned to the free list
+    const int numSamples = buffer.getNumSamples();
+    int numRenderedGrains = 0;
+    for (int a = numActiveGrains; --a >= 0;)
     {
-        if (grains[g].isActive())
+        const int g = activeGrains[a];
+        grains[g].processBlock (grainSignals.getWritePointer (numRenderedGrains),
+                                numSamples,
+                                circularBuffer);
+
+        const float* channelWeights = grains[g].getChannelWeights();
+        const float grainGain = grains[g].getGainFactor();
+        for (int ch = 0; ch < nChOut; ++ch)
+            grainEncoderMatrix[ch][numRenderedGrains] = channelWeights[ch] * grainGain;
+        ++numRenderedGrains;
+
+        if (! grains[g].isActive())
         {
-            numActiveGrains++;
-            grains[g].processBlock (wetAmbiBuffer, circularBuffer);
+            activeGrains[a] = activeGrains[--numActiveGrains];
+            freeGrains[numFreeGrains++] = g;
         }
     }
 
+    // Encode all grains at once, the wet buffer holds nothing else
+    if (numRenderedGrains > 0)
+        grainEncoder.process (grainEncoderRows,
+                              wetAmbiBuffer.getArrayOfWritePointers(),
+                              nChOut,
+                              grainSignals.getArrayOfReadPointers(),
+                              numRenderedGrains,
+                              numSamples);
+
     for (int i = 0; i < nChOut; ++i)
     {
         buffer.addFrom (i, 0, dryAmbiBuffer, i, 0, buffer.getNumSamples(), dryFactor);
@@ -701,6 +651,115 @@ void GranularEncoderAudioProcessor::processBlock (juce::AudioBuffer<float>& buff
     juce::FloatVectorOperations::copy (_SHC, SHC, nChOut);
 }
 
+void GranularEncoderAudioProcessor::scheduleGrains (const int numSamples)
+{
+    grainOnsets.clearQuick();
+
+    // a grain starts when the counter has reached deltaTimeSamples, which restarts the counter,
+    // so the onsets of the whole block follow from the counter and the modulated delta times
+    int onset = juce::jmax (0, deltaTimeSamples - grainTimeCounter);
+    if (onset < numSamples)
+    {
+        // the shortest possible delta time limits the number of onsets, so the variates of all
+        // of them can be drawn at once (one sample less, in case of rounding differences)
+        const float minDeltaTime =
+            juce::jlimit (MIN_DELTA_T, MAX_DELTA_T, *deltaTime * (1.0f - *deltaTimeMod / 100.0f));
+        const int minDeltaTimeSamples =
+            juce::jmax (0, juce::roundToInt (lastSampleRate * minDeltaTime) - 1);
+        const int maxNumOnsets =
+            juce::jmin ((numSamples - 1 - onset) / (minDeltaTimeSamples + 1) + 1,
+                        grainVariates.getNumSamples());
+
+        float* deltaTimeVariates = grainVariates.getWritePointer (deltaTimeVariate);
+        random.fillUniform (deltaTimeVariates, maxNumOnsets);
+
+        while (onset < numSamples && grainOnsets.size() < maxNumOnsets)
+        {
+            deltaTimeSamples = getDeltaTimeSamples (deltaTimeVariates[grainOnsets.size()]);
+            grainOnsets.add (onset);
+            onset += deltaTimeSamples + 1;
+        }
+
+        for (int v = positionVariate; v < numGrainVariates; ++v)
+            random.fillUniform (grainVariates.getWritePointer (v), grainOnsets.size());
+    }
+
+    if (grainOnsets.isEmpty())
+        grainTimeCounter += numSamples;
+    else
+        grainTimeCounter = numSamples - 1 - grainOnsets.getLast();
+}
+
+void GranularEncoderAudioProcessor::startGrain (const int onsetIndex,
+                                                const int ambisonicOrder,
+                                                const int nChOut,
+                                                const float gainFactor)
+{
+    if (numFreeGrains == 0)
+        return; // all grains are busy, skip this one
+
+    const int g = freeGrains[--numFreeGrains];
+    activeGrains[numActiveGrains++] = g;
+
+    juce::Vector3D<float> grainDir;
+    if (*spatialize2D > 0.5f)
+        grainDir = getRandomGrainDirection2D();
+    else
+        grainDir = getRandomGrainDirection3D();
+    SHEval (ambisonicOrder, grainDir.x, grainDir.y, grainDir.z, _grainSH[g]);
+    if (*useSN3D > 0.5f)
+    {
+        juce::FloatVectorOperations::multiply (_grainSH[g], _grainSH[g], n3d2sn3d, nChOut);
+    }
+
+    Grain::GrainJobParameters params;
+    std::copy (_grainSH[g], _grainSH[g] + 64, params.channelWeights.begin());
+    params.startPositionCircBuffer =
+        getStartPositionCircBuffer (grainVariates.getSample (positionVariate, onsetIndex));
+    auto grainLengthAndPitch =
+        getGrainLengthAndPitchFactor (grainVariates.getSample (lengthVariate, onsetIndex),
+                                      grainVariates.getSample (pitchVariate, onsetIndex));
+    params.grainLengthSamples = grainLengthAndPitch.first;
+    params.pitchReadFactor = grainLengthAndPitch.second;
+    params.startOffsetInBlock = grainOnsets.getUnchecked (onsetIndex);
+    params.gainFactor = gainFactor;
+    params.seedFromLeftCircBuffer =
+        getChannelToSeed (grainVariates.getSample (channelVariate, onsetIndex));
+
+    const auto fadeLengths =
+        getWindowFadeLengths (1.0f,
+                              grainVariates.getSample (attackVariate, onsetIndex),
+                              grainVariates.getSample (decayVariate, onsetIndex));
+    params.windowAttackSamples = fadeLengths.first;
+    params.windowDecaySamples = fadeLengths.second;
+    grains[g].startGrain (params, *windowTable);
+}
+
+void GranularEncoderAudioProcessor::updateGrainLists()
+{
+    // the free list is filled in reverse, so the grains with the lowest indices are used first
+    numFreeGrains = 0;
+    numActiveGrains = 0;
+    for (int g = maxNumGrains; --g >= 0;)
+    {
+        if (grains[g].isActive())
+            activeGrains[numActiveGrains++] = g;
+        else
+            freeGrains[numFreeGrains++] = g;
+    }
+}
+
+void GranularEncoderAudioProcessor::restartGrainCloud()
+{
+    random.setSeed (static_cast<juce::uint64> (randomSeed.load()));
+    deltaTimeSamples = 0;
+    grainTimeCounter = 0;
+    for (int g = 0; g < maxNumGrains; g++)
+        grains[g].reset();
+
+    updateGrainLists();
+}
+
 //==============================================================================
 bool GranularEncoderAudioProcessor::hasEditor() const
 {
@@ -775,6 +834,7 @@ void GranularEncoderAudioProcessor::getStateInformation (juce::MemoryBlock& dest
     }
 
     state.setProperty ("FreezeModeState", (int) mode, nullptr);
+    state.setProperty ("RandomSeed", randomSeed.load(), nullptr);
 
     std::unique_ptr<juce::XmlElement> xml (state.createXml());
     copyXmlToBinary (*xml, destData);
@@ -803,6 +863,13 @@ void GranularEncoderAudioProcessor::setStateInformation (const void* data, int s
             mode = static_cast<OperationMode> (
                 (int) parameters.state.getProperty ("FreezeModeState", 0));
 
+            if (parameters.state.hasProperty ("RandomSeed"))
+            {
+                // the audio thread restarts the grain cloud with the stored seed
+                randomSeed = static_cast<juce::int64> (parameters.state.getProperty ("RandomSeed"));
+                grainCloudNeedsRestart = true;
+            }
+
             if (mode == OperationMode::Freeze)
             {
                 sampleRateAtSerialize =
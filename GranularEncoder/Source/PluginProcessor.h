@@ -30,12 +30,12 @@
 #include "../../resources/efficientSHvanilla.h"
 
 #include "../../resources/Conversions.h"
+#include "../../resources/DenseMatrixKernel.h"
+#include "../../resources/FastRandom.h"
 #include "Grain.h"
-#include <random>
 
 #define ProcessorClass GranularEncoderAudioProcessor
 #define maxNumGrains 512
-#define windowResolution 1024
 #define CIRC_BUFFER_SECONDS 8.0f
 #define MAX_GRAIN_LENGTH 2.0f
 #define MIN_GRAIN_LENGTH 0.001f
@@ -98,11 +98,13 @@ public:
 
     juce::Vector3D<float> getRandomGrainDirection3D();
     juce::Vector3D<float> getRandomGrainDirection2D();
-    juce::AudioBuffer<float> getWindowBuffer (float modWeight);
-    int getStartPositionCircBuffer() const;
-    std::pair<int, float> getGrainLengthAndPitchFactor() const;
-    int getDeltaTimeSamples();
-    bool getChannelToSeed();
+    // the modulations are driven by uniform variates in [0, 1), drawn for a whole block
+    std::pair<int, int>
+        getWindowFadeLengths (float modWeight, float attackVariate, float decayVariate);
+    int getStartPositionCircBuffer (float variate);
+    std::pair<int, float> getGrainLengthAndPitchFactor (float lengthVariate, float pitchVariate);
+    int getDeltaTimeSamples (float variate);
+    bool getChannelToSeed (float variate);
 
     bool getFreezeGUIBool();
     void initializeModeTransition (bool freeze);
@@ -195,12 +197,54 @@ private:
     float sampleRateAtSerialize;
 
     int grainTimeCounter = 0;
+    juce::Array<int> grainOnsets; // sample offsets of the grains starting in the current block
+
+    // uniform variates of the grains starting in the current block, one channel per parameter
+    enum GrainVariate
+    {
+        deltaTimeVariate,
+        positionVariate,
+        lengthVariate,
+        pitchVariate,
+        channelVariate,
+        attackVariate,
+        decayVariate,
+        numGrainVariates
+    };
+    juce::AudioBuffer<float> grainVariates;
+
+    void scheduleGrains (const int numSamples);
+    void startGrain (const int onsetIndex,
+                     const int ambisonicOrder,
+                     const int nChOut,
+                     const float gainFactor);
+    void updateGrainLists();
+
+    /** Stops all grains and restarts the random sequence with randomSeed. */
+    void restartGrainCloud();
 
     Grain grains[maxNumGrains];
+    juce::SharedResourcePointer<GrainWindowTable> windowTable;
+
+    // grain slots are taken from the top of the free list, and returned to it when finished
+    int freeGrains[maxNumGrains];
+    int numFreeGrains = 0;
+    int activeGrains[maxNumGrains];
+    int numActiveGrains = 0;
+
+    // the mono signals of all grains of a block are encoded with a single matrix product
+    juce::AudioBuffer<float> grainSignals;
+    float grainEncoderMatrix[64][maxNumGrains];
+    const float* grainEncoderRows[64];
+    DenseMatrixKernel grainEncoder;
 
     float _grainSH[maxNumGrains][64];
 
-    std::mt19937 rng;
+    // per-instance generator, reseeded in prepareToPlay(), the seed is stored with the state,
+    // so renders of a session are reproducible
+    FastRandom random;
+    std::atomic<juce::int64> randomSeed;
+    std::atomic<bool> grainCloudNeedsRestart { false }; // set when a state brings a new seed
 
     juce::SmoothedValue<float> writeGainCircBuffer = 1.0f;
     OperationMode mode = OperationMode::Realtime;
@@ -149,7 +149,7 @@ void MatrixMultiplierAudioProcessorEditor::loadConfigurationFile()
         processor.getLastDir().exists()
             ? processor.getLastDir()
             : juce::File::getSpecialLocation (juce::File::userHomeDirectory),
-        "*.json");
+        "*.json;*.iemmatrix");
     if (myChooser.browseForFileToOpen())
     {
         juce::File configurationFile (myChooser.getResult());
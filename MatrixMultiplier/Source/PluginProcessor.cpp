@@ -104,6 +104,7 @@ void MatrixMultiplierAudioProcessor::prepareToPlay (double sampleRate, int sampl
     specs.maximumBlockSize = samplesPerBlock;
     specs.numChannels = 64;
 
+    matTrans.setInterpolationTime (0.05f);
     matTrans.prepare (specs);
 }
 
@@ -218,6 +219,7 @@ void MatrixMultiplierAudioProcessor::loadConfiguration (const juce::File& config
     if (tempMatrix != nullptr)
     {
         matTrans.setMatrix (tempMatrix);
+        matTrans.releaseRetiredMatrices();
         output += "Configuration loaded successfully!\n";
         output += "    Name: \t" + tempMatrix->getName() + "\n";
         output += "    Size: " + juce::String (tempMatrix->getMatrix().getNumRows()) + "x"
@@ -21,6 +21,7 @@
  */
 
 #pragma once
+#include <functional>
 #include <set>
 
 // ============================
@@ -295,6 +296,15 @@ public:
 
     void updateFilterResponse()
     {
+        if (magnitudeResponse != nullptr)
+        {
+            magnitudeResponse (s.frequencies.getRawDataPointer(),
+                               magnitudes.getRawDataPointer(),
+                               s.numPixels);
+            updatePath();
+            return;
+        }
+
         juce::Array<double> tempMagnitude;
         tempMagnitude.resize (s.numPixels);
         tempMagnitude.fill (1.0f);
@@ -375,9 +385,18 @@ public:
         coeffs.add (coeffs2);
     }
 
+    /** Replaces the magnitude response of the coefficients, e.g. for FIR filters, nullptr
+        restores it. The function gets the frequencies, the magnitudes and their number. */
+    void setMagnitudeResponse (std::function<void (const double*, double*, int)> newResponse)
+    {
+        magnitudeResponse = std::move (newResponse);
+        updateFilterResponse();
+    }
+
 private:
     Settings& s;
     juce::Array<typename juce::dsp::IIR::Coefficients<coeffType>::Ptr> coeffs;
+    std::function<void (const double*, double*, int)> magnitudeResponse;
 
     juce::Colour colour;
     bool bypassed { false };
@@ -648,6 +667,12 @@ public:
 
     void updateOverallMagnitude() { overallMagnitude.updateOverallMagnitude(); }
 
+    void setMagnitudeResponse (const int i,
+                               std::function<void (const double*, double*, int)> newResponse)
+    {
+        freqBands[i]->setMagnitudeResponse (std::move (newResponse));
+    }
+
     void setBypassed (const int i, const bool bypassed) { freqBands[i]->setBypassed (bypassed); }
 
     void setSolo (const int i, const bool soloed)
@@ -235,6 +235,17 @@ MultiBandCompressorAudioProcessorEditor::MultiBandCompressorAudioProcessorEditor
     tbOverallMagnitude.addListener (this);
     addAndMakeVisible (&tbOverallMagnitude);
 
+    // LINEAR-PHASE CROSSOVER BUTTON
+    tbLinearPhase.setColour (juce::ToggleButton::tickColourId, juce::Colours::white);
+    tbLinearPhase.setButtonText ("linear-phase crossover");
+    tbLinearPhase.setTooltip ("Splits the bands with linear-phase FIR filters instead of "
+                              "Linkwitz-Riley filters, which adds latency.");
+    linearPhaseAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ButtonAttachment> (
+        valueTreeState,
+        "linearPhase",
+        tbLinearPhase);
+    addAndMakeVisible (&tbLinearPhase);
+
     // ==== CROSSOVER SLIDERS ====
     for (int i = 0; i < numFilterBands - 1; ++i)
     {
@@ -573,6 +584,7 @@ void MultiBandCompressorAudioProcessorEditor::resized()
     juce::Rectangle<int> totalMagnitudeButtonArea =
         rightArea.removeFromTop (rightArea.proportionOfHeight (0.5));
     tbOverallMagnitude.setBounds (totalMagnitudeButtonArea);
+    tbLinearPhase.setBounds (rightArea);
 }
 
 void MultiBandCompressorAudioProcessorEditor::sliderValueChanged (juce::Slider* slider)
@@ -614,7 +626,26 @@ void MultiBandCompressorAudioProcessorEditor::timerCallback()
     title.setMaxSize (processor.getMaxSize());
     // ==========================================
 
-    if (processor.repaintFilterVisualization.get())
+    // the linear-phase crossover is visualized with the magnitude responses of its FIR filters
+    const bool linearPhase = processor.isLinearPhaseCrossoverActive();
+    if (linearPhase != visualizesLinearPhase)
+    {
+        visualizesLinearPhase = linearPhase;
+        processor.repaintFilterVisualization = false;
+        for (int i = 0; i < numFilterBands; ++i)
+        {
+            if (linearPhase)
+                filterBankVisualizer.setMagnitudeResponse (
+                    i,
+                    [this, i] (const double* frequencies, double* magnitudes, int num)
+                    {
+                        processor.calculateLinearPhaseMagnitudes (i, frequencies, magnitudes, num);
+                    });
+            else
+                filterBankVisualizer.setMagnitudeResponse (i, nullptr);
+        }
+    }
+    else if (processor.repaintFilterVisualization.get())
     {
         processor.repaintFilterVisualization = false;
         filterBankVisualizer.updateFreqBandResponses();
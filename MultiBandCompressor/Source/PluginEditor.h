@@ -101,7 +101,7 @@ private:
     RoundButton tbBypass[numFilterBands];
     std::unique_ptr<juce::AudioProcessorValueTreeState::ButtonAttachment>
         soloAttachment[numFilterBands], bypassAttachment[numFilterBands],
-        overallMagnitudeDisplayAttachment;
+        overallMagnitudeDisplayAttachment, linearPhaseAttachment;
 
     // Compressor Parameters
     ReverseSlider slKnee[numFilterBands], slThreshold[numFilterBands], slRatio[numFilterBands],
@@ -124,7 +124,9 @@ private:
 
     // juce::Toggle juce::Buttons
     juce::ToggleButton tbOverallMagnitude;
+    juce::ToggleButton tbLinearPhase;
     bool displayOverallMagnitude { false };
+    bool visualizesLinearPhase { false };
 
     // juce::Labels
     SimpleLabel lbKnee[numFilterBands + 1], lbThreshold[numFilterBands + 1],
@@ -53,6 +53,9 @@ MultiBandCompressorAudioProcessor::MultiBandCompressorAudioProcessor() :
     orderSetting = parameters.getRawParameterValue (inputSettingID);
     parameters.addParameterListener (inputSettingID, this);
 
+    linearPhase = parameters.getRawParameterValue ("linearPhase");
+    parameters.addParameterListener ("linearPhase", this);
+
     for (int filterBandIdx = 0; filterBandIdx < numFilterBands - 1; ++filterBandIdx)
     {
         const juce::String crossoverID ("crossover" + juce::String (filterBandIdx));
@@ -311,11 +314,16 @@ std::vector<std::unique_ptr<juce::RangedAudioParameter>>
         params.push_back (std::move (boolParam));
     }
 
-    auto boolParam = std::make_unique<juce::AudioParameterBool> ("displayOverallMagnitude",
-                                                                 "Display overall magnitude",
+    auto boolParam = std::make_unique<juce::AudioParameterBool> ("linearPhase",
+                                                                 "Linear-phase crossover",
                                                                  false);
     params.push_back (std::move (boolParam));
 
+    boolParam = std::make_unique<juce::AudioParameterBool> ("displayOverallMagnitude",
+                                                            "Display overall magnitude",
+                                                            false);
+    params.push_back (std::move (boolParam));
+
     return params;
 }
 
@@ -377,6 +385,108 @@ void MultiBandCompressorAudioProcessor::copyCoeffsToProcessor()
     userChangedFilterSettings = false;
 }
 
+void MultiBandCompressorAudioProcessor::designLinearPhaseFilters()
+{
+    const int filterLength = 2 * linearPhaseFilterDelay + 1;
+    const float* window = linearPhaseWindow.getRawDataPointer();
+    float* h = linearPhaseCoefficients.getRawDataPointer();
+
+    for (int i = 0; i < numFilterBands - 1; ++i)
+    {
+        designLinearPhaseLowpass (i, window, h);
+        linearPhaseFilterBank.setFilter (i, h, filterLength);
+    }
+}
+
+void MultiBandCompressorAudioProcessor::designLinearPhaseLowpass (const int crossover,
+                                                                  const float* window,
+                                                                  float* h)
+{
+    // windowed sinc lowpass filter, which is -6 dB at the crossover frequency like the
+    // Linkwitz-Riley filters, and sums up to a delayed dirac with its complementary highpass
+    const int D = linearPhaseFilterDelay;
+    const double fc =
+        juce::jmin (0.5 * lastSampleRate, static_cast<double> (crossovers[crossover]->load()))
+        / lastSampleRate;
+
+    // sin (2 pi fc m) is calculated recursively with a rotating phasor
+    const double omega = 2.0 * juce::MathConstants<double>::pi * fc;
+    const std::complex<double> rotation (std::cos (omega), std::sin (omega));
+    std::complex<double> phasor (1.0, 0.0);
+
+    double sum = 2.0 * fc * window[D];
+    h[D] = static_cast<float> (sum);
+    for (int m = 1; m <= D; ++m)
+    {
+        phasor *= rotation;
+        const double sinc = phasor.imag() / (juce::MathConstants<double>::pi * m);
+        h[D + m] = static_cast<float> (sinc * window[D + m]);
+        h[D - m] = h[D + m];
+        sum += 2.0 * h[D + m];
+    }
+
+    // unity gain at DC
+    juce::FloatVectorOperations::multiply (h, static_cast<float> (1.0 / sum), 2 * D + 1);
+}
+
+float MultiBandCompressorAudioProcessor::getLinearPhaseWindow (const int n, const int filterLength)
+{
+    // Blackman window
+    const double phi = 2.0 * juce::MathConstants<double>::pi * n / (filterLength - 1);
+    return static_cast<float> (0.42 - 0.5 * std::cos (phi) + 0.08 * std::cos (2.0 * phi));
+}
+
+void MultiBandCompressorAudioProcessor::calculateLinearPhaseMagnitudes (const int band,
+                                                                        const double* frequencies,
+                                                                        double* magnitudes,
+                                                                        const int numFrequencies)
+{
+    // the lowpass filters are designed once more, as the audio thread reuses its coefficients
+    const int D = linearPhaseFilterDelay;
+    const int filterLength = 2 * D + 1;
+    std::vector<float> window (filterLength), h (filterLength);
+    for (int n = 0; n < filterLength; ++n)
+        window[n] = getLinearPhaseWindow (n, filterLength);
+
+    // the bands are the differences of the lowpasses below and above them, and of the delayed
+    // input for the highest band, their zero-phase amplitude responses are subtracted likewise
+    for (int i = 0; i < numFrequencies; ++i)
+        magnitudes[i] = band == FrequencyBands::High ? 1.0 : 0.0;
+
+    for (int crossover = band - 1; crossover <= band; ++crossover)
+    {
+        if (crossover < 0 || crossover >= numFilterBands - 1)
+            continue;
+
+        designLinearPhaseLowpass (crossover, window.data(), h.data());
+        const double sign = crossover == band ? 1.0 : -1.0;
+
+        for (int i = 0; i < numFrequencies; ++i)
+        {
+            // cos (omega m) is calculated recursively
+            const double omega = 2.0 * juce::MathConstants<double>::pi * frequencies[i]
+                                 / lastSampleRate;
+            const double twoCos = 2.0 * std::cos (omega);
+            double cosPrevious = 1.0;
+            double cosCurrent = std::cos (omega);
+
+            double amplitude = h[D];
+            for (int m = 1; m <= D; ++m)
+            {
+                amplitude += 2.0 * h[D + m] * cosCurrent;
+                const double cosNext = twoCos * cosCurrent - cosPrevious;
+                cosPrevious = cosCurrent;
+                cosCurrent = cosNext;
+            }
+
+            magnitudes[i] += sign * amplitude;
+        }
+    }
+
+    for (int i = 0; i < numFrequencies; ++i)
+        magnitudes[i] = std::abs (magnitudes[i]);
+}
+
 //==============================================================================
 int MultiBandCompressorAudioProcessor::getNumPrograms()
 {
@@ -475,11 +585,42 @@ void MultiBandCompressorAudioProcessor::prepareToPlay (double sampleRate, int sa
     zero = juce::dsp::AudioBlock<float> (zeroData, IIRfloat_elements, samplesPerBlock);
     zero.clear();
 
-    gains = juce::dsp::AudioBlock<float> (gainData, 1, samplesPerBlock);
+    sideChains = juce::dsp::AudioBlock<float> (sideChainData, numFilterBands, samplesPerBlock);
+    gains = juce::dsp::AudioBlock<float> (gainData, numFilterBands, samplesPerBlock);
     gains.clear();
 
     tempBuffer.setSize (64, samplesPerBlock, false, true);
 
+    // linear-phase crossover with filters of about 85 ms, independent of the sample rate, the
+    // filter bank processes their later taps with longer partitions
+    linearPhaseFilterDelay = juce::nextPowerOfTwo (static_cast<int> (sampleRate / 24.0));
+    const int filterLength = 2 * linearPhaseFilterDelay + 1;
+    const int partitionSize = juce::jlimit (64, 1024, juce::nextPowerOfTwo (samplesPerBlock));
+    linearPhaseFilterBank.prepare (numberOfInputChannels,
+                                   numFilterBands - 1,
+                                   partitionSize,
+                                   filterLength);
+
+    for (auto& band : linearPhaseBands)
+        band.setSize (numberOfInputChannels, samplesPerBlock);
+
+    juce::dsp::ProcessSpec linearPhaseDelaySpec;
+    linearPhaseDelaySpec.sampleRate = sampleRate;
+    linearPhaseDelaySpec.maximumBlockSize = samplesPerBlock;
+    linearPhaseDelaySpec.numChannels = numberOfInputChannels;
+    linearPhaseDelay.setDelayTime ((linearPhaseFilterDelay + 0.5f)
+                                   / static_cast<float> (sampleRate));
+    linearPhaseDelay.prepare (linearPhaseDelaySpec);
+    linearPhaseWasActive = *linearPhase >= 0.5f;
+
+    linearPhaseWindow.resize (filterLength);
+    linearPhaseCoefficients.resize (filterLength);
+    for (int n = 0; n < filterLength; ++n)
+        linearPhaseWindow.set (n, getLinearPhaseWindow (n, filterLength));
+
+    designLinearPhaseFilters();
+    setLatencySamples (getLinearPhaseLatency());
+
     repaintFilterVisualization = true;
 }
 
@@ -507,19 +648,169 @@ void MultiBandCompressorAudioProcessor::processBlock (juce::AudioSampleBuffer& b
         return;
 
     const int L = buffer.getNumSamples();
-    const int nSIMDFilters = 1 + (maxNChIn - 1) / IIRfloat_elements;
-    gainChannelPointer = gains.getChannelPointer (0);
-
     gains.clear();
     zero.clear();
 
-    // update iir filter coefficients
+    // update iir filter coefficients and linear-phase filters
     if (userChangedFilterSettings.get())
+    {
         copyCoeffsToProcessor();
+        designLinearPhaseFilters();
+    }
+
+    // when the crossover changes, both are computed and their bands are crossfaded, the one
+    // which becomes active starts without any history
+    const bool useLinearPhase = *linearPhase >= 0.5f;
+    const bool crossoverChanged = useLinearPhase != linearPhaseWasActive;
+    if (crossoverChanged)
+    {
+        if (useLinearPhase)
+        {
+            // clear the history without any allocation
+            linearPhaseFilterBank.reset();
+            linearPhaseDelay.reset();
+        }
+        else
+            resetIIRFilters();
+    }
+    linearPhaseWasActive = useLinearPhase;
+
+    const bool computeLinearPhase = useLinearPhase || crossoverChanged;
+    const bool computeIIR = ! useLinearPhase || crossoverChanged;
+    const float linearPhaseGainStart = useLinearPhase ? 0.0f : 1.0f;
+    const float linearPhaseGainEnd = 1.0f - linearPhaseGainStart;
 
     inputPeak = juce::Decibels::gainToDecibels (buffer.getMagnitude (0, 0, L));
 
+    if (computeLinearPhase)
+        processLinearPhaseCrossover (buffer, maxNChIn, L);
+    if (computeIIR)
+        processIIRCrossover (buffer, maxNChIn, L);
+
+    // the omni channels of the bands drive the compressors, which are all computed at once
+    iem::Compressor* activeCompressors[numFilterBands];
+    const float* sideChainPointers[numFilterBands];
+    float* gainPointers[numFilterBands];
+    int numActiveCompressors = 0;
+    for (int filterBandIdx = 0; filterBandIdx < numFilterBands; ++filterBandIdx)
+    {
+        if (*bypass[filterBandIdx] >= 0.5f
+            || (! soloArray.isZero() && ! soloArray[filterBandIdx]))
+            continue;
+
+        const float* sideChain = linearPhaseBands[filterBandIdx].getReadPointer (0);
+        if (computeIIR)
+        {
+            const float* omni = reinterpret_cast<const float*> (
+                freqBands[filterBandIdx][0]->getChannelPointer (0));
+            float* sideChainWrite = sideChains.getChannelPointer (filterBandIdx);
+            for (int i = 0; i < L; ++i)
+                sideChainWrite[i] = omni[i * IIRfloat_elements];
+
+            if (crossoverChanged)
+            {
+                const float step = (linearPhaseGainEnd - linearPhaseGainStart) / L;
+                for (int i = 0; i < L; ++i)
+                {
+                    const float linearPhaseGain = linearPhaseGainStart + i * step;
+                    sideChainWrite[i] = (1.0f - linearPhaseGain) * sideChainWrite[i]
+                                        + linearPhaseGain * sideChain[i];
+                }
+            }
+            sideChain = sideChainWrite;
+        }
+
+        activeCompressors[numActiveCompressors] = &compressors[filterBandIdx];
+        sideChainPointers[numActiveCompressors] = sideChain;
+        gainPointers[numActiveCompressors] = gains.getChannelPointer (filterBandIdx);
+        ++numActiveCompressors;
+    }
+
+    iem::Compressor::getGainsFromSidechainSignals (activeCompressors,
+                                                   sideChainPointers,
+                                                   gainPointers,
+                                                   numActiveCompressors,
+                                                   L);
+
+    buffer.clear();
+
+    for (int filterBandIdx = 0; filterBandIdx < numFilterBands; ++filterBandIdx)
+    {
+        if (! soloArray.isZero())
+        {
+            if (! soloArray[filterBandIdx])
+            {
+                maxGR[filterBandIdx] = 0.0f;
+                maxPeak[filterBandIdx] = -INFINITY;
+                continue;
+            }
+        }
+
+        const float* const* bandSignals =
+            linearPhaseBands[filterBandIdx].getArrayOfReadPointers();
+        if (computeIIR)
+        {
+            deinterleaveBand (filterBandIdx, maxNChIn, L);
+
+            if (crossoverChanged)
+                for (int ch = 0; ch < maxNChIn; ++ch)
+                {
+                    tempBuffer.applyGainRamp (ch,
+                                              0,
+                                              L,
+                                              1.0f - linearPhaseGainStart,
+                                              1.0f - linearPhaseGainEnd);
+                    tempBuffer.addFromWithRamp (ch,
+                                                0,
+                                                bandSignals[ch],
+                                                L,
+                                                linearPhaseGainStart,
+                                                linearPhaseGainEnd);
+                }
+
+            bandSignals = tempBuffer.getArrayOfReadPointers();
+        }
+
+        // Compress
+        if (*bypass[filterBandIdx] < 0.5f)
+        {
+            const float* bandGains = gains.getChannelPointer (filterBandIdx);
+            maxGR[filterBandIdx] =
+                juce::Decibels::gainToDecibels (
+                    juce::FloatVectorOperations::findMinimum (bandGains, L))
+                - *makeUpGain[filterBandIdx];
+            maxPeak[filterBandIdx] = compressors[filterBandIdx].getMaxLevelInDecibels();
+
+            for (int ch = 0; ch < maxNChIn; ++ch)
+            {
+                juce::FloatVectorOperations::addWithMultiply (buffer.getWritePointer (ch),
+                                                              bandSignals[ch],
+                                                              bandGains,
+                                                              L);
+            }
+        }
+        else
+        {
+            for (int ch = 0; ch < maxNChIn; ++ch)
+            {
+                juce::FloatVectorOperations::add (buffer.getWritePointer (ch),
+                                                  bandSignals[ch],
+                                                  L);
+            }
+            maxGR[filterBandIdx] = 0.0f;
+            maxPeak[filterBandIdx] = juce::Decibels::gainToDecibels (-INFINITY);
+        }
+    }
+
+    outputPeak = juce::Decibels::gainToDecibels (buffer.getMagnitude (0, 0, L));
+}
+
+void MultiBandCompressorAudioProcessor::processIIRCrossover (juce::AudioSampleBuffer& buffer,
+                                                             const int maxNChIn,
+                                                             const int L)
+{
     using Format = juce::AudioData::Format<juce::AudioData::Float32, juce::AudioData::NativeEndian>;
+    const int nSIMDFilters = 1 + (maxNChIn - 1) / IIRfloat_elements;
 
     //interleave input data
     int partial = maxNChIn % IIRfloat_elements;
@@ -637,110 +928,123 @@ void MultiBandCompressorAudioProcessor::processBlock (juce::AudioSampleBuffer& b
         iirHP[2][simdFilterIdx]->process (juce::dsp::ProcessContextReplacing<IIRfloat> (abHigh));
         iirHP2[2][simdFilterIdx]->process (juce::dsp::ProcessContextReplacing<IIRfloat> (abHigh));
     }
+}
 
-    buffer.clear();
-
-    for (int filterBandIdx = 0; filterBandIdx < numFilterBands; ++filterBandIdx)
-    {
-        if (! soloArray.isZero())
-        {
-            if (! soloArray[filterBandIdx])
-            {
-                maxGR[filterBandIdx] = 0.0f;
-                maxPeak[filterBandIdx] = -INFINITY;
-                continue;
-            }
-        }
+void MultiBandCompressorAudioProcessor::deinterleaveBand (const int filterBandIdx,
+                                                          const int maxNChIn,
+                                                          const int L)
+{
+    using Format = juce::AudioData::Format<juce::AudioData::Float32, juce::AudioData::NativeEndian>;
+    const int nSIMDFilters = 1 + (maxNChIn - 1) / IIRfloat_elements;
+    const int partial = maxNChIn % IIRfloat_elements;
 
-        tempBuffer.clear();
+    tempBuffer.clear();
 
-        // Deinterleave
-        if (partial == 0)
+    // Deinterleave
+    if (partial == 0)
+    {
+        for (int simdFilterIdx = 0; simdFilterIdx < nSIMDFilters; ++simdFilterIdx)
         {
-            for (int simdFilterIdx = 0; simdFilterIdx < nSIMDFilters; ++simdFilterIdx)
-            {
-                juce::AudioData::deinterleaveSamples (
-                    juce::AudioData::InterleavedSource<Format> {
-                        reinterpret_cast<float*> (
-                            freqBands[filterBandIdx][simdFilterIdx]->getChannelPointer (0)),
-                        IIRfloat_elements },
-                    juce::AudioData::NonInterleavedDest<Format> {
-                        tempBuffer.getArrayOfWritePointers() + simdFilterIdx * IIRfloat_elements,
-                        IIRfloat_elements },
-                    L);
-            }
+            juce::AudioData::deinterleaveSamples (
+                juce::AudioData::InterleavedSource<Format> {
+                    reinterpret_cast<float*> (
+                        freqBands[filterBandIdx][simdFilterIdx]->getChannelPointer (0)),
+                    IIRfloat_elements },
+                juce::AudioData::NonInterleavedDest<Format> {
+                    tempBuffer.getArrayOfWritePointers() + simdFilterIdx * IIRfloat_elements,
+                    IIRfloat_elements },
+                L);
         }
-        else
+    }
+    else
+    {
+        int simdFilterIdx;
+        for (simdFilterIdx = 0; simdFilterIdx < nSIMDFilters - 1; ++simdFilterIdx)
         {
-            int simdFilterIdx;
-            for (simdFilterIdx = 0; simdFilterIdx < nSIMDFilters - 1; ++simdFilterIdx)
-            {
-                juce::AudioData::deinterleaveSamples (
-                    juce::AudioData::InterleavedSource<Format> {
-                        reinterpret_cast<float*> (
-                            freqBands[filterBandIdx][simdFilterIdx]->getChannelPointer (0)),
-                        IIRfloat_elements },
-                    juce::AudioData::NonInterleavedDest<Format> {
-                        tempBuffer.getArrayOfWritePointers() + simdFilterIdx * IIRfloat_elements,
-                        IIRfloat_elements },
-                    L);
-            }
-
-            float* addr[IIRfloat_elements];
-            int iirElementIdx;
-            for (iirElementIdx = 0; iirElementIdx < partial; ++iirElementIdx)
-            {
-                addr[iirElementIdx] =
-                    tempBuffer.getWritePointer (simdFilterIdx * IIRfloat_elements + iirElementIdx);
-            }
-            for (; iirElementIdx < IIRfloat_elements; ++iirElementIdx)
-            {
-                addr[iirElementIdx] = zero.getChannelPointer (iirElementIdx);
-            }
             juce::AudioData::deinterleaveSamples (
                 juce::AudioData::InterleavedSource<Format> {
                     reinterpret_cast<float*> (
                         freqBands[filterBandIdx][simdFilterIdx]->getChannelPointer (0)),
                     IIRfloat_elements },
-                juce::AudioData::NonInterleavedDest<Format> { addr, IIRfloat_elements },
+                juce::AudioData::NonInterleavedDest<Format> {
+                    tempBuffer.getArrayOfWritePointers() + simdFilterIdx * IIRfloat_elements,
+                    IIRfloat_elements },
                 L);
-            zero.clear();
         }
 
-        // Compress
-        if (*bypass[filterBandIdx] < 0.5f)
+        float* addr[IIRfloat_elements];
+        int iirElementIdx;
+        for (iirElementIdx = 0; iirElementIdx < partial; ++iirElementIdx)
         {
-            compressors[filterBandIdx].getGainFromSidechainSignal (tempBuffer.getReadPointer (0),
-                                                                   gainChannelPointer,
-                                                                   L);
-            maxGR[filterBandIdx] =
-                juce::Decibels::gainToDecibels (
-                    juce::FloatVectorOperations::findMinimum (gainChannelPointer, L))
-                - *makeUpGain[filterBandIdx];
-            maxPeak[filterBandIdx] = compressors[filterBandIdx].getMaxLevelInDecibels();
-
-            for (int ch = 0; ch < maxNChIn; ++ch)
-            {
-                juce::FloatVectorOperations::addWithMultiply (buffer.getWritePointer (ch),
-                                                              tempBuffer.getReadPointer (ch),
-                                                              gainChannelPointer,
-                                                              L);
-            }
+            addr[iirElementIdx] =
+                tempBuffer.getWritePointer (simdFilterIdx * IIRfloat_elements + iirElementIdx);
         }
-        else
+        for (; iirElementIdx < IIRfloat_elements; ++iirElementIdx)
         {
-            for (int ch = 0; ch < maxNChIn; ++ch)
-            {
-                juce::FloatVectorOperations::add (buffer.getWritePointer (ch),
-                                                  tempBuffer.getReadPointer (ch),
-                                                  L);
-            }
-            maxGR[filterBandIdx] = 0.0f;
-            maxPeak[filterBandIdx] = juce::Decibels::gainToDecibels (-INFINITY);
+            addr[iirElementIdx] = zero.getChannelPointer (iirElementIdx);
         }
+        juce::AudioData::deinterleaveSamples (
+            juce::AudioData::InterleavedSource<Format> {
+                reinterpret_cast<float*> (
+                    freqBands[filterBandIdx][simdFilterIdx]->getChannelPointer (0)),
+                IIRfloat_elements },
+            juce::AudioData::NonInterleavedDest<Format> { addr, IIRfloat_elements },
+            L);
+        zero.clear();
     }
+}
 
-    outputPeak = juce::Decibels::gainToDecibels (buffer.getMagnitude (0, 0, L));
+void MultiBandCompressorAudioProcessor::resetIIRFilters()
+{
+    for (int filterBandIdx = 0; filterBandIdx < numFilterBands - 1; ++filterBandIdx)
+    {
+        for (int simdFilterIdx = 0; simdFilterIdx < maxNumFilters; ++simdFilterIdx)
+        {
+            iirLP[filterBandIdx][simdFilterIdx]->reset (IIRfloat (0.0f));
+            iirLP2[filterBandIdx][simdFilterIdx]->reset (IIRfloat (0.0f));
+            iirHP[filterBandIdx][simdFilterIdx]->reset (IIRfloat (0.0f));
+            iirHP2[filterBandIdx][simdFilterIdx]->reset (IIRfloat (0.0f));
+            iirAP[filterBandIdx][simdFilterIdx]->reset (IIRfloat (0.0f));
+        }
+    }
+}
+
+void MultiBandCompressorAudioProcessor::handleAsyncUpdate()
+{
+    setLatencySamples (getLinearPhaseLatency());
+}
+
+void MultiBandCompressorAudioProcessor::processLinearPhaseCrossover (
+    juce::AudioSampleBuffer& buffer,
+    const int numChannels,
+    const int numSamples)
+{
+    // lowpass signals of all crossovers, one forward transform per channel
+    float* const* lowpassSignals[numFilterBands - 1];
+    for (int i = 0; i < numFilterBands - 1; ++i)
+        lowpassSignals[i] = linearPhaseBands[i].getArrayOfWritePointers();
+
+    linearPhaseFilterBank.process (buffer.getArrayOfReadPointers(),
+                                   lowpassSignals,
+                                   numChannels,
+                                   numSamples);
+
+    // the highest band needs the delayed input
+    auto& high = linearPhaseBands[FrequencyBands::High];
+    for (int ch = 0; ch < numChannels; ++ch)
+        high.copyFrom (ch, 0, buffer, ch, 0, numSamples);
+
+    juce::dsp::AudioBlock<float> highBlock (high.getArrayOfWritePointers(),
+                                            static_cast<size_t> (numChannels),
+                                            static_cast<size_t> (numSamples));
+    linearPhaseDelay.process (juce::dsp::ProcessContextReplacing<float> (highBlock));
+
+    // complementary bands: LP0, LP1 - LP0, LP2 - LP1, delayed input - LP2
+    for (int band = numFilterBands - 1; band > 0; --band)
+        for (int ch = 0; ch < numChannels; ++ch)
+            juce::FloatVectorOperations::subtract (linearPhaseBands[band].getWritePointer (ch),
+                                                   linearPhaseBands[band - 1].getReadPointer (ch),
+                                                   numSamples);
 }
 
 //==============================================================================
@@ -843,6 +1147,10 @@ void MultiBandCompressorAudioProcessor::parameterChanged (const juce::String& pa
         else
             soloArray.clearBit (parameterID.getLastCharacters (1).getIntValue());
     }
+    else if (parameterID == "linearPhase")
+    {
+        triggerAsyncUpdate();
+    }
     else if (parameterID == "orderSetting")
     {
         userChangedIOSettings = true;
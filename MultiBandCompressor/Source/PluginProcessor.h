@@ -26,7 +26,9 @@
 #include "../JuceLibraryCode/JuceHeader.h"
 
 #include "../../resources/Compressor.h"
+#include "../../resources/Delay.h"
 #include "../../resources/FilterVisualizerHelper.h"
+#include "../../resources/PartitionedFilterBank.h"
 
 #define ProcessorClass MultiBandCompressorAudioProcessor
 #define numFilterBands 4
@@ -35,7 +37,8 @@ using namespace juce::dsp;
 using ParameterLayout = juce::AudioProcessorValueTreeState::ParameterLayout;
 
 class MultiBandCompressorAudioProcessor
-    : public AudioProcessorBase<IOTypes::Ambisonics<>, IOTypes::Ambisonics<>>
+    : public AudioProcessorBase<IOTypes::Ambisonics<>, IOTypes::Ambisonics<>>,
+      private juce::AsyncUpdater
 {
 public:
     constexpr static int numberOfInputChannels = 64;
@@ -94,6 +97,14 @@ public:
 
     // Interface for gui
     double& getSampleRate() { return lastSampleRate; };
+    bool isLinearPhaseCrossoverActive() { return *linearPhase >= 0.5f; }
+
+    /** Calculates the magnitude response of a band of the linear-phase crossover for the
+        visualization, has to be called from the message thread. */
+    void calculateLinearPhaseMagnitudes (const int band,
+                                         const double* frequencies,
+                                         double* magnitudes,
+                                         const int numFrequencies);
     IIR::Coefficients<double>::Ptr lowPassLRCoeffs[numFilterBands - 1];
     IIR::Coefficients<double>::Ptr highPassLRCoeffs[numFilterBands - 1];
 
@@ -110,6 +121,31 @@ private:
     void calculateCoefficients (const int index);
     void copyCoeffsToProcessor();
 
+    /** Designs the linear-phase lowpass filters of the crossovers and hands them to the
+        filter bank. Allocation free, so it's called from the audio thread. */
+    void designLinearPhaseFilters();
+
+    /** Designs the lowpass filter of a crossover into h (2 * linearPhaseFilterDelay + 1 taps). */
+    void designLinearPhaseLowpass (const int crossover, const float* window, float* h);
+    static float getLinearPhaseWindow (const int n, const int filterLength);
+    int getLinearPhaseLatency() { return *linearPhase >= 0.5f ? linearPhaseFilterDelay : 0; }
+
+    /** Reports the latency of the selected crossover to the host, on the message thread. */
+    void handleAsyncUpdate() override;
+
+    void resetIIRFilters();
+
+    /** Splits the input into the bands with the Linkwitz-Riley crossover (interleaved). */
+    void processIIRCrossover (juce::AudioSampleBuffer& buffer, const int maxNChIn, const int L);
+
+    /** Deinterleaves the signals of a band (IIR crossover) into tempBuffer. */
+    void deinterleaveBand (const int filterBandIdx, const int maxNChIn, const int L);
+
+    /** Splits the input into the bands with the linear-phase crossover. */
+    void processLinearPhaseCrossover (juce::AudioSampleBuffer& buffer,
+                                      const int numChannels,
+                                      const int numSamples);
+
     inline void clear (juce::dsp::AudioBlock<IIRfloat>& ab);
 
     double lastSampleRate { 48000 };
@@ -125,6 +161,7 @@ private:
     std::atomic<float>* attack[numFilterBands];
     std::atomic<float>* release[numFilterBands];
     std::atomic<float>* bypass[numFilterBands];
+    std::atomic<float>* linearPhase;
 
     juce::BigInteger soloArray;
 
@@ -151,10 +188,18 @@ private:
     juce::OwnedArray<juce::dsp::AudioBlock<IIRfloat>> freqBands[numFilterBands];
     std::vector<juce::HeapBlock<char>> freqBandsBlocks[numFilterBands];
 
-    // Additional compressor parameters
-    float* gainChannelPointer;
-    juce::dsp::AudioBlock<float> gains;
-    juce::HeapBlock<char> gainData;
+    // linear-phase crossover: the filter bank computes the lowpass signals of all crossovers
+    // with one forward transform per channel, the bands are their differences
+    PartitionedFilterBank linearPhaseFilterBank;
+    Delay linearPhaseDelay; // aligns the input with the filtered signals for the highest band
+    juce::AudioBuffer<float> linearPhaseBands[numFilterBands];
+    juce::Array<float> linearPhaseWindow, linearPhaseCoefficients;
+    int linearPhaseFilterDelay = 0; // half the filter length
+    bool linearPhaseWasActive = false; // a change of the crossover is crossfaded over one block
+
+    // side chain signals and gains of all bands
+    juce::dsp::AudioBlock<float> sideChains, gains;
+    juce::HeapBlock<char> sideChainData, gainData;
 
     juce::Atomic<bool> userChangedFilterSettings = true;
 
@@ -197,6 +197,10 @@ void MultiEncoderAudioProcessor::prepareToPlay (double sampleRate, int samplesPe
 
     timeConstant = exp (-1.0 / (sampleRate * 0.1 / samplesPerBlock)); // 100ms RMS averaging
     std::fill (rms.begin(), rms.end(), 0.0f);
+
+    encodingKernel.prepare (maxNumberOfInputs);
+    rampBuffer.setSize (64, samplesPerBlock);
+    rampWeights.resize (samplesPerBlock);
 }
 
 void MultiEncoderAudioProcessor::releaseResources()
@@ -223,10 +227,10 @@ void MultiEncoderAudioProcessor::processBlock (juce::AudioSampleBuffer& buffer,
                       + oneMinusTimeConstant * buffer.getRMSLevel (ch, 0, buffer.getNumSamples());
     }
 
-    for (int i = 0; i < nChIn; ++i)
-        bufferCopy.copyFrom (i, 0, buffer.getReadPointer (i), buffer.getNumSamples());
-
-    buffer.clear();
+    const int L = buffer.getNumSamples();
+    const float* inputs[maxNumberOfInputs];
+    const float* movingInputs[maxNumberOfInputs];
+    int nMoving = 0;
 
     for (int i = 0; i < nChIn; ++i)
     {
@@ -257,17 +261,62 @@ void MultiEncoderAudioProcessor::processBlock (juce::AudioSampleBuffer& buffer,
         if (*useSN3D >= 0.5f)
             juce::FloatVectorOperations::multiply (SH[i], SH[i], n3d2sn3d, nChOut);
 
-        const float* inpReadPtr = bufferCopy.getReadPointer (i);
+        inputs[i] = buffer.getReadPointer (i);
+
+        bool isMoving = false;
         for (int ch = 0; ch < nChOut; ++ch)
-            buffer.addFromWithRamp (ch,
-                                    0,
-                                    inpReadPtr,
-                                    buffer.getNumSamples(),
-                                    _SH[i][ch] * _gain[i],
-                                    SH[i][ch] * currGain);
+        {
+            const float previous = _SH[i][ch] * _gain[i];
+            encodingMatrix[ch][i] = SH[i][ch] * currGain;
+            encodingDifference[ch][nMoving] = encodingMatrix[ch][i] - previous;
+            isMoving = isMoving || encodingMatrix[ch][i] != previous;
+        }
+
+        if (isMoving)
+            movingInputs[nMoving++] = inputs[i];
 
         _gain[i] = currGain;
     }
+
+    const float* encodingRows[64];
+    const float* differenceRows[64];
+    float* outputs[64];
+    for (int ch = 0; ch < nChOut; ++ch)
+    {
+        encodingRows[ch] = encodingMatrix[ch];
+        differenceRows[ch] = encodingDifference[ch];
+        outputs[ch] = buffer.getWritePointer (ch);
+    }
+
+    // the gains of moving sources are ramped from their previous to their current values:
+    // y = G_current x - (1 - n / L) (G_current - G_previous) x, with the second product only
+    // covering the moving sources, so static scenes cost a single matrix product
+    if (nMoving > 0)
+        encodingKernel.process (differenceRows,
+                                rampBuffer.getArrayOfWritePointers(),
+                                nChOut,
+                                movingInputs,
+                                nMoving,
+                                L);
+
+    // in place, the kernel reads each chunk of all inputs before writing the outputs
+    encodingKernel.process (encodingRows, outputs, nChOut, inputs, nChIn, L);
+
+    for (int ch = nChOut; ch < buffer.getNumChannels(); ++ch)
+        buffer.clear (ch, 0, L);
+
+    if (nMoving > 0)
+    {
+        float* weights = rampWeights.getRawDataPointer();
+        for (int n = 0; n < L; ++n)
+            weights[n] = static_cast<float> (n) / L - 1.0f;
+
+        for (int ch = 0; ch < nChOut; ++ch)
+            juce::FloatVectorOperations::addWithMultiply (outputs[ch],
+                                                          rampBuffer.getReadPointer (ch),
+                                                          weights,
+                                                          L);
+    }
 }
 
 //==============================================================================
@@ -449,8 +498,6 @@ void MultiEncoderAudioProcessor::updateBuffers()
     const int nChIn = input.getSize();
     const int _nChIn = input.getPreviousSize();
 
-    bufferCopy.setSize (nChIn, getBlockSize());
-
     // disable solo and mute for deleted input channels
     for (int i = nChIn; i < _nChIn; ++i)
     {
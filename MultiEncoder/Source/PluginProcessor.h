@@ -24,6 +24,7 @@
 
 #include "../../resources/AudioProcessorBase.h"
 #include "../../resources/Conversions.h"
+#include "../../resources/DenseMatrixKernel.h"
 #include "../../resources/Quaternion.h"
 #include "../../resources/ambisonicTools.h"
 #include "../../resources/efficientSHvanilla.h"
@@ -145,7 +146,13 @@ private:
     float _SH[maxNumberOfInputs][64];
     float _gain[maxNumberOfInputs];
 
-    juce::AudioBuffer<float> bufferCopy;
+    // encoding matrices (output channel x source): the current gains of all sources, and the
+    // change since the last block of the moving sources only
+    float encodingMatrix[64][maxNumberOfInputs];
+    float encodingDifference[64][maxNumberOfInputs];
+    DenseMatrixKernel encodingKernel;
+    juce::AudioBuffer<float> rampBuffer; // contribution of the gain changes
+    juce::Array<float> rampWeights;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MultiEncoderAudioProcessor)
 };
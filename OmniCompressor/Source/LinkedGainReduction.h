@@ -0,0 +1,119 @@
+/*
+ ==============================================================================
+ This file is part of the IEM plug-in suite.
+ Author: Daniel Rudrich
+ Copyright (c) 2024 - Institute of Electronic Music and Acoustics (IEM)
+ https://iem.at
+
+ The IEM plug-in suite is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ The IEM plug-in suite is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this software.  If not, see <https://www.gnu.org/licenses/>.
+ ==============================================================================
+ */
+
+#pragma once
+#include "../JuceLibraryCode/JuceHeader.h"
+
+/**
+ Gain reductions of all OmniCompressor instances of a process, shared via a
+ juce::SharedResourcePointer, so instances in the same link group can follow the strongest gain
+ reduction of the group. Each instance owns one slot, into which it publishes the gain
+ reduction of its current block together with a timestamp. Readers skip entries which haven't
+ been updated for a while, e.g. of bypassed or stopped instances.
+
+ Slots are acquired in the constructor and released in the destructor of an instance, none of
+ the methods ever locks. The values of a slot are stored independently, so a reader might
+ combine the gain reduction of one block with the group of another one, which is harmless at
+ block rate.
+ */
+class LinkedGainReduction
+{
+public:
+    static constexpr int maxNumInstances = 128;
+    static constexpr int numGroups = 4;
+    static constexpr juce::uint32 timeoutInMilliseconds = 100;
+
+    /** Returns the index of a free slot, or -1 if all of them are in use. */
+    int acquireSlot()
+    {
+        for (int i = 0; i < maxNumInstances; ++i)
+        {
+            bool expected = false;
+            if (slots[i].used.compare_exchange_strong (expected, true))
+            {
+                slots[i].group.store (-1, std::memory_order_relaxed);
+                return i;
+            }
+        }
+
+        return -1;
+    }
+
+    void releaseSlot (const int slot)
+    {
+        if (slot < 0)
+            return;
+
+        slots[slot].group.store (-1, std::memory_order_relaxed);
+        slots[slot].used.store (false);
+    }
+
+    /** Publishes the gain reduction (in decibels, negative) of a slot, group -1 means the
+        instance isn't linked. */
+    void publish (const int slot,
+                  const int group,
+                  const float gainReductionInDecibels,
+                  const juce::uint32 timeInMilliseconds)
+    {
+        auto& s = slots[slot];
+        s.gainReduction.store (gainReductionInDecibels, std::memory_order_relaxed);
+        s.timestamp.store (timeInMilliseconds, std::memory_order_relaxed);
+        s.group.store (group, std::memory_order_release);
+    }
+
+    /** Returns the strongest gain reduction of all other up-to-date members of a group, or zero
+        if there are none. */
+    float getGroupGainReduction (const int ownSlot,
+                                 const int group,
+                                 const juce::uint32 timeInMilliseconds) const
+    {
+        float minimum = 0.0f;
+        for (int i = 0; i < maxNumInstances; ++i)
+        {
+            const auto& s = slots[i];
+            if (i == ownSlot || s.group.load (std::memory_order_acquire) != group)
+                continue;
+
+            // the difference wraps around with the millisecond counter, and is negative for
+            // entries published after timeInMilliseconds has been taken
+            const auto age = static_cast<int> (timeInMilliseconds
+                                               - s.timestamp.load (std::memory_order_relaxed));
+            if (age > static_cast<int> (timeoutInMilliseconds))
+                continue;
+
+            minimum = juce::jmin (minimum, s.gainReduction.load (std::memory_order_relaxed));
+        }
+
+        return minimum;
+    }
+
+private:
+    struct Slot
+    {
+        std::atomic<bool> used { false };
+        std::atomic<int> group { -1 };
+        std::atomic<float> gainReduction { 0.0f };
+        std::atomic<juce::uint32> timestamp { 0 };
+    };
+
+    Slot slots[maxNumInstances];
+};
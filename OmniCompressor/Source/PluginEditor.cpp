@@ -33,7 +33,7 @@ OmniCompressorAudioProcessorEditor::OmniCompressorAudioProcessorEditor (
     footer (p.getOSCParameterInterface()),
     characteristic (&processor.compressor)
 {
-    setSize (330, 500);
+    setSize (330, 530);
     setLookAndFeel (&globalLaF);
 
     addAndMakeVisible (&title);
@@ -48,6 +48,24 @@ OmniCompressorAudioProcessorEditor::OmniCompressorAudioProcessorEditor (
     tbLookAhead.setButtonText ("Look ahead (5ms)");
     tbLookAhead.setColour (juce::ToggleButton::tickColourId, globalLaF.ClWidgetColours[0]);
 
+    addAndMakeVisible (&tbTruePeak);
+    tbTruePeakAttachment.reset (new ButtonAttachment (valueTreeState, "truePeak", tbTruePeak));
+    tbTruePeak.setButtonText ("True peak (4x)");
+    tbTruePeak.setColour (juce::ToggleButton::tickColourId, globalLaF.ClWidgetColours[0]);
+
+    addAndMakeVisible (&cbSideChain);
+    cbSideChain.setJustificationType (juce::Justification::centred);
+    cbSideChain.addItem ("Detector: W", 1);
+    cbSideChain.addItem ("Detector: Side Chain", 2);
+    cbSideChainAttachment.reset (new ComboBoxAttachment (valueTreeState, "sideChain", cbSideChain));
+
+    addAndMakeVisible (&cbLinkGroup);
+    cbLinkGroup.setJustificationType (juce::Justification::centred);
+    cbLinkGroup.addItem ("No Link", 1);
+    for (int i = 1; i <= LinkedGainReduction::numGroups; ++i)
+        cbLinkGroup.addItem ("Link Group " + juce::String (i), i + 1);
+    cbLinkGroupAttachment.reset (new ComboBoxAttachment (valueTreeState, "linkGroup", cbLinkGroup));
+
     addAndMakeVisible (&sliderKnee);
     KnAttachment.reset (new SliderAttachment (valueTreeState, "knee", sliderKnee));
     sliderKnee.setSliderStyle (juce::Slider::RotaryHorizontalVerticalDrag);
@@ -226,7 +244,14 @@ void OmniCompressorAudioProcessorEditor::resized()
     lbRelease.setBounds (sliderRow.removeFromLeft (sliderWidth));
 
     area.removeFromBottom (10);
-    tbLookAhead.setBounds (area.removeFromBottom (20).removeFromLeft (130));
+    sliderRow = area.removeFromBottom (20);
+    tbLookAhead.setBounds (sliderRow.removeFromLeft (130));
+    tbTruePeak.setBounds (sliderRow.removeFromRight (110));
+    area.removeFromBottom (10);
+
+    sliderRow = area.removeFromBottom (20);
+    cbSideChain.setBounds (sliderRow.removeFromLeft (155));
+    cbLinkGroup.setBounds (sliderRow.removeFromRight (100));
     area.removeFromBottom (10);
     characteristic.setBounds (area);
 }
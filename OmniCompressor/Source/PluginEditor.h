@@ -76,6 +76,12 @@ private:
     juce::ToggleButton tbLookAhead;
     std::unique_ptr<ButtonAttachment> tbLookAheadAttachment;
 
+    juce::ToggleButton tbTruePeak;
+    std::unique_ptr<ButtonAttachment> tbTruePeakAttachment;
+
+    juce::ComboBox cbSideChain, cbLinkGroup;
+    std::unique_ptr<ComboBoxAttachment> cbSideChainAttachment, cbLinkGroupAttachment;
+
     CompressorVisualizer characteristic;
     LevelMeter inpMeter, dbGRmeter;
 
@@ -36,6 +36,7 @@ OmniCompressorAudioProcessor::OmniCompressorAudioProcessor() :
                              ? juce::AudioChannelSet::ambisonic (1)
                              : juce::AudioChannelSet::ambisonic (7)),
                         true)
+            .withInput ("Sidechain", juce::AudioChannelSet::mono(), false)
         #endif
             .withOutput ("Output",
                          ((juce::PluginHostType::getPluginLoadedAs()
@@ -49,6 +50,9 @@ OmniCompressorAudioProcessor::OmniCompressorAudioProcessor() :
         createParameterLayout())
 {
     parameters.addParameterListener ("orderSetting", this);
+    parameters.addParameterListener ("lookAhead", this);
+    parameters.addParameterListener ("reportLatency", this);
+    parameters.addParameterListener ("truePeak", this);
 
     orderSetting = parameters.getRawParameterValue ("orderSetting");
     threshold = parameters.getRawParameterValue ("threshold");
@@ -59,14 +63,20 @@ OmniCompressorAudioProcessor::OmniCompressorAudioProcessor() :
     release = parameters.getRawParameterValue ("release");
     lookAhead = parameters.getRawParameterValue ("lookAhead");
     reportLatency = parameters.getRawParameterValue ("reportLatency");
+    sideChain = parameters.getRawParameterValue ("sideChain");
+    linkGroup = parameters.getRawParameterValue ("linkGroup");
+    truePeak = parameters.getRawParameterValue ("truePeak");
     GR = 0.0f;
 
+    linkSlot = linkedGainReductions->acquireSlot();
+
     delay.setDelayTime (0.005f);
     grProcessing.setDelayTime (0.005f);
 }
 
 OmniCompressorAudioProcessor::~OmniCompressorAudioProcessor()
 {
+    linkedGainReductions->releaseSlot (linkSlot);
 }
 
 //==============================================================================
@@ -99,6 +109,9 @@ void OmniCompressorAudioProcessor::parameterChanged (const juce::String& paramet
 {
     if (parameterID == "orderSetting")
         userChangedIOSettings = true;
+    else if (parameterID == "lookAhead" || parameterID == "reportLatency"
+             || parameterID == "truePeak")
+        triggerAsyncUpdate();
 }
 
 //==============================================================================
@@ -109,7 +122,8 @@ void OmniCompressorAudioProcessor::prepareToPlay (double sampleRate, int samples
     RMS.resize (samplesPerBlock);
     allGR.resize (samplesPerBlock);
 
-    gains.setSize (1, samplesPerBlock);
+    gains.setSize (2, samplesPerBlock);
+    linkedGainReduction = 0.0f;
 
     juce::dsp::ProcessSpec spec;
     spec.sampleRate = sampleRate;
@@ -118,13 +132,36 @@ void OmniCompressorAudioProcessor::prepareToPlay (double sampleRate, int samples
 
     compressor.prepare (spec);
     grProcessing.prepare (spec);
-    spec.numChannels = getTotalNumInputChannels();
+    spec.numChannels = getMainBusNumInputChannels();
     delay.prepare (spec);
 
-    if (*reportLatency >= 0.5f && *lookAhead >= 0.5f)
-        setLatencySamples (delay.getDelayInSamples());
-    else
-        setLatencySamples (0);
+    truePeakSignal.setSize (1, samplesPerBlock);
+    truePeakDetector.reset();
+    truePeakDelay.setDelayTime ((TruePeakDetector::getLatencyInSamples() + 0.5f)
+                                / static_cast<float> (sampleRate));
+    truePeakDelay.prepare (spec);
+    truePeakWasActive = false;
+
+    setLatencySamples (getLatency());
+}
+
+int OmniCompressorAudioProcessor::getLatency()
+{
+    if (*reportLatency < 0.5f)
+        return 0;
+
+    int latency = 0;
+    if (*lookAhead >= 0.5f)
+        latency += delay.getDelayInSamples();
+    if (*truePeak >= 0.5f)
+        latency += TruePeakDetector::getLatencyInSamples();
+
+    return latency;
+}
+
+void OmniCompressorAudioProcessor::handleAsyncUpdate()
+{
+    setLatencySamples (getLatency());
 }
 
 void OmniCompressorAudioProcessor::releaseResources()
@@ -138,17 +175,37 @@ void OmniCompressorAudioProcessor::processBlock (juce::AudioSampleBuffer& buffer
 {
     checkInputAndOutput (this, *orderSetting, *orderSetting);
 
-    const int totalNumInputChannels = getTotalNumInputChannels();
-    const int totalNumOutputChannels = getTotalNumOutputChannels();
+    const int totalNumInputChannels = getMainBusNumInputChannels();
+    const int totalNumOutputChannels = getMainBusNumOutputChannels();
     const int bufferSize = buffer.getNumSamples();
 
     const int numCh = juce::jmin (buffer.getNumChannels(),
                                   input.getNumberOfChannels(),
                                   output.getNumberOfChannels());
     //const int ambisonicOrder = juce::jmin(input.getOrder(), output.getOrder());
-    const float* bufferReadPtr = buffer.getReadPointer (0);
+    const float* bufferReadPtr = getDetectorSignal (buffer);
 
     const bool useLookAhead = *lookAhead >= 0.5f;
+    const bool useTruePeak = *truePeak >= 0.5f;
+
+    if (useTruePeak)
+    {
+        if (! truePeakWasActive)
+        {
+            // clear the history without any allocation
+            truePeakDetector.reset();
+            truePeakDelay.reset();
+        }
+
+        truePeakDetector.process (bufferReadPtr, truePeakSignal.getWritePointer (0), bufferSize);
+        bufferReadPtr = truePeakSignal.getReadPointer (0);
+
+        // align the audio signal with the detected peaks
+        juce::dsp::AudioBlock<float> ab (buffer);
+        juce::dsp::ProcessContextReplacing<float> context (ab);
+        truePeakDelay.process (context);
+    }
+    truePeakWasActive = useTruePeak;
 
     if (*ratio > 15.9f)
         compressor.setRatio (INFINITY);
@@ -171,7 +228,9 @@ void OmniCompressorAudioProcessor::processBlock (juce::AudioSampleBuffer& buffer
         compressor.getGainFromSidechainSignalInDecibelsWithoutMakeUpGain (bufferReadPtr,
                                                                           gains.getWritePointer (0),
                                                                           bufferSize);
-        maxGR = juce::FloatVectorOperations::findMinimum (gains.getWritePointer (0), bufferSize);
+        const float ownGR =
+            juce::FloatVectorOperations::findMinimum (gains.getWritePointer (0), bufferSize);
+        maxGR = ownGR;
 
         // delay input signal
         {
@@ -184,23 +243,40 @@ void OmniCompressorAudioProcessor::processBlock (juce::AudioSampleBuffer& buffer
         grProcessing.process();
         grProcessing.readSamples (gains.getWritePointer (0), bufferSize);
 
+        if (updateLinkedGainReduction (ownGR, bufferSize))
+            juce::FloatVectorOperations::min (gains.getWritePointer (0),
+                                              gains.getReadPointer (0),
+                                              gains.getReadPointer (1),
+                                              bufferSize);
+
         // convert from decibels to gain values
-        for (int i = 0; i < bufferSize; ++i)
-        {
-            gains.setSample (0,
-                             i,
-                             juce::Decibels::decibelsToGain (gains.getSample (0, i) + *outGain));
-        }
+        iem::Compressor::decibelsToGain (gains.getReadPointer (0),
+                                         gains.getWritePointer (0),
+                                         *outGain,
+                                         bufferSize);
     }
     else
     {
         compressor.getGainFromSidechainSignal (bufferReadPtr,
                                                gains.getWritePointer (0),
                                                bufferSize);
-        maxGR =
+        const float ownGR =
             juce::Decibels::gainToDecibels (
                 juce::FloatVectorOperations::findMinimum (gains.getWritePointer (0), bufferSize))
             - *outGain;
+        maxGR = ownGR;
+
+        if (updateLinkedGainReduction (ownGR, bufferSize))
+        {
+            iem::Compressor::decibelsToGain (gains.getReadPointer (1),
+                                             gains.getWritePointer (1),
+                                             *outGain,
+                                             bufferSize);
+            juce::FloatVectorOperations::min (gains.getWritePointer (0),
+                                              gains.getReadPointer (0),
+                                              gains.getReadPointer (1),
+                                              bufferSize);
+        }
     }
 
     maxRMS = compressor.getMaxLevelInDecibels();
@@ -212,6 +288,50 @@ void OmniCompressorAudioProcessor::processBlock (juce::AudioSampleBuffer& buffer
     }
 }
 
+const float* OmniCompressorAudioProcessor::getDetectorSignal (juce::AudioSampleBuffer& buffer)
+{
+    // falls back to the W channel if the side chain bus is disabled
+    if (*sideChain >= 0.5f && getBusCount (true) > 1)
+    {
+        auto sideChainBuffer = getBusBuffer (buffer, true, 1);
+        if (sideChainBuffer.getNumChannels() > 0)
+            return sideChainBuffer.getReadPointer (0);
+    }
+
+    return buffer.getReadPointer (0);
+}
+
+/** Publishes the gain reduction of this block to the link group and writes the gain reduction
+    of the other members, ramped across the block, into the second channel of gains. Returns
+    false if there is no gain reduction to apply. */
+bool OmniCompressorAudioProcessor::updateLinkedGainReduction (const float ownGainReduction,
+                                                             const int numSamples)
+{
+    float target = 0.0f;
+    if (linkSlot >= 0)
+    {
+        const int group = juce::roundToInt (linkGroup->load()) - 1;
+        const auto now = juce::Time::getMillisecondCounter();
+
+        linkedGainReductions->publish (linkSlot, group, ownGainReduction, now);
+        if (group >= 0)
+            target = linkedGainReductions->getGroupGainReduction (linkSlot, group, now);
+    }
+
+    const float start = linkedGainReduction;
+    linkedGainReduction = target;
+
+    if (start >= 0.0f && target >= 0.0f)
+        return false;
+
+    float* ramp = gains.getWritePointer (1);
+    const float increment = (target - start) / numSamples;
+    for (int i = 0; i < numSamples; ++i)
+        ramp[i] = start + (i + 1) * increment;
+
+    return true;
+}
+
 //==============================================================================
 bool OmniCompressorAudioProcessor::hasEditor() const
 {
@@ -389,6 +509,38 @@ std::vector<std::unique_ptr<juce::RangedAudioParameter>>
         },
         nullptr));
 
+    params.push_back (OSCParameterInterface::createParameterTheOldWay (
+        "sideChain",
+        "Detector Signal",
+        "",
+        juce::NormalisableRange<float> (0.0f, 1.0f, 1.0f),
+        0.0f,
+        [] (float value) { return value >= 0.5f ? "Side Chain" : "W Channel"; },
+        nullptr));
+
+    params.push_back (OSCParameterInterface::createParameterTheOldWay (
+        "linkGroup",
+        "Link Group",
+        "",
+        juce::NormalisableRange<float> (0.0f, LinkedGainReduction::numGroups, 1.0f),
+        0.0f,
+        [] (float value)
+        {
+            if (value < 0.5f)
+                return juce::String ("Off");
+            return juce::String (juce::roundToInt (value));
+        },
+        nullptr));
+
+    params.push_back (OSCParameterInterface::createParameterTheOldWay (
+        "truePeak",
+        "True-Peak Detection",
+        "",
+        juce::NormalisableRange<float> (0.0f, 1.0f, 1.0f),
+        0.0f,
+        [] (float value) { return value >= 0.5f ? "ON (4x)" : "OFF"; },
+        nullptr));
+
     return params;
 }
 
@@ -26,8 +26,10 @@
 #include "../../resources/Compressor.h"
 #include "../../resources/Delay.h"
 #include "../../resources/MaxRE.h"
+#include "../../resources/TruePeakDetector.h"
 #include "../../resources/ambisonicTools.h"
 #include "../JuceLibraryCode/JuceHeader.h"
+#include "LinkedGainReduction.h"
 #include "LookAheadGainReduction.h"
 
 #define ProcessorClass OmniCompressorAudioProcessor
@@ -36,7 +38,8 @@
 /**
 */
 class OmniCompressorAudioProcessor
-    : public AudioProcessorBase<IOTypes::Ambisonics<>, IOTypes::Ambisonics<>>
+    : public AudioProcessorBase<IOTypes::Ambisonics<>, IOTypes::Ambisonics<>>,
+      private juce::AsyncUpdater
 {
 public:
     constexpr static int numberOfInputChannels = 64;
@@ -77,11 +80,29 @@ public:
 
 private:
     //==============================================================================
+    const float* getDetectorSignal (juce::AudioSampleBuffer& buffer);
+    bool updateLinkedGainReduction (const float ownGainReduction, const int numSamples);
+    int getLatency();
+
+    /** Reports the latency of the look-ahead and true-peak detection to the host, on the
+        message thread. */
+    void handleAsyncUpdate() override;
+
     Delay delay;
     LookAheadGainReduction grProcessing;
 
+    // true-peak detection, the audio is delayed by the detector's latency
+    TruePeakDetector truePeakDetector;
+    Delay truePeakDelay;
+    juce::AudioBuffer<float> truePeakSignal;
+    bool truePeakWasActive = false;
+
     juce::Array<float> RMS, allGR;
-    juce::AudioBuffer<float> gains;
+    juce::AudioBuffer<float> gains; // gains and gain reduction of the link group
+
+    juce::SharedResourcePointer<LinkedGainReduction> linkedGainReductions;
+    int linkSlot = -1;
+    float linkedGainReduction = 0.0f; // group's gain reduction at the end of the last block
 
     float GR;
     std::atomic<float>* orderSetting;
@@ -93,6 +114,9 @@ private:
     std::atomic<float>* knee;
     std::atomic<float>* lookAhead;
     std::atomic<float>* reportLatency;
+    std::atomic<float>* sideChain;
+    std::atomic<float>* linkGroup;
+    std::atomic<float>* truePeak;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (OmniCompressorAudioProcessor)
 };
@@ -223,8 +223,35 @@ RoomEncoderAudioProcessorEditor::RoomEncoderAudioProcessorEditor (
     sourceElement.setColour (globalLaF.ClWidgetColours[2]);
     listenerElement.setColour (globalLaF.ClWidgetColours[1]);
 
+    for (int i = 2; i <= RoomEncoderAudioProcessor::maxNumberOfSources; ++i)
+    {
+        const juce::String index (i);
+        auto element = additionalSourceElements.add (new PositionPlane::ParameterElement (
+            *valueTreeState.getParameter ("sourceX" + index),
+            valueTreeState.getParameterRange ("sourceX" + index),
+            *valueTreeState.getParameter ("sourceY" + index),
+            valueTreeState.getParameterRange ("sourceY" + index),
+            *valueTreeState.getParameter ("sourceZ" + index),
+            valueTreeState.getParameterRange ("sourceZ" + index)));
+        element->setColour (globalLaF.ClWidgetColours[2].withMultipliedAlpha (0.6f));
+    }
+
+    addAndMakeVisible (cbNumberOfSources);
+    cbNumberOfSources.setJustificationType (juce::Justification::centred);
+    cbNumberOfSources.addItem ("1 (directivity)", 1);
+    for (int i = 2; i <= RoomEncoderAudioProcessor::maxNumberOfSources; ++i)
+        cbNumberOfSources.addItem (juce::String (i), i);
+    cbNumberOfSourcesAttachment.reset (
+        new ComboBoxAttachment (valueTreeState, "numberOfSources", cbNumberOfSources));
+    cbNumberOfSources.setTooltip (
+        "With more than one source, each input channel is rendered as an omnidirectional "
+        "source, all sharing the same room.");
+
+    addAndMakeVisible (lbNumberOfSources);
+    lbNumberOfSources.setText ("Number of Sources", true, juce::Justification::left);
+
     addAndMakeVisible (&lbNumReflections);
-    lbNumReflections.setText ("Number of Reflections");
+    lbNumReflections.setText ("Reflections");
     addAndMakeVisible (&slNumReflections);
     slNumReflectionsAttachment.reset (
         new SliderAttachment (valueTreeState, "numRefl", slNumReflections));
@@ -232,6 +259,20 @@ RoomEncoderAudioProcessorEditor::RoomEncoderAudioProcessorEditor (
     slNumReflections.setTextBoxStyle (juce::Slider::TextBoxBelow, false, 50, 15);
     slNumReflections.setColour (juce::Slider::rotarySliderOutlineColourId,
                                 globalLaF.ClWidgetColours[1]);
+    slNumReflections.setTooltip ("number of reflections");
+
+    addAndMakeVisible (&lbLodThreshold);
+    lbLodThreshold.setText ("LOD Threshold");
+    addAndMakeVisible (&slLodThreshold);
+    slLodThresholdAttachment.reset (
+        new SliderAttachment (valueTreeState, "lodThreshold", slLodThreshold));
+    slLodThreshold.setSliderStyle (juce::Slider::RotaryHorizontalVerticalDrag);
+    slLodThreshold.setTextBoxStyle (juce::Slider::TextBoxBelow, false, 50, 15);
+    slLodThreshold.setColour (juce::Slider::rotarySliderOutlineColourId,
+                              globalLaF.ClWidgetColours[1]);
+    slLodThreshold.setTooltip (
+        "Image sources below this level are not rendered, the ones up to 36 dB above it are "
+        "encoded with a reduced Ambisonic order.");
 
     addAndMakeVisible (lbWallAttenuation);
     lbWallAttenuation.setText ("Additional Attenuation", true, juce::Justification::left);
@@ -358,7 +399,8 @@ RoomEncoderAudioProcessorEditor::RoomEncoderAudioProcessorEditor (
                         &slHighShelfGain);
 
     addAndMakeVisible (&rv);
-    rv.setDataPointers (p.allGains, p.mRadius, p.numRefl);
+    rv.setDataPointers (p.allGains, p.getSourceState (0).mRadius, p.numRefl);
+    rv.setNumRenderedPointer (&p.numRenderedImageSources);
 
     juce::Vector3D<float> dims (slRoomX.getValue(), slRoomY.getValue(), slRoomZ.getValue());
     float scale = juce::jmin (xyPlane.setDimensions (dims), zyPlane.setDimensions (dims));
@@ -616,13 +658,23 @@ void RoomEncoderAudioProcessorEditor::resized()
     lbWallAttenuationFloor.setBounds (sliderRow.removeFromLeft (rotSliderWidth));
 
     propArea.removeFromTop (5);
-    slNumReflections.setBounds (propArea.removeFromTop (rotSliderHeight));
-    lbNumReflections.setBounds (propArea.removeFromTop (labelHeight));
+    sliderRow = propArea.removeFromTop (rotSliderHeight);
+    slNumReflections.setBounds (sliderRow.removeFromLeft (sliderRow.getWidth() / 2));
+    slLodThreshold.setBounds (sliderRow);
+    sliderRow = propArea.removeFromTop (labelHeight);
+    lbNumReflections.setBounds (sliderRow.removeFromLeft (sliderRow.getWidth() / 2));
+    lbLodThreshold.setBounds (sliderRow);
 
     area.removeFromRight (10);
 
     {
         juce::Rectangle<int> planeArea (area.removeFromLeft (300));
+
+        juce::Rectangle<int> sourcesRow (planeArea.removeFromTop (20));
+        lbNumberOfSources.setBounds (sourcesRow.removeFromLeft (110));
+        cbNumberOfSources.setBounds (sourcesRow.removeFromLeft (110));
+        planeArea.removeFromTop (5);
+
         int height = planeArea.getHeight() / 2;
 
         xyPlane.setBounds (planeArea.removeFromTop (height));
@@ -660,6 +712,33 @@ void RoomEncoderAudioProcessorEditor::timerCallback()
         processor.updateFv = false;
     }
 
+    const int numSources = juce::roundToInt (
+        valueTreeState.getRawParameterValue ("numberOfSources")->load());
+    if (numSources != numVisibleSources)
+    {
+        for (int i = 0; i < additionalSourceElements.size(); ++i)
+        {
+            auto element = additionalSourceElements[i];
+            const bool wasVisible = i + 2 <= numVisibleSources;
+            const bool isVisible = i + 2 <= numSources;
+
+            if (wasVisible && ! isVisible)
+            {
+                xyPlane.removeElement (element);
+                zyPlane.removeElement (element);
+            }
+            else if (isVisible && ! wasVisible)
+            {
+                xyPlane.addElement (element);
+                zyPlane.addElement (element);
+            }
+        }
+
+        numVisibleSources = numSources;
+        xyPlane.repaint();
+        zyPlane.repaint();
+    }
+
     if (processor.repaintPositionPlanes.get())
     {
         processor.repaintPositionPlanes = false;
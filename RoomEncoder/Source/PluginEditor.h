@@ -71,7 +71,7 @@ private:
     RoomEncoderAudioProcessor& processor;
     juce::AudioProcessorValueTreeState& valueTreeState;
 
-    SimpleLabel lbReflCoeff, lbNumReflections;
+    SimpleLabel lbReflCoeff, lbNumReflections, lbLodThreshold;
     TripleLabel lbRoomDim;
 
     FilterVisualizer<float> fv;
@@ -106,7 +106,7 @@ private:
     ReverseSlider slRoomX, slRoomY, slRoomZ;
 
     ReverseSlider slReflCoeff, slLowShelfFreq, slLowShelfGain, slHighShelfFreq, slHighShelfGain;
-    ReverseSlider slNumReflections;
+    ReverseSlider slNumReflections, slLodThreshold;
 
     ReverseSlider slWallAttenuationFront, slWallAttenuationBack, slWallAttenuationLeft,
         slWallAttenuationRight, slWallAttenuationCeiling, slWallAttenuationFloor;
@@ -118,7 +118,7 @@ private:
 
     std::unique_ptr<SliderAttachment> slReflCoeffAttachment, slLowShelfFreqAttachment,
         slLowShelfGainAttachment, slHighShelfFreqAttachment, slHighShelfGainAttachment;
-    std::unique_ptr<SliderAttachment> slNumReflectionsAttachment;
+    std::unique_ptr<SliderAttachment> slNumReflectionsAttachment, slLodThresholdAttachment;
 
     std::unique_ptr<SliderAttachment> slWallAttenuationFrontAttachment,
         slWallAttenuationBackAttachment, slWallAttenuationLeftAttachment,
@@ -132,6 +132,12 @@ private:
 
     PositionPlane xyPlane, zyPlane;
     PositionPlane::ParameterElement sourceElement, listenerElement;
+    juce::OwnedArray<PositionPlane::ParameterElement> additionalSourceElements;
+    int numVisibleSources = 1;
+
+    juce::ComboBox cbNumberOfSources;
+    SimpleLabel lbNumberOfSources;
+    std::unique_ptr<ComboBoxAttachment> cbNumberOfSourcesAttachment;
 
     juce::OpenGLContext mOpenGlContext;
 
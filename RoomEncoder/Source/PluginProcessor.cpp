@@ -22,6 +22,8 @@
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
 
+thread_local bool RoomEncoderAudioProcessor::readingSharedParams = false;
+
 //==============================================================================
 RoomEncoderAudioProcessor::RoomEncoderAudioProcessor() :
     AudioProcessorBase (
@@ -45,7 +47,8 @@ RoomEncoderAudioProcessor::RoomEncoderAudioProcessor() :
     #endif
             ,
 #endif
-        createParameterLayout())
+        createParameterLayout()),
+    juce::Thread ("RoomEncoderGeometry")
 {
     initializeReflectionList();
 
@@ -58,9 +61,16 @@ RoomEncoderAudioProcessor::RoomEncoderAudioProcessor() :
     roomY = parameters.getRawParameterValue ("roomY");
     roomZ = parameters.getRawParameterValue ("roomZ");
 
-    sourceX = parameters.getRawParameterValue ("sourceX");
-    sourceY = parameters.getRawParameterValue ("sourceY");
-    sourceZ = parameters.getRawParameterValue ("sourceZ");
+    numberOfSources = parameters.getRawParameterValue ("numberOfSources");
+    sourceX[0] = parameters.getRawParameterValue ("sourceX");
+    sourceY[0] = parameters.getRawParameterValue ("sourceY");
+    sourceZ[0] = parameters.getRawParameterValue ("sourceZ");
+    for (int i = 1; i < maxNumberOfSources; ++i)
+    {
+        sourceX[i] = parameters.getRawParameterValue ("sourceX" + juce::String (i + 1));
+        sourceY[i] = parameters.getRawParameterValue ("sourceY" + juce::String (i + 1));
+        sourceZ[i] = parameters.getRawParameterValue ("sourceZ" + juce::String (i + 1));
+    }
     listenerX = parameters.getRawParameterValue ("listenerX");
     listenerY = parameters.getRawParameterValue ("listenerY");
     listenerZ = parameters.getRawParameterValue ("listenerZ");
@@ -89,6 +99,7 @@ RoomEncoderAudioProcessor::RoomEncoderAudioProcessor() :
     wallAttenuationFloor = parameters.getRawParameterValue ("wallAttenuationFloor");
 
     constantGainDistance = parameters.getRawParameterValue ("constantGainDistance");
+    lodThreshold = parameters.getRawParameterValue ("lodThreshold");
 
     parameters.addParameterListener ("directivityOrderSetting", this);
     parameters.addParameterListener ("orderSetting", this);
@@ -104,6 +115,12 @@ RoomEncoderAudioProcessor::RoomEncoderAudioProcessor() :
     parameters.addParameterListener ("sourceX", this);
     parameters.addParameterListener ("sourceY", this);
     parameters.addParameterListener ("sourceZ", this);
+    for (int i = 1; i < maxNumberOfSources; ++i)
+    {
+        parameters.addParameterListener ("sourceX" + juce::String (i + 1), this);
+        parameters.addParameterListener ("sourceY" + juce::String (i + 1), this);
+        parameters.addParameterListener ("sourceZ" + juce::String (i + 1), this);
+    }
     parameters.addParameterListener ("roomX", this);
     parameters.addParameterListener ("roomY", this);
     parameters.addParameterListener ("roomZ", this);
@@ -115,16 +132,71 @@ RoomEncoderAudioProcessor::RoomEncoderAudioProcessor() :
     parameters.addParameterListener ("wallAttenuationCeiling", this);
     parameters.addParameterListener ("wallAttenuationFloor", this);
 
+    // parameters which can be synchronized, in the groups of the shared room state
+    const juce::StringArray syncGroupIDs[SharedParams::numGroups] = {
+        { "roomX", "roomY", "roomZ" },
+        { "listenerX", "listenerY", "listenerZ" },
+        { "reflCoeff",
+          "numRefl",
+          "lowShelfFreq",
+          "lowShelfGain",
+          "highShelfFreq",
+          "highShelfGain",
+          "wallAttenuationFront",
+          "wallAttenuationBack",
+          "wallAttenuationLeft",
+          "wallAttenuationRight",
+          "wallAttenuationCeiling",
+          "wallAttenuationFloor" }
+    };
+    syncGroups[0].enabled = syncRoomSize;
+    syncGroups[1].enabled = syncListener;
+    syncGroups[2].enabled = syncReflection;
+
+    for (int g = 0; g < SharedParams::numGroups; ++g)
+    {
+        auto& group = syncGroups[g];
+        group.numValues = syncGroupIDs[g].size();
+        jassert (group.numValues <= SharedRoomValues::maxNumValues);
+
+        for (int i = 0; i < group.numValues; ++i)
+        {
+            group.parameters[i] = parameters.getParameter (syncGroupIDs[g][i]);
+            group.values[i] = parameters.getRawParameterValue (syncGroupIDs[g][i]);
+        }
+    }
+
+    parameters.addParameterListener ("numberOfSources", this);
+    parameters.addParameterListener ("inputIsSN3D", this);
+    parameters.addParameterListener ("useSN3D", this);
+    parameters.addParameterListener ("renderDirectPath", this);
+    parameters.addParameterListener ("directPathZeroDelay", this);
+    parameters.addParameterListener ("directPathUnityGain", this);
+    parameters.addParameterListener ("constantGainDistance", this);
+    parameters.addParameterListener ("lodThreshold", this);
+
     _numRefl = 0;
+    _numSources = 1;
 
-    sourcePos = juce::Vector3D<float> (*sourceX, *sourceY, *sourceZ);
     listenerPos = juce::Vector3D<float> (*listenerX, *listenerY, *listenerZ);
 
+    for (int s = 0; s < maxNumberOfSources; ++s)
+    {
+        sourcePos[s] = juce::Vector3D<float> (*sourceX[s], *sourceY[s], *sourceZ[s]);
+
+        auto source = sources.add (new ImageSourceState());
+        for (int i = 0; i < nImgSrc; ++i)
+        {
+            source->mRadius[i] = 1.0f;
+            source->oldDelay[i] = 44100 / 343.2f * interpMult; //init oldRadius
+            source->numEncodedChannels[i] = 0;
+            juce::FloatVectorOperations::clear (source->SHcoeffsOld[i], 64);
+        }
+    }
+
     for (int i = 0; i < nImgSrc; ++i)
     {
-        oldDelay[i] = 44100 / 343.2f * interpMult; //init oldRadius
         allGains[i] = 0.0f;
-        juce::FloatVectorOperations::clear (SHcoeffsOld[i], 64);
         juce::FloatVectorOperations::clear ((float*) &SHsampleOld[i], 64);
     }
 
@@ -153,11 +225,12 @@ RoomEncoderAudioProcessor::RoomEncoderAudioProcessor() :
         }
     }
 
-    startTimer (50);
+    startThread();
 }
 
 RoomEncoderAudioProcessor::~RoomEncoderAudioProcessor()
 {
+    stopThread (5000);
 }
 
 //==============================================================================
@@ -269,9 +342,6 @@ void RoomEncoderAudioProcessor::changeProgramName (int index, const juce::String
 //==============================================================================
 void RoomEncoderAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlock)
 {
-    dist2smpls =
-        sampleRate / 343.2f * interpMult; //factor 128 is a small hack for Lagrange lookuptable
-
     checkInputAndOutput (this, *directivityOrderSetting, *orderSetting, true);
 
     readOffset = 0;
@@ -296,29 +366,27 @@ void RoomEncoderAudioProcessor::prepareToPlay (double sampleRate, int samplesPer
     zero = juce::dsp::AudioBlock<float> (zeroData, IIRfloat_elements, samplesPerBlock);
     zero.clear();
 
-    updateFv = true;
+    sourceSignals.setSize (maxNumberOfSources, samplesPerBlock);
 
-    const float rX = *roomX;
-    const float rY = *roomY;
-    const float rZ = *roomZ;
-
-    const float rXHalfBound = rX / 2 - 0.1f;
-    const float rYHalfBound = rY / 2 - 0.1f;
-    const float rZHalfBound = rZ / 2 - 0.1f;
-
-    sourcePos = juce::Vector3D<float> (juce::jlimit (-rXHalfBound, rXHalfBound, sourceX->load()),
-                                       juce::jlimit (-rYHalfBound, rYHalfBound, sourceY->load()),
-                                       juce::jlimit (-rZHalfBound, rZHalfBound, sourceZ->load()));
-
-    listenerPos =
-        juce::Vector3D<float> (juce::jlimit (-rXHalfBound, rXHalfBound, listenerX->load()),
-                               juce::jlimit (-rYHalfBound, rYHalfBound, listenerY->load()),
-                               juce::jlimit (-rZHalfBound, rZHalfBound, listenerZ->load()));
+    updateFv = true;
 
-    calculateImageSourcePositions (rX, rY, rZ);
+    // the first geometry is computed right away, with all positions at their targets
+    {
+        const juce::ScopedLock geometryScopedLock (geometryLock);
+        geometrySampleRate = sampleRate;
+        updateGeometry (true);
+    }
 
-    for (int q = 0; q < nImgSrc; ++q)
-        oldDelay[q] = mRadius[q] * dist2smpls;
+    geometryBuffer.update();
+    const auto& geometry = geometryBuffer.getReadBuffer();
+    for (int s = 0; s < maxNumberOfSources; ++s)
+    {
+        juce::FloatVectorOperations::copy (sources[s]->mRadius,
+                                           geometry.sources[s].radius,
+                                           nImgSrc);
+        for (int q = 0; q < nImgSrc; ++q)
+            sources[s]->oldDelay[q] = geometry.sources[s].delay[q];
+    }
 
     updateFilterCoefficients (sampleRate);
 }
@@ -343,55 +411,22 @@ void RoomEncoderAudioProcessor::parameterChanged (const juce::String& parameterI
         repaintPositionPlanes = true;
     }
 
-    if (*syncChannel >= 0.5f && ! readingSharedParams)
-    {
-        const int ch = (int) *syncChannel - 1;
-        RoomParams& roomParam = sharedParams.get().rooms.getReference (ch);
-
-        bool sRoom (*syncRoomSize >= 0.5f);
-        bool sListener (*syncListener >= 0.5f);
-        bool sReflections (*syncReflection >= 0.5f);
+    notify(); // let the geometry thread update the image sources
 
-        if (sRoom && (parameterID == "roomX" || parameterID == "roomY" || parameterID == "roomZ"))
-        {
-            roomParam.roomX = *roomX;
-            roomParam.roomY = *roomY;
-            roomParam.roomZ = *roomZ;
-            roomParam.validRoomData = true;
-        }
-        else if (sListener
-                 && (parameterID == "listenerX" || parameterID == "listenerY"
-                     || parameterID == "listenerZ"))
-        {
-            roomParam.listenerX = *listenerX;
-            roomParam.listenerY = *listenerY;
-            roomParam.listenerZ = *listenerZ;
-            roomParam.validListenerData = true;
-        }
-        else if (sReflections
-                 && (parameterID == "reflCoeff" || parameterID == "numRefl"
-                     || parameterID == "lowShelfFreq" || parameterID == "lowShelfGain"
-                     || parameterID == "highShelfFreq" || parameterID == "highShelfGain"
-                     || parameterID == "wallAttenuationFront"
-                     || parameterID == "wallAttenuationBack" || parameterID == "wallAttenuationLeft"
-                     || parameterID == "wallAttenuationRight"
-                     || parameterID == "wallAttenuationCeiling"
-                     || parameterID == "wallAttenuationFloor"))
+    // changes of own settings are published to the synchronized channel
+    const int ch = juce::roundToInt (syncChannel->load()) - 1;
+    if (ch >= 0 && ! readingSharedParams)
+    {
+        for (int g = 0; g < SharedParams::numGroups; ++g)
         {
-            roomParam.reflCoeff = *reflCoeff;
-            roomParam.numRefl = *numRefl;
-            roomParam.lowShelfFreq = *lowShelfFreq;
-            roomParam.lowShelfGain = *lowShelfGain;
-            roomParam.highShelfFreq = *highShelfFreq;
-            roomParam.highShelfGain = *highShelfGain;
-            roomParam.wallAttenuationFront = *wallAttenuationFront;
-            roomParam.wallAttenuationBack = *wallAttenuationBack;
-            roomParam.wallAttenuationLeft = *wallAttenuationLeft;
-            roomParam.wallAttenuationRight = *wallAttenuationRight;
-            roomParam.wallAttenuationCeiling = *wallAttenuationCeiling;
-            roomParam.wallAttenuationFloor = *wallAttenuationFloor;
-
-            roomParam.validReflectionData = true;
+            auto& group = syncGroups[g];
+            if (*group.enabled < 0.5f)
+                continue;
+
+            for (int i = 0; i < group.numValues; ++i)
+                if (group.parameters[i]->paramID == parameterID
+                    && publishRoomSettings (ch, g) == 0)
+                    group.publishPending = true;
         }
     }
 }
@@ -416,10 +451,213 @@ void RoomEncoderAudioProcessor::updateFilterCoefficients (double sampleRate)
     updateFv = true;
 }
 
-void RoomEncoderAudioProcessor::calculateImageSourcePositions (const float t,
-                                                               const float b,
-                                                               const float h)
+void RoomEncoderAudioProcessor::run()
 {
+    while (! threadShouldExit())
+    {
+        // offline, the audio thread computes the geometry itself
+        if (isNonRealtime())
+        {
+            wait (-1);
+            continue;
+        }
+
+        bool settled;
+        {
+            const juce::ScopedLock geometryScopedLock (geometryLock);
+            settled = updateGeometry (false);
+        }
+
+        // while sources or the listener are still moving, the geometry is updated periodically
+        wait (settled ? -1 : 5);
+    }
+}
+
+bool RoomEncoderAudioProcessor::updateGeometry (const bool snapToTargets)
+{
+    if (geometrySampleRate <= 0.0) // not prepared yet
+        return true;
+
+    auto& geometry = geometryBuffer.getWriteBuffer();
+
+    //factor 128 is a small hack for Lagrange lookuptable
+    const double dist2smpls = geometrySampleRate / 343.2 * interpMult;
+
+    // positions move with at most 30 meters per second of processed audio; after an idle
+    // period, the audio processed in the meantime doesn't count, as the targets didn't change
+    const juce::int64 sampleCount = processedSamples.load();
+    juce::int64 elapsedSamples = sampleCount - geometrySampleCount;
+    if (geometrySettled)
+        elapsedSamples = juce::jmin (elapsedSamples, static_cast<juce::int64> (getBlockSize()));
+    geometrySampleCount = sampleCount;
+
+    const float maxDist =
+        snapToTargets ? std::numeric_limits<float>::max()
+                      : static_cast<float> (30.0 * elapsedSamples / geometrySampleRate);
+
+    const int ambisonicOrder = currentAmbisonicOrder.load();
+    const int directivityOrder = currentDirectivityOrder.load();
+    const int numSources =
+        juce::jlimit (1, maxNumberOfSources, juce::roundToInt (numberOfSources->load()));
+    const int currNumRefl = juce::roundToInt (numRefl->load());
+
+    geometry.numSources = numSources;
+    geometry.numRefl = currNumRefl;
+
+    // calculating reflection coefficients (only if parameter changed)
+    float reflCoeffGain = juce::Decibels::decibelsToGain (reflCoeff->load());
+    if (powReflCoeff[1] != reflCoeffGain)
+    {
+        powReflCoeff[0] = 1;
+        powReflCoeff[1] = reflCoeffGain;
+        for (int i = 2; i <= maxOrderImgSrc; ++i)
+        {
+            powReflCoeff[i] = powReflCoeff[i - 1] * reflCoeffGain;
+        }
+    }
+
+    // level of detail: image sources below the threshold are culled, the ones up to
+    // numLodSteps * lodStepInDb above it are encoded with a reduced order
+    {
+        const float thresholdInDb = lodThreshold->load();
+        levelOfDetailEnabled = thresholdInDb > lodThresholdOff;
+        for (int r = 0; r <= numLodSteps; ++r)
+            lodGains[r] =
+                juce::Decibels::decibelsToGain (thresholdInDb + (numLodSteps - r) * lodStepInDb);
+    }
+
+    // gains of the image sources without the distance attenuation, equal for all sources
+    float reflectionGains[nImgSrc];
+    {
+        const float attenuationFront = *wallAttenuationFront;
+        const float attenuationBack = *wallAttenuationBack;
+        const float attenuationLeft = *wallAttenuationLeft;
+        const float attenuationRight = *wallAttenuationRight;
+        const float attenuationCeiling = *wallAttenuationCeiling;
+        const float attenuationFloor = *wallAttenuationFloor;
+
+        for (int q = 0; q < nImgSrc; ++q)
+        {
+            // additional wall attenuations
+            float extraAttenuationInDb = 0.0f;
+            const auto& reflProp = *reflectionList[q];
+            extraAttenuationInDb += reflProp.xPlusReflections * attenuationFront;
+            extraAttenuationInDb += reflProp.xMinusReflections * attenuationBack;
+            extraAttenuationInDb += reflProp.yPlusReflections * attenuationLeft;
+            extraAttenuationInDb += reflProp.yMinusReflections * attenuationRight;
+            extraAttenuationInDb += reflProp.zPlusReflections * attenuationCeiling;
+            extraAttenuationInDb += reflProp.zMinusReflections * attenuationFloor;
+
+            reflectionGains[q] = powReflCoeff[reflProp.order]
+                                 * juce::Decibels::decibelsToGain (extraAttenuationInDb);
+        }
+    }
+
+    const bool renderDirect = *renderDirectPath >= 0.5f;
+    const bool zeroDelay = *directPathZeroDelay > 0.5f;
+    const bool unityGain = *directPathUnityGain > 0.5f;
+    const bool encodeSN3D = *useSN3D > 0.5f;
+    const float minDistance = constantGainDistance->load();
+
+    const float rX = *roomX;
+    const float rY = *roomY;
+    const float rZ = *roomZ;
+
+    const float rXHalfBound = rX / 2 - 0.1f;
+    const float rYHalfBound = rY / 2 - 0.1f;
+    const float rZHalfBound = rZ / 2 - 0.1f;
+    const auto limitToRoom = [&] (const juce::Vector3D<float>& pos)
+    {
+        return juce::Vector3D<float> (juce::jlimit (-rXHalfBound, rXHalfBound, pos.x),
+                                      juce::jlimit (-rYHalfBound, rYHalfBound, pos.y),
+                                      juce::jlimit (-rZHalfBound, rZHalfBound, pos.z));
+    };
+
+    //===== LIMIT MOVING SPEED OF SOURCE AND LISTENER ===============================
+    bool settled = moveTowards (
+        listenerPos,
+        limitToRoom (juce::Vector3D<float> (*listenerX, *listenerY, *listenerZ)),
+        maxDist);
+
+    for (int s = 0; s < maxNumberOfSources; ++s)
+    {
+        // sources which aren't rendered stay at their targets, so they start there
+        const bool isActive = s < numSources;
+        settled &= moveTowards (
+            sourcePos[s],
+            limitToRoom (juce::Vector3D<float> (*sourceX[s], *sourceY[s], *sourceZ[s])),
+            isActive ? maxDist : std::numeric_limits<float>::max());
+
+        auto& sourceGeometry = geometry.sources[s];
+        sourceGeometry.position = sourcePos[s];
+        calculateImageSourcePositions (sourceGeometry, rX, rY, rZ);
+
+        const float* radius = sourceGeometry.radius;
+        const double delayOffset = zeroDelay ? radius[0] * dist2smpls : 0.0;
+
+        for (int q = 0; q < nImgSrc; ++q)
+        {
+            sourceGeometry.delay[q] = radius[q] * dist2smpls - delayOffset;
+
+            // Regularize radius to avoid division by zero
+            float gain = reflectionGains[q] / juce::jmax (radius[q], minDistance);
+            if (unityGain)
+                gain *= radius[0];
+
+            const bool isRendered = isActive && q <= currNumRefl && (q > 0 || renderDirect);
+            const int order = isRendered ? getLevelOfDetailOrder (gain, ambisonicOrder) : -1;
+            sourceGeometry.gain[q] = order < 0 ? 0.0f : gain;
+            sourceGeometry.numChannels[q] = order < 0 ? 0 : juce::square (order + 1);
+
+            if (order < 0)
+                continue;
+
+            float* SHcoeffs = sourceGeometry.SHcoeffs[q];
+            SHEval (order, mx[q], my[q], mz[q], SHcoeffs, true); // encoding -> true
+            if (encodeSN3D)
+                juce::FloatVectorOperations::multiply (SHcoeffs,
+                                                       SHcoeffs,
+                                                       n3d2sn3d,
+                                                       sourceGeometry.numChannels[q]);
+            juce::FloatVectorOperations::multiply (SHcoeffs, gain, sourceGeometry.numChannels[q]);
+        }
+
+        // the directivity of the first source is evaluated in the direction of departure,
+        // also for reflections which are fading out
+        if (s == 0)
+        {
+            const int nChIn = juce::square (directivityOrder + 1);
+            for (int q = 0; q < nImgSrc; ++q)
+            {
+                float* weights = geometry.directivity[q];
+                juce::FloatVectorOperations::clear (weights, 64);
+                SHEval (directivityOrder,
+                        smx[q],
+                        smy[q],
+                        smz[q],
+                        weights,
+                        false); // deoding -> false
+
+                if (*inputIsSN3D > 0.5f)
+                    juce::FloatVectorOperations::multiply (weights, sn3d2n3d, nChIn);
+            }
+        }
+    }
+
+    geometryBuffer.publish();
+    geometrySettled = settled;
+    return settled;
+}
+
+void RoomEncoderAudioProcessor::calculateImageSourcePositions (
+    ImageSourceGeometry& sourceGeometry,
+    const float t,
+    const float b,
+    const float h)
+{
+    const auto& sourcePos = sourceGeometry.position;
+    float* mRadius = sourceGeometry.radius;
+
     for (int q = 0; q < nImgSrc; ++q)
     {
         const int m = reflectionList[q]->x;
@@ -441,6 +679,40 @@ void RoomEncoderAudioProcessor::calculateImageSourcePositions (const float t,
     }
 }
 
+int RoomEncoderAudioProcessor::getLevelOfDetailOrder (const float gain,
+                                                      const int ambisonicOrder) const
+{
+    if (! levelOfDetailEnabled)
+        return ambisonicOrder;
+
+    if (gain < lodGains[numLodSteps])
+        return -1;
+
+    // one order less for every lodStepInDb closer to the threshold
+    int reduction = 0;
+    while (gain < lodGains[reduction])
+        ++reduction;
+
+    return juce::jmax (0, ambisonicOrder - reduction);
+}
+
+bool RoomEncoderAudioProcessor::moveTowards (juce::Vector3D<float>& position,
+                                             const juce::Vector3D<float>& target,
+                                             const float maxDist)
+{
+    const auto posDiff = target - position;
+    const float posDiffLength = posDiff.length();
+
+    if (posDiffLength > maxDist)
+    {
+        position += posDiff * maxDist / posDiffLength;
+        return false;
+    }
+
+    position = target;
+    return true;
+}
+
 void RoomEncoderAudioProcessor::processBlock (juce::AudioSampleBuffer& buffer,
                                               juce::MidiBuffer& midiMessages)
 {
@@ -450,17 +722,12 @@ void RoomEncoderAudioProcessor::processBlock (juce::AudioSampleBuffer& buffer,
     // =============================== settings and parameters
     const int maxNChIn = juce::jmin (buffer.getNumChannels(), input.getNumberOfChannels());
     const int maxNChOut = juce::jmin (buffer.getNumChannels(), output.getNumberOfChannels());
-    const int directivityOrder = input.getOrder();
-    const int ambisonicOrder = output.getOrder();
 
     const int sampleRate = getSampleRate();
     const int L = buffer.getNumSamples();
     const float oneOverL = 1.0 / ((double) L);
 
-    const bool doInputSn3dToN3dConversion = *inputIsSN3D > 0.5f;
-
     float* pBufferWrite = buffer.getWritePointer (0);
-    const float* pBufferRead = buffer.getReadPointer (0);
 
     const int nSIMDFilters = 1 + (maxNChIn - 1) / IIRfloat_elements;
 
@@ -469,124 +736,307 @@ void RoomEncoderAudioProcessor::processBlock (juce::AudioSampleBuffer& buffer,
     if (maxNChIn < 1)
         return;
 
+    const bool roomSettingsChanged = synchronizeRoomSettings();
+    processedSamples += L;
+
+    // image source geometry and coefficients come from the geometry thread, offline they are
+    // computed for every block, so renders don't depend on the timing of the thread
+    if (isNonRealtime())
+    {
+        const juce::ScopedLock geometryScopedLock (geometryLock);
+        updateGeometry (false);
+    }
+    else if (roomSettingsChanged)
+        notify(); // settings of other instances are rendered from one of the next blocks on
+
+    geometryBuffer.update();
+    const auto& geometry = geometryBuffer.getReadBuffer();
+
+    // with more than one source, each input channel is a mono source; as they are filtered in
+    // groups of IIRfloat_elements, there can't be more sources than SIMD filters can hold
+    const int maxNumSources = juce::jmin (maxNumberOfSources,
+                                          getTotalNumInputChannels(),
+                                          buffer.getNumChannels(),
+                                          16 * IIRfloat_elements);
+    const int numSources = juce::jmin (geometry.numSources, maxNumSources);
+
+    // removed sources are faded out, also when switching to a single source, which therefore
+    // happens one block later
+    const int workingNumSources = juce::jmin (maxNumSources, juce::jmax (numSources, _numSources));
+    const bool renderMultipleSources = workingNumSources > 1;
+
+    // the filters process channels or sources, depending on the mode, so their states don't
+    // belong to the signals of the other mode
+    if (renderMultipleSources != renderedMultipleSources)
+    {
+        for (int o = 0; o < maxOrderImgSrc; ++o)
+            for (int i = 0; i < 16; ++i)
+            {
+                lowShelfArray[o]->getUnchecked (i)->reset (IIRfloat (0.0f));
+                highShelfArray[o]->getUnchecked (i)->reset (IIRfloat (0.0f));
+            }
+
+        renderedMultipleSources = renderMultipleSources;
+    }
+
     // update iir filter coefficients
     if (userChangedFilterSettings)
         updateFilterCoefficients (sampleRate);
 
-    using Format = juce::AudioData::Format<juce::AudioData::Float32, juce::AudioData::NativeEndian>;
+    int currNumRefl = geometry.numRefl;
+    int workingNumRefl = (currNumRefl < _numRefl) ? _numRefl : currNumRefl;
 
-    //interleave input data
-    int partial = maxNChIn % IIRfloat_elements;
-    if (partial == 0)
+    renderedImageSources = 0;
+
+    for (int s = 0; s < workingNumSources; ++s)
     {
-        for (int i = 0; i < nSIMDFilters; ++i)
+        auto& source = *sources[s];
+        const auto& sourceGeometry = geometry.sources[s];
+        juce::FloatVectorOperations::copy (source.mRadius, sourceGeometry.radius, nImgSrc);
+
+        // sources which have just been added start at their target position and fade in
+        if (s >= _numSources)
         {
-            juce::AudioData::interleaveSamples (
-                juce::AudioData::NonInterleavedSource<Format> { buffer.getArrayOfReadPointers()
-                                                                    + i * IIRfloat_elements,
-                                                                IIRfloat_elements },
-                juce::AudioData::InterleavedDest<Format> {
-                    reinterpret_cast<float*> (interleavedData[i]->getChannelPointer (0)),
-                    IIRfloat_elements },
-                L);
+            for (int q = 0; q < nImgSrc; ++q)
+            {
+                source.oldDelay[q] = sourceGeometry.delay[q];
+                source.numEncodedChannels[q] = 0;
+                juce::FloatVectorOperations::clear (source.SHcoeffsOld[q], 64);
+            }
         }
     }
+
+    if (renderMultipleSources)
+    {
+        renderMonoSources (buffer, geometry, workingNumSources, workingNumRefl);
+    }
     else
     {
-        int i;
-        for (i = 0; i < nSIMDFilters - 1; ++i)
+        using Format =
+            juce::AudioData::Format<juce::AudioData::Float32, juce::AudioData::NativeEndian>;
+
+        //interleave input data
+        int partial = maxNChIn % IIRfloat_elements;
+        if (partial == 0)
+        {
+            for (int i = 0; i < nSIMDFilters; ++i)
+            {
+                juce::AudioData::interleaveSamples (
+                    juce::AudioData::NonInterleavedSource<Format> {
+                        buffer.getArrayOfReadPointers() + i * IIRfloat_elements,
+                        IIRfloat_elements },
+                    juce::AudioData::InterleavedDest<Format> {
+                        reinterpret_cast<float*> (interleavedData[i]->getChannelPointer (0)),
+                        IIRfloat_elements },
+                    L);
+            }
+        }
+        else
         {
+            int i;
+            for (i = 0; i < nSIMDFilters - 1; ++i)
+            {
+                juce::AudioData::interleaveSamples (
+                    juce::AudioData::NonInterleavedSource<Format> {
+                        buffer.getArrayOfReadPointers() + i * IIRfloat_elements,
+                        IIRfloat_elements },
+                    juce::AudioData::InterleavedDest<Format> {
+                        reinterpret_cast<float*> (interleavedData[i]->getChannelPointer (0)),
+                        IIRfloat_elements },
+                    L);
+            }
+
+            const float* addr[IIRfloat_elements];
+            size_t ch;
+            for (ch = 0; ch < partial; ++ch)
+            {
+                addr[ch] = buffer.getReadPointer (i * static_cast<int> (IIRfloat_elements + ch));
+            }
+            for (; ch < IIRfloat_elements; ++ch)
+            {
+                addr[ch] = zero.getChannelPointer (ch);
+            }
             juce::AudioData::interleaveSamples (
-                juce::AudioData::NonInterleavedSource<Format> { buffer.getArrayOfReadPointers()
-                                                                    + i * IIRfloat_elements,
-                                                                IIRfloat_elements },
+                juce::AudioData::NonInterleavedSource<Format> { addr, IIRfloat_elements },
                 juce::AudioData::InterleavedDest<Format> {
                     reinterpret_cast<float*> (interleavedData[i]->getChannelPointer (0)),
                     IIRfloat_elements },
                 L);
         }
 
-        const float* addr[IIRfloat_elements];
-        size_t ch;
-        for (ch = 0; ch < partial; ++ch)
-        {
-            addr[ch] = buffer.getReadPointer (i * static_cast<int> (IIRfloat_elements + ch));
-        }
-        for (; ch < IIRfloat_elements; ++ch)
+        auto& source = *sources[0];
+        const auto& sourceGeometry = geometry.sources[0];
+
+        for (int q = 0; q < workingNumRefl + 1; ++q)
         {
-            addr[ch] = zero.getChannelPointer (ch);
+            const int idx = filterPoints.indexOf (q);
+            if (idx != -1)
+            {
+                for (int i = 0; i < nSIMDFilters; ++i)
+                {
+                    const IIRfloat* chPtr[1];
+                    chPtr[0] = interleavedData[i]->getChannelPointer (0);
+                    juce::dsp::AudioBlock<IIRfloat> ab (const_cast<IIRfloat**> (chPtr), 1, L);
+                    juce::dsp::ProcessContextReplacing<IIRfloat> context (ab);
+
+                    lowShelfArray[idx]->getUnchecked (i)->process (context);
+                    highShelfArray[idx]->getUnchecked (i)->process (context);
+                }
+            }
+
+            allGains[q] = sourceGeometry.gain[q]; // for reflectionVisualizer
+
+            if (sourceGeometry.numChannels[q] == 0 && source.numEncodedChannels[q] == 0)
+            {
+                skipImageSource (source, sourceGeometry, q);
+                continue;
+            }
+
+            // ========================================   CALCULATE SAMPLED MONO SIGNALS
+            /* JMZ:
+             * the following section is broken, as it hardcodes asumptions about how
+             * many floats can be stored in IIRfloat
+             */
+            IIRfloat SHsample[16]; //TODO: can be smaller: (N+1)^2/IIRfloat_elements
+            IIRfloat SHsampleStep[16];
+#if JUCE_USE_SIMD
+            juce::FloatVectorOperations::clear ((float*) &SHsample->value,
+                                                IIRfloat_elements * sizeof (SHsample)
+                                                    / sizeof (*SHsample));
+            juce::FloatVectorOperations::copy ((float*) &SHsample->value,
+                                               geometry.directivity[q],
+                                               maxNChIn);
+#else /* !JUCE_USE_SIMD */
+            juce::FloatVectorOperations::clear ((float*) SHsample,
+                                                IIRfloat_elements * sizeof (SHsample)
+                                                    / sizeof (*SHsample));
+            juce::FloatVectorOperations::copy ((float*) SHsample,
+                                               geometry.directivity[q],
+                                               maxNChIn);
+#endif /* JUCE_USE_SIMD */
+
+            juce::Array<IIRfloat*> interleavedDataPtr;
+            interleavedDataPtr.resize (nSIMDFilters);
+            IIRfloat** intrlvdDataArrayPtr = interleavedDataPtr.getRawDataPointer();
+
+            for (int i = 0; i < nSIMDFilters; ++i)
+            {
+                intrlvdDataArrayPtr[i] =
+                    reinterpret_cast<IIRfloat*> (interleavedData[i]->getChannelPointer (0));
+                SHsampleStep[i] = SHsample[i] - SHsampleOld[q][i];
+                SHsampleStep[i] *= oneOverL;
+                SHsample[i] = SHsampleOld[q][i];
+            }
+
+            for (int smpl = 0; smpl < L; ++smpl)
+            {
+                IIRfloat SIMDTemp;
+                SIMDTemp = 0.0f;
+
+                for (int i = 0; i < nSIMDFilters; ++i)
+                {
+                    SIMDTemp += SHsample[i] * *(intrlvdDataArrayPtr[i]++);
+                    SHsample[i] += SHsampleStep[i];
+                }
+#if JUCE_USE_SIMD
+                pBufferWrite[smpl] = SIMDTemp.sum();
+#else /* !JUCE_USE_SIMD */
+                pBufferWrite[smpl] = SIMDTemp;
+#endif /* JUCE_USE_SIMD */
+            }
+
+            encodeImageSource (source, sourceGeometry, q, pBufferWrite, L);
+
+#if JUCE_USE_SIMD
+            juce::FloatVectorOperations::copy ((float*) &SHsampleOld[q]->value,
+                                               (float*) &SHsample->value,
+                                               maxNChIn);
+#else /* !JUCE_USE_SIMD */
+            juce::FloatVectorOperations::copy ((float*) SHsampleOld[q],
+                                               (float*) SHsample,
+                                               maxNChIn);
+#endif /* JUCE_USE_SIMD */
         }
-        juce::AudioData::interleaveSamples (
-            juce::AudioData::NonInterleavedSource<Format> { addr, IIRfloat_elements },
-            juce::AudioData::InterleavedDest<Format> {
-                reinterpret_cast<float*> (interleavedData[i]->getChannelPointer (0)),
-                IIRfloat_elements },
-            L);
     }
 
-    int currNumRefl = juce::roundToInt (numRefl->load());
-    int workingNumRefl = (currNumRefl < _numRefl) ? _numRefl : currNumRefl;
+    //updating the remaining oldDelay values
+    for (int s = 0; s < workingNumSources; ++s)
+        for (int q = workingNumRefl + 1; q < nImgSrc; ++q)
+            sources[s]->oldDelay[q] = geometry.sources[s].delay[q];
 
-    // calculating reflection coefficients (only if parameter changed)
-    float reflCoeffGain = juce::Decibels::decibelsToGain (reflCoeff->load());
-    if (powReflCoeff[1] != reflCoeffGain)
+    // ======= Read from delayBuffer and clear read content ==============
+    buffer.clear();
+
+    const int blockSize1 = juce::jmin (bufferSize - readOffset, L);
+
+    for (int channel = 0; channel < maxNChOut; ++channel)
     {
-        powReflCoeff[0] = 1;
-        powReflCoeff[1] = reflCoeffGain;
-        for (int i = 2; i <= maxOrderImgSrc; ++i)
+        buffer.copyFrom (channel, 0, delayBufferWritePtrArray[channel] + readOffset, blockSize1);
+        delayBuffer.clear (channel, readOffset, blockSize1);
+    }
+
+    const int numLeft = L - blockSize1;
+    if (numLeft > 0)
+    {
+        for (int channel = 0; channel < maxNChOut; ++channel)
         {
-            powReflCoeff[i] = powReflCoeff[i - 1] * reflCoeffGain;
+            buffer.copyFrom (channel, 0, delayBufferWritePtrArray[channel], numLeft);
+            delayBuffer.clear (channel, 0, numLeft);
         }
     }
 
-    const float rX = *roomX;
-    const float rY = *roomY;
-    const float rZ = *roomZ;
+    _numRefl = currNumRefl;
+    _numSources = numSources;
+    numRenderedImageSources = renderedImageSources;
 
-    const float rXHalfBound = rX / 2 - 0.1f;
-    const float rYHalfBound = rY / 2 - 0.1f;
-    const float rZHalfBound = rZ / 2 - 0.1f;
-    //===== LIMIT MOVING SPEED OF SOURCE AND LISTENER ===============================
-    const float maxDist = 30.0f / sampleRate * L; // 30 meters per second
-    {
-        const juce::Vector3D<float> targetSourcePos (*sourceX, *sourceY, *sourceZ);
-        const auto sourcePosDiff = targetSourcePos - sourcePos;
-        const float sourcePosDiffLength = sourcePosDiff.length();
+    readOffset += L;
+    if (readOffset >= bufferSize)
+        readOffset -= bufferSize;
+}
 
-        if (sourcePosDiffLength > maxDist)
-            sourcePos += sourcePosDiff * maxDist / sourcePosDiffLength;
-        else
-            sourcePos = targetSourcePos;
+void RoomEncoderAudioProcessor::renderMonoSources (juce::AudioSampleBuffer& buffer,
+                                                   const RoomGeometry& geometry,
+                                                   const int workingNumSources,
+                                                   const int workingNumRefl)
+{
+    static_assert (maxNumberOfSources % IIRfloat_elements == 0,
+                   "sourceSignals has to hold full groups of sources");
 
-        sourcePos = juce::Vector3D<float> (juce::jlimit (-rXHalfBound, rXHalfBound, sourcePos.x),
-                                           juce::jlimit (-rYHalfBound, rYHalfBound, sourcePos.y),
-                                           juce::jlimit (-rZHalfBound, rZHalfBound, sourcePos.z));
+    const int L = buffer.getNumSamples();
+    const int nGroups = 1 + (workingNumSources - 1) / IIRfloat_elements;
 
-        const juce::Vector3D<float> listenerSourcePos (*listenerX, *listenerY, *listenerZ);
-        const auto listenerPosDiff = listenerSourcePos - listenerPos;
-        const float listenerPosDiffLength = listenerPosDiff.length();
+    using Format = juce::AudioData::Format<juce::AudioData::Float32, juce::AudioData::NativeEndian>;
 
-        if (listenerPosDiffLength > maxDist)
-            listenerPos += listenerPosDiff * maxDist / listenerPosDiffLength;
-        else
-            listenerPos = listenerSourcePos;
+    // interleave the sources, so IIRfloat_elements sources are filtered at once
+    for (int i = 0; i < nGroups; ++i)
+    {
+        const float* addr[IIRfloat_elements];
+        for (int ch = 0; ch < IIRfloat_elements; ++ch)
+        {
+            const int s = i * IIRfloat_elements + ch;
+            addr[ch] = s < workingNumSources ? buffer.getReadPointer (s)
+                                             : zero.getChannelPointer (ch);
+        }
 
-        listenerPos =
-            juce::Vector3D<float> (juce::jlimit (-rXHalfBound, rXHalfBound, listenerPos.x),
-                                   juce::jlimit (-rYHalfBound, rYHalfBound, listenerPos.y),
-                                   juce::jlimit (-rZHalfBound, rZHalfBound, listenerPos.z));
+        juce::AudioData::interleaveSamples (
+            juce::AudioData::NonInterleavedSource<Format> { addr, IIRfloat_elements },
+            juce::AudioData::InterleavedDest<Format> {
+                reinterpret_cast<float*> (interleavedData[i]->getChannelPointer (0)),
+                IIRfloat_elements },
+            L);
     }
 
-    float* pMonoBufferWrite = monoBuffer.getWritePointer (0);
-
-    calculateImageSourcePositions (rX, rY, rZ);
+    // the direct sound is rendered unfiltered, the buffer isn't written before the read out
+    const float* signals[maxNumberOfSources];
+    for (int s = 0; s < workingNumSources; ++s)
+        signals[s] = buffer.getReadPointer (s);
 
     for (int q = 0; q < workingNumRefl + 1; ++q)
     {
         const int idx = filterPoints.indexOf (q);
         if (idx != -1)
         {
-            for (int i = 0; i < nSIMDFilters; ++i)
+            for (int i = 0; i < nGroups; ++i)
             {
                 const IIRfloat* chPtr[1];
                 chPtr[0] = interleavedData[i]->getChannelPointer (0);
@@ -595,318 +1045,237 @@ void RoomEncoderAudioProcessor::processBlock (juce::AudioSampleBuffer& buffer,
 
                 lowShelfArray[idx]->getUnchecked (i)->process (context);
                 highShelfArray[idx]->getUnchecked (i)->process (context);
-            }
-        }
 
-        // ========================================   CALCULATE SAMPLED MONO SIGNALS
-        /* JMZ:
-         * the following section is broken, as it hardcodes asumptions about how
-         * many floats can be stored in IIRfloat
-         */
-        IIRfloat SHsample[16]; //TODO: can be smaller: (N+1)^2/IIRfloat_elements
-        IIRfloat SHsampleStep[16];
-#if JUCE_USE_SIMD
-        juce::FloatVectorOperations::clear ((float*) &SHsample->value,
-                                            IIRfloat_elements * sizeof (SHsample)
-                                                / sizeof (*SHsample));
-        SHEval (directivityOrder,
-                smx[q],
-                smy[q],
-                smz[q],
-                (float*) &SHsample->value,
-                false); // deoding -> false
-#else /* !JUCE_USE_SIMD */
-        juce::FloatVectorOperations::clear ((float*) SHsample,
-                                            IIRfloat_elements * sizeof (SHsample)
-                                                / sizeof (*SHsample));
-        SHEval (directivityOrder,
-                smx[q],
-                smy[q],
-                smz[q],
-                (float*) SHsample,
-                false); // deoding -> false
-#endif /* JUCE_USE_SIMD */
+                // the filtered signals are used until the next filter point
+                juce::AudioData::deinterleaveSamples (
+                    juce::AudioData::InterleavedSource<Format> {
+                        reinterpret_cast<const float*> (interleavedData[i]->getChannelPointer (0)),
+                        IIRfloat_elements },
+                    juce::AudioData::NonInterleavedDest<Format> {
+                        sourceSignals.getArrayOfWritePointers() + i * IIRfloat_elements,
+                        IIRfloat_elements },
+                    L);
+            }
 
-        if (doInputSn3dToN3dConversion)
-            juce::FloatVectorOperations::multiply ((float*) SHsample, sn3d2n3d, maxNChIn);
+            for (int s = 0; s < workingNumSources; ++s)
+                signals[s] = sourceSignals.getReadPointer (s);
+        }
 
-        juce::Array<IIRfloat*> interleavedDataPtr;
-        interleavedDataPtr.resize (nSIMDFilters);
-        IIRfloat** intrlvdDataArrayPtr = interleavedDataPtr.getRawDataPointer();
+        allGains[q] = geometry.sources[0].gain[q];
 
-        for (int i = 0; i < nSIMDFilters; ++i)
+        // removed sources and reflections are faded out
+        for (int s = 0; s < workingNumSources; ++s)
         {
-            intrlvdDataArrayPtr[i] =
-                reinterpret_cast<IIRfloat*> (interleavedData[i]->getChannelPointer (0));
-            SHsampleStep[i] = SHsample[i] - SHsampleOld[q][i];
-            SHsampleStep[i] *= oneOverL;
-            SHsample[i] = SHsampleOld[q][i];
+            auto& source = *sources[s];
+            const auto& sourceGeometry = geometry.sources[s];
+
+            if (sourceGeometry.numChannels[q] == 0 && source.numEncodedChannels[q] == 0)
+                skipImageSource (source, sourceGeometry, q);
+            else
+                encodeImageSource (source, sourceGeometry, q, signals[s], L);
         }
+    }
+}
 
-        for (int smpl = 0; smpl < L; ++smpl)
-        {
-            IIRfloat SIMDTemp;
-            SIMDTemp = 0.0f;
+void RoomEncoderAudioProcessor::skipImageSource (ImageSourceState& source,
+                                                 const ImageSourceGeometry& sourceGeometry,
+                                                 const int q)
+{
+    // keep the delay up to date, so the image source fades in without a delay sweep
+    source.oldDelay[q] = sourceGeometry.delay[q];
+}
 
-            for (int i = 0; i < nSIMDFilters; ++i)
-            {
-                SIMDTemp += SHsample[i] * *(intrlvdDataArrayPtr[i]++);
-                SHsample[i] += SHsampleStep[i];
-            }
-#if JUCE_USE_SIMD
-            pBufferWrite[smpl] = SIMDTemp.sum();
-#else /* !JUCE_USE_SIMD */
-            pBufferWrite[smpl] = SIMDTemp;
-#endif /* JUCE_USE_SIMD */
-        }
+void RoomEncoderAudioProcessor::encodeImageSource (ImageSourceState& source,
+                                                   const ImageSourceGeometry& sourceGeometry,
+                                                   const int q,
+                                                   const float* signal,
+                                                   const int L)
+{
+    const int maxNChOut = juce::jmin (delayBuffer.getNumChannels(), output.getNumberOfChannels());
+    const float oneOverL = 1.0 / ((double) L);
 
-        // ============================================
-        double delayOffset = *directPathZeroDelay > 0.5f ? mRadius[0] * dist2smpls : 0.0;
-        double delay, delayStep;
-        int firstIdx, copyL;
-        delay =
-            mRadius[q] * dist2smpls - delayOffset; // dist2smpls also contains factor 128 for LUT
-        delayStep = (delay - oldDelay[q]) * oneOverL;
-
-        //calculate firstIdx and copyL
-        int startIdx = ((int) oldDelay[q]) >> interpShift;
-        int stopIdx = L - 1
-                      + (((int) (oldDelay[q] + delayStep * L - 1))
-                         >> interpShift); // ((int)(startIdx + delayStep * L-1))>>7
-        firstIdx = juce::jmin (startIdx, stopIdx);
-        copyL = abs (stopIdx - startIdx) + interpLength;
-
-        monoBuffer.clear (
-            0,
-            firstIdx,
-            copyL); //TODO: optimization idea: resample input to match delay stretching
-
-        float* tempWritePtr =
-            pMonoBufferWrite; //reset writePtr as it gets increased during the next for loop
-        const float* readPtr = pBufferRead;
-
-        double tempDelay =
-            oldDelay[q]; //start from oldDelay and add delayStep after each iteration;
-
-        //int interpCoeffIdx;
-        for (int smplIdx = 0; smplIdx < L; ++smplIdx)
-        {
-            //int delayInt; = truncatePositiveToUnsignedInt(tempDelay); //(int)tempDelay;
-            float integer;
-            float fraction = modff (tempDelay, &integer);
-            int delayInt = (int) integer;
+    // channels to fade in or keep, and the ones still fading out from a higher order
+    const int nChOld = source.numEncodedChannels[q];
+    const int nChTarget = juce::jmin (sourceGeometry.numChannels[q], maxNChOut);
+    const int nCh = juce::jmax (juce::jmin (nChOld, maxNChOut), nChTarget);
+    ++renderedImageSources;
+
+    const auto delayBufferWritePtrArray = delayBuffer.getArrayOfWritePointers();
+    float* pMonoBufferWrite = monoBuffer.getWritePointer (0);
+
+    // ============================================
+    double delay, delayStep;
+    int firstIdx, copyL;
+    delay = sourceGeometry.delay[q]; // also contains factor 128 for LUT
+    delayStep = (delay - source.oldDelay[q]) * oneOverL;
+
+    //calculate firstIdx and copyL
+    int startIdx = ((int) source.oldDelay[q]) >> interpShift;
+    int stopIdx = L - 1
+                  + (((int) (source.oldDelay[q] + delayStep * L - 1))
+                     >> interpShift); // ((int)(startIdx + delayStep * L-1))>>7
+    firstIdx = juce::jmin (startIdx, stopIdx);
+    copyL = abs (stopIdx - startIdx) + interpLength;
+
+    monoBuffer.clear (0,
+                      firstIdx,
+                      copyL); //TODO: optimization idea: resample input to match delay stretching
+
+    float* tempWritePtr =
+        pMonoBufferWrite; //reset writePtr as it gets increased during the next for loop
+    const float* readPtr = signal;
+
+    double tempDelay =
+        source.oldDelay[q]; //start from oldDelay and add delayStep after each iteration;
+
+    //int interpCoeffIdx;
+    for (int smplIdx = 0; smplIdx < L; ++smplIdx)
+    {
+        //int delayInt; = truncatePositiveToUnsignedInt(tempDelay); //(int)tempDelay;
+        float integer;
+        float fraction = modff (tempDelay, &integer);
+        int delayInt = (int) integer;
 
-            int interpCoeffIdx = delayInt & interpMask;
-            delayInt = delayInt >> interpShift;
-            int idx = delayInt;
+        int interpCoeffIdx = delayInt & interpMask;
+        delayInt = delayInt >> interpShift;
+        int idx = delayInt;
 
-            float* dest = tempWritePtr++ + idx;
+        float* dest = tempWritePtr++ + idx;
 
 #if JUCE_USE_SSE_INTRINSICS
-            __m128 destSamples = _mm_loadu_ps (dest);
-            __m128 srcSample = _mm_set1_ps (*readPtr++);
-            __m128 interp = getInterpolatedLagrangeWeights (interpCoeffIdx, fraction);
+        __m128 destSamples = _mm_loadu_ps (dest);
+        __m128 srcSample = _mm_set1_ps (*readPtr++);
+        __m128 interp = getInterpolatedLagrangeWeights (interpCoeffIdx, fraction);
 
-            destSamples = _mm_add_ps (destSamples, _mm_mul_ps (interp, srcSample));
-            _mm_storeu_ps (dest, destSamples);
+        destSamples = _mm_add_ps (destSamples, _mm_mul_ps (interp, srcSample));
+        _mm_storeu_ps (dest, destSamples);
 #else /* !JUCE_USE_SSE_INTRINSICS */
-            float interp[4];
-            getInterpolatedLagrangeWeights (interpCoeffIdx, fraction, interp);
-            float src = *readPtr++;
-            dest[0] += interp[0] * src;
-            dest[1] += interp[1] * src;
-            dest[2] += interp[2] * src;
-            dest[3] += interp[3] * src;
+        float interp[4];
+        getInterpolatedLagrangeWeights (interpCoeffIdx, fraction, interp);
+        float src = *readPtr++;
+        dest[0] += interp[0] * src;
+        dest[1] += interp[1] * src;
+        dest[2] += interp[2] * src;
+        dest[3] += interp[3] * src;
 #endif /* JUCE_USE_SSE_INTRINSICS */
-            tempDelay += delayStep;
-        }
+        tempDelay += delayStep;
+    }
 
-        const float* monoBufferReadPtrWithOffset = monoBuffer.getReadPointer (0) + firstIdx;
-        firstIdx = firstIdx + readOffset;
-        if (firstIdx >= bufferSize)
-            firstIdx -= bufferSize;
+    const float* monoBufferReadPtrWithOffset = monoBuffer.getReadPointer (0) + firstIdx;
+    firstIdx = firstIdx + readOffset;
+    if (firstIdx >= bufferSize)
+        firstIdx -= bufferSize;
 
-        float SHcoeffs[64];
-        float SHcoeffsStep[64];
+    float SHcoeffs[64];
+    float SHcoeffsStep[64];
+    float* SHcoeffsOld = source.SHcoeffsOld[q];
 
-        if (q <= currNumRefl)
-        {
-            SHEval (ambisonicOrder, mx[q], my[q], mz[q], SHcoeffs, true); // encoding -> true
-            if (*useSN3D > 0.5f)
-            {
-                juce::FloatVectorOperations::multiply (SHcoeffs, SHcoeffs, n3d2sn3d, maxNChOut);
-            }
-        }
-        else
-            juce::FloatVectorOperations::clear (SHcoeffs, 64);
-
-        float gain =
-            powReflCoeff[reflectionList[q]->order]
-            / juce::jmax (
-                mRadius[q],
-                constantGainDistance->load()); // Regularize radius to avoid division by zero
-        if (*directPathUnityGain > 0.5f)
-            gain *= mRadius[0];
-
-        // additional wall attenuations
-        float extraAttenuationInDb = 0.0f;
-        auto reflProp = *reflectionList[q];
-        extraAttenuationInDb += reflProp.xPlusReflections * *wallAttenuationFront;
-        extraAttenuationInDb += reflProp.xMinusReflections * *wallAttenuationBack;
-        extraAttenuationInDb += reflProp.yPlusReflections * *wallAttenuationLeft;
-        extraAttenuationInDb += reflProp.yMinusReflections * *wallAttenuationRight;
-        extraAttenuationInDb += reflProp.zPlusReflections * *wallAttenuationCeiling;
-        extraAttenuationInDb += reflProp.zMinusReflections * *wallAttenuationFloor;
-        gain *= juce::Decibels::decibelsToGain (extraAttenuationInDb);
-
-        // direct path rendering
-        if (q == 0 && *renderDirectPath < 0.5f)
-        {
-            allGains[0] = 0.0f;
-            continue;
-        }
+    juce::FloatVectorOperations::clear (SHcoeffs, 64);
+    juce::FloatVectorOperations::copy (SHcoeffs, sourceGeometry.SHcoeffs[q], nChTarget);
 
-        allGains[q] = gain; // for reflectionVisualizer
+    juce::FloatVectorOperations::subtract (SHcoeffsStep, SHcoeffs, SHcoeffsOld, nCh);
+    juce::FloatVectorOperations::multiply (SHcoeffsStep, 1.0f / copyL, nCh);
 
-        juce::FloatVectorOperations::multiply (SHcoeffs, gain, maxNChOut);
-        juce::FloatVectorOperations::subtract (SHcoeffsStep, SHcoeffs, SHcoeffsOld[q], maxNChOut);
-        juce::FloatVectorOperations::multiply (SHcoeffsStep, 1.0f / copyL, maxNChOut);
+    if (firstIdx + copyL - 1 >= bufferSize)
+    {
+        int firstNumCopy = bufferSize - firstIdx;
+        int secondNumCopy = copyL - firstNumCopy;
 
-        if (firstIdx + copyL - 1 >= bufferSize)
+        for (int channel = 0; channel < nCh; ++channel)
         {
-            int firstNumCopy = bufferSize - firstIdx;
-            int secondNumCopy = copyL - firstNumCopy;
-
-            for (int channel = 0; channel < maxNChOut; ++channel)
+            if (SHcoeffsOld[channel] != SHcoeffs[channel])
             {
-                if (SHcoeffsOld[q][channel] != SHcoeffs[channel])
-                {
 #if defined(JUCE_USE_VDSP_FRAMEWORK) && defined(JUCE_MAC)
-                    vDSP_vrampmuladd (monoBufferReadPtrWithOffset,
-                                      1, //input vector with stride
-                                      &SHcoeffsOld[q][channel], //ramp start value (gets increased)
-                                      &SHcoeffsStep[channel], //step value
-                                      delayBufferWritePtrArray[channel] + firstIdx,
-                                      1, // output with stride
-                                      (size_t) firstNumCopy //num
-                    );
-                    vDSP_vrampmuladd (monoBufferReadPtrWithOffset + firstNumCopy,
-                                      1, //input vector with stride
-                                      &SHcoeffsOld[q][channel], //ramp start value (gets increased)
-                                      &SHcoeffsStep[channel], //step value
-                                      delayBufferWritePtrArray[channel],
-                                      1, // output with stride
-                                      (size_t) secondNumCopy //num
-                    );
+                vDSP_vrampmuladd (monoBufferReadPtrWithOffset,
+                                  1, //input vector with stride
+                                  &SHcoeffsOld[channel], //ramp start value (gets increased)
+                                  &SHcoeffsStep[channel], //step value
+                                  delayBufferWritePtrArray[channel] + firstIdx,
+                                  1, // output with stride
+                                  (size_t) firstNumCopy //num
+                );
+                vDSP_vrampmuladd (monoBufferReadPtrWithOffset + firstNumCopy,
+                                  1, //input vector with stride
+                                  &SHcoeffsOld[channel], //ramp start value (gets increased)
+                                  &SHcoeffsStep[channel], //step value
+                                  delayBufferWritePtrArray[channel],
+                                  1, // output with stride
+                                  (size_t) secondNumCopy //num
+                );
 #else
-                    delayBuffer.addFromWithRamp (channel,
-                                                 firstIdx,
-                                                 monoBufferReadPtrWithOffset,
-                                                 firstNumCopy,
-                                                 SHcoeffsOld[q][channel],
-                                                 SHcoeffsOld[q][channel]
-                                                     + SHcoeffsStep[channel] * firstNumCopy);
-                    delayBuffer.addFromWithRamp (channel,
-                                                 0,
-                                                 monoBufferReadPtrWithOffset + firstNumCopy,
-                                                 secondNumCopy,
-                                                 SHcoeffsOld[q][channel]
-                                                     + SHcoeffsStep[channel] * firstNumCopy,
-                                                 SHcoeffs[channel]);
+                delayBuffer.addFromWithRamp (channel,
+                                             firstIdx,
+                                             monoBufferReadPtrWithOffset,
+                                             firstNumCopy,
+                                             SHcoeffsOld[channel],
+                                             SHcoeffsOld[channel]
+                                                 + SHcoeffsStep[channel] * firstNumCopy);
+                delayBuffer.addFromWithRamp (channel,
+                                             0,
+                                             monoBufferReadPtrWithOffset + firstNumCopy,
+                                             secondNumCopy,
+                                             SHcoeffsOld[channel]
+                                                 + SHcoeffsStep[channel] * firstNumCopy,
+                                             SHcoeffs[channel]);
 #endif
-                }
-                else
-                {
-                    juce::FloatVectorOperations::addWithMultiply (delayBufferWritePtrArray[channel]
-                                                                      + firstIdx,
-                                                                  monoBufferReadPtrWithOffset,
-                                                                  SHcoeffs[channel],
-                                                                  firstNumCopy);
-                    juce::FloatVectorOperations::addWithMultiply (delayBufferWritePtrArray[channel],
-                                                                  monoBufferReadPtrWithOffset
-                                                                      + firstNumCopy,
-                                                                  SHcoeffs[channel],
-                                                                  secondNumCopy);
-                }
+            }
+            else
+            {
+                juce::FloatVectorOperations::addWithMultiply (delayBufferWritePtrArray[channel]
+                                                                  + firstIdx,
+                                                              monoBufferReadPtrWithOffset,
+                                                              SHcoeffs[channel],
+                                                              firstNumCopy);
+                juce::FloatVectorOperations::addWithMultiply (delayBufferWritePtrArray[channel],
+                                                              monoBufferReadPtrWithOffset
+                                                                  + firstNumCopy,
+                                                              SHcoeffs[channel],
+                                                              secondNumCopy);
             }
         }
-        else
+    }
+    else
+    {
+        for (int channel = 0; channel < nCh; ++channel)
         {
-            for (int channel = 0; channel < maxNChOut; ++channel)
+            if (SHcoeffsOld[channel] != SHcoeffs[channel])
             {
-                if (SHcoeffsOld[q][channel] != SHcoeffs[channel])
-                {
 #if defined(JUCE_USE_VDSP_FRAMEWORK) && defined(JUCE_MAC)
-                    vDSP_vrampmuladd (monoBufferReadPtrWithOffset,
-                                      1, //input vector with stride
-                                      &SHcoeffsOld[q][channel], //ramp start value (gets increased)
-                                      &SHcoeffsStep[channel], //step value
-                                      delayBufferWritePtrArray[channel] + firstIdx,
-                                      1, // output with stride
-                                      (size_t) copyL //num
-                    );
+                vDSP_vrampmuladd (monoBufferReadPtrWithOffset,
+                                  1, //input vector with stride
+                                  &SHcoeffsOld[channel], //ramp start value (gets increased)
+                                  &SHcoeffsStep[channel], //step value
+                                  delayBufferWritePtrArray[channel] + firstIdx,
+                                  1, // output with stride
+                                  (size_t) copyL //num
+                );
 #else
-                    delayBuffer.addFromWithRamp (channel,
-                                                 firstIdx,
-                                                 monoBufferReadPtrWithOffset,
-                                                 copyL,
-                                                 SHcoeffsOld[q][channel],
-                                                 SHcoeffs[channel]);
+                delayBuffer.addFromWithRamp (channel,
+                                             firstIdx,
+                                             monoBufferReadPtrWithOffset,
+                                             copyL,
+                                             SHcoeffsOld[channel],
+                                             SHcoeffs[channel]);
 #endif
-                }
-                else
-                {
-                    juce::FloatVectorOperations::addWithMultiply (delayBufferWritePtrArray[channel]
-                                                                      + firstIdx,
-                                                                  monoBufferReadPtrWithOffset,
-                                                                  SHcoeffs[channel],
-                                                                  copyL);
-                }
             }
-        }
-
-        juce::FloatVectorOperations::copy (SHcoeffsOld[q], SHcoeffs, maxNChOut);
-#if JUCE_USE_SIMD
-        juce::FloatVectorOperations::copy ((float*) &SHsampleOld[q]->value,
-                                           (float*) &SHsample->value,
-                                           maxNChIn);
-#else /* !JUCE_USE_SIMD */
-        juce::FloatVectorOperations::copy ((float*) SHsampleOld[q], (float*) SHsample, maxNChIn);
-#endif /* JUCE_USE_SIMD */
-        //oldDelay[q] = delay;
-        oldDelay[q] = tempDelay;
-    }
-
-    //updating the remaining oldDelay values
-    for (int q = workingNumRefl + 1; q < nImgSrc; ++q)
-        oldDelay[q] = mRadius[q] * dist2smpls;
-
-    // ======= Read from delayBuffer and clear read content ==============
-    buffer.clear();
-
-    const int blockSize1 = juce::jmin (bufferSize - readOffset, L);
-
-    for (int channel = 0; channel < maxNChOut; ++channel)
-    {
-        buffer.copyFrom (channel, 0, delayBufferWritePtrArray[channel] + readOffset, blockSize1);
-        delayBuffer.clear (channel, readOffset, blockSize1);
-    }
-
-    const int numLeft = L - blockSize1;
-    if (numLeft > 0)
-    {
-        for (int channel = 0; channel < maxNChOut; ++channel)
-        {
-            buffer.copyFrom (channel, 0, delayBufferWritePtrArray[channel], numLeft);
-            delayBuffer.clear (channel, 0, numLeft);
+            else
+            {
+                juce::FloatVectorOperations::addWithMultiply (delayBufferWritePtrArray[channel]
+                                                                  + firstIdx,
+                                                              monoBufferReadPtrWithOffset,
+                                                              SHcoeffs[channel],
+                                                              copyL);
+            }
         }
     }
 
-    _numRefl = currNumRefl;
+    juce::FloatVectorOperations::copy (SHcoeffsOld, SHcoeffs, nCh);
+    if (nChOld > nCh)
+        juce::FloatVectorOperations::clear (SHcoeffsOld + nCh, nChOld - nCh);
+    source.numEncodedChannels[q] = nChTarget;
 
-    readOffset += L;
-    if (readOffset >= bufferSize)
-        readOffset -= bufferSize;
+    //oldDelay[q] = delay;
+    source.oldDelay[q] = tempDelay;
 }
 
 //==============================================================================
@@ -952,117 +1321,66 @@ void RoomEncoderAudioProcessor::setStateInformation (const void* data, int sizeI
         }
 }
 
-void RoomEncoderAudioProcessor::timerCallback()
+bool RoomEncoderAudioProcessor::synchronizeRoomSettings()
 {
-    if (*syncChannel > 0.5f)
-    {
-        int ch = (int) *syncChannel - 1;
-        bool sRoom (*syncRoomSize >= 0.5f);
-        bool sListener (*syncListener >= 0.5f);
-        bool sReflections (*syncReflection >= 0.5f);
+    const int ch = juce::roundToInt (syncChannel->load()) - 1;
+    bool settingsChanged = false;
 
-        RoomParams& roomParam = sharedParams.get().rooms.getReference (ch);
-
-        if (sRoom)
+    for (int g = 0; g < SharedParams::numGroups; ++g)
+    {
+        auto& group = syncGroups[g];
+        if (ch < 0 || *group.enabled < 0.5f)
         {
-            if (roomParam.validRoomData)
-            {
-                readingSharedParams = true;
-                parameters.getParameter ("roomX")->setValueNotifyingHost (
-                    parameters.getParameterRange ("roomX").convertTo0to1 (roomParam.roomX));
-                parameters.getParameter ("roomY")->setValueNotifyingHost (
-                    parameters.getParameterRange ("roomY").convertTo0to1 (roomParam.roomY));
-                parameters.getParameter ("roomZ")->setValueNotifyingHost (
-                    parameters.getParameterRange ("roomZ").convertTo0to1 (roomParam.roomZ));
-                readingSharedParams = false;
-            }
-            else
-            {
-                roomParam.roomX = *roomX;
-                roomParam.roomY = *roomY;
-                roomParam.roomZ = *roomZ;
-                roomParam.validRoomData = true;
-            }
+            group.channel = -1;
+            group.publishPending = false;
+            continue;
         }
-        if (sListener)
+
+        // everything is taken over when (re)joining a channel
+        if (group.channel != ch)
         {
-            if (roomParam.validListenerData)
-            {
-                readingSharedParams = true;
-                parameters.getParameter ("listenerX")
-                    ->setValueNotifyingHost (parameters.getParameterRange ("listenerX")
-                                                 .convertTo0to1 (roomParam.listenerX));
-                parameters.getParameter ("listenerY")
-                    ->setValueNotifyingHost (parameters.getParameterRange ("listenerY")
-                                                 .convertTo0to1 (roomParam.listenerY));
-                parameters.getParameter ("listenerZ")
-                    ->setValueNotifyingHost (parameters.getParameterRange ("listenerZ")
-                                                 .convertTo0to1 (roomParam.listenerZ));
-                readingSharedParams = false;
-            }
-            else
-            {
-                roomParam.listenerX = *listenerX;
-                roomParam.listenerY = *listenerY;
-                roomParam.listenerZ = *listenerZ;
-                roomParam.validListenerData = true;
-            }
+            group.channel = ch;
+            group.version = 0;
         }
-        if (sReflections)
+
+        auto& sharedValues = sharedParams.get().rooms[ch][g];
+        if (group.publishPending.exchange (false) || ! sharedValues.hasData())
         {
-            if (roomParam.validReflectionData)
-            {
-                readingSharedParams = true;
-                parameters.getParameter ("reflCoeff")
-                    ->setValueNotifyingHost (parameters.getParameterRange ("reflCoeff")
-                                                 .convertTo0to1 (roomParam.reflCoeff));
-                parameters.getParameter ("numRefl")->setValueNotifyingHost (
-                    parameters.getParameterRange ("numRefl").convertTo0to1 (roomParam.numRefl));
-                parameters.getParameter ("lowShelfFreq")
-                    ->setValueNotifyingHost (parameters.getParameterRange ("lowShelfFreq")
-                                                 .convertTo0to1 (roomParam.lowShelfFreq));
-                parameters.getParameter ("lowShelfGain")
-                    ->setValueNotifyingHost (parameters.getParameterRange ("lowShelfGain")
-                                                 .convertTo0to1 (roomParam.lowShelfGain));
-                parameters.getParameter ("highShelfFreq")
-                    ->setValueNotifyingHost (parameters.getParameterRange ("highShelfFreq")
-                                                 .convertTo0to1 (roomParam.highShelfFreq));
-                parameters.getParameter ("highShelfGain")
-                    ->setValueNotifyingHost (parameters.getParameterRange ("highShelfGain")
-                                                 .convertTo0to1 (roomParam.highShelfGain));
-
-                parameters.getParameter ("wallAttenuationFront")
-                    ->setValueNotifyingHost (parameters.getParameterRange ("wallAttenuationFront")
-                                                 .convertTo0to1 (roomParam.wallAttenuationFront));
-                parameters.getParameter ("wallAttenuationBack")
-                    ->setValueNotifyingHost (parameters.getParameterRange ("wallAttenuationBack")
-                                                 .convertTo0to1 (roomParam.wallAttenuationBack));
-                parameters.getParameter ("wallAttenuationLeft")
-                    ->setValueNotifyingHost (parameters.getParameterRange ("wallAttenuationLeft")
-                                                 .convertTo0to1 (roomParam.wallAttenuationLeft));
-                parameters.getParameter ("wallAttenuationRight")
-                    ->setValueNotifyingHost (parameters.getParameterRange ("wallAttenuationRight")
-                                                 .convertTo0to1 (roomParam.wallAttenuationRight));
-                parameters.getParameter ("wallAttenuationCeiling")
-                    ->setValueNotifyingHost (parameters.getParameterRange ("wallAttenuationCeiling")
-                                                 .convertTo0to1 (roomParam.wallAttenuationCeiling));
-                parameters.getParameter ("wallAttenuationFloor")
-                    ->setValueNotifyingHost (parameters.getParameterRange ("wallAttenuationFloor")
-                                                 .convertTo0to1 (roomParam.wallAttenuationFloor));
-                readingSharedParams = false;
-            }
+            const auto version = publishRoomSettings (ch, g);
+            if (version == 0)
+                group.publishPending = true;
             else
+                group.version = version;
+            continue;
+        }
+
+        float values[SharedRoomValues::maxNumValues];
+        if (! sharedValues.read (values, group.numValues, group.version))
+            continue;
+
+        // setValue() updates the parameters without notifying the host, just like automation
+        readingSharedParams = true;
+        for (int i = 0; i < group.numValues; ++i)
+            if (group.values[i]->load() != values[i])
             {
-                roomParam.reflCoeff = *reflCoeff;
-                roomParam.numRefl = *numRefl;
-                roomParam.lowShelfFreq = *lowShelfFreq;
-                roomParam.lowShelfGain = *lowShelfGain;
-                roomParam.highShelfFreq = *highShelfFreq;
-                roomParam.highShelfGain = *highShelfGain;
-                roomParam.validReflectionData = true;
+                group.parameters[i]->setValue (group.parameters[i]->convertTo0to1 (values[i]));
+                settingsChanged = true;
             }
-        }
+        readingSharedParams = false;
     }
+
+    return settingsChanged;
+}
+
+juce::uint32 RoomEncoderAudioProcessor::publishRoomSettings (const int channel, const int group)
+{
+    const auto& syncGroup = syncGroups[group];
+
+    float values[SharedRoomValues::maxNumValues];
+    for (int i = 0; i < syncGroup.numValues; ++i)
+        values[i] = syncGroup.values[i]->load();
+
+    return sharedParams.get().rooms[channel][group].write (values, syncGroup.numValues);
 }
 
 void RoomEncoderAudioProcessor::updateBuffers()
@@ -1082,6 +1400,10 @@ void RoomEncoderAudioProcessor::updateBuffers()
     delayBuffer.setSize (nChOut, bufferSize);
     delayBuffer.clear();
 
+    currentAmbisonicOrder = output.getOrder();
+    currentDirectivityOrder = input.getOrder();
+    notify();
+
     if (input.getSize() != input.getPreviousSize())
     {
         for (int i = 0; i < interleavedData.size(); ++i)
@@ -1235,6 +1557,50 @@ std::vector<std::unique_ptr<juce::RangedAudioParameter>>
         [] (float value) { return juce::String (value, 3); },
         nullptr));
 
+    params.push_back (OSCParameterInterface::createParameterTheOldWay (
+        "numberOfSources",
+        "Number of Sources",
+        "",
+        juce::NormalisableRange<float> (1.0f, maxNumberOfSources, 1.0f),
+        1.0f,
+        [] (float value)
+        {
+            if (value < 1.5f)
+                return juce::String ("1 (directivity)");
+            else
+                return juce::String ((int) value);
+        },
+        nullptr));
+
+    // additional mono sources, the first one uses the sourceX/Y/Z parameters from above
+    for (int i = 2; i <= maxNumberOfSources; ++i)
+    {
+        params.push_back (OSCParameterInterface::createParameterTheOldWay (
+            "sourceX" + juce::String (i),
+            "source " + juce::String (i) + " position x",
+            "m",
+            juce::NormalisableRange<float> (-15.0f, 15.0f, 0.001f),
+            1.0f,
+            [] (float value) { return juce::String (value, 3); },
+            nullptr));
+        params.push_back (OSCParameterInterface::createParameterTheOldWay (
+            "sourceY" + juce::String (i),
+            "source " + juce::String (i) + " position y",
+            "m",
+            juce::NormalisableRange<float> (-15.0f, 15.0f, 0.001f),
+            1.0f,
+            [] (float value) { return juce::String (value, 3); },
+            nullptr));
+        params.push_back (OSCParameterInterface::createParameterTheOldWay (
+            "sourceZ" + juce::String (i),
+            "source " + juce::String (i) + " position z",
+            "m",
+            juce::NormalisableRange<float> (-10.0f, 10.0f, 0.001f),
+            -1.0f,
+            [] (float value) { return juce::String (value, 3); },
+            nullptr));
+    }
+
     params.push_back (OSCParameterInterface::createParameterTheOldWay (
         "listenerX",
         "listener position x",
@@ -1486,6 +1852,21 @@ std::vector<std::unique_ptr<juce::RangedAudioParameter>>
         [] (float value) { return juce::String (value, 3); },
         nullptr));
 
+    params.push_back (OSCParameterInterface::createParameterTheOldWay (
+        "lodThreshold",
+        "Level of Detail Threshold",
+        "dB",
+        juce::NormalisableRange<float> (lodThresholdOff, -40.0f, 1.0f),
+        lodThresholdOff,
+        [] (float value)
+        {
+            if (value <= lodThresholdOff)
+                return juce::String ("off");
+            else
+                return juce::String (value, 0);
+        },
+        nullptr));
+
     return params;
 }
 
@@ -25,6 +25,7 @@
 #pragma once
 
 #include "../../resources/AudioProcessorBase.h"
+#include "../../resources/TripleBuffer.h"
 #include "../../resources/ambisonicTools.h"
 #include "../../resources/customComponents/FilterVisualizer.h"
 #include "../../resources/efficientSHvanilla.h"
@@ -50,28 +51,73 @@ static constexpr int IIRfloat_elements = 1;
 const int mSig[] = { 1, -1 };
 using namespace juce::dsp;
 
-struct RoomParams
+/**
+ One group of room settings (e.g. the room dimensions), shared between the instances
+ synchronized to the same channel. Reading and writing never locks or waits: the values are
+ guarded by a sequence counter, which is odd while they are written. Its value also serves as
+ version, so readers only take over values which have changed since their last read.
+ */
+class SharedRoomValues
 {
-    bool validRoomData = false;
-    bool validListenerData = false;
-    bool validReflectionData = false;
-    float roomX, roomY, roomZ;
-    float listenerX, listenerY, listenerZ;
-    float reflCoeff, lowShelfFreq, lowShelfGain, highShelfFreq, highShelfGain, numRefl;
-    float wallAttenuationFront, wallAttenuationBack, wallAttenuationLeft, wallAttenuationRight,
-        wallAttenuationCeiling, wallAttenuationFloor;
+public:
+    static constexpr int maxNumValues = 12;
+
+    /** Writes new values and returns their version. If another instance is writing at the same
+        time, nothing is written and 0 is returned, so the write should be tried again later. */
+    juce::uint32 write (const float* newValues, const int numValues)
+    {
+        jassert (numValues <= maxNumValues);
+
+        auto seq = sequence.load (std::memory_order_relaxed);
+        if ((seq & 1) != 0
+            || ! sequence.compare_exchange_strong (seq, seq + 1, std::memory_order_acquire))
+            return 0;
+
+        for (int i = 0; i < numValues; ++i)
+            values[i].store (newValues[i], std::memory_order_relaxed);
+
+        sequence.store (seq + 2, std::memory_order_release);
+        return seq + 2;
+    }
+
+    /** Copies the values into destValues, if there's a version newer than the given one, which
+        is updated in that case. Returns false if there are no new values, or if they are being
+        written, so the read should be tried again later. */
+    bool read (float* destValues, const int numValues, juce::uint32& version) const
+    {
+        jassert (numValues <= maxNumValues);
+
+        const auto seq = sequence.load (std::memory_order_acquire);
+        if ((seq & 1) != 0 || seq == version || seq == 0)
+            return false;
+
+        for (int i = 0; i < numValues; ++i)
+            destValues[i] = values[i].load (std::memory_order_relaxed);
+
+        std::atomic_thread_fence (std::memory_order_acquire);
+        if (sequence.load (std::memory_order_relaxed) != seq)
+            return false;
+
+        version = seq;
+        return true;
+    }
+
+    /** Returns false until values have been written for the first time. */
+    bool hasData() const { return sequence.load (std::memory_order_acquire) != 0; }
+
+private:
+    std::atomic<juce::uint32> sequence { 0 };
+    std::atomic<float> values[maxNumValues] {};
 };
 
 struct SharedParams
 {
-    SharedParams()
-    {
-        rooms.add (RoomParams());
-        rooms.add (RoomParams());
-        rooms.add (RoomParams());
-        rooms.add (RoomParams());
-    }
-    juce::Array<RoomParams> rooms;
+    static constexpr int numChannels = 4;
+
+    // room dimensions, listener position and reflection properties
+    static constexpr int numGroups = 3;
+
+    SharedRoomValues rooms[numChannels][numGroups];
 };
 
 struct ReflectionProperty
@@ -88,16 +134,40 @@ struct ReflectionProperty
     const int zMinusReflections; // number of reflections at floor
 };
 
+/** Image source positions and encoding coefficients of one source, computed by the geometry
+    thread and handed over to the audio thread. */
+struct ImageSourceGeometry
+{
+    juce::Vector3D<float> position;
+
+    float radius[nImgSrc];
+    double delay[nImgSrc]; // in samples times interpMult, including the direct path offset
+    float gain[nImgSrc];
+    int numChannels[nImgSrc]; // channels to encode, 0 if the image source isn't rendered
+    float SHcoeffs[nImgSrc][64]; // including the gain and the normalization
+};
+
+/** State of one source's image sources on the audio thread. */
+struct ImageSourceState
+{
+    float mRadius[nImgSrc]; // radii of the geometry currently rendered
+
+    double oldDelay[nImgSrc];
+    float SHcoeffsOld[nImgSrc][64];
+    int numEncodedChannels[nImgSrc]; // channels with non-zero SHcoeffsOld
+};
+
 //==============================================================================
 /**
 */
 class RoomEncoderAudioProcessor
     : public AudioProcessorBase<IOTypes::Ambisonics<>, IOTypes::Ambisonics<>>,
-      private juce::Timer
+      private juce::Thread
 {
 public:
     constexpr static int numberOfInputChannels = 64;
     constexpr static int numberOfOutputChannels = 64;
+    constexpr static int maxNumberOfSources = 32;
     //==============================================================================
     RoomEncoderAudioProcessor();
     ~RoomEncoderAudioProcessor();
@@ -133,8 +203,7 @@ public:
     std::vector<std::unique_ptr<juce::RangedAudioParameter>> createParameterLayout();
 
     //==============================================================================
-    double oldDelay[nImgSrc];
-    float allGains[nImgSrc];
+    float allGains[nImgSrc]; // gains of the first source's image sources
 
     //filter coefficients
     IIR::Coefficients<float>::Ptr lowShelfCoefficients;
@@ -143,24 +212,99 @@ public:
     bool userChangedFilterSettings = true;
     bool updateFv = false;
 
-    void timerCallback() override;
-
     void updateFilterCoefficients (double sampleRate);
-    void calculateImageSourcePositions (const float t, const float b, const float h);
 
     std::atomic<float>* numRefl;
-    float mRadius[nImgSrc];
+
+    /** Returns the state of one of the sources, e.g. to visualize its reflections. */
+    const ImageSourceState& getSourceState (const int index) const { return *sources[index]; }
 
     void updateBuffers() override;
 
     juce::Atomic<bool> repaintPositionPlanes = true;
 
+    // number of image sources rendered during the last block, summed over all sources
+    std::atomic<int> numRenderedImageSources { 0 };
+
 private:
     //==============================================================================
     inline void clear (juce::dsp::AudioBlock<IIRfloat>& ab);
 
-    bool readingSharedParams = false;
-    ;
+    // everything the audio thread needs to render the image sources of all sources
+    struct RoomGeometry
+    {
+        int numSources = 1;
+        int numRefl = 0;
+        ImageSourceGeometry sources[maxNumberOfSources];
+        float directivity[nImgSrc][64]; // first source's directivity weights, normalized to N3D
+    };
+
+    void renderMonoSources (juce::AudioSampleBuffer& buffer,
+                            const RoomGeometry& geometry,
+                            const int workingNumSources,
+                            const int workingNumRefl);
+
+    /** Updates the state of an image source, which is neither rendered nor fading out. */
+    void skipImageSource (ImageSourceState& source,
+                          const ImageSourceGeometry& sourceGeometry,
+                          const int q);
+
+    /** Adds the q-th image source of a source to the delay buffer, encoded with the channels
+        given by the geometry. Channels above those, or all if there are none, fade to zero. */
+    void encodeImageSource (ImageSourceState& source,
+                            const ImageSourceGeometry& sourceGeometry,
+                            const int q,
+                            const float* signal,
+                            const int L);
+
+    // ======= geometry thread
+    void run() override;
+
+    /** Moves the sources and the listener towards their targets, computes the image sources
+        and publishes them. Has to be called with the geometryLock held. Returns true if all
+        positions have reached their targets. */
+    bool updateGeometry (const bool snapToTargets);
+    void calculateImageSourcePositions (ImageSourceGeometry& sourceGeometry,
+                                        const float t,
+                                        const float b,
+                                        const float h);
+
+    /** Returns the ambisonic order an image source with the given gain is encoded with, or -1
+        if it's below the level of detail threshold and should be faded out. */
+    int getLevelOfDetailOrder (const float gain, const int ambisonicOrder) const;
+
+    static bool moveTowards (juce::Vector3D<float>& position,
+                             const juce::Vector3D<float>& target,
+                             const float maxDist);
+
+    // ======= room synchronization
+    /** Takes over settings other instances have changed in the synchronized channel, and
+        publishes the own ones if that channel has no data yet or a previous write has failed.
+        Called at the beginning of each block, returns true if settings have been taken over,
+        so the geometry thread can be woken up to compute the new image sources. */
+    bool synchronizeRoomSettings();
+    /** Returns the version of the written values, or 0 if the write has to be repeated. */
+    juce::uint32 publishRoomSettings (const int channel, const int group);
+
+    struct SyncGroup
+    {
+        std::atomic<float>* enabled;
+        int numValues = 0;
+        juce::RangedAudioParameter* parameters[SharedRoomValues::maxNumValues];
+        std::atomic<float>* values[SharedRoomValues::maxNumValues];
+
+        // set if a change couldn't be written, the audio thread repeats the write
+        std::atomic<bool> publishPending { false };
+
+        // used by the audio thread only
+        int channel = -1;
+        juce::uint32 version = 0;
+    };
+
+    SyncGroup syncGroups[SharedParams::numGroups];
+
+    // set while the current thread applies shared settings, which mustn't be published again
+    static thread_local bool readingSharedParams;
 
     double phi;
     double theta;
@@ -175,9 +319,10 @@ private:
     std::atomic<float>* roomY;
     std::atomic<float>* roomZ;
 
-    std::atomic<float>* sourceX;
-    std::atomic<float>* sourceY;
-    std::atomic<float>* sourceZ;
+    std::atomic<float>* numberOfSources;
+    std::atomic<float>* sourceX[maxNumberOfSources];
+    std::atomic<float>* sourceY[maxNumberOfSources];
+    std::atomic<float>* sourceZ[maxNumberOfSources];
 
     std::atomic<float>* listenerX;
     std::atomic<float>* listenerY;
@@ -207,8 +352,38 @@ private:
     std::atomic<float>* wallAttenuationFloor;
 
     std::atomic<float>* constantGainDistance;
+    std::atomic<float>* lodThreshold;
 
     int _numRefl;
+    int _numSources;
+    bool renderedMultipleSources = false; // mode of the last block, the filters belong to
+
+    // level of detail
+    static constexpr float lodThresholdOff = -120.0f;
+    static constexpr int numLodSteps = 6;
+    static constexpr float lodStepInDb = 6.0f;
+    bool levelOfDetailEnabled = false;
+    float lodGains[numLodSteps + 1]; // threshold gains for 0 ... numLodSteps order reductions
+    int renderedImageSources = 0;
+
+    // computed by the geometry thread, or prepareToPlay() and offline processBlock() while
+    // holding the geometryLock
+    juce::CriticalSection geometryLock;
+    TripleBuffer<RoomGeometry> geometryBuffer;
+    double geometrySampleRate = 0.0;
+    juce::int64 geometrySampleCount = 0;
+    bool geometrySettled = true; // positions reached their targets with the last update
+    float mx[nImgSrc]; // direction of arrival
+    float my[nImgSrc];
+    float mz[nImgSrc];
+    float smx[nImgSrc]; // direction of departure
+    float smy[nImgSrc];
+    float smz[nImgSrc];
+
+    // written by the audio thread, so the geometry thread can follow the audio time and orders
+    std::atomic<juce::int64> processedSamples { 0 };
+    std::atomic<int> currentAmbisonicOrder { 0 };
+    std::atomic<int> currentDirectivityOrder { 0 };
 
     juce::SharedResourcePointer<SharedParams> sharedParams;
 
@@ -222,14 +397,10 @@ private:
 
     juce::Array<int> filterPoints { 1, 7, 25, 61, 113, 169, 213 };
 
-    juce::Vector3D<float> sourcePos, listenerPos;
+    juce::Vector3D<float> listenerPos;
+    juce::Vector3D<float> sourcePos[maxNumberOfSources];
 
-    float mx[nImgSrc];
-    float my[nImgSrc];
-    float mz[nImgSrc];
-    float smx[nImgSrc];
-    float smy[nImgSrc];
-    float smz[nImgSrc];
+    juce::OwnedArray<ImageSourceState> sources;
 
     int bufferSize;
     int bufferReadIdx;
@@ -237,13 +408,12 @@ private:
     int readOffset;
 
     float powReflCoeff[maxOrderImgSrc + 1];
-    double dist2smpls;
 
-    float SHcoeffsOld[nImgSrc][64];
     IIRfloat SHsampleOld[nImgSrc][16]; //TODO: can be smaller: (N+1)^2/IIRfloat_elements()
 
     juce::AudioBuffer<float> delayBuffer;
     juce::AudioBuffer<float> monoBuffer;
+    juce::AudioBuffer<float> sourceSignals; // filtered signals of the mono sources
 
     juce::OwnedArray<ReflectionProperty> reflectionList;
 
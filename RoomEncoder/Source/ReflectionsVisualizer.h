@@ -89,6 +89,12 @@ public:
                         false);
         }
 
+        if (numRenderedPtr != nullptr)
+            g.drawText (juce::String (numRenderedPtr->load()) + " image sources rendered",
+                        getLocalBounds().removeFromTop (20).reduced (5, 0),
+                        juce::Justification::topRight,
+                        false);
+
         const float xFactor = 1000.0f / 343.2f;
 
         if (radiusPtr != nullptr)
@@ -138,13 +144,15 @@ public:
         xRangeInMs = juce::jmin (xRangeInMs, 550);
         xRangeInMs = juce::jmax (xRangeInMs, 40);
     }
-    void setDataPointers (float* Gain, float* Radius, std::atomic<float>* NumRefl)
+    void setDataPointers (const float* Gain, const float* Radius, std::atomic<float>* NumRefl)
     {
         gainPtr = Gain;
         numReflPtr = NumRefl;
         radiusPtr = Radius;
     }
 
+    void setNumRenderedPointer (std::atomic<int>* NumRendered) { numRenderedPtr = NumRendered; }
+
     void setZeroDelay (const bool shouldBeZeroDelay)
     {
         if (zeroDelay != shouldBeZeroDelay)
@@ -186,8 +194,9 @@ private:
     float plotHeight = 1.0f;
     int xRangeInMs = 100;
     std::atomic<float>* numReflPtr = nullptr;
-    float* gainPtr = nullptr;
-    float* radiusPtr = nullptr;
+    std::atomic<int>* numRenderedPtr = nullptr;
+    const float* gainPtr = nullptr;
+    const float* radiusPtr = nullptr;
 
     bool zeroDelay = false;
 };
@@ -35,7 +35,7 @@ SceneRotatorAudioProcessorEditor::SceneRotatorAudioProcessorEditor (
     // ============== BEGIN: essentials ======================
     // set GUI size and lookAndFeel
     //setSize(500, 300); // use this to create a fixed-size GUI
-    setResizeLimits (450, 320, 800, 500); // use this to create a resizable GUI
+    setResizeLimits (450, 345, 800, 500); // use this to create a resizable GUI
     setResizable (true, true);
     setLookAndFeel (&globalLaF);
 
@@ -207,6 +207,22 @@ SceneRotatorAudioProcessorEditor::SceneRotatorAudioProcessorEditor (
     addAndMakeVisible (slMidiScheme);
     slMidiScheme.setText ("Scheme");
 
+    addAndMakeVisible (cbUpdateInterval);
+    cbUpdateInterval.setTooltip (
+        "Interval in which the rotation follows the head tracker within the audio blocks");
+    cbUpdateInterval.setJustificationType (juce::Justification::centred);
+    cbUpdateInterval.addSectionHeading ("Rotation update interval");
+    cbUpdateInterval.addItem ("once per block", 1);
+    cbUpdateInterval.addItem ("16 samples", 2);
+    cbUpdateInterval.addItem ("32 samples", 3);
+    cbUpdateInterval.addItem ("64 samples", 4);
+    cbUpdateInterval.addItem ("128 samples", 5);
+    cbUpdateIntervalAttachment.reset (
+        new ComboBoxAttachment (valueTreeState, "updateInterval", cbUpdateInterval));
+
+    addAndMakeVisible (lbUpdateInterval);
+    lbUpdateInterval.setText ("Update");
+
     tooltipWin.setLookAndFeel (&globalLaF);
     tooltipWin.setMillisecondsBeforeTipAppears (500);
     tooltipWin.setOpaque (false);
@@ -330,6 +346,12 @@ void SceneRotatorAudioProcessorEditor::resized()
     row.removeFromLeft (10);
     slMidiScheme.setBounds (row.removeFromLeft (48));
     cbMidiScheme.setBounds (row.removeFromLeft (140));
+
+    area.removeFromTop (5);
+    row = area.removeFromTop (20);
+    row.removeFromLeft (190);
+    lbUpdateInterval.setBounds (row.removeFromLeft (48));
+    cbUpdateInterval.setBounds (row.removeFromLeft (140));
 }
 
 void SceneRotatorAudioProcessorEditor::timerCallback()
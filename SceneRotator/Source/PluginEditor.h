@@ -106,6 +106,10 @@ private:
     SimpleLabel slMidiDevices, slMidiScheme;
     juce::ComboBox cbMidiDevices, cbMidiScheme;
 
+    SimpleLabel lbUpdateInterval;
+    juce::ComboBox cbUpdateInterval;
+    std::unique_ptr<ComboBoxAttachment> cbUpdateIntervalAttachment;
+
     juce::Atomic<bool> refreshingMidiDevices = false;
     juce::Atomic<bool> updatingMidiScheme = false;
 
@@ -20,24 +20,6 @@
  ==============================================================================
  */
 
-/*
- The computation of Ambisonic rotation matrices is done by the recursive method
- of Ivanic and Ruedenberg:
-
-    Ivanic, J., Ruedenberg, K. (1996). Rotation Matrices for Real Spherical
-    Harmonics. Direct Determination by Recursion. The Journal of Physical
-    Chemistry, 100(15), 6342?6347.
-
- Including their corrections:
-
-    Ivanic, J., Ruedenberg, K. (1998). Rotation Matrices for Real Spherical
-    Harmonics. Direct Determination by Recursion Page: Additions and
-    Corrections. Journal of Physical Chemistry A, 102(45), 9099?9100.
-
- It also follows the implementations of Archontis Politis (Spherical Harmonic
- Transform Toolbox) and Matthias Kronlachner (AmbiX Plug-in Suite).
- */
-
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
 
@@ -81,6 +63,7 @@ SceneRotatorAudioProcessor::SceneRotatorAudioProcessor() :
     invertRoll = parameters.getRawParameterValue ("invertRoll");
     invertQuaternion = parameters.getRawParameterValue ("invertQuaternion");
     rotationSequence = parameters.getRawParameterValue ("rotationSequence");
+    updateInterval = parameters.getRawParameterValue ("updateInterval");
 
     // add listeners to parameter changes
     parameters.addParameterListener ("orderSetting", this);
@@ -99,18 +82,6 @@ SceneRotatorAudioProcessor::SceneRotatorAudioProcessor() :
     parameters.addParameterListener ("invertQuaternion", this);
     parameters.addParameterListener ("rotationSequence", this);
 
-    orderMatrices.add (new juce::dsp::Matrix<float> (0, 0)); // 0th
-    orderMatricesCopy.add (new juce::dsp::Matrix<float> (0, 0)); // 0th
-
-    for (int l = 1; l <= 7; ++l)
-    {
-        const int nCh = (2 * l + 1);
-        auto elem = orderMatrices.add (new juce::dsp::Matrix<float> (nCh, nCh));
-        elem->clear();
-        auto elemCopy = orderMatricesCopy.add (new juce::dsp::Matrix<float> (nCh, nCh));
-        elemCopy->clear();
-    }
-
     trackerDriver.addListener (this);
     trackerDriver.setAutoDisconnect (false);
 
@@ -152,12 +123,13 @@ void SceneRotatorAudioProcessor::prepareToPlay (double sampleRate, int samplesPe
 {
     checkInputAndOutput (this, *orderSetting, *orderSetting, true);
 
-    copyBuffer.setSize (copyBuffer.getNumChannels(), samplesPerBlock);
+    shRotation.prepare (samplesPerBlock);
 
     // Use this method as the place to do any pre-playback
     // initialisation that you need..
 
     juce::MidiMessageCollector::reset (sampleRate);
+    lastBlockTimeInMs = juce::Time::getMillisecondCounterHiRes();
     rotationParamsHaveChanged = true;
 }
 
@@ -182,236 +154,309 @@ void SceneRotatorAudioProcessor::processBlock (juce::AudioSampleBuffer& buffer,
     jassert (actualChannels <= nChIn);
 
     if (currentMidiScheme != MidiScheme::none)
-    {
         removeNextBlockOfMessages (midiMessages, buffer.getNumSamples());
 
-        for (const auto& msg : midiMessages)
+    const int intervalInSamples = getUpdateIntervalInSamples();
+    if (intervalInSamples > 0)
+        processSubBlocks (buffer, midiMessages, inputOrder, actualOrder, intervalInSamples);
+    else
+    {
+        lastBlockTimeInMs = juce::Time::getMillisecondCounterHiRes();
+
+        // updates queued before the update interval was changed
+        const int nUpdates =
+            orientationUpdates.readFromQueue (pendingUpdates.data(), (int) pendingUpdates.size());
+        for (int i = 0; i < nUpdates; ++i)
+            setQuaternionParameters (pendingUpdates[i].qw,
+                                     pendingUpdates[i].qx,
+                                     pendingUpdates[i].qy,
+                                     pendingUpdates[i].qz);
+
+        if (currentMidiScheme != MidiScheme::none)
         {
-            const auto message = msg.getMessage();
+            for (const auto& msg : midiMessages)
+            {
+                const auto message = msg.getMessage();
 
-            if (! message.isController())
-                break;
+                if (! message.isController())
+                    break;
 
-            switch (currentMidiScheme)
+                handleMidiMessage (message);
+            }
+        }
+
+        if (rotationParamsHaveChanged.get())
+        {
+            calcRotationMatrix (inputOrder);
+            renderedQuaternion = getRotationQuaternion();
+        }
+
+        // rotate buffer, fading between old and new matrices
+        shRotation.process (juce::dsp::AudioBlock<float> (buffer), actualOrder);
+    }
+
+    // clear all channels above the actual order
+    for (int ch = actualChannels; ch < buffer.getNumChannels(); ++ch)
+        buffer.clear (ch, 0, L);
+
+    midiMessages.clear();
+}
+
+void SceneRotatorAudioProcessor::handleMidiMessage (const juce::MidiMessage& message)
+{
+    switch (currentMidiScheme)
+    {
+        case MidiScheme::mrHeadTrackerYprDir:
+        case MidiScheme::mrHeadTrackerYprInv:
+            switch (message.getControllerNumber())
             {
-                case MidiScheme::mrHeadTrackerYprDir:
-                case MidiScheme::mrHeadTrackerYprInv:
-                    switch (message.getControllerNumber())
-                    {
-                        case 48:
-                            yawLsb = message.getControllerValue();
-                            break;
-                        case 49:
-                            pitchLsb = message.getControllerValue();
-                            break;
-                        case 50:
-                            rollLsb = message.getControllerValue();
-                            break;
-
-                        case 16:
-                        {
-                            float yawVal =
-                                (128 * message.getControllerValue() + yawLsb) * (1.0f / 16384);
-                            parameters.getParameter ("yaw")->setValueNotifyingHost (yawVal);
-                            break;
-                        }
-
-                        case 17:
-                        {
-                            float pitchVal =
-                                (128 * message.getControllerValue() + pitchLsb) * (1.0f / 16384);
-                            parameters.getParameter ("pitch")->setValueNotifyingHost (pitchVal);
-                            break;
-                        }
-
-                        case 18:
-                        {
-                            float rollVal =
-                                (128 * message.getControllerValue() + rollLsb) * (1.0f / 16384);
-                            parameters.getParameter ("roll")->setValueNotifyingHost (rollVal);
-                            break;
-                        }
-                    } // switch (message.getControllerNumber())
+                case 48:
+                    yawLsb = message.getControllerValue();
+                    break;
+                case 49:
+                    pitchLsb = message.getControllerValue();
+                    break;
+                case 50:
+                    rollLsb = message.getControllerValue();
                     break;
 
-                case MidiScheme::mrHeadTrackerQuaternions:
-                    switch (message.getControllerNumber())
-                    {
-                        case 48:
-                            qwLsb = message.getControllerValue();
-                            break;
-                        case 49:
-                            qxLsb = message.getControllerValue();
-                            break;
-                        case 50:
-                            qyLsb = message.getControllerValue();
-                            break;
-                        case 51:
-                            qzLsb = message.getControllerValue();
-                            break;
-
-                        case 16:
-                        {
-                            float qwVal =
-                                (128 * message.getControllerValue() + qwLsb) * (1.0f / 16384);
-                            parameters.getParameter ("qw")->setValueNotifyingHost (qwVal);
-                            break;
-                        }
-
-                        case 17:
-                        {
-                            float qxVal =
-                                (128 * message.getControllerValue() + qxLsb) * (1.0f / 16384);
-                            parameters.getParameter ("qx")->setValueNotifyingHost (qxVal);
-                            break;
-                        }
-
-                        case 18:
-                        {
-                            float qyVal =
-                                (128 * message.getControllerValue() + qyLsb) * (1.0f / 16384);
-                            parameters.getParameter ("qy")->setValueNotifyingHost (qyVal);
-                            break;
-                        }
-
-                        case 19:
-                        {
-                            float qzVal =
-                                (128 * message.getControllerValue() + qzLsb) * (1.0f / 16384);
-                            parameters.getParameter ("qz")->setValueNotifyingHost (qzVal);
-                            break;
-                        }
-                    } // switch (message.getControllerNumber())
+                case 16:
+                {
+                    float yawVal =
+                        (128 * message.getControllerValue() + yawLsb) * (1.0f / 16384);
+                    setParameterDeferringNotification ("yaw", yawVal, yawChanged);
                     break;
-                default:
+                }
+
+                case 17:
+                {
+                    float pitchVal =
+                        (128 * message.getControllerValue() + pitchLsb) * (1.0f / 16384);
+                    setParameterDeferringNotification ("pitch", pitchVal, pitchChanged);
                     break;
-            } // switch (currentMidiScheme)
-        } //while (i.getNextEvent (message, time))
-    } //if (currentMidiScheme != MidiScheme::none)
+                }
 
-    bool newRotationMatrix = false;
-    if (rotationParamsHaveChanged.get())
-    {
-        newRotationMatrix = true;
-        calcRotationMatrix (inputOrder);
-    }
+                case 18:
+                {
+                    float rollVal =
+                        (128 * message.getControllerValue() + rollLsb) * (1.0f / 16384);
+                    setParameterDeferringNotification ("roll", rollVal, rollChanged);
+                    break;
+                }
+            } // switch (message.getControllerNumber())
+            break;
 
-    // make copy of input
-    for (int ch = 0; ch < actualChannels; ++ch)
-        copyBuffer.copyFrom (ch, 0, buffer, ch, 0, L);
+        case MidiScheme::mrHeadTrackerQuaternions:
+            switch (message.getControllerNumber())
+            {
+                case 48:
+                    qwLsb = message.getControllerValue();
+                    break;
+                case 49:
+                    qxLsb = message.getControllerValue();
+                    break;
+                case 50:
+                    qyLsb = message.getControllerValue();
+                    break;
+                case 51:
+                    qzLsb = message.getControllerValue();
+                    break;
 
-    // clear all channels except first
-    for (int ch = 1; ch < buffer.getNumChannels(); ++ch)
-        buffer.clear (ch, 0, L);
+                case 16:
+                {
+                    float qwVal =
+                        (128 * message.getControllerValue() + qwLsb) * (1.0f / 16384);
+                    setParameterDeferringNotification ("qw", qwVal, quatChangedW);
+                    break;
+                }
 
-    // rotate buffer
-    for (int l = 1; l <= actualOrder; ++l)
+                case 17:
+                {
+                    float qxVal =
+                        (128 * message.getControllerValue() + qxLsb) * (1.0f / 16384);
+                    setParameterDeferringNotification ("qx", qxVal, quatChangedX);
+                    break;
+                }
+
+                case 18:
+                {
+                    float qyVal =
+                        (128 * message.getControllerValue() + qyLsb) * (1.0f / 16384);
+                    setParameterDeferringNotification ("qy", qyVal, quatChangedY);
+                    break;
+                }
+
+                case 19:
+                {
+                    float qzVal =
+                        (128 * message.getControllerValue() + qzLsb) * (1.0f / 16384);
+                    setParameterDeferringNotification ("qz", qzVal, quatChangedZ);
+                    break;
+                }
+            } // switch (message.getControllerNumber())
+            break;
+        default:
+            break;
+    } // switch (currentMidiScheme)
+}
+
+void SceneRotatorAudioProcessor::processSubBlocks (juce::AudioSampleBuffer& buffer,
+                                                   juce::MidiBuffer& midiMessages,
+                                                   const int inputOrder,
+                                                   const int actualOrder,
+                                                   const int intervalInSamples)
+{
+    const int L = buffer.getNumSamples();
+    juce::dsp::AudioBlock<float> block (buffer);
+
+    // orientation updates from the head tracker and OSC threads are placed within this block
+    // according to their arrival time during the previous block, just like the MIDI messages
+    const double blockTimeInMs = juce::Time::getMillisecondCounterHiRes();
+    const int nUpdates =
+        orientationUpdates.readFromQueue (pendingUpdates.data(), (int) pendingUpdates.size());
+    for (int i = 0; i < nUpdates; ++i)
+        pendingUpdates[i].samplePosition = juce::jlimit (
+            0,
+            juce::jmax (0, L - 1),
+            static_cast<int> ((pendingUpdates[i].timeInMs - lastBlockTimeInMs) * 0.001
+                              * getSampleRate()));
+    lastBlockTimeInMs = blockTimeInMs;
+
+    auto midiIterator = midiMessages.cbegin();
+    bool midiDone = currentMidiScheme == MidiScheme::none;
+    int nextUpdate = 0;
+
+    for (int start = 0; start < L; start += intervalInSamples)
     {
-        const int offset = l * l;
-        const int nCh = 2 * l + 1;
-        auto R = orderMatrices[l];
-        auto Rcopy = orderMatricesCopy[l];
-        for (int o = 0; o < nCh; ++o)
+        const int numSamples = juce::jmin (intervalInSamples, L - start);
+        const int end = start + numSamples;
+
+        // apply all orientation changes up to the end of this sub-block
+        for (; ! midiDone && midiIterator != midiMessages.cend()
+               && (*midiIterator).samplePosition < end;
+             ++midiIterator)
         {
-            const int chOut = offset + o;
-            for (int p = 0; p < nCh; ++p)
-            {
-                buffer.addFromWithRamp (chOut,
-                                        0,
-                                        copyBuffer.getReadPointer (offset + p),
-                                        L,
-                                        Rcopy->operator() (o, p),
-                                        R->operator() (o, p));
-            }
+            const auto message = (*midiIterator).getMessage();
+            if (! message.isController())
+                midiDone = true;
+            else
+                handleMidiMessage (message);
         }
+
+        for (; nextUpdate < nUpdates && pendingUpdates[nextUpdate].samplePosition < end;
+             ++nextUpdate)
+        {
+            const auto& update = pendingUpdates[nextUpdate];
+            setQuaternionParameters (update.qw, update.qx, update.qy, update.qz);
+        }
+
+        auto subBlock = block.getSubBlock ((size_t) start, (size_t) numSamples);
+        if (rotationParamsHaveChanged.compareAndSetBool (false, true))
+            rotateSubBlock (subBlock, inputOrder, actualOrder, getRotationQuaternion());
+        else
+            shRotation.process (subBlock, actualOrder);
     }
+}
 
-    // make copies for fading between old and new matrices
-    if (newRotationMatrix)
-        for (int l = 1; l <= inputOrder; ++l)
-            *orderMatricesCopy[l] = *orderMatrices[l];
+void SceneRotatorAudioProcessor::rotateSubBlock (juce::dsp::AudioBlock<float> block,
+                                                 const int inputOrder,
+                                                 const int actualOrder,
+                                                 const iem::Quaternion<float>& target)
+{
+    const float angle = renderedQuaternion.getAngleTo (target);
+
+    // The rotation engine interpolates the matrix entries linearly, which attenuates the
+    // signal in between two distant rotations, the more the higher the order. Therefore, large
+    // rotations are split into several steps along the slerp path, each with a bounded angle.
+    const int numSamples = static_cast<int> (block.getNumSamples());
+    const float maxAngle = maxSlerpStepAngle / juce::jmax (1, actualOrder);
+    const int nSteps = juce::jlimit (1,
+                                     juce::jmin (maxSlerpStepsPerSubBlock, numSamples),
+                                     static_cast<int> (std::ceil (angle / maxAngle)));
+
+    for (int step = 1; step <= nSteps; ++step)
+    {
+        const int start = (step - 1) * numSamples / nSteps;
+        const int end = step * numSamples / nSteps;
+
+        const auto q = iem::Quaternion<float>::slerp (renderedQuaternion,
+                                                      target,
+                                                      static_cast<float> (step) / nSteps);
+        q.toRotationMatrix (subBlockRotMat);
+        shRotation.setRotationMatrix (subBlockRotMat, inputOrder);
+        shRotation.process (block.getSubBlock ((size_t) start, (size_t) (end - start)),
+                            actualOrder);
+    }
 
-    midiMessages.clear();
+    renderedQuaternion = target;
 }
 
-double SceneRotatorAudioProcessor::P (int i,
-                                      int l,
-                                      int a,
-                                      int b,
-                                      juce::dsp::Matrix<float>& R1,
-                                      juce::dsp::Matrix<float>& Rlm1)
+iem::Quaternion<float> SceneRotatorAudioProcessor::getRotationQuaternion()
 {
-    double ri1 = R1 (i + 1, 2);
-    double rim1 = R1 (i + 1, 0);
-    double ri0 = R1 (i + 1, 1);
-
-    if (b == -l)
-        return ri1 * Rlm1 (a + l - 1, 0) + rim1 * Rlm1 (a + l - 1, 2 * l - 2);
-    else if (b == l)
-        return ri1 * Rlm1 (a + l - 1, 2 * l - 2) - rim1 * Rlm1 (a + l - 1, 0);
-    else
-        return ri0 * Rlm1 (a + l - 1, b + l - 1);
-};
-
-double SceneRotatorAudioProcessor::U (int l,
-                                      int m,
-                                      int n,
-                                      juce::dsp::Matrix<float>& Rone,
-                                      juce::dsp::Matrix<float>& Rlm1)
+    const float wa = cos (Conversions<float>::degreesToRadians (*yaw) * 0.5f);
+    const float za =
+        sin (Conversions<float>::degreesToRadians (*yaw) * (*invertYaw >= 0.5 ? -0.5f : 0.5f));
+    const float wb = cos (Conversions<float>::degreesToRadians (*pitch) * 0.5f);
+    const float yb =
+        sin (Conversions<float>::degreesToRadians (*pitch) * (*invertPitch >= 0.5 ? -0.5f : 0.5f));
+    const float wc = cos (Conversions<float>::degreesToRadians (*roll) * 0.5f);
+    const float xc =
+        sin (Conversions<float>::degreesToRadians (*roll) * (*invertRoll >= 0.5 ? -0.5f : 0.5f));
+
+    if (*rotationSequence >= 0.5f) // roll -> pitch -> yaw (extrinsic rotations)
+        return iem::Quaternion<float> (wa * wc * wb + za * xc * yb,
+                                       wa * xc * wb - za * wc * yb,
+                                       wa * wc * yb + za * xc * wb,
+                                       za * wc * wb - wa * xc * yb);
+
+    // yaw -> pitch -> roll (extrinsic rotations)
+    return iem::Quaternion<float> (wc * wb * wa - xc * yb * za,
+                                   wc * yb * za + xc * wb * wa,
+                                   wc * yb * wa - xc * wb * za,
+                                   wc * wb * za + xc * yb * wa);
+}
+
+int SceneRotatorAudioProcessor::getUpdateIntervalInSamples()
 {
-    return P (0, l, m, n, Rone, Rlm1);
+    const int index = juce::roundToInt (updateInterval->load());
+    return index == 0 ? 0 : 8 << index;
 }
 
-double SceneRotatorAudioProcessor::V (int l,
-                                      int m,
-                                      int n,
-                                      juce::dsp::Matrix<float>& Rone,
-                                      juce::dsp::Matrix<float>& Rlm1)
+void SceneRotatorAudioProcessor::pushOrientationUpdate (float qw, float qx, float qy, float qz)
 {
-    if (m == 0)
-    {
-        auto p0 = P (1, l, 1, n, Rone, Rlm1);
-        auto p1 = P (-1, l, -1, n, Rone, Rlm1);
-        return p0 + p1;
-    }
-    else if (m > 0)
-    {
-        auto p0 = P (1, l, m - 1, n, Rone, Rlm1);
-        if (m == 1) // d = 1;
-            return p0 * sqrt (2);
-        else // d = 0;
-            return p0 - P (-1, l, 1 - m, n, Rone, Rlm1);
-    }
-    else
-    {
-        auto p1 = P (-1, l, -m - 1, n, Rone, Rlm1);
-        if (m == -1) // d = 1;
-            return p1 * sqrt (2);
-        else // d = 0;
-            return p1 + P (1, l, m + 1, n, Rone, Rlm1);
-    }
+    const juce::SpinLock::ScopedLockType lock (orientationUpdatesWriteLock);
+    OrientationUpdate update { qw, qx, qy, qz, juce::Time::getMillisecondCounterHiRes(), 0 };
+    orientationUpdates.addToQueue (&update, 1);
 }
 
-double SceneRotatorAudioProcessor::W (int l,
-                                      int m,
-                                      int n,
-                                      juce::dsp::Matrix<float>& Rone,
-                                      juce::dsp::Matrix<float>& Rlm1)
+void SceneRotatorAudioProcessor::setQuaternionParameters (float qw, float qx, float qy, float qz)
 {
-    if (m > 0)
-    {
-        auto p0 = P (1, l, m + 1, n, Rone, Rlm1);
-        auto p1 = P (-1, l, -m - 1, n, Rone, Rlm1);
-        return p0 + p1;
-    }
-    else if (m < 0)
-    {
-        auto p0 = P (1, l, m - 1, n, Rone, Rlm1);
-        auto p1 = P (-1, l, 1 - m, n, Rone, Rlm1);
-        return p0 - p1;
-    }
+    updatingParams =
+        true; // We always get all quaternions at once --> no need to update eulers four times
+    setParameterDeferringNotification ("qw",
+                                       parameters.getParameterRange ("qw").convertTo0to1 (qw),
+                                       quatChangedW);
+    setParameterDeferringNotification ("qx",
+                                       parameters.getParameterRange ("qx").convertTo0to1 (qx),
+                                       quatChangedX);
+    setParameterDeferringNotification ("qy",
+                                       parameters.getParameterRange ("qy").convertTo0to1 (qy),
+                                       quatChangedY);
+    updatingParams = false;
+    setParameterDeferringNotification ("qz",
+                                       parameters.getParameterRange ("qz").convertTo0to1 (qz),
+                                       quatChangedZ);
+}
 
-    return 0.0;
+void SceneRotatorAudioProcessor::setParameterDeferringNotification (
+    const char* parameterID,
+    const float newValue,
+    const NotifyHostFlags flag)
+{
+    NotifyHostFlags flags = 0;
+    setParameterIfChanged (parameters.getParameter (parameterID), newValue, flag, flags);
+    if (flags != 0)
+        notfyHostPending.fetch_or (flags, std::memory_order_acq_rel);
 }
 
 void SceneRotatorAudioProcessor::calcRotationMatrix (const int order)
@@ -462,50 +507,7 @@ void SceneRotatorAudioProcessor::calcRotationMatrix (const int order)
         rotMat (2, 2) = cb * cy;
     }
 
-    auto Rl = orderMatrices[1];
-
-    Rl->operator() (0, 0) = rotMat (1, 1);
-    Rl->operator() (0, 1) = rotMat (1, 2);
-    Rl->operator() (0, 2) = rotMat (1, 0);
-    Rl->operator() (1, 0) = rotMat (2, 1);
-    Rl->operator() (1, 1) = rotMat (2, 2);
-    Rl->operator() (1, 2) = rotMat (2, 0);
-    Rl->operator() (2, 0) = rotMat (0, 1);
-    Rl->operator() (2, 1) = rotMat (0, 2);
-    Rl->operator() (2, 2) = rotMat (0, 0);
-
-    for (int l = 2; l <= order; ++l)
-    {
-        auto Rone = orderMatrices[1];
-        auto Rlm1 = orderMatrices[l - 1];
-        auto Rl = orderMatrices[l];
-        for (int m = -l; m <= l; ++m)
-        {
-            for (int n = -l; n <= l; ++n)
-            {
-                const int d = (m == 0) ? 1 : 0;
-                double denom;
-                if (abs (n) == l)
-                    denom = (2 * l) * (2 * l - 1);
-                else
-                    denom = l * l - n * n;
-
-                double u = sqrt ((l * l - m * m) / denom);
-                double v = sqrt ((1.0 + d) * (l + abs (m) - 1.0) * (l + abs (m)) / denom)
-                           * (1.0 - 2.0 * d) * 0.5;
-                double w = sqrt ((l - abs (m) - 1.0) * (l - abs (m)) / denom) * (1.0 - d) * (-0.5);
-
-                if (u != 0.0)
-                    u *= U (l, m, n, *Rone, *Rlm1);
-                if (v != 0.0)
-                    v *= V (l, m, n, *Rone, *Rlm1);
-                if (w != 0.0)
-                    w *= W (l, m, n, *Rone, *Rlm1);
-
-                Rl->operator() (m + l, n + l) = u + v + w;
-            }
-        }
-    }
+    shRotation.setRotationMatrix (rotMat, order);
 
     rotationParamsHaveChanged = false;
 }
@@ -735,12 +737,19 @@ void SceneRotatorAudioProcessor::updateEuler()
 	auto* pPitch = parameters.getParameter ("pitch");
 	auto* pRoll = parameters.getParameter ("roll");
 
+    auto yawNorm = parameters.getParameterRange ("yaw").convertTo0to1 (
+        Conversions<float>::radiansToDegrees (ypr[0]));
+    auto pitchNorm = parameters.getParameterRange ("pitch").convertTo0to1 (
+        Conversions<float>::radiansToDegrees (ypr[1]));
+    auto rollNorm = parameters.getParameterRange ("roll").convertTo0to1 (
+        Conversions<float>::radiansToDegrees (ypr[2]));
+
 	NotifyHostFlags flags = 0;
 	
     updatingParams = true;
-	setParameterIfChanged(pYaw, ypr[0], yawChanged, flags);
-	setParameterIfChanged(pPitch, ypr[1], pitchChanged, flags);
-	setParameterIfChanged(pRoll, ypr[2], rollChanged, flags);
+	setParameterIfChanged(pYaw, yawNorm, yawChanged, flags);
+	setParameterIfChanged(pPitch, pitchNorm, pitchChanged, flags);
+	setParameterIfChanged(pRoll, rollNorm, rollChanged, flags);
     updatingParams = false;
 
 	if (flags != 0)
@@ -751,8 +760,6 @@ void SceneRotatorAudioProcessor::updateBuffers()
 {
     DBG ("IOHelper:  input size: " << input.getSize());
     DBG ("IOHelper: output size: " << output.getSize());
-
-    copyBuffer.setSize (input.getNumberOfChannels(), copyBuffer.getNumSamples());
 }
 
 //==============================================================================
@@ -770,6 +777,12 @@ const bool SceneRotatorAudioProcessor::interceptOSCMessage (juce::OSCMessage& me
             else if (message[i].isInt32())
                 qs[i] = message[i].getInt32();
 
+        if (getUpdateIntervalInSamples() > 0)
+        {
+            pushOrientationUpdate (qs[0], qs[1], qs[2], qs[3]);
+            return true;
+        }
+
         oscParameterInterface.setValue ("qw", qs[0]);
         oscParameterInterface.setValue ("qx", qs[1]);
         oscParameterInterface.setValue ("qy", qs[2]);
@@ -962,6 +975,20 @@ std::vector<std::unique_ptr<juce::RangedAudioParameter>>
         [] (float value) { return value >= 0.5f ? "Roll->Pitch->Yaw" : "Yaw->Pitch->Roll"; },
         nullptr));
 
+    params.push_back (OSCParameterInterface::createParameterTheOldWay (
+        "updateInterval",
+        "Rotation Update Interval",
+        "",
+        juce::NormalisableRange<float> (0.0f, 4.0f, 1.0f),
+        0.0,
+        [] (float value)
+        {
+            if (value < 0.5f)
+                return juce::String ("once per block");
+            return juce::String (8 << juce::roundToInt (value)) + " samples";
+        },
+        nullptr));
+
     return params;
 }
 
@@ -1200,17 +1227,10 @@ void SceneRotatorAudioProcessor::trackerOrientationQ (float inp_qw,
                                                       float inp_qz)
 {
     // The supperware head tracker sends quaternions with different reference system --> x and y are swapped
-    updatingParams =
-        true; // We always get all quaternions at once --> no need to update eulers four times
-    parameters.getParameter ("qw")->setValueNotifyingHost (
-        parameters.getParameterRange ("qw").convertTo0to1 (inp_qw));
-    parameters.getParameter ("qx")->setValueNotifyingHost (
-        parameters.getParameterRange ("qx").convertTo0to1 (-inp_qy));
-    parameters.getParameter ("qy")->setValueNotifyingHost (
-        parameters.getParameterRange ("qy").convertTo0to1 (inp_qx));
-    updatingParams = false;
-    parameters.getParameter ("qz")->setValueNotifyingHost (
-        parameters.getParameterRange ("qz").convertTo0to1 (-inp_qz));
+    if (getUpdateIntervalInSamples() > 0)
+        pushOrientationUpdate (inp_qw, -inp_qy, inp_qx, -inp_qz);
+    else
+        setQuaternionParameters (inp_qw, -inp_qy, inp_qx, -inp_qz);
 }
 
 //==============================================================================
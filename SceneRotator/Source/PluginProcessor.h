@@ -27,7 +27,9 @@
 
 #include "../../resources/Conversions.h"
 #include "../../resources/Quaternion.h"
+#include "../../resources/Queue.h"
 #include "../../resources/ReferenceCountedMatrix.h"
+#include "../../resources/SHRotation.h"
 
 #include "../../resources/ht-api-juce/supperware/Tracker.h"
 #include "../../resources/ht-api-juce/supperware/midi/midi.h"
@@ -88,6 +90,12 @@ public:
                        const int samples);
     void calcRotationMatrix (const int order);
 
+    /** Returns the rotation set by the yaw, pitch, and roll parameters as a quaternion. */
+    iem::Quaternion<float> getRotationQuaternion();
+
+    /** Returns the interval of the sub-block rotation updates, or 0 for one update per block. */
+    int getUpdateIntervalInSamples();
+
     //======= MIDI Connection ======================================================
     enum class MidiScheme
     {
@@ -125,6 +133,9 @@ public:
     void trackerMidiConnectionChanged (Midi::State newState) override;
     void trackerOrientationQ (float inp_qw, float inp_qx, float inp_qy, float inp_qz) override;
 
+    /** Sets all four quaternion parameters, while updating the euler angles only once. */
+    void setQuaternionParameters (float qw, float qx, float qy, float qz);
+
     //==============================================================================
     // Flags for editor
     juce::Atomic<bool> deviceHasChanged = false;
@@ -152,24 +163,46 @@ private:
     std::atomic<float>* invertRoll;
     std::atomic<float>* invertQuaternion;
     std::atomic<float>* rotationSequence;
+    std::atomic<float>* updateInterval;
 
     juce::Atomic<bool> updatingParams { false };
     juce::Atomic<bool> rotationParamsHaveChanged { true };
 
-    juce::AudioBuffer<float> copyBuffer;
+    SHRotation<7> shRotation;
+
+    //======= Sub-block rotation updates ===========================================
+    struct OrientationUpdate
+    {
+        float qw, qx, qy, qz;
+        double timeInMs;
+        int samplePosition;
+    };
+
+    // max angle of a single interpolation step at first order, divided by the order
+    static constexpr float maxSlerpStepAngle = 0.6f;
+    static constexpr int maxSlerpStepsPerSubBlock = 8;
+
+    void handleMidiMessage (const juce::MidiMessage& message);
+    void processSubBlocks (juce::AudioSampleBuffer& buffer,
+                           juce::MidiBuffer& midiMessages,
+                           const int inputOrder,
+                           const int actualOrder,
+                           const int intervalInSamples);
+    void rotateSubBlock (juce::dsp::AudioBlock<float> block,
+                         const int inputOrder,
+                         const int actualOrder,
+                         const iem::Quaternion<float>& target);
 
-    juce::OwnedArray<juce::dsp::Matrix<float>> orderMatrices;
-    juce::OwnedArray<juce::dsp::Matrix<float>> orderMatricesCopy;
+    /** Queues a quaternion received on a non-audio thread together with its arrival time. */
+    void pushOrientationUpdate (float qw, float qx, float qy, float qz);
 
-    double P (int i,
-              int l,
-              int a,
-              int b,
-              juce::dsp::Matrix<float>& R1,
-              juce::dsp::Matrix<float>& Rlm1);
-    double U (int l, int m, int n, juce::dsp::Matrix<float>& Rone, juce::dsp::Matrix<float>& Rlm1);
-    double V (int l, int m, int n, juce::dsp::Matrix<float>& Rone, juce::dsp::Matrix<float>& Rlm1);
-    double W (int l, int m, int n, juce::dsp::Matrix<float>& Rone, juce::dsp::Matrix<float>& Rlm1);
+    Queue<OrientationUpdate, 64> orientationUpdates;
+    juce::SpinLock orientationUpdatesWriteLock;
+    std::array<OrientationUpdate, 64> pendingUpdates;
+    double lastBlockTimeInMs = 0.0;
+
+    iem::Quaternion<float> renderedQuaternion;
+    juce::dsp::Matrix<float> subBlockRotMat { 3, 3 };
 
     void timerCallback() override;
     
@@ -191,6 +224,12 @@ private:
 	
     std::atomic<NotifyHostFlags> notfyHostPending { 0 };
 
+    /** Sets a parameter without notifying the host, which is done by the timer on the message
+        thread, so it can be called from the audio thread. */
+    void setParameterDeferringNotification (const char* parameterID,
+                                            const float newValue,
+                                            const NotifyHostFlags flag);
+
     inline void setParameterIfChanged(
 					juce::RangedAudioParameter*	inParam,
 					float						inNewValue,
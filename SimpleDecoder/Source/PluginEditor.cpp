@@ -376,7 +376,7 @@ void SimpleDecoderAudioProcessorEditor::loadPresetFile()
         processor.getLastDir().exists()
             ? processor.getLastDir()
             : juce::File::getSpecialLocation (juce::File::userHomeDirectory),
-        "*.json");
+        "*.json;*.iemmatrix");
     if (myChooser.browseForFileToOpen())
     {
         juce::File presetFile (myChooser.getResult());
@@ -274,6 +274,7 @@ void SimpleDecoderAudioProcessor::prepareToPlay (double sampleRate, int samplesP
     specs.sampleRate = sampleRate;
     specs.maximumBlockSize = samplesPerBlock;
     specs.numChannels = 64;
+    decoder.setInterpolationTime (0.05f);
     decoder.prepare (specs);
     decoder.setInputNormalization (*useSN3D >= 0.5f ? ReferenceCountedDecoder::Normalization::sn3d
                                                     : ReferenceCountedDecoder::Normalization::n3d);
@@ -113,6 +113,10 @@ void StereoEncoderAudioProcessor::prepareToPlay (double sampleRate, int samplesP
 
     bufferCopy.setSize (2, samplesPerBlock);
 
+    maxBlockSize = samplesPerBlock;
+    sampleWiseDirections.malloc (3 * maxBlockSize);
+    sampleWiseSH.malloc (64 * maxBlockSize);
+
     smoothAzimuthL.setCurrentAndTargetValue (*azimuth / 180.0f * juce::MathConstants<float>::pi);
     smoothElevationL.setCurrentAndTargetValue (*elevation / 180.0f
                                                * juce::MathConstants<float>::pi);
@@ -285,33 +289,21 @@ void StereoEncoderAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer
         smoothAzimuthR.setTargetValue (azimuthR);
         smoothElevationR.setTargetValue (elevationR);
 
-        for (int i = 0; i < L; ++i) // left
-        {
-            const float azimuth = smoothAzimuthL.getNextValue();
-            const float elevation = smoothElevationL.getNextValue();
-            float sample = bufferCopy.getSample (0, i);
-
-            const juce::Vector3D<float> pos =
-                Conversions<float>::sphericalToCartesian (azimuth, elevation);
-            SHEval (ambisonicOrder, pos.x, pos.y, pos.z, SHL);
-
-            for (int ch = 0; ch < nChOut; ++ch)
-                buffer.setSample (ch, i, sample * SHL[ch]);
-        }
-
-        for (int i = 0; i < L; ++i) // right
-        {
-            const float azimuth = smoothAzimuthR.getNextValue();
-            const float elevation = smoothElevationR.getNextValue();
-            float sample = bufferCopy.getSample (1, i);
-
-            const juce::Vector3D<float> pos =
-                Conversions<float>::sphericalToCartesian (azimuth, elevation);
-            SHEval (ambisonicOrder, pos.x, pos.y, pos.z, SHR);
-
-            for (int ch = 0; ch < nChOut; ++ch)
-                buffer.addSample (ch, i, sample * SHR[ch]);
-        }
+        // left
+        calcSampleWiseSH (smoothAzimuthL, smoothElevationL, ambisonicOrder, L, SHL);
+        for (int ch = 0; ch < nChOut; ++ch)
+            juce::FloatVectorOperations::multiply (buffer.getWritePointer (ch),
+                                                   bufferCopy.getReadPointer (0),
+                                                   sampleWiseSH + ch * maxBlockSize,
+                                                   L);
+
+        // right
+        calcSampleWiseSH (smoothAzimuthR, smoothElevationR, ambisonicOrder, L, SHR);
+        for (int ch = 0; ch < nChOut; ++ch)
+            juce::FloatVectorOperations::addWithMultiply (buffer.getWritePointer (ch),
+                                                          bufferCopy.getReadPointer (1),
+                                                          sampleWiseSH + ch * maxBlockSize,
+                                                          L);
 
         if (*useSN3D > 0.5f)
         {
@@ -328,6 +320,41 @@ void StereoEncoderAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer
     juce::FloatVectorOperations::copy (_SHR, SHR, nChOut);
 }
 
+void StereoEncoderAudioProcessor::calcSampleWiseSH (
+    juce::LinearSmoothedValue<float>& smoothAzimuth,
+    juce::LinearSmoothedValue<float>& smoothElevation,
+    const int ambisonicOrder,
+    const int numSamples,
+    float* lastSH)
+{
+    jassert (numSamples <= maxBlockSize);
+    if (numSamples == 0)
+        return;
+
+    float* x = sampleWiseDirections;
+    float* y = sampleWiseDirections + maxBlockSize;
+    float* z = sampleWiseDirections + 2 * maxBlockSize;
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        const float azimuth = smoothAzimuth.getNextValue();
+        const float elevation = smoothElevation.getNextValue();
+
+        const juce::Vector3D<float> pos =
+            Conversions<float>::sphericalToCartesian (azimuth, elevation);
+        x[i] = pos.x;
+        y[i] = pos.y;
+        z[i] = pos.z;
+    }
+
+    SHEvalBatch (ambisonicOrder, x, y, z, numSamples, sampleWiseSH, maxBlockSize);
+
+    // coefficients of the last sample, used as the start of the next low-quality ramp
+    const int nCh = juce::square (ambisonicOrder + 1);
+    for (int ch = 0; ch < nCh; ++ch)
+        lastSH[ch] = sampleWiseSH[ch * maxBlockSize + numSamples - 1];
+}
+
 //==============================================================================
 bool StereoEncoderAudioProcessor::hasEditor() const
 {
@@ -106,6 +106,15 @@ private:
     //==============================================================================
     bool processorUpdatingParams;
 
+    /** Evaluates the SH coefficients for each sample of the smoothed direction into
+        sampleWiseSH (one row of maxBlockSize samples per channel), and copies the coefficients
+        of the last sample to lastSH. */
+    void calcSampleWiseSH (juce::LinearSmoothedValue<float>& smoothAzimuth,
+                           juce::LinearSmoothedValue<float>& smoothElevation,
+                           const int ambisonicOrder,
+                           const int numSamples,
+                           float* lastSH);
+
     float SHL[64];
     float SHR[64];
     float _SHL[64];
@@ -117,6 +126,11 @@ private:
 
     juce::AudioBuffer<float> bufferCopy;
 
+    // directions and SH coefficients of each sample for the high-quality mode
+    int maxBlockSize = 0;
+    juce::HeapBlock<float> sampleWiseDirections;
+    juce::HeapBlock<float> sampleWiseSH;
+
     juce::LinearSmoothedValue<float> smoothAzimuthL, smoothElevationL;
     juce::LinearSmoothedValue<float> smoothAzimuthR, smoothElevationR;
 
@@ -39,8 +39,11 @@ public:
         spec = newSpec;
         matMult.prepare (newSpec, false); // we let do this class do the buffering
 
-        buffer.setSize (buffer.getNumChannels(), spec.maximumBlockSize);
+        // allocate for the highest supported order, so a new decoder won't allocate
+        buffer.setSize (maxNumInputChannels, spec.maximumBlockSize);
         buffer.clear();
+        previousBuffer.setSize (maxNumInputChannels, spec.maximumBlockSize);
+        previousBuffer.clear();
 
         checkIfNewDecoderAvailable();
     }
@@ -50,6 +53,16 @@ public:
         inputNormalization = newNormalization;
     }
 
+    /**
+     Sets the time in seconds used for crossfading from the previous to a new decoder. Both
+     decoders are rendered during the crossfade, so decoders can be changed without clicks.
+     A time of zero switches the decoders hard at the block boundary.
+     */
+    void setInterpolationTime (const float interpolationTimeInSeconds)
+    {
+        matMult.setInterpolationTime (interpolationTimeInSeconds);
+    }
+
     /**
      Decodes the Ambisonic input signals to loudspeaker signals using the current decoder.
      This method takes care of buffering the input data, so inputBlock and outputBlock are
@@ -60,51 +73,78 @@ public:
         checkIfNewDecoderAvailable();
 
         ReferenceCountedDecoder::Ptr retainedDecoder = currentDecoder;
+        if (retainedDecoder == nullptr)
+        {
+            outputBlock.clear();
+            return;
+        }
 
-        auto& T = retainedDecoder->getMatrix();
-
-        const int nInputChannels = juce::jmin (static_cast<int> (inputBlock.getNumChannels()),
-                                               static_cast<int> (T.getNumColumns()));
-        const int nSamples = static_cast<int> (inputBlock.getNumSamples());
-
-        // copy input data to buffer
-        for (int ch = 0; ch < nInputChannels; ++ch)
-            buffer.copyFrom (ch, 0, inputBlock.getChannelPointer (ch), nSamples);
+        auto ab = copyToBuffer (buffer, *retainedDecoder, inputBlock);
 
-        juce::dsp::AudioBlock<float> ab (buffer.getArrayOfWritePointers(),
-                                         nInputChannels,
-                                         0,
-                                         nSamples);
-        processInternal (ab, outputBlock);
+        ReferenceCountedDecoder::Ptr retainedPreviousDecoder = previousDecoder;
+        if (matMult.isInterpolating() && retainedPreviousDecoder != nullptr)
+        {
+            // the previous decoder might expect a different weighting of the input
+            auto previousAb = copyToBuffer (previousBuffer, *retainedPreviousDecoder, inputBlock);
+            applyDecoderWeights (*retainedPreviousDecoder, previousAb);
+            applyDecoderWeights (*retainedDecoder, ab);
+            matMult.processNonReplacing (ab, outputBlock, false, &previousAb);
+        }
+        else
+        {
+            matMult.retireMatrix (previousDecoder);
+            applyDecoderWeights (*retainedDecoder, ab);
+            matMult.processNonReplacing (ab, outputBlock, false);
+        }
     }
 
+    /**
+     Takes over a new decoder, unless the crossfade to the current one is still running or the
+     replaced decoders can't be retired yet. Decoders larger than prepared for are rejected, so
+     nothing is allocated on the audio thread.
+     */
     const bool checkIfNewDecoderAvailable()
     {
-        if (newDecoderAvailable)
+        if (newDecoderAvailable && ! matMult.isInterpolating())
         {
+            if (newDecoder != nullptr
+                && (newDecoder->getNumInputChannels() > buffer.getNumChannels()
+                    || ! matMult.fitsPreparedSize (*newDecoder)))
+            {
+                DBG ("AmbisonicDecoder: Decoder larger than prepared for, ignoring it.");
+                if (matMult.retireMatrix (newDecoder))
+                    newDecoderAvailable = false;
+                return false;
+            }
+
+            // the previous decoder and the two matrices replaced by matMult
+            if (! matMult.canRetire (3))
+                return false;
+
             newDecoderAvailable = false;
+            matMult.retireMatrix (previousDecoder);
+            previousDecoder = currentDecoder;
             currentDecoder = newDecoder;
             newDecoder = nullptr;
 
-            if (currentDecoder != nullptr)
-            {
-                currentDecoder->removeAppliedWeights();
-                const int cols = (int) currentDecoder->getMatrix().getNumColumns();
-                buffer.setSize (cols, buffer.getNumSamples());
-            }
-
-            matMult.setMatrix (currentDecoder, true);
+            matMult.setMatrix (currentDecoder, true); // taken over right away
             return true;
         }
         return false;
     };
 
-    /** Giving the AmbisonicDecoder a new decoder for the audio processing. Note: The AmbisonicDecoder will call the removeAppliedWeights() of the ReferenceCountedDecoder before it processes audio! The matrix elements may change due to this method.
+    /** Giving the AmbisonicDecoder a new decoder for the audio processing. Note: This method
+        calls the removeAppliedWeights() of the ReferenceCountedDecoder, so the matrix elements
+        may change. It has to be called from a non-realtime thread.
      */
     void setDecoder (ReferenceCountedDecoder::Ptr newDecoderToUse)
     {
+        if (newDecoderToUse != nullptr)
+            newDecoderToUse->removeAppliedWeights();
+
         newDecoder = newDecoderToUse;
         newDecoderAvailable = true;
+        matMult.releaseRetiredMatrices();
     }
 
     ReferenceCountedDecoder::Ptr getCurrentDecoder() { return currentDecoder; }
@@ -115,62 +155,69 @@ public:
 
 private:
     /**
-     Decodes the Ambisonic input signals to loudspeaker signals using the current decoder. Keep in mind that the input data will be changed!
+     Copies the channels of the inputBlock needed by the decoder into the buffer and returns
+     an AudioBlock referring to them.
      */
-    void processInternal (juce::dsp::AudioBlock<float> inputBlock,
-                          juce::dsp::AudioBlock<float> outputBlock)
+    juce::dsp::AudioBlock<float> copyToBuffer (juce::AudioBuffer<float>& destination,
+                                               ReferenceCountedDecoder& decoder,
+                                               const juce::dsp::AudioBlock<float>& inputBlock)
     {
-        // you should call the processReplacing instead, it will buffer the input data
-        // this is a weak check, as e.g. if number channels differ, it won't trigger
-        jassert (inputBlock != outputBlock);
+        const int nInputChannels =
+            juce::jmin (static_cast<int> (inputBlock.getNumChannels()),
+                        static_cast<int> (decoder.getMatrix().getNumColumns()),
+                        destination.getNumChannels());
+        const int nSamples = static_cast<int> (inputBlock.getNumSamples());
 
-        juce::ScopedNoDenormals noDenormals;
+        for (int ch = 0; ch < nInputChannels; ++ch)
+            destination.copyFrom (ch, 0, inputBlock.getChannelPointer (ch), nSamples);
 
-        ReferenceCountedDecoder::Ptr retainedDecoder = currentDecoder;
+        return juce::dsp::AudioBlock<float> (destination.getArrayOfWritePointers(),
+                                             nInputChannels,
+                                             0,
+                                             nSamples);
+    }
 
-        if (retainedDecoder != nullptr) // if decoder is available, do the pre-processing
-        {
-            const int order = isqrt (static_cast<int> (inputBlock.getNumChannels())) - 1;
-            const int chAmbi = juce::square (order + 1);
-            const int numSamples = static_cast<int> (inputBlock.getNumSamples());
+    /**
+     Applies the order correction, the decoder's weights and the normalization conversion to the buffered input signals.
+     */
+    void applyDecoderWeights (ReferenceCountedDecoder& decoder,
+                              juce::dsp::AudioBlock<float>& inputBlock)
+    {
+        const int order = isqrt (static_cast<int> (inputBlock.getNumChannels())) - 1;
+        const int chAmbi = juce::square (order + 1);
+        const int numSamples = static_cast<int> (inputBlock.getNumSamples());
 
-            float weights[64];
-            const float correction =
-                std::sqrt (std::sqrt ((static_cast<float> (retainedDecoder->getOrder()) + 1)
-                                      / (static_cast<float> (order) + 1)));
-            juce::FloatVectorOperations::fill (weights, correction, chAmbi);
+        float weights[64];
+        const float correction =
+            std::sqrt (std::sqrt ((static_cast<float> (decoder.getOrder()) + 1)
+                                  / (static_cast<float> (order) + 1)));
+        juce::FloatVectorOperations::fill (weights, correction, chAmbi);
 
-            if (retainedDecoder->getSettings().weights == ReferenceCountedDecoder::Weights::maxrE)
-            {
-                multiplyMaxRE (order, weights);
-                juce::FloatVectorOperations::multiply (weights,
-                                                       maxRECorrectionEnergy[order],
-                                                       chAmbi);
-            }
-            else if (retainedDecoder->getSettings().weights
-                     == ReferenceCountedDecoder::Weights::inPhase)
-            {
-                multiplyInPhase (order, weights);
-                juce::FloatVectorOperations::multiply (weights,
-                                                       inPhaseCorrectionEnergy[order],
-                                                       chAmbi);
-            }
-
-            if (retainedDecoder->getSettings().expectedNormalization != inputNormalization)
-            {
-                const float* conversionPtr (
-                    inputNormalization == ReferenceCountedDecoder::Normalization::sn3d ? sn3d2n3d
-                                                                                       : n3d2sn3d);
-                juce::FloatVectorOperations::multiply (weights, conversionPtr, chAmbi);
-            }
+        if (decoder.getSettings().weights == ReferenceCountedDecoder::Weights::maxrE)
+        {
+            multiplyMaxRE (order, weights);
+            juce::FloatVectorOperations::multiply (weights, maxRECorrectionEnergy[order], chAmbi);
+        }
+        else if (decoder.getSettings().weights == ReferenceCountedDecoder::Weights::inPhase)
+        {
+            multiplyInPhase (order, weights);
+            juce::FloatVectorOperations::multiply (weights,
+                                                   inPhaseCorrectionEnergy[order],
+                                                   chAmbi);
+        }
 
-            for (int ch = 0; ch < chAmbi; ++ch)
-                juce::FloatVectorOperations::multiply (inputBlock.getChannelPointer (ch),
-                                                       weights[ch],
-                                                       numSamples);
+        if (decoder.getSettings().expectedNormalization != inputNormalization)
+        {
+            const float* conversionPtr (
+                inputNormalization == ReferenceCountedDecoder::Normalization::sn3d ? sn3d2n3d
+                                                                                   : n3d2sn3d);
+            juce::FloatVectorOperations::multiply (weights, conversionPtr, chAmbi);
         }
 
-        matMult.processNonReplacing (inputBlock, outputBlock);
+        for (int ch = 0; ch < chAmbi; ++ch)
+            juce::FloatVectorOperations::multiply (inputBlock.getChannelPointer (ch),
+                                                   weights[ch],
+                                                   numSamples);
     }
 
 private:
@@ -180,7 +227,10 @@ private:
     ReferenceCountedDecoder::Ptr newDecoder { nullptr };
     bool newDecoderAvailable { false };
 
-    juce::AudioBuffer<float> buffer;
+    ReferenceCountedDecoder::Ptr previousDecoder { nullptr };
+
+    static constexpr int maxNumInputChannels = 64;
+    juce::AudioBuffer<float> buffer, previousBuffer;
 
     ReferenceCountedDecoder::Normalization inputNormalization {
         ReferenceCountedDecoder::Normalization::sn3d
@@ -23,31 +23,19 @@
 
 #include "Conversions.h"
 #include "Quaternion.h"
+#include "SHRotation.h"
 #include "ambisonicTools.h"
 
 template <int maxOrder = 7>
 class AmbisonicRotator
 {
 public:
-    AmbisonicRotator()
-    {
-        orderMatrices.add (new juce::dsp::Matrix<float> (0, 0)); // 0th
-        orderMatricesCopy.add (new juce::dsp::Matrix<float> (0, 0)); // 0th
-
-        for (int l = 1; l <= maxOrder; ++l)
-        {
-            const int nCh = (2 * l + 1);
-            auto elem = orderMatrices.add (new juce::dsp::Matrix<float> (nCh, nCh));
-            elem->clear();
-            auto elemCopy = orderMatricesCopy.add (new juce::dsp::Matrix<float> (nCh, nCh));
-            elemCopy->clear();
-        }
-
-        copyBuffer.setSize (maxChannels, maxChannels);
-    };
+    AmbisonicRotator() {};
 
     ~AmbisonicRotator() {};
 
+    void prepare (const int maximumBlockSize) { rotation.prepare (maximumBlockSize); }
+
     void process (juce::AudioBuffer<float>* bufferToRotate)
     {
         // Get samples per block and actual number of channels
@@ -59,11 +47,6 @@ public:
 
         const int actualChannels = squares[workingOrder + 1];
 
-        // Resize copyBuffer if necessary
-        if ((copyBuffer.getNumChannels() != actualChannels)
-            || (copyBuffer.getNumSamples() != samples))
-            copyBuffer.setSize (actualChannels, samples);
-
         // Calculate new rotation matrix if necessary
         if (workingOrder != orderSetting)
         {
@@ -71,47 +54,15 @@ public:
             rotationParamsHaveChanged = true;
         }
 
-        bool newRotationMatrix = false;
         if (rotationParamsHaveChanged.get())
-        {
-            newRotationMatrix = true;
             calcRotationMatrix (workingOrder);
-        }
 
-        // make copy of input
-        for (int ch = 0; ch < actualChannels; ++ch)
-            copyBuffer.copyFrom (ch, 0, bufferToRotate->getReadPointer (ch), samples);
+        // rotate buffer, fading between old and new matrices
+        rotation.process (juce::dsp::AudioBlock<float> (*bufferToRotate), workingOrder);
 
-        // clear all channels except first
-        for (int ch = 1; ch < bufferToRotate->getNumChannels(); ++ch)
+        // clear all channels above the working order
+        for (int ch = actualChannels; ch < bufferChannels; ++ch)
             bufferToRotate->clear (ch, 0, samples);
-
-        // rotate buffer
-        for (int l = 1; l <= workingOrder; ++l)
-        {
-            const int offset = l * l;
-            const int nCh = 2 * l + 1;
-            auto R = orderMatrices[l];
-            auto Rcopy = orderMatricesCopy[l];
-            for (int o = 0; o < nCh; ++o)
-            {
-                const int chOut = offset + o;
-                for (int p = 0; p < nCh; ++p)
-                {
-                    bufferToRotate->addFromWithRamp (chOut,
-                                                     0,
-                                                     copyBuffer.getReadPointer (offset + p),
-                                                     samples,
-                                                     Rcopy->operator() (o, p),
-                                                     R->operator() (o, p));
-                }
-            }
-        }
-
-        // make copies for fading between old and new matrices
-        if (newRotationMatrix)
-            for (int l = 1; l <= workingOrder; ++l)
-                *orderMatricesCopy[l] = *orderMatrices[l];
     }
 
     void updateParams (float yaw, float pitch, float roll, float order)
@@ -127,70 +78,6 @@ public:
     const int getOrder() { return orderSetting; }
 
 private:
-    double
-        P (int i, int l, int a, int b, juce::dsp::Matrix<float>& R1, juce::dsp::Matrix<float>& Rlm1)
-    {
-        double ri1 = R1 (i + 1, 2);
-        double rim1 = R1 (i + 1, 0);
-        double ri0 = R1 (i + 1, 1);
-
-        if (b == -l)
-            return ri1 * Rlm1 (a + l - 1, 0) + rim1 * Rlm1 (a + l - 1, 2 * l - 2);
-        else if (b == l)
-            return ri1 * Rlm1 (a + l - 1, 2 * l - 2) - rim1 * Rlm1 (a + l - 1, 0);
-        else
-            return ri0 * Rlm1 (a + l - 1, b + l - 1);
-    };
-
-    double U (int l, int m, int n, juce::dsp::Matrix<float>& Rone, juce::dsp::Matrix<float>& Rlm1)
-    {
-        return P (0, l, m, n, Rone, Rlm1);
-    }
-
-    double V (int l, int m, int n, juce::dsp::Matrix<float>& Rone, juce::dsp::Matrix<float>& Rlm1)
-    {
-        if (m == 0)
-        {
-            auto p0 = P (1, l, 1, n, Rone, Rlm1);
-            auto p1 = P (-1, l, -1, n, Rone, Rlm1);
-            return p0 + p1;
-        }
-        else if (m > 0)
-        {
-            auto p0 = P (1, l, m - 1, n, Rone, Rlm1);
-            if (m == 1) // d = 1;
-                return p0 * sqrt (2);
-            else // d = 0;
-                return p0 - P (-1, l, 1 - m, n, Rone, Rlm1);
-        }
-        else
-        {
-            auto p1 = P (-1, l, -m - 1, n, Rone, Rlm1);
-            if (m == -1) // d = 1;
-                return p1 * sqrt (2);
-            else // d = 0;
-                return p1 + P (1, l, m + 1, n, Rone, Rlm1);
-        }
-    }
-
-    double W (int l, int m, int n, juce::dsp::Matrix<float>& Rone, juce::dsp::Matrix<float>& Rlm1)
-    {
-        if (m > 0)
-        {
-            auto p0 = P (1, l, m + 1, n, Rone, Rlm1);
-            auto p1 = P (-1, l, -m - 1, n, Rone, Rlm1);
-            return p0 + p1;
-        }
-        else if (m < 0)
-        {
-            auto p0 = P (1, l, m - 1, n, Rone, Rlm1);
-            auto p1 = P (-1, l, 1 - m, n, Rone, Rlm1);
-            return p0 - p1;
-        }
-
-        return 0.0;
-    }
-
     void calcRotationMatrix (const int order)
     {
         auto ca = std::cos (yawRadians);
@@ -232,65 +119,16 @@ private:
         rotMat (2, 2) = cb * cy;
         // }
 
-        auto Rl = orderMatrices[1];
-
-        Rl->operator() (0, 0) = rotMat (1, 1);
-        Rl->operator() (0, 1) = rotMat (1, 2);
-        Rl->operator() (0, 2) = rotMat (1, 0);
-        Rl->operator() (1, 0) = rotMat (2, 1);
-        Rl->operator() (1, 1) = rotMat (2, 2);
-        Rl->operator() (1, 2) = rotMat (2, 0);
-        Rl->operator() (2, 0) = rotMat (0, 1);
-        Rl->operator() (2, 1) = rotMat (0, 2);
-        Rl->operator() (2, 2) = rotMat (0, 0);
-
-        for (int l = 2; l <= order; ++l)
-        {
-            auto Rone = orderMatrices[1];
-            auto Rlm1 = orderMatrices[l - 1];
-            auto Rl = orderMatrices[l];
-            for (int m = -l; m <= l; ++m)
-            {
-                for (int n = -l; n <= l; ++n)
-                {
-                    const int d = (m == 0) ? 1 : 0;
-                    double denom;
-                    if (abs (n) == l)
-                        denom = (2 * l) * (2 * l - 1);
-                    else
-                        denom = l * l - n * n;
-
-                    double u = sqrt ((l * l - m * m) / denom);
-                    double v = sqrt ((1.0 + d) * (l + abs (m) - 1.0) * (l + abs (m)) / denom)
-                               * (1.0 - 2.0 * d) * 0.5;
-                    double w =
-                        sqrt ((l - abs (m) - 1.0) * (l - abs (m)) / denom) * (1.0 - d) * (-0.5);
-
-                    if (u != 0.0)
-                        u *= U (l, m, n, *Rone, *Rlm1);
-                    if (v != 0.0)
-                        v *= V (l, m, n, *Rone, *Rlm1);
-                    if (w != 0.0)
-                        w *= W (l, m, n, *Rone, *Rlm1);
-
-                    Rl->operator() (m + l, n + l) = u + v + w;
-                }
-            }
-        }
+        rotation.setRotationMatrix (rotMat, order);
 
         rotationParamsHaveChanged = false;
     }
 
-    static constexpr int maxChannels = (maxOrder + 1) * (maxOrder + 1);
-
     float yawRadians { 0.0f };
     float pitchRadians { 0.0f };
     float rollRadians { 0.0f };
     int orderSetting { 0 };
 
-    juce::AudioBuffer<float> copyBuffer;
-
-    juce::OwnedArray<juce::dsp::Matrix<float>> orderMatrices;
-    juce::OwnedArray<juce::dsp::Matrix<float>> orderMatricesCopy;
+    SHRotation<maxOrder> rotation;
     juce::Atomic<bool> rotationParamsHaveChanged { true };
 };
\ No newline at end of file
@@ -64,14 +64,14 @@ public:
         _usedChannels = squares[_workingOrder + 1];
 
         // Calculate decoder matrix
-        float tmp_SH[maxChannels];
-        for (int p = 0; p < tDesignN; ++p)
-        {
-            SHEval (maxOrder, tDesignX[p], tDesignY[p], tDesignZ[p], tmp_SH, false);
-
-            for (int r = 0; r < maxChannels; ++r)
-                _Y (r, p) = tmp_SH[r];
-        }
+        SHEvalBatch (maxOrder,
+                     tDesignX,
+                     tDesignY,
+                     tDesignZ,
+                     tDesignN,
+                     _Y.getRawDataPointer(),
+                     tDesignN,
+                     false);
         _Y *= 1.0f / decodeCorrection (maxOrder);
 
         calculateWarpingMatrix();
@@ -114,6 +114,65 @@ public:
         }
     }
 
+    /**
+     Computes the gains of several independent compressors, each driven by its own side chain
+     signal, e.g. one per frequency band. With SSE, four compressors are processed at once in the
+     lanes of a SIMD register. The levels are computed with fast log2 / exp2 approximations
+     (level errors below 1e-4 dB) and a branch-free knee, so the results match the ones of
+     getGainFromSidechainSignal(), which is kept as scalar reference, within that tolerance.
+     */
+    static void getGainsFromSidechainSignals (Compressor* const* compressors,
+                                              const float* const* sideChainSignals,
+                                              float* const* destinations,
+                                              const int numCompressors,
+                                              const int numSamples)
+    {
+#if JUCE_USE_SSE_INTRINSICS
+        for (int c = 0; c < numCompressors; c += numLanes)
+            getGainsFromSidechainSignalsSSE (compressors + c,
+                                             sideChainSignals + c,
+                                             destinations + c,
+                                             juce::jmin (numLanes, numCompressors - c),
+                                             numSamples);
+#else /* !JUCE_USE_SSE_INTRINSICS */
+        for (int c = 0; c < numCompressors; ++c)
+            compressors[c]->getGainFromSidechainSignalFast (sideChainSignals[c],
+                                                            destinations[c],
+                                                            numSamples);
+#endif /* JUCE_USE_SSE_INTRINSICS */
+    }
+
+    /**
+     Converts gain reductions in decibels plus an offset (e.g. the make-up gain) to gain values,
+     using the fast exp2 approximation of getGainsFromSidechainSignals(). Like
+     juce::Decibels::decibelsToGain(), levels at or below -100 dB result in a gain of zero.
+     Source and destination may be the same.
+     */
+    static void decibelsToGain (const float* decibels,
+                                float* destination,
+                                const float offsetInDecibels,
+                                const int numSamples)
+    {
+        int i = 0;
+#if JUCE_USE_SSE_INTRINSICS
+        const __m128 offset = _mm_set1_ps (offsetInDecibels);
+        const __m128 vMinusInfinityDb = _mm_set1_ps (minusInfinityDb);
+        const __m128 vLog2PerDecibel = _mm_set1_ps (log2PerDecibel);
+        for (; i <= numSamples - numLanes; i += numLanes)
+        {
+            const __m128 level = _mm_add_ps (_mm_loadu_ps (decibels + i), offset);
+            const __m128 gain = fastExp2 (_mm_mul_ps (vLog2PerDecibel, level));
+            _mm_storeu_ps (destination + i,
+                           _mm_and_ps (_mm_cmpgt_ps (level, vMinusInfinityDb), gain));
+        }
+#endif /* JUCE_USE_SSE_INTRINSICS */
+        for (; i < numSamples; ++i)
+        {
+            const float level = decibels[i] + offsetInDecibels;
+            destination[i] = level > minusInfinityDb ? fastExp2 (log2PerDecibel * level) : 0.0f;
+        }
+    }
+
     void getGainFromSidechainSignalInDecibelsWithoutMakeUpGain (const float* sideChainSignal,
                                                                 float* destination,
                                                                 const int numSamples)
@@ -156,6 +215,230 @@ public:
     }
 
 private:
+    // 20 * log10 (2) and log2 (10) / 20, converting between log2 and decibels
+    static constexpr float decibelsPerLog2 = 6.0205999f;
+    static constexpr float log2PerDecibel = 0.16609640f;
+
+    // Juce's gainToDecibels() and decibelsToGain() treat levels below -100 dB as silence
+    static constexpr float minusInfinityDb = -100.0f;
+    static constexpr float minGain = 1.0e-5f;
+
+    /** Minimax polynomial approximations of log2 (1 + x) and exp2 (x) for x in [0, 1), the
+        absolute errors are below 1.5e-5 and the relative ones below 2.6e-6 respectively. */
+    static constexpr float log2Coefficients[5] = { 1.44196546f,
+                                                   -0.709661267f,
+                                                   0.417591017f,
+                                                   -0.196263863f,
+                                                   0.0463829485f };
+    static constexpr float exp2Coefficients[5] = { 1.00000259f,
+                                                   0.693003846f,
+                                                   0.241442714f,
+                                                   0.0520115144f,
+                                                   0.0135341469f };
+
+    static float fastLog2 (const float x)
+    {
+        juce::uint32 bits;
+        std::memcpy (&bits, &x, sizeof (bits));
+
+        const float exponent = static_cast<float> (static_cast<int> (bits >> 23) - 127);
+        bits = (bits & 0x007fffffu) | 0x3f800000u;
+
+        float mantissa;
+        std::memcpy (&mantissa, &bits, sizeof (mantissa));
+        const float t = mantissa - 1.0f;
+
+        float p = log2Coefficients[4];
+        for (int k = 3; k >= 0; --k)
+            p = p * t + log2Coefficients[k];
+
+        return exponent + p * t;
+    }
+
+    static float fastExp2 (float x)
+    {
+        x = juce::jlimit (-126.0f, 126.0f, x);
+        const float integer = std::floor (x);
+        const float t = x - integer;
+
+        float p = exp2Coefficients[4];
+        for (int k = 3; k >= 0; --k)
+            p = p * t + exp2Coefficients[k];
+
+        const auto bits = static_cast<juce::uint32> (static_cast<int> (integer) + 127) << 23;
+        float scale;
+        std::memcpy (&scale, &bits, sizeof (scale));
+
+        return p * scale;
+    }
+
+    /** Same as getGainFromSidechainSignal() with the fast approximations and branch-free knee
+        of getGainsFromSidechainSignals(), for platforms without SSE. */
+    void getGainFromSidechainSignalFast (const float* sideChainSignal,
+                                         float* destination,
+                                         const int numSamples)
+    {
+        const float halfOverKnee = knee > 0.0f ? 0.5f / knee : 0.0f;
+        const float attack = static_cast<float> (alphaAttack);
+        const float release = static_cast<float> (alphaRelease);
+
+        maxLevel = -INFINITY;
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const float gain = juce::jmax (std::abs (sideChainSignal[i]), minGain);
+            const float levelInDecibels =
+                juce::jmax (minusInfinityDb, decibelsPerLog2 * fastLog2 (gain));
+            maxLevel = juce::jmax (maxLevel, levelInDecibels);
+
+            // knee and ratio: the quadratic part is limited to the knee width, the linear part
+            // starts above it, so all three segments of the characteristic are covered
+            const float overShoot = levelInDecibels - threshold;
+            const float kneeInput = juce::jlimit (0.0f, knee, overShoot + kneeHalf);
+            const float gainReduction = slope
+                                        * (kneeInput * kneeInput * halfOverKnee
+                                           + juce::jmax (0.0f, overShoot - kneeHalf));
+
+            const float diff = gainReduction - state;
+            state += (diff < 0.0f ? attack : release) * diff;
+
+            const float stateWithMakeUp = state + makeUpGain;
+            destination[i] = stateWithMakeUp > minusInfinityDb
+                                 ? fastExp2 (log2PerDecibel * stateWithMakeUp)
+                                 : 0.0f;
+        }
+    }
+
+#if JUCE_USE_SSE_INTRINSICS
+    static constexpr int numLanes = 4;
+
+    static __m128 fastLog2 (const __m128 x)
+    {
+        const __m128i bits = _mm_castps_si128 (x);
+        const __m128 exponent = _mm_cvtepi32_ps (
+            _mm_sub_epi32 (_mm_srli_epi32 (bits, 23), _mm_set1_epi32 (127)));
+        const __m128 mantissa = _mm_castsi128_ps (
+            _mm_or_si128 (_mm_and_si128 (bits, _mm_set1_epi32 (0x007fffff)),
+                          _mm_set1_epi32 (0x3f800000)));
+        const __m128 t = _mm_sub_ps (mantissa, _mm_set1_ps (1.0f));
+
+        __m128 p = _mm_set1_ps (log2Coefficients[4]);
+        for (int k = 3; k >= 0; --k)
+            p = _mm_add_ps (_mm_mul_ps (p, t), _mm_set1_ps (log2Coefficients[k]));
+
+        return _mm_add_ps (exponent, _mm_mul_ps (p, t));
+    }
+
+    static __m128 fastExp2 (__m128 x)
+    {
+        x = _mm_min_ps (_mm_max_ps (x, _mm_set1_ps (-126.0f)), _mm_set1_ps (126.0f));
+
+        // floor without SSE4.1: truncate and subtract one for negative fractions
+        __m128i integer = _mm_cvttps_epi32 (x);
+        const __m128 truncated = _mm_cvtepi32_ps (integer);
+        integer = _mm_add_epi32 (integer, _mm_castps_si128 (_mm_cmpgt_ps (truncated, x)));
+        const __m128 t = _mm_sub_ps (x, _mm_cvtepi32_ps (integer));
+
+        __m128 p = _mm_set1_ps (exp2Coefficients[4]);
+        for (int k = 3; k >= 0; --k)
+            p = _mm_add_ps (_mm_mul_ps (p, t), _mm_set1_ps (exp2Coefficients[k]));
+
+        const __m128 scale =
+            _mm_castsi128_ps (_mm_slli_epi32 (_mm_add_epi32 (integer, _mm_set1_epi32 (127)), 23));
+        return _mm_mul_ps (p, scale);
+    }
+
+    static void getGainsFromSidechainSignalsSSE (Compressor* const* compressors,
+                                                 const float* const* sideChainSignals,
+                                                 float* const* destinations,
+                                                 const int numActiveLanes,
+                                                 const int numSamples)
+    {
+        // unused lanes process the last compressor again, their results are discarded
+        alignas (16) float threshold[numLanes], kneeHalf[numLanes], knee[numLanes],
+            halfOverKnee[numLanes], slope[numLanes], makeUpGain[numLanes], attack[numLanes],
+            release[numLanes], state[numLanes], maxLevel[numLanes];
+        const float* inputs[numLanes];
+
+        for (int lane = 0; lane < numLanes; ++lane)
+        {
+            const int c = juce::jmin (lane, numActiveLanes - 1);
+            const auto& comp = *compressors[c];
+            threshold[lane] = comp.threshold;
+            kneeHalf[lane] = comp.kneeHalf;
+            knee[lane] = comp.knee;
+            halfOverKnee[lane] = comp.knee > 0.0f ? 0.5f / comp.knee : 0.0f;
+            slope[lane] = comp.slope;
+            makeUpGain[lane] = comp.makeUpGain;
+            attack[lane] = static_cast<float> (comp.alphaAttack);
+            release[lane] = static_cast<float> (comp.alphaRelease);
+            state[lane] = comp.state;
+            inputs[lane] = sideChainSignals[c];
+        }
+
+        const __m128 vThreshold = _mm_load_ps (threshold);
+        const __m128 vKneeHalf = _mm_load_ps (kneeHalf);
+        const __m128 vKnee = _mm_load_ps (knee);
+        const __m128 vHalfOverKnee = _mm_load_ps (halfOverKnee);
+        const __m128 vSlope = _mm_load_ps (slope);
+        const __m128 vMakeUpGain = _mm_load_ps (makeUpGain);
+        const __m128 vAttack = _mm_load_ps (attack);
+        const __m128 vRelease = _mm_load_ps (release);
+        const __m128 absMask = _mm_castsi128_ps (_mm_set1_epi32 (0x7fffffff));
+        const __m128 vZero = _mm_setzero_ps();
+        const __m128 vMinusInfinityDb = _mm_set1_ps (minusInfinityDb);
+
+        __m128 vState = _mm_load_ps (state);
+        __m128 vMaxLevel = _mm_set1_ps (-INFINITY);
+
+        alignas (16) float in[numLanes], out[numLanes];
+        for (int i = 0; i < numSamples; ++i)
+        {
+            for (int lane = 0; lane < numLanes; ++lane)
+                in[lane] = inputs[lane][i];
+
+            const __m128 gain = _mm_max_ps (_mm_and_ps (_mm_load_ps (in), absMask),
+                                            _mm_set1_ps (minGain));
+            const __m128 levelInDecibels =
+                _mm_max_ps (vMinusInfinityDb,
+                            _mm_mul_ps (_mm_set1_ps (decibelsPerLog2), fastLog2 (gain)));
+            vMaxLevel = _mm_max_ps (vMaxLevel, levelInDecibels);
+
+            // knee and ratio, see getGainFromSidechainSignalFast()
+            const __m128 overShoot = _mm_sub_ps (levelInDecibels, vThreshold);
+            const __m128 kneeInput =
+                _mm_min_ps (_mm_max_ps (_mm_add_ps (overShoot, vKneeHalf), vZero), vKnee);
+            const __m128 gainReduction = _mm_mul_ps (
+                vSlope,
+                _mm_add_ps (_mm_mul_ps (_mm_mul_ps (kneeInput, kneeInput), vHalfOverKnee),
+                            _mm_max_ps (_mm_sub_ps (overShoot, vKneeHalf), vZero)));
+
+            // ballistics: attack where the gain reduction increases, release otherwise
+            const __m128 diff = _mm_sub_ps (gainReduction, vState);
+            const __m128 isAttack = _mm_cmplt_ps (diff, vZero);
+            const __m128 alpha = _mm_or_ps (_mm_and_ps (isAttack, vAttack),
+                                            _mm_andnot_ps (isAttack, vRelease));
+            vState = _mm_add_ps (vState, _mm_mul_ps (alpha, diff));
+
+            const __m128 stateWithMakeUp = _mm_add_ps (vState, vMakeUpGain);
+            const __m128 result =
+                _mm_and_ps (_mm_cmpgt_ps (stateWithMakeUp, vMinusInfinityDb),
+                            fastExp2 (_mm_mul_ps (_mm_set1_ps (log2PerDecibel), stateWithMakeUp)));
+            _mm_store_ps (out, result);
+
+            for (int lane = 0; lane < numActiveLanes; ++lane)
+                destinations[lane][i] = out[lane];
+        }
+
+        _mm_store_ps (state, vState);
+        _mm_store_ps (maxLevel, vMaxLevel);
+        for (int lane = 0; lane < numActiveLanes; ++lane)
+        {
+            compressors[lane]->state = state[lane];
+            compressors[lane]->maxLevel = maxLevel[lane];
+        }
+    }
+#endif /* JUCE_USE_SSE_INTRINSICS */
+
     double sampleRate { 0.0 };
     bool prepared;
 
@@ -108,6 +108,9 @@ public:
     {
         jassert (dest != nullptr);
 
+        if (isBinaryConfigurationFile (fileToParse))
+            return parseBinaryFileForTransformationMatrix (fileToParse, dest);
+
         // parsing configuration file
         juce::var parsedJson;
         {
@@ -162,6 +165,8 @@ public:
         if (! result.wasOk())
             return juce::Result::fail (result.getErrorMessage());
 
+        newMatrix->analyseStructure();
+
         *matrix = newMatrix;
         return juce::Result::ok();
     }
@@ -319,6 +324,7 @@ public:
         }
 
         newDecoder->setSettings (settings);
+        newDecoder->analyseStructure();
 
         *decoder = newDecoder;
         return juce::Result::ok();
@@ -357,6 +363,9 @@ public:
     {
         jassert (decoder != nullptr);
 
+        if (isBinaryConfigurationFile (fileToParse))
+            return parseBinaryFileForDecoder (fileToParse, decoder);
+
         // parsing configuration file
         juce::var parsedJson;
         juce::Result result = parseFile (fileToParse, parsedJson);
@@ -742,6 +751,425 @@ public:
 
 #endif //#if CONFIGURATIONHELPER_ENABLE_GENERICLAYOUT_METHODS
 
+#if CONFIGURATIONHELPER_ENABLE_MATRIX_METHODS
+    // =============== BINARY CONTAINER ============================================
+    /*
+     Versioned binary container for matrices and decoders, which can be memory-mapped and
+     copied into a ReferenceCountedMatrix without parsing. All values are little endian.
+
+        offset  type                    content
+        0       char[4]                 magic "IEMM"
+        4       uint32                  version
+        8       uint32                  content type (0: TransformationMatrix, 1: Decoder)
+        12      uint32                  rows
+        16      uint32                  columns
+        20      uint32                  name length in bytes (UTF-8)
+        24      uint32                  description length in bytes (UTF-8)
+        28      uint32                  offset of the matrix payload (multiple of 64)
+        32      int32                   expected input normalization (0: n3d, 1: sn3d)
+        36      int32                   weights (0: none, 1: maxrE, 2: inPhase)
+        40      int32                   weights already applied (0 or 1)
+        44      int32                   subwoofer channel (one-based, 0 if none)
+        48      (reserved)
+        64      char[]                  name, followed by description
+                int32[rows]             routing (zero-based)
+                float32[rows * columns] row-major matrix payload
+     */
+    static constexpr juce::uint32 binaryVersion = 1;
+    static constexpr int binaryHeaderSize = 64;
+    static constexpr int binaryPayloadAlignment = 64;
+
+    enum class BinaryContentType
+    {
+        transformationMatrix = 0,
+        decoder = 1
+    };
+
+    struct BinaryHeader
+    {
+        BinaryContentType contentType = BinaryContentType::transformationMatrix;
+        int rows = 0, columns = 0;
+        juce::String name, description;
+        const juce::int32* routing = nullptr;
+        const float* payload = nullptr;
+        int expectedNormalization = 1, weights = 0, weightsAlreadyApplied = 0;
+        int subwooferChannel = 0;
+    };
+
+    /**
+     Returns true if the file starts with the magic bytes of the binary container.
+     */
+    static bool isBinaryConfigurationFile (const juce::File& file)
+    {
+        juce::FileInputStream stream (file);
+        if (! stream.openedOk())
+            return false;
+
+        char magic[4];
+        return stream.read (magic, 4) == 4 && magic[0] == 'I' && magic[1] == 'E'
+               && magic[2] == 'M' && magic[3] == 'M';
+    }
+
+    /**
+     Parses the header of a memory-mapped binary container. On success, the routing and payload
+     pointers of the header point into the mapped data.
+     */
+    static juce::Result
+        parseBinaryHeader (const void* data, const size_t dataSize, BinaryHeader& header)
+    {
+        const auto* bytes = static_cast<const char*> (data);
+        if (data == nullptr || dataSize < (size_t) binaryHeaderSize
+            || ! (bytes[0] == 'I' && bytes[1] == 'E' && bytes[2] == 'M' && bytes[3] == 'M'))
+            return juce::Result::fail ("Not a valid binary matrix container.");
+
+        auto readInt = [bytes] (const int offset)
+        { return static_cast<int> (juce::ByteOrder::littleEndianInt (bytes + offset)); };
+
+        if (readInt (4) > static_cast<int> (binaryVersion))
+            return juce::Result::fail ("Binary container version " + juce::String (readInt (4))
+                                       + " is not supported.");
+
+        const int contentType = readInt (8);
+        if (contentType != 0 && contentType != 1)
+            return juce::Result::fail ("Unknown content type in binary container.");
+        header.contentType = static_cast<BinaryContentType> (contentType);
+
+        header.rows = readInt (12);
+        header.columns = readInt (16);
+        const int nameLength = readInt (20);
+        const int descriptionLength = readInt (24);
+        const int payloadOffset = readInt (28);
+        header.expectedNormalization = readInt (32);
+        header.weights = readInt (36);
+        header.weightsAlreadyApplied = readInt (40);
+        header.subwooferChannel = readInt (44);
+
+        if (header.rows <= 0 || header.columns <= 0 || nameLength < 0 || descriptionLength < 0)
+            return juce::Result::fail ("Invalid sizes in binary container header.");
+
+        const size_t routingOffset =
+            (size_t) binaryHeaderSize + (size_t) nameLength + (size_t) descriptionLength;
+        const size_t routingEnd = routingOffset + sizeof (juce::int32) * (size_t) header.rows;
+        const size_t payloadSize = sizeof (float) * (size_t) header.rows * (size_t) header.columns;
+
+        // the offset is checked for being negative before any cast, and the end of the payload
+        // is compared without overflow
+        if (payloadOffset < 0 || payloadOffset % binaryPayloadAlignment != 0
+            || (size_t) payloadOffset < routingEnd || (size_t) payloadOffset > dataSize
+            || payloadSize > dataSize - (size_t) payloadOffset)
+            return juce::Result::fail ("Binary container is truncated or corrupt.");
+
+        header.name = juce::String::fromUTF8 (bytes + binaryHeaderSize, nameLength);
+        header.description =
+            juce::String::fromUTF8 (bytes + binaryHeaderSize + nameLength, descriptionLength);
+        header.routing = reinterpret_cast<const juce::int32*> (bytes + routingOffset);
+        header.payload = reinterpret_cast<const float*> (bytes + payloadOffset);
+
+        return juce::Result::ok();
+    }
+
+    /**
+     Copies routing and payload of a parsed binary container into the destination matrix, which has to be of the right size.
+     */
+    static juce::Result copyBinaryDataToMatrix (const BinaryHeader& header,
+                                                ReferenceCountedMatrix& dest)
+    {
+        auto& matrix = dest.getMatrix();
+        jassert ((int) matrix.getNumRows() == header.rows
+                 && (int) matrix.getNumColumns() == header.columns);
+
+        const int nElements = header.rows * header.columns;
+#if JUCE_LITTLE_ENDIAN
+        std::memcpy (matrix.getRawDataPointer(), header.payload, sizeof (float) * nElements);
+#else
+        float* destData = matrix.getRawDataPointer();
+        for (int i = 0; i < nElements; ++i)
+        {
+            auto value = juce::ByteOrder::littleEndianInt (header.payload + i);
+            std::memcpy (destData + i, &value, sizeof (float));
+        }
+#endif
+
+        auto& routingArray = dest.getRoutingArrayReference();
+        for (int r = 0; r < header.rows; ++r)
+        {
+            // zero-based output channel, at most 64 like the subwoofer channel
+            const int channel = static_cast<int> (
+                juce::ByteOrder::littleEndianInt (header.routing + r));
+            if (channel < 0 || channel >= 64)
+                return juce::Result::fail ("Invalid routing in binary container.");
+            routingArray.set (r, channel);
+        }
+
+        dest.analyseStructure();
+        return juce::Result::ok();
+    }
+
+    /**
+     Memory-maps a binary container file (fileToParse) and writes the contained matrix into the destination (dest). Decoder containers can be loaded as matrices as well.
+     */
+    static juce::Result parseBinaryFileForTransformationMatrix (const juce::File& fileToParse,
+                                                                ReferenceCountedMatrix::Ptr* dest)
+    {
+        jassert (dest != nullptr);
+
+        juce::MemoryMappedFile mappedFile (fileToParse, juce::MemoryMappedFile::readOnly);
+        if (mappedFile.getData() == nullptr)
+            return juce::Result::fail ("File '" + fileToParse.getFullPathName()
+                                       + "' could not be opened.");
+
+        BinaryHeader header;
+        auto result = parseBinaryHeader (mappedFile.getData(), mappedFile.getSize(), header);
+        if (! result.wasOk())
+            return result;
+
+        ReferenceCountedMatrix::Ptr newMatrix = new ReferenceCountedMatrix (header.name,
+                                                                            header.description,
+                                                                            header.rows,
+                                                                            header.columns);
+        result = copyBinaryDataToMatrix (header, *newMatrix);
+        if (! result.wasOk())
+            return result;
+
+        *dest = newMatrix;
+        return juce::Result::ok();
+    }
+
+    /**
+     Writes a ReferenceCountedMatrix into a binary container file. The decoder settings are only written if contentType is BinaryContentType::decoder.
+     */
+    static juce::Result writeMatrixToBinaryFile (const juce::File& fileToWrite,
+                                                 ReferenceCountedMatrix& matrixToWrite,
+                                                 const BinaryContentType contentType,
+                                                 const BinaryHeader& decoderSettings = {})
+    {
+        auto& matrix = matrixToWrite.getMatrix();
+        const int rows = static_cast<int> (matrix.getNumRows());
+        const int columns = static_cast<int> (matrix.getNumColumns());
+
+        const auto nameData = matrixToWrite.getName().toUTF8();
+        const auto descriptionData = matrixToWrite.getDescription().toUTF8();
+        const int nameLength = static_cast<int> (nameData.sizeInBytes()) - 1;
+        const int descriptionLength = static_cast<int> (descriptionData.sizeInBytes()) - 1;
+
+        const int routingOffset = binaryHeaderSize + nameLength + descriptionLength;
+        const int routingEnd = routingOffset + (int) sizeof (juce::int32) * rows;
+        const int payloadOffset = (routingEnd + binaryPayloadAlignment - 1)
+                                  / binaryPayloadAlignment * binaryPayloadAlignment;
+
+        juce::TemporaryFile tempFile (fileToWrite);
+        {
+            juce::FileOutputStream stream (tempFile.getFile());
+            if (! stream.openedOk())
+                return juce::Result::fail ("File '" + fileToWrite.getFullPathName()
+                                           + "' could not be opened for writing.");
+
+            const bool isDecoder = contentType == BinaryContentType::decoder;
+            stream.write ("IEMM", 4);
+            stream.writeInt ((int) binaryVersion);
+            stream.writeInt (static_cast<int> (contentType));
+            stream.writeInt (rows);
+            stream.writeInt (columns);
+            stream.writeInt (nameLength);
+            stream.writeInt (descriptionLength);
+            stream.writeInt (payloadOffset);
+            stream.writeInt (isDecoder ? decoderSettings.expectedNormalization : 0);
+            stream.writeInt (isDecoder ? decoderSettings.weights : 0);
+            stream.writeInt (isDecoder ? decoderSettings.weightsAlreadyApplied : 0);
+            stream.writeInt (isDecoder ? decoderSettings.subwooferChannel : 0);
+            stream.writeRepeatedByte (0, binaryHeaderSize - 48);
+
+            stream.write (nameData.getAddress(), (size_t) nameLength);
+            stream.write (descriptionData.getAddress(), (size_t) descriptionLength);
+
+            auto& routingArray = matrixToWrite.getRoutingArrayReference();
+            for (int r = 0; r < rows; ++r)
+                stream.writeInt (routingArray[r]);
+
+            stream.writeRepeatedByte (0, (size_t) (payloadOffset - routingEnd));
+
+#if JUCE_LITTLE_ENDIAN
+            stream.write (matrix.getRawDataPointer(), sizeof (float) * (size_t) (rows * columns));
+#else
+            for (int i = 0; i < rows * columns; ++i)
+                stream.writeFloat (matrix.getRawDataPointer()[i]);
+#endif
+
+            stream.flush();
+            if (stream.getStatus().failed())
+                return juce::Result::fail ("Writing binary container failed.");
+        }
+
+        if (! tempFile.overwriteTargetFileWithTemporary())
+            return juce::Result::fail ("Writing binary container failed.");
+
+        return juce::Result::ok();
+    }
+
+    /**
+     Writes a ReferenceCountedMatrix as 'TransformationMatrix' into a binary container file.
+     */
+    static juce::Result writeTransformationMatrixToBinaryFile (const juce::File& fileToWrite,
+                                                               ReferenceCountedMatrix::Ptr& matrix)
+    {
+        if (matrix == nullptr)
+            return juce::Result::fail ("No matrix to write.");
+
+        return writeMatrixToBinaryFile (fileToWrite,
+                                        *matrix,
+                                        BinaryContentType::transformationMatrix);
+    }
+
+#endif // #if CONFIGURATIONHELPER_ENABLE_MATRIX_METHODS
+
+#if CONFIGURATIONHELPER_ENABLE_DECODER_METHODS
+    /**
+     Memory-maps a binary container file (fileToParse) and tries to read a decoder from it. If successful, writes the decoder into the destination (decoder).
+     */
+    static juce::Result parseBinaryFileForDecoder (const juce::File& fileToParse,
+                                                   ReferenceCountedDecoder::Ptr* decoder)
+    {
+        jassert (decoder != nullptr);
+
+        juce::MemoryMappedFile mappedFile (fileToParse, juce::MemoryMappedFile::readOnly);
+        if (mappedFile.getData() == nullptr)
+            return juce::Result::fail ("File '" + fileToParse.getFullPathName()
+                                       + "' could not be opened.");
+
+        BinaryHeader header;
+        auto result = parseBinaryHeader (mappedFile.getData(), mappedFile.getSize(), header);
+        if (! result.wasOk())
+            return result;
+
+        if (header.contentType != BinaryContentType::decoder)
+            return juce::Result::fail ("Binary container does not contain a decoder.");
+
+        const int decoderOrder = isqrt (header.columns) - 1;
+        if (header.columns != juce::square (decoderOrder + 1))
+            return juce::Result::fail (
+                "Decoder matrix's number of columns is no valid Ambisonic channel count: nCh = (order+1)^2.");
+
+        if (header.expectedNormalization < 0 || header.expectedNormalization > 1
+            || header.weights < 0 || header.weights > 2 || header.subwooferChannel < 0
+            || header.subwooferChannel > 64)
+            return juce::Result::fail ("Invalid decoder settings in binary container.");
+
+        ReferenceCountedDecoder::Ptr newDecoder = new ReferenceCountedDecoder (header.name,
+                                                                               header.description,
+                                                                               header.rows,
+                                                                               header.columns);
+
+        ReferenceCountedDecoder::Settings settings;
+        settings.expectedNormalization =
+            static_cast<ReferenceCountedDecoder::Normalization> (header.expectedNormalization);
+        settings.weights = static_cast<ReferenceCountedDecoder::Weights> (header.weights);
+        settings.weightsAlreadyApplied = header.weightsAlreadyApplied != 0;
+        settings.subwooferChannel = header.subwooferChannel > 0 ? header.subwooferChannel : -1;
+        newDecoder->setSettings (settings);
+
+        result = copyBinaryDataToMatrix (header, *newDecoder);
+        if (! result.wasOk())
+            return result;
+
+        *decoder = newDecoder;
+        return juce::Result::ok();
+    }
+
+    /**
+     Writes a ReferenceCountedDecoder including its settings into a binary container file.
+     */
+    static juce::Result writeDecoderToBinaryFile (const juce::File& fileToWrite,
+                                                  ReferenceCountedDecoder::Ptr& decoder)
+    {
+        if (decoder == nullptr)
+            return juce::Result::fail ("No decoder to write.");
+
+        const auto settings = decoder->getSettings();
+        BinaryHeader decoderSettings;
+        decoderSettings.expectedNormalization = static_cast<int> (settings.expectedNormalization);
+        decoderSettings.weights = static_cast<int> (settings.weights);
+        decoderSettings.weightsAlreadyApplied = settings.weightsAlreadyApplied ? 1 : 0;
+        decoderSettings.subwooferChannel = juce::jmax (0, settings.subwooferChannel);
+
+        return writeMatrixToBinaryFile (fileToWrite,
+                                        *decoder,
+                                        BinaryContentType::decoder,
+                                        decoderSettings);
+    }
+
+#endif // #if CONFIGURATIONHELPER_ENABLE_DECODER_METHODS
+
+#if CONFIGURATIONHELPER_ENABLE_MATRIX_METHODS
+    /**
+     Converts a JSON configuration file containing a 'Decoder' or 'TransformationMatrix' object into a binary container file. Decoders are only recognized if the decoder methods are enabled.
+     */
+    static juce::Result convertJsonFileToBinaryFile (const juce::File& jsonFile,
+                                                     const juce::File& binaryFile)
+    {
+        juce::var parsedJson;
+        auto result = parseFile (jsonFile, parsedJson);
+        if (! result.wasOk())
+            return result;
+
+    #if CONFIGURATIONHELPER_ENABLE_DECODER_METHODS
+        if (parsedJson.hasProperty ("Decoder"))
+        {
+            ReferenceCountedDecoder::Ptr decoder;
+            result = parseVarForDecoder (parsedJson, &decoder);
+            if (! result.wasOk())
+                return result;
+
+            return writeDecoderToBinaryFile (binaryFile, decoder);
+        }
+    #endif
+
+        ReferenceCountedMatrix::Ptr matrix;
+        juce::var tmVar = parsedJson.getProperty ("TransformationMatrix", parsedJson);
+        result = convertTransformationMatrixVarToMatrix (
+            tmVar,
+            &matrix,
+            parsedJson.getProperty ("Name", juce::var ("")),
+            parsedJson.getProperty ("Description", juce::var ("")));
+        if (! result.wasOk())
+            return result;
+
+        return writeTransformationMatrixToBinaryFile (binaryFile, matrix);
+    }
+
+    /**
+     Converts a binary container file into a JSON configuration file with a 'Decoder' or 'TransformationMatrix' object.
+     */
+    static juce::Result convertBinaryFileToJsonFile (const juce::File& binaryFile,
+                                                     const juce::File& jsonFile)
+    {
+        auto* configuration = new juce::DynamicObject();
+        juce::var configurationVar (configuration);
+
+    #if CONFIGURATIONHELPER_ENABLE_DECODER_METHODS
+        ReferenceCountedDecoder::Ptr decoder;
+        if (parseBinaryFileForDecoder (binaryFile, &decoder).wasOk())
+        {
+            configuration->setProperty ("Name", decoder->getName());
+            configuration->setProperty ("Description", decoder->getDescription());
+            configuration->setProperty ("Decoder", convertDecoderToVar (decoder));
+            return writeConfigurationToFile (jsonFile, configurationVar);
+        }
+    #endif
+
+        ReferenceCountedMatrix::Ptr matrix;
+        auto result = parseBinaryFileForTransformationMatrix (binaryFile, &matrix);
+        if (! result.wasOk())
+            return result;
+
+        configuration->setProperty ("Name", matrix->getName());
+        configuration->setProperty ("Description", matrix->getDescription());
+        configuration->setProperty ("TransformationMatrix",
+                                    convertTransformationMatrixToVar (matrix));
+        return writeConfigurationToFile (jsonFile, configurationVar);
+    }
+
+#endif // #if CONFIGURATIONHELPER_ENABLE_MATRIX_METHODS
+
     /**
      Writes a configuration juce::var to a JSON file.
      Example use-case:
@@ -752,7 +1180,8 @@ public:
         configuration->setProperty ("LoudspeakerLayout", ConfigurationHelper::convertLoudspeakersToVar (loudspeakersValueTree));
         ConfigurationHelper::writeConfigurationToFile (fileName, juce::var (configuration));
      */
-    static juce::Result writeConfigurationToFile (juce::File& fileToWrite, juce::var configuration)
+    static juce::Result writeConfigurationToFile (const juce::File& fileToWrite,
+                                                  juce::var configuration)
     {
         juce::String jsonString = juce::JSON::toString (configuration);
         if (fileToWrite.replaceWithText (jsonString))
@@ -24,65 +24,110 @@
 #include "../JuceLibraryCode/JuceHeader.h"
 
 using namespace juce::dsp;
+
+/**
+ Delays all channels by the same amount. The line is allocated in prepare() for the largest of
+ the delay time and the maximum delay time, within that range setDelayTime() doesn't allocate or
+ clear the line, so the delay can be changed while playing: process() crossfades from the old
+ to the new delay across the next block. Optionally, fractional delays are read with linear
+ interpolation, otherwise delay times are truncated to whole samples.
+ */
 class Delay : private ProcessorBase
 {
 public:
     Delay() {}
     ~Delay() override = default;
 
+    /** Sets the delay time, only allocates if it exceeds the delay time the line has been
+        prepared for. */
     void setDelayTime (float delayTimeInSeconds)
     {
-        if (delayTimeInSeconds <= 0.0f)
-        {
-            delay = 0.0f;
-            bypassed = true;
-        }
+        delay = juce::jmax (0.0f, delayTimeInSeconds);
+
+        if (spec.sampleRate <= 0.0)
+            return;
+
+        if (delay > maxDelay)
+            prepare (spec); // the line has to grow
         else
-        {
-            delay = delayTimeInSeconds;
-            bypassed = false;
-        }
+            targetDelayInSamples.store (toSamples (delay), std::memory_order_relaxed);
+    }
 
-        prepare (spec);
+    /** Sets the delay time the line is allocated for with the next prepare() call, so the delay
+        time can be changed up to this value without any allocation. */
+    void setMaximumDelayTime (float maxDelayTimeInSeconds)
+    {
+        maxDelay = juce::jmax (0.0f, maxDelayTimeInSeconds);
+    }
+
+    /** Enables fractional delays, which are read with linear interpolation. Takes effect with
+        the next setDelayTime() or prepare() call. */
+    void setFractionalDelays (bool shouldUseFractionalDelays)
+    {
+        fractionalDelays = shouldUseFractionalDelays;
     }
 
-    const int getDelayInSamples() { return bypassed ? 0 : delayInSamples; }
+    const int getDelayInSamples()
+    {
+        return static_cast<int> (targetDelayInSamples.load (std::memory_order_relaxed));
+    }
 
     void prepare (const juce::dsp::ProcessSpec& specs) override
     {
         spec = specs;
+        maxDelay = juce::jmax (maxDelay, delay);
 
-        delayInSamples = delay * specs.sampleRate;
-
-        buffer.setSize (specs.numChannels, specs.maximumBlockSize + delayInSamples);
+        // one more sample for the interpolation
+        const int maxDelayInSamples = static_cast<int> (std::ceil (maxDelay * specs.sampleRate));
+        buffer.setSize (specs.numChannels, specs.maximumBlockSize + maxDelayInSamples + 1);
         buffer.clear();
         writePosition = 0;
+
+        currentDelayInSamples = toSamples (delay);
+        targetDelayInSamples.store (currentDelayInSamples, std::memory_order_relaxed);
+        delayInSamples = static_cast<int> (currentDelayInSamples);
+        bypassed = currentDelayInSamples == 0.0f;
     }
 
     void process (const juce::dsp::ProcessContextReplacing<float>& context) override
     {
         juce::ScopedNoDenormals noDenormals;
 
-        if (! bypassed)
+        const float targetDelay = targetDelayInSamples.load (std::memory_order_relaxed);
+        if (currentDelayInSamples == 0.0f && targetDelay == 0.0f)
         {
-            auto abIn = context.getInputBlock();
-            auto abOut = context.getOutputBlock();
-            auto L = abIn.getNumSamples();
-            auto nCh = juce::jmin ((int) spec.numChannels, (int) abIn.getNumChannels());
+            bypassed = true;
+            return;
+        }
 
-            int startIndex, blockSize1, blockSize2;
+        if (bypassed)
+        {
+            // the line hasn't been written while bypassed
+            buffer.clear();
+            bypassed = false;
+        }
 
-            // write in delay line
-            getReadWritePositions (false, (int) L, startIndex, blockSize1, blockSize2);
+        auto abIn = context.getInputBlock();
+        auto abOut = context.getOutputBlock();
+        auto L = abIn.getNumSamples();
+        auto nCh = juce::jmin ((int) spec.numChannels, (int) abIn.getNumChannels());
 
-            for (int ch = 0; ch < nCh; ch++)
-                buffer.copyFrom (ch, startIndex, abIn.getChannelPointer (ch), blockSize1);
+        int startIndex, blockSize1, blockSize2;
 
-            if (blockSize2 > 0)
-                for (int ch = 0; ch < nCh; ch++)
-                    buffer.copyFrom (ch, 0, abIn.getChannelPointer (ch) + blockSize1, blockSize2);
+        // write in delay line
+        getReadWritePositions (false, (int) L, startIndex, blockSize1, blockSize2);
+        const int blockStart = startIndex;
+
+        for (int ch = 0; ch < nCh; ch++)
+            buffer.copyFrom (ch, startIndex, abIn.getChannelPointer (ch), blockSize1);
+
+        if (blockSize2 > 0)
+            for (int ch = 0; ch < nCh; ch++)
+                buffer.copyFrom (ch, 0, abIn.getChannelPointer (ch) + blockSize1, blockSize2);
 
-            // read from delay line
+        // read from delay line
+        if (targetDelay == currentDelayInSamples && targetDelay == std::floor (targetDelay))
+        {
             getReadWritePositions (true, (int) L, startIndex, blockSize1, blockSize2);
 
             for (int ch = 0; ch < nCh; ch++)
@@ -95,13 +140,33 @@ public:
                     juce::FloatVectorOperations::copy (abOut.getChannelPointer (ch) + blockSize1,
                                                        buffer.getReadPointer (ch),
                                                        blockSize2);
+        }
+        else
+        {
+            for (int ch = 0; ch < nCh; ch++)
+                readCrossfaded (buffer.getReadPointer (ch),
+                                buffer.getNumSamples(),
+                                blockStart,
+                                currentDelayInSamples,
+                                targetDelay,
+                                abOut.getChannelPointer (ch),
+                                (int) L);
 
-            writePosition += L;
-            writePosition = writePosition % buffer.getNumSamples();
+            currentDelayInSamples = targetDelay;
+            delayInSamples = static_cast<int> (targetDelay);
         }
+
+        writePosition += L;
+        writePosition = writePosition % buffer.getNumSamples();
     }
 
-    void reset() override {}
+    /** Clears the line without any allocation, e.g. when the delay is used again after a
+        while. */
+    void reset() override
+    {
+        buffer.clear();
+        writePosition = 0;
+    }
 
     void getReadWritePositions (bool read,
                                 int numSamples,
@@ -136,11 +201,84 @@ public:
         }
     }
 
+    /**
+     Reads numSamples samples, written to the circular line starting at blockStart, once
+     delayed by the old and once by the new number of samples, and crossfades linearly from the
+     former to the latter. Fractional delays are read with linear interpolation. Also used by
+     MultiChannelDelay.
+     */
+    template <typename FloatType>
+    static void readCrossfaded (const FloatType* line,
+                                const int lineLength,
+                                const int blockStart,
+                                const float oldDelayInSamples,
+                                const float newDelayInSamples,
+                                FloatType* destination,
+                                const int numSamples)
+    {
+        int position = blockStart;
+        if (oldDelayInSamples == newDelayInSamples)
+        {
+            for (int i = 0; i < numSamples; ++i)
+            {
+                destination[i] = readSample (line, lineLength, position, newDelayInSamples);
+                if (++position == lineLength)
+                    position = 0;
+            }
+            return;
+        }
+
+        const FloatType increment = FloatType (1) / numSamples;
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const FloatType newGain = (i + 1) * increment;
+            const FloatType oldSample = readSample (line, lineLength, position, oldDelayInSamples);
+            const FloatType newSample = readSample (line, lineLength, position, newDelayInSamples);
+            destination[i] = oldSample + newGain * (newSample - oldSample);
+
+            if (++position == lineLength)
+                position = 0;
+        }
+    }
+
+    /** Reads the sample delayed by delayInSamples with respect to the one at position. */
+    template <typename FloatType>
+    static FloatType readSample (const FloatType* line,
+                                 const int lineLength,
+                                 const int position,
+                                 const float delayInSamples)
+    {
+        const int integer = static_cast<int> (delayInSamples);
+        const FloatType fraction = delayInSamples - integer;
+
+        int index = position - integer;
+        if (index < 0)
+            index += lineLength;
+
+        if (fraction == 0.0f)
+            return line[index];
+
+        const int previous = index == 0 ? lineLength - 1 : index - 1;
+        return line[index] + fraction * (line[previous] - line[index]);
+    }
+
 private:
+    float toSamples (const float delayInSeconds) const
+    {
+        const double samples = delayInSeconds * spec.sampleRate;
+        return static_cast<float> (fractionalDelays ? samples : std::floor (samples));
+    }
+
     //==============================================================================
     juce::dsp::ProcessSpec spec = { -1, 0, 0 };
-    float delay;
+    float delay = 0.0f;
+    float maxDelay = 0.0f;
+    bool fractionalDelays = false;
+
+    std::atomic<float> targetDelayInSamples { 0.0f };
+    float currentDelayInSamples = 0.0f;
     int delayInSamples = 0;
+
     bool bypassed = false;
     int writePosition = 0;
     juce::AudioBuffer<float> buffer;
@@ -0,0 +1,184 @@
+/*
+ ==============================================================================
+ This file is part of the IEM plug-in suite.
+ Author: Daniel Rudrich
+ Copyright (c) 2024 - Institute of Electronic Music and Acoustics (IEM)
+ https://iem.at
+
+ The IEM plug-in suite is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ The IEM plug-in suite is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this software.  If not, see <https://www.gnu.org/licenses/>.
+ ==============================================================================
+ */
+
+#pragma once
+
+#include <JuceHeader.h>
+
+/**
+ Cache-blocked and register-tiled kernel computing y = T * x for a block of multichannel
+ audio data, with T being a dense (row-major) matrix.
+
+ The input is processed in chunks of `chunkSize` samples, which are packed into an aligned
+ panel, so they stay in L1 while all output rows are computed. The output rows are computed
+ in tiles of four rows and two SIMD registers, so each input sample is loaded once per four
+ output rows instead of once per row. The accumulation order is the same as for the straight
+ forward multiply / addWithMultiply approach, so results only differ within floating point
+ tolerance (if the compiler contracts to FMA instructions).
+ */
+class DenseMatrixKernel
+{
+#if JUCE_USE_SIMD
+    using SIMDfloat = juce::dsp::SIMDRegister<float>;
+    static constexpr int SIMDfloat_elements = juce::dsp::SIMDRegister<float>::size();
+#else /* !JUCE_USE_SIMD */
+    using SIMDfloat = float;
+    static constexpr int SIMDfloat_elements = 1;
+#endif /* JUCE_USE_SIMD */
+
+public:
+    /** Number of samples processed per chunk. */
+    static constexpr int chunkSize = 64;
+
+    /** Number of output rows processed at once. */
+    static constexpr int tileRows = 4;
+
+    DenseMatrixKernel() {}
+
+    /** Allocates the internal panels. Has to be called with the maximum number of input
+        channels before calling process() and must not be called from the audio thread.
+     */
+    void prepare (const int maximumNumInputs)
+    {
+        if (maximumNumInputs <= maxNumInputs)
+            return;
+
+        maxNumInputs = maximumNumInputs;
+        panel = juce::dsp::AudioBlock<SIMDfloat> (panelData,
+                                                  1,
+                                                  (size_t) (maxNumInputs * chunkVectors));
+        outputTile = juce::dsp::AudioBlock<SIMDfloat> (outputTileData,
+                                                       1,
+                                                       (size_t) (tileRows * chunkVectors));
+        juce::FloatVectorOperations::clear (reinterpret_cast<float*> (panel.getChannelPointer (0)),
+                                            maxNumInputs * chunkVectors * SIMDfloat_elements);
+        juce::FloatVectorOperations::clear (
+            reinterpret_cast<float*> (outputTile.getChannelPointer (0)),
+            tileRows * chunkVectors * SIMDfloat_elements);
+    }
+
+    int getMaximumNumInputs() const { return maxNumInputs; }
+
+    /**
+     Computes outputs[r][n] = sum_i coefficientRows[r][i] * inputs[i][n] for all numRows rows.
+     Outputs are overwritten. As each chunk of the inputs is packed before the outputs are
+     written, outputs may point to the same channels as inputs (in-place processing), but they
+     must not be shifted against each other.
+     */
+    void process (const float* const* coefficientRows,
+                  float* const* outputs,
+                  const int numRows,
+                  const float* const* inputs,
+                  const int numInputs,
+                  const int numSamples)
+    {
+        // call prepare() with the maximum number of inputs first!
+        jassert (numInputs <= maxNumInputs);
+
+        for (int start = 0; start < numSamples; start += chunkSize)
+        {
+            const int L = juce::jmin (chunkSize, numSamples - start);
+            const int nVectors = (L + SIMDfloat_elements - 1) / SIMDfloat_elements;
+            const int nPairs = (nVectors + 1) / 2;
+
+            // pack input chunk, zero-pad to full register pairs
+            float* panelPtr = reinterpret_cast<float*> (panel.getChannelPointer (0));
+            const int paddedLength = 2 * nPairs * SIMDfloat_elements;
+            for (int i = 0; i < numInputs; ++i)
+            {
+                float* dest = panelPtr + i * chunkVectors * SIMDfloat_elements;
+                juce::FloatVectorOperations::copy (dest, inputs[i] + start, L);
+                if (paddedLength > L)
+                    juce::FloatVectorOperations::clear (dest + L, paddedLength - L);
+            }
+
+            int row = 0;
+            for (; row + tileRows <= numRows; row += tileRows)
+                processTile<tileRows> (coefficientRows + row,
+                                       outputs + row,
+                                       numInputs,
+                                       nPairs,
+                                       start,
+                                       L);
+
+            for (; row < numRows; ++row)
+                processTile<1> (coefficientRows + row, outputs + row, numInputs, nPairs, start, L);
+        }
+    }
+
+private:
+    template <int nRows>
+    void processTile (const float* const* coefficientRows,
+                      float* const* outputs,
+                      const int numInputs,
+                      const int nPairs,
+                      const int startSample,
+                      const int numSamples)
+    {
+        const SIMDfloat* panelPtr = panel.getChannelPointer (0);
+        SIMDfloat* tilePtr = outputTile.getChannelPointer (0);
+
+        for (int p = 0; p < nPairs; ++p)
+        {
+            SIMDfloat acc0[nRows], acc1[nRows];
+            for (int r = 0; r < nRows; ++r)
+            {
+                acc0[r] = 0.0f;
+                acc1[r] = 0.0f;
+            }
+
+            const SIMDfloat* x = panelPtr + 2 * p;
+            for (int i = 0; i < numInputs; ++i, x += chunkVectors)
+            {
+                const SIMDfloat x0 = x[0];
+                const SIMDfloat x1 = x[1];
+                for (int r = 0; r < nRows; ++r)
+                {
+                    const SIMDfloat c (coefficientRows[r][i]);
+                    acc0[r] += c * x0;
+                    acc1[r] += c * x1;
+                }
+            }
+
+            for (int r = 0; r < nRows; ++r)
+            {
+                tilePtr[r * chunkVectors + 2 * p] = acc0[r];
+                tilePtr[r * chunkVectors + 2 * p + 1] = acc1[r];
+            }
+        }
+
+        const float* tileFloatPtr = reinterpret_cast<const float*> (tilePtr);
+        for (int r = 0; r < nRows; ++r)
+            juce::FloatVectorOperations::copy (outputs[r] + startSample,
+                                               tileFloatPtr + r * chunkVectors * SIMDfloat_elements,
+                                               numSamples);
+    }
+
+    //==============================================================================
+    static constexpr int chunkVectors =
+        2 * ((chunkSize + 2 * SIMDfloat_elements - 1) / (2 * SIMDfloat_elements));
+
+    int maxNumInputs = 0;
+
+    juce::HeapBlock<char> panelData, outputTileData;
+    juce::dsp::AudioBlock<SIMDfloat> panel, outputTile;
+};
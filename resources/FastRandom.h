@@ -0,0 +1,204 @@
+/*
+ ==============================================================================
+ This file is part of the IEM plug-in suite.
+ Author: Daniel Rudrich
+ Copyright (c) 2024 - Institute of Electronic Music and Acoustics (IEM)
+ https://iem.at
+
+ The IEM plug-in suite is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ The IEM plug-in suite is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this software.  If not, see <https://www.gnu.org/licenses/>.
+ ==============================================================================
+ */
+
+#pragma once
+
+#include <JuceHeader.h>
+
+/**
+ Small, seedable pseudo-random number generator for audio-thread use, e.g. for the parameters of
+ granular synthesis. Contrary to juce::Random::getSystemRandom(), each instance owns its state,
+ so the same seed always results in the same sequence, which makes offline renders reproducible.
+
+ Four independent xoshiro128+ generators run side by side, their states are stored per lane,
+ so the compiler can update all of them with SIMD instructions. Values are handed out from the
+ four results of the last update. Only the upper bits are used for floats, as the lowest bits of
+ xoshiro128+ are of lower quality.
+ */
+class FastRandom
+{
+public:
+    static constexpr int numLanes = 4;
+
+    explicit FastRandom (const juce::uint64 seed = 0) { setSeed (seed); }
+
+    /** Restarts the sequence belonging to seed. */
+    void setSeed (juce::uint64 seed)
+    {
+        // splitmix64 expands the seed into the states, which therefore can't be all zero
+        for (int lane = 0; lane < numLanes; ++lane)
+            for (int word = 0; word < 4; word += 2)
+            {
+                seed += 0x9e3779b97f4a7c15ULL;
+                juce::uint64 z = seed;
+                z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+                z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+                z = z ^ (z >> 31);
+                state[word][lane] = static_cast<juce::uint32> (z);
+                state[word + 1][lane] = static_cast<juce::uint32> (z >> 32);
+            }
+
+        position = numLanes;
+        hasSpareNormal = false;
+    }
+
+    juce::uint32 nextUInt32()
+    {
+        if (position == numLanes)
+            update();
+
+        return results[position++];
+    }
+
+    /** Uniformly distributed in [0, 1). */
+    float nextFloat() { return toFloat (nextUInt32()); }
+
+    /**
+     Fills destination with uniformly distributed values in [0, 1), the same sequence as calling
+     nextFloat() numValues times. All lanes are advanced and converted at once, so drawing the
+     values of a whole block is cheaper than drawing them one by one.
+     */
+    void fillUniform (float* destination, const int numValues)
+    {
+        int i = 0;
+        for (; i < numValues && position < numLanes; ++i) // rest of the last update
+            destination[i] = nextFloat();
+
+        for (; i + numLanes <= numValues; i += numLanes)
+        {
+            update();
+            for (int lane = 0; lane < numLanes; ++lane)
+                destination[i + lane] = toFloat (results[lane]);
+            position = numLanes;
+        }
+
+        for (; i < numValues; ++i)
+            destination[i] = nextFloat();
+    }
+
+    /** Fills destination with standard normal distributed values, the same sequence as calling
+        nextNormal() numValues times. */
+    void fillNormal (float* destination, const int numValues)
+    {
+        int i = 0;
+        if (hasSpareNormal && numValues > 0)
+        {
+            hasSpareNormal = false;
+            destination[i++] = spareNormal;
+        }
+
+        // uniforms for numLanes pairs at a time, each pair results in two values
+        float uniforms[2 * numLanes];
+        while (numValues - i >= 2)
+        {
+            const int numPairs = juce::jmin (numLanes, (numValues - i) / 2);
+            fillUniform (uniforms, 2 * numPairs);
+            for (int p = 0; p < numPairs; ++p)
+            {
+                const float radius = std::sqrt (-2.0f * std::log (1.0f - uniforms[2 * p]));
+                const float angle = juce::MathConstants<float>::twoPi * uniforms[2 * p + 1];
+                destination[i++] = radius * std::cos (angle);
+                destination[i++] = radius * std::sin (angle);
+            }
+        }
+
+        if (i < numValues)
+            destination[i] = nextNormal();
+    }
+
+    /** Standard normal distribution (Box-Muller transform, values are generated in pairs). */
+    float nextNormal()
+    {
+        if (hasSpareNormal)
+        {
+            hasSpareNormal = false;
+            return spareNormal;
+        }
+
+        const float radius = std::sqrt (-2.0f * std::log (1.0f - nextFloat()));
+        const float angle = juce::MathConstants<float>::twoPi * nextFloat();
+        spareNormal = radius * std::sin (angle);
+        hasSpareNormal = true;
+        return radius * std::cos (angle);
+    }
+
+    /** Gamma distribution with unit scale and shape >= 1 (Marsaglia and Tsang's method). */
+    float nextGamma (const float shape)
+    {
+        jassert (shape >= 1.0f);
+        const float d = shape - 1.0f / 3.0f;
+        const float c = 1.0f / std::sqrt (9.0f * d);
+
+        for (;;)
+        {
+            const float x = nextNormal();
+            float v = 1.0f + c * x;
+            if (v <= 0.0f)
+                continue;
+
+            v = v * v * v;
+            const float u = 1.0f - nextFloat();
+            const float xSquared = x * x;
+            if (u < 1.0f - 0.0331f * xSquared * xSquared
+                || std::log (u) < 0.5f * xSquared + d * (1.0f - v + std::log (v)))
+                return d * v;
+        }
+    }
+
+private:
+    /** Converts the upper 24 bits to [0, 1). */
+    static float toFloat (const juce::uint32 value)
+    {
+        return static_cast<float> (value >> 8) * (1.0f / 16777216.0f);
+    }
+
+    /** Advances all lanes by one step of xoshiro128+. */
+    void update()
+    {
+        for (int lane = 0; lane < numLanes; ++lane)
+        {
+            auto& s0 = state[0][lane];
+            auto& s1 = state[1][lane];
+            auto& s2 = state[2][lane];
+            auto& s3 = state[3][lane];
+
+            results[lane] = s0 + s3;
+
+            const juce::uint32 t = s1 << 9;
+            s2 ^= s0;
+            s3 ^= s1;
+            s1 ^= s2;
+            s0 ^= s3;
+            s2 ^= t;
+            s3 = (s3 << 11) | (s3 >> 21);
+        }
+
+        position = 0;
+    }
+
+    alignas (16) juce::uint32 state[4][numLanes];
+    alignas (16) juce::uint32 results[numLanes];
+    int position = numLanes;
+
+    float spareNormal = 0.0f;
+    bool hasSpareNormal = false;
+};
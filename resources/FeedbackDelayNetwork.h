@@ -27,8 +27,19 @@
 using namespace juce::dsp;
 class FeedbackDelayNetwork : private ProcessorBase
 {
+#if JUCE_USE_SIMD
+    using SIMDfloat = juce::dsp::SIMDRegister<float>;
+    static constexpr int SIMDfloat_elements = juce::dsp::SIMDRegister<float>::size();
+#else /* !JUCE_USE_SIMD */
+    using SIMDfloat = float;
+    static constexpr int SIMDfloat_elements = 1;
+#endif /* JUCE_USE_SIMD */
+
     static constexpr int maxDelayLength = 30;
 
+    // the delay lines are processed in chunks of at most this many samples
+    static constexpr int maxChunkSize = 32;
+
 public:
     enum FdnSize
     {
@@ -60,6 +71,16 @@ public:
 
     FeedbackDelayNetwork (FdnSize size = big)
     {
+        // SIMD state of all delay lines, allocated for the largest network size
+        parameterRows = juce::dsp::AudioBlock<SIMDfloat> (parameterData,
+                                                          numParameterRows,
+                                                          (size_t) maxLineVectors);
+        workBuffer = juce::dsp::AudioBlock<SIMDfloat> (workData,
+                                                       1,
+                                                       (size_t) (maxChunkSize * maxLineVectors));
+        for (int row = 0; row < numParameterRows; ++row)
+            clearRow (row, giant);
+
         updateFdnSize (size);
         setDelayLength (20);
         dryWet = 0.5f;
@@ -90,14 +111,10 @@ public:
         updateGuiCoefficients();
 
         for (int ch = 0; ch < fdnSize; ++ch)
-        {
             delayBufferVector[ch]->clear();
-            lowShelfFilters[ch]->reset();
-            highShelfFilters[ch]->reset();
 
-            hpFilters[ch]->reset (0.0f);
-            additionalHpFilters[ch]->reset (0.0f);
-        }
+        for (int stage = 0; stage < numStages; ++stage)
+            clearFilterState (stage, 0, giant);
     }
 
     void process (const juce::dsp::ProcessContextReplacing<float>& context) override
@@ -175,76 +192,92 @@ public:
         //            }
         //        }
 
-        float dryGain = 1.0f - dryWet;
+        const float dryGain = 1.0f - dryWet;
+        const int nLines = fdnSize;
+        const int nIO = juce::jmin (nChannels, nLines);
+        const int stride = getLineStride();
 
-        for (int i = 0; i < numSamples; ++i)
+        // within a chunk not longer than the shortest delay line, all samples read from the
+        // delay lines have been written before the chunk, so the chunk can be processed
+        // sample by sample for all lines at once
+        const int chunkSize = juce::jmin (maxChunkSize, minDelayLength);
+
+        for (int start = 0; start < numSamples; start += chunkSize)
         {
-            // apply delay to each channel for one time sample
-            for (int channel = 0; channel < fdnSize; ++channel)
-            {
-                const int idx = std::min (channel, nChannels - 1);
-                float* const channelData = buffer.getChannelPointer (idx);
-                float* const delayData = delayBufferVector[channel]->getWritePointer (0);
+            const int L = juce::jmin (chunkSize, numSamples - start);
+            float* work = reinterpret_cast<float*> (workBuffer.getChannelPointer (0));
 
+            // read the delay lines into the work buffer (interleaved, one row per sample)
+            for (int channel = 0; channel < nLines; ++channel)
+            {
+                const float* delayData = delayBufferVector[channel]->getReadPointer (0);
+                const int delaySize = delayBufferVector[channel]->getNumSamples();
                 int delayPos = delayPositionVector[channel];
 
-                const float inSample = channelData[i];
-                if (! freeze)
+                for (int i = 0; i < L; ++i)
                 {
-                    // data exchange between IO buffer and delay buffer
-
-                    if (channel < nChannels)
-                        delayData[delayPos] += inSample;
+                    work[i * stride + channel] = delayData[delayPos];
+                    if (++delayPos >= delaySize)
+                        delayPos = 0;
                 }
+            }
 
-                if (! freeze)
+            if (! freeze)
+            {
+                // data exchange between IO buffer and delay buffer
+                for (int channel = 0; channel < nIO; ++channel)
                 {
-                    // Apply highpass filter
-                    if (hpFilterParameters.mode != 0)
-                        delayData[delayPos] =
-                            hpFilters[channel]->processSample (delayData[delayPos]);
-
-                    if (hpFilterParameters.mode == 3)
-                        delayData[delayPos] =
-                            additionalHpFilters[channel]->processSample (delayData[delayPos]);
-                    // apply shelving filters
-                    delayData[delayPos] =
-                        highShelfFilters[channel]->processSingleSampleRaw (delayData[delayPos]);
-                    delayData[delayPos] =
-                        lowShelfFilters[channel]->processSingleSampleRaw (delayData[delayPos]);
+                    const float* channelData = buffer.getChannelPointer (channel) + start;
+                    for (int i = 0; i < L; ++i)
+                        work[i * stride + channel] += channelData[i];
                 }
 
-                if (channel < nChannels)
-                {
-                    channelData[i] = delayData[delayPos] * dryWet;
-                    channelData[i] += inSample * dryGain;
-                }
-                if (! freeze)
-                    transferVector.set (channel, delayData[delayPos] * feedbackGainVector[channel]);
-                else
-                    transferVector.set (channel, delayData[delayPos]);
+                processFilters (work, L);
             }
 
-            // perform fast walsh hadamard transform
-            fwht (transferVector.getRawDataPointer(), transferVector.size());
+            for (int channel = 0; channel < nIO; ++channel)
+            {
+                float* const channelData = buffer.getChannelPointer (channel) + start;
+                for (int i = 0; i < L; ++i)
+                    channelData[i] = work[i * stride + channel] * dryWet + channelData[i] * dryGain;
+            }
+
+            // apply feedback gains and the (normalised) fast walsh hadamard transform
+            const SIMDfloat* gains = parameterRows.getChannelPointer (gainRow);
+            const float freezeGain = 1.0f / std::sqrt (static_cast<float> (nLines));
+            const int nVectors = stride / SIMDfloat_elements;
+            for (int i = 0; i < L; ++i)
+            {
+                SIMDfloat* row = reinterpret_cast<SIMDfloat*> (work + i * stride);
+                if (freeze)
+                    for (int v = 0; v < nVectors; ++v)
+                        row[v] *= freezeGain;
+                else
+                    for (int v = 0; v < nVectors; ++v)
+                        row[v] *= gains[v];
+
+                fwhtRow (work + i * stride, nLines);
+            }
 
             // write back into delay buffer
             // increment the delay buffer pointer
-            for (int channel = 0; channel < fdnSize; ++channel)
+            for (int channel = 0; channel < nLines; ++channel)
             {
-                float* const delayData =
-                    delayBufferVector[channel]->getWritePointer (0); // the buffer is single channel
-
+                float* const delayData = delayBufferVector[channel]->getWritePointer (0);
+                const int delaySize = delayBufferVector[channel]->getNumSamples();
                 int delayPos = delayPositionVector[channel];
 
-                delayData[delayPos] = transferVector[channel];
-
-                if (++delayPos >= delayBufferVector[channel]->getNumSamples())
-                    delayPos = 0;
+                for (int i = 0; i < L; ++i)
+                {
+                    delayData[delayPos] = work[i * stride + channel];
+                    if (++delayPos >= delaySize)
+                        delayPos = 0;
+                }
 
                 delayPositionVector.set (channel, delayPos);
             }
         }
+
         // if more channels than network order, mix pairs of high order channels
         // until order == number of channels
         //        if (nChannels > fdnSize)
@@ -417,23 +450,38 @@ private:
     juce::dsp::ProcessSpec spec = { 48000.0, 0, 0 };
 
     juce::OwnedArray<juce::AudioBuffer<float>> delayBufferVector;
-    juce::OwnedArray<juce::IIRFilter> highShelfFilters;
-    juce::OwnedArray<juce::IIRFilter> lowShelfFilters;
 
     juce::dsp::IIR::Coefficients<float>::Ptr hpCoefficients =
         juce::dsp::IIR::Coefficients<float>::makeAllPass (48000.0, 20.0f);
 
-    juce::dsp::IIR::Coefficients<float>::Ptr additionalHpCoefficients =
-        juce::dsp::IIR::Coefficients<float>::makeAllPass (48000.0, 20.0f);
-
-    juce::OwnedArray<juce::dsp::IIR::Filter<float>> hpFilters;
-    juce::OwnedArray<juce::dsp::IIR::Filter<float>> additionalHpFilters;
-
     juce::dsp::IIR::Coefficients<double>::Ptr guiCoefficients[3];
 
     juce::Array<int> delayPositionVector;
-    juce::Array<float> feedbackGainVector;
-    juce::Array<float> transferVector;
+    int minDelayLength = 1;
+
+    /*
+     Structure-of-arrays state of all delay lines: one row holds a value for each line, so
+     SIMD registers process neighbouring lines. The first row holds the feedback gains, followed
+     by the coefficients (b0, b1, b2, a1, a2) and states (s1, s2) of each filter stage.
+     */
+    enum FilterStage
+    {
+        hpStage,
+        additionalHpStage,
+        highShelfStage,
+        lowShelfStage,
+        numStages
+    };
+
+    static constexpr int gainRow = 0;
+    static constexpr int rowsPerStage = 7;
+    static constexpr int numParameterRows = 1 + numStages * rowsPerStage;
+    static constexpr int maxLineVectors = (giant + SIMDfloat_elements - 1) / SIMDfloat_elements;
+
+    juce::HeapBlock<char> parameterData, workData;
+    juce::dsp::AudioBlock<SIMDfloat> parameterRows;
+    juce::dsp::AudioBlock<SIMDfloat> workBuffer; // maxChunkSize rows of all lines
+    int lastHpMode = -1;
 
     std::vector<int> primeNumbers;
     std::vector<int> indices;
@@ -487,6 +535,144 @@ private:
         return pow (gain, length);
     }
 
+    /** Filter in transposed direct form II (like juce::IIRFilter), running one SIMD register
+        worth of delay lines. */
+    struct SIMDBiquad
+    {
+        SIMDfloat b0, b1, b2, a1, a2, s1, s2;
+
+        SIMDfloat processSample (const SIMDfloat in)
+        {
+            const SIMDfloat out = b0 * in + s1;
+            s1 = b1 * in - a1 * out + s2;
+            s2 = b2 * in - a2 * out;
+            return out;
+        }
+    };
+
+    int getStageRow (const int stage) const { return 1 + stage * rowsPerStage; }
+
+    /** Number of floats between two samples in the work buffer, at least one register. */
+    int getLineStride() const
+    {
+        return juce::jmax (static_cast<int> (fdnSize), SIMDfloat_elements);
+    }
+
+    float* getRowFloats (const int row)
+    {
+        return reinterpret_cast<float*> (parameterRows.getChannelPointer ((size_t) row));
+    }
+
+    void clearRow (const int row, const int numLines)
+    {
+        juce::FloatVectorOperations::clear (getRowFloats (row), numLines);
+    }
+
+    void clearFilterState (const int stage, const int firstLine, const int numLines)
+    {
+        for (int r = 5; r < rowsPerStage; ++r)
+            juce::FloatVectorOperations::clear (getRowFloats (getStageRow (stage) + r) + firstLine,
+                                                numLines);
+    }
+
+    void loadStage (const int stage, const int vector, SIMDBiquad& biquad)
+    {
+        const int row = getStageRow (stage);
+        biquad.b0 = parameterRows.getChannelPointer ((size_t) row)[vector];
+        biquad.b1 = parameterRows.getChannelPointer ((size_t) row + 1)[vector];
+        biquad.b2 = parameterRows.getChannelPointer ((size_t) row + 2)[vector];
+        biquad.a1 = parameterRows.getChannelPointer ((size_t) row + 3)[vector];
+        biquad.a2 = parameterRows.getChannelPointer ((size_t) row + 4)[vector];
+        biquad.s1 = parameterRows.getChannelPointer ((size_t) row + 5)[vector];
+        biquad.s2 = parameterRows.getChannelPointer ((size_t) row + 6)[vector];
+    }
+
+    void storeState (const int stage, const int vector, const SIMDBiquad& biquad)
+    {
+        const int row = getStageRow (stage);
+        parameterRows.getChannelPointer ((size_t) row + 5)[vector] = biquad.s1;
+        parameterRows.getChannelPointer ((size_t) row + 6)[vector] = biquad.s2;
+    }
+
+    /** Sets the coefficients (b0, b1, b2, a1, a2) of a filter stage for one delay line. */
+    void setStageCoefficients (const int stage, const int line, const float* coeffs)
+    {
+        for (int i = 0; i < 5; ++i)
+            getRowFloats (getStageRow (stage) + i)[line] = coeffs[i];
+    }
+
+    /**
+     Runs all filter stages on the work buffer. The filter states of one register worth of
+     lines are kept in registers, while the samples of the chunk are processed.
+     */
+    void processFilters (float* work, const int numSamples)
+    {
+        const int stride = getLineStride();
+        const int nVectors = stride / SIMDfloat_elements;
+        const bool useHp = hpFilterParameters.mode != 0;
+        const bool useAdditionalHp = hpFilterParameters.mode == 3;
+
+        for (int v = 0; v < nVectors; ++v)
+        {
+            SIMDBiquad hp, additionalHp, highShelf, lowShelf;
+            loadStage (hpStage, v, hp);
+            loadStage (additionalHpStage, v, additionalHp);
+            loadStage (highShelfStage, v, highShelf);
+            loadStage (lowShelfStage, v, lowShelf);
+
+            SIMDfloat* x = reinterpret_cast<SIMDfloat*> (work) + v;
+            for (int i = 0; i < numSamples; ++i, x += nVectors)
+            {
+                SIMDfloat sample = *x;
+
+                // Apply highpass filter
+                if (useHp)
+                    sample = hp.processSample (sample);
+
+                if (useAdditionalHp)
+                    sample = additionalHp.processSample (sample);
+
+                // apply shelving filters
+                sample = highShelf.processSample (sample);
+                *x = lowShelf.processSample (sample);
+            }
+
+            storeState (hpStage, v, hp);
+            storeState (additionalHpStage, v, additionalHp);
+            storeState (highShelfStage, v, highShelf);
+            storeState (lowShelfStage, v, lowShelf);
+        }
+    }
+
+    /** Unnormalised fast walsh hadamard transform of n (power of two) values. Butterflies
+        further apart than a register are done on whole registers. */
+    static void fwhtRow (float* data, const int n)
+    {
+        int h = 1;
+        for (; h < n && h < SIMDfloat_elements; h <<= 1)
+            for (int j = 0; j < n; j += 2 * h)
+                for (int k = j; k < j + h; ++k)
+                {
+                    const float a = data[k];
+                    data[k] = a + data[k + h];
+                    data[k + h] = a - data[k + h];
+                }
+
+        SIMDfloat* vectors = reinterpret_cast<SIMDfloat*> (data);
+        const int nVectors = n / SIMDfloat_elements;
+        for (; h < n; h <<= 1)
+        {
+            const int hv = h / SIMDfloat_elements;
+            for (int j = 0; j < nVectors; j += 2 * hv)
+                for (int k = j; k < j + hv; ++k)
+                {
+                    const SIMDfloat a = vectors[k];
+                    vectors[k] = a + vectors[k + hv];
+                    vectors[k + hv] = a - vectors[k + hv];
+                }
+        }
+    }
+
     std::vector<int> indexGen (FdnSize nChannels, int delayLength)
     {
         const int firstIncrement = delayLength / 10;
@@ -546,13 +732,16 @@ private:
     {
         indices = indexGen (fdnSize, delayLength);
 
+        minDelayLength = maxChunkSize;
         for (int channel = 0; channel < fdnSize; ++channel)
         {
             // update multichannel delay parameters
-            int delayLenSamples = delayLengthConversion (channel);
+            int delayLenSamples = juce::jmax (1, delayLengthConversion (channel));
             delayBufferVector[channel]->setSize (1, delayLenSamples, true, true, true);
             if (delayPositionVector[channel] >= delayBufferVector[channel]->getNumSamples())
                 delayPositionVector.set (channel, 0);
+
+            minDelayLength = juce::jmin (minDelayLength, delayLenSamples);
         }
         updateFeedBackGainVector();
         updateFilterCoefficients();
@@ -560,10 +749,11 @@ private:
 
     void updateFeedBackGainVector()
     {
+        // includes the normalisation of the walsh hadamard transform
+        const float norm = 1.0f / std::sqrt (static_cast<float> (fdnSize));
+        float* gains = getRowFloats (gainRow);
         for (int channel = 0; channel < fdnSize; ++channel)
-        {
-            feedbackGainVector.set (channel, channelGainConversion (channel, overallGain));
-        }
+            gains[channel] = channelGainConversion (channel, overallGain) * norm;
     }
 
     void updateFilterCoefficients()
@@ -573,19 +763,21 @@ private:
             // update shelving filter parameters
             for (int channel = 0; channel < fdnSize; ++channel)
             {
-                lowShelfFilters[channel]->setCoefficients (juce::IIRCoefficients::makeLowShelf (
+                const auto lowShelf = juce::IIRCoefficients::makeLowShelf (
                     spec.sampleRate,
                     juce::jmin (0.5 * spec.sampleRate,
                                 static_cast<double> (lowShelfParameters.frequency)),
                     lowShelfParameters.q,
-                    channelGainConversion (channel, lowShelfParameters.linearGain)));
+                    channelGainConversion (channel, lowShelfParameters.linearGain));
+                setStageCoefficients (lowShelfStage, channel, lowShelf.coefficients);
 
-                highShelfFilters[channel]->setCoefficients (juce::IIRCoefficients::makeHighShelf (
+                const auto highShelf = juce::IIRCoefficients::makeHighShelf (
                     spec.sampleRate,
                     juce::jmin (0.5 * spec.sampleRate,
                                 static_cast<double> (highShelfParameters.frequency)),
                     highShelfParameters.q,
-                    channelGainConversion (channel, highShelfParameters.linearGain)));
+                    channelGainConversion (channel, highShelfParameters.linearGain));
+                setStageCoefficients (highShelfStage, channel, highShelf.coefficients);
             }
 
             juce::dsp::IIR::Coefficients<float>::Ptr tmpCoeffs;
@@ -627,6 +819,26 @@ private:
                     *hpCoefficients = *tmpCoeffs;
             }
 
+            // first order coefficients (b0, b1, a1) are extended to a biquad
+            const float* c = hpCoefficients->getRawCoefficients();
+            float hpCoeffs[5] = { c[0], c[1], 0.0f, c[2], 0.0f };
+            if (hpCoefficients->getFilterOrder() == 2)
+                std::copy (c, c + 5, hpCoeffs);
+
+            for (int channel = 0; channel < fdnSize; ++channel)
+            {
+                setStageCoefficients (hpStage, channel, hpCoeffs);
+                setStageCoefficients (additionalHpStage, channel, hpCoeffs);
+            }
+
+            // like juce::dsp::IIR::Filter, which resets when the filter order changes
+            if (hpFilterParameters.mode != lastHpMode)
+            {
+                clearFilterState (hpStage, 0, fdnSize);
+                clearFilterState (additionalHpStage, 0, fdnSize);
+                lastHpMode = hpFilterParameters.mode;
+            }
+
             updateGuiCoefficients();
         }
     }
@@ -639,27 +851,19 @@ private:
             if (fdnSize < newSize)
             {
                 for (int i = 0; i < diff; i++)
-                {
                     delayBufferVector.add (new juce::AudioBuffer<float>());
-                    highShelfFilters.add (new juce::IIRFilter());
-                    lowShelfFilters.add (new juce::IIRFilter());
-                    hpFilters.add (new juce::dsp::IIR::Filter<float> (hpCoefficients));
-                    additionalHpFilters.add (new juce::dsp::IIR::Filter<float> (hpCoefficients));
-                }
+
+                // new lines start with cleared filters
+                for (int stage = 0; stage < numStages; ++stage)
+                    clearFilterState (stage, fdnSize, diff);
             }
             else
             {
                 //TODO: what happens if newSize == 0?;
                 delayBufferVector.removeLast (diff);
-                highShelfFilters.removeLast (diff);
-                lowShelfFilters.removeLast (diff);
-                hpFilters.removeLast (diff);
-                additionalHpFilters.removeLast (diff);
             }
         }
         delayPositionVector.resize (newSize);
-        feedbackGainVector.resize (newSize);
-        transferVector.resize (newSize);
         fdnSize = newSize;
     }
 };
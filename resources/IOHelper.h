@@ -60,9 +60,9 @@ public:
     bool check (juce::AudioProcessor* p, int setting, bool isInput)
     {
         int previous = nChannels;
-        int maxNumInputs =
-            juce::jmin (isInput ? p->getTotalNumInputChannels() : p->getTotalNumOutputChannels(),
-                        maxNumberOfInputChannels);
+        int maxNumInputs = juce::jmin (isInput ? p->getMainBusNumInputChannels()
+                                               : p->getMainBusNumOutputChannels(),
+                                       maxNumberOfInputChannels);
         if (setting == 0 || setting > maxNumberOfInputChannels)
             nChannels =
                 maxNumInputs; // Auto setting or requested order exceeds highest possible order
@@ -102,7 +102,8 @@ public:
         --setting;
 
         int maxPossibleOrder = juce::jmin (
-            isqrt (isInput ? p->getTotalNumInputChannels() : p->getTotalNumOutputChannels()) - 1,
+            isqrt (isInput ? p->getMainBusNumInputChannels() : p->getMainBusNumOutputChannels())
+                - 1,
             highestOrder);
         if (setting == -1 || setting > maxPossibleOrder)
             order =
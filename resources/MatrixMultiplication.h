@@ -22,6 +22,7 @@
 
 #pragma once
 #include "../JuceLibraryCode/JuceHeader.h"
+#include "DenseMatrixKernel.h"
 #include "ReferenceCountedDecoder.h"
 #include "ReferenceCountedMatrix.h"
 
@@ -30,13 +31,26 @@ class MatrixMultiplication
 public:
     MatrixMultiplication() {}
 
+    /**
+     Prepares the processor. All buffers are allocated for matrices with up to maxNumChannels
+     (or spec.numChannels, if larger) inputs, rows and outputs, so the audio thread never
+     allocates when taking over a new matrix. Larger matrices are rejected while processing.
+     */
     void prepare (const juce::dsp::ProcessSpec& newSpec, bool prepareInputBuffering = true)
     {
         spec = newSpec;
+        const int blockSize = static_cast<int> (spec.maximumBlockSize);
+        int maxChannels = juce::jmax (static_cast<int> (spec.numChannels), maxNumChannels);
+        for (auto* matrix : { currentMatrix.get(), newMatrix.get() })
+            if (matrix != nullptr)
+                maxChannels = juce::jmax (maxChannels,
+                                          matrix->getNumInputChannels(),
+                                          matrix->getNumOutputChannels(),
+                                          static_cast<int> (matrix->getMatrix().getNumRows()));
 
         if (prepareInputBuffering)
         {
-            buffer.setSize (buffer.getNumChannels(), spec.maximumBlockSize);
+            buffer.setSize (maxChannels, blockSize);
             bufferPrepared = true;
         }
         else
@@ -45,7 +59,32 @@ public:
             bufferPrepared = false;
         }
 
+        fadeBuffer.setSize (maxChannels, blockSize);
+        fadeGains.setSize (2, blockSize);
+        updateInterpolationLength();
+
+        allocateForMatrixSize (maxChannels, maxChannels);
+        preparedNumChannels = maxChannels;
+
         checkIfNewMatrixAvailable();
+        releaseRetiredMatrices();
+    }
+
+    /**
+     Sets the time in seconds used for crossfading between the previous and a new matrix. The
+     old and new matrices are rendered in the same blocks and the output is faded linearly.
+     A time of zero switches the matrices hard at the block boundary.
+     */
+    void setInterpolationTime (const float interpolationTimeInSeconds)
+    {
+        interpolationTime = juce::jmax (0.0f, interpolationTimeInSeconds);
+        updateInterpolationLength();
+    }
+
+    /** Returns true if the output is currently crossfaded from the previous matrix. */
+    bool isInterpolating() const
+    {
+        return previousMatrix != nullptr && fadeSamplesDone < fadeLength;
     }
 
     void processReplacing (juce::dsp::AudioBlock<float> data)
@@ -62,10 +101,13 @@ public:
             return;
         }
 
-        auto& T = retainedCurrentMatrix->getMatrix();
+        int nInputChannels = static_cast<int> (retainedCurrentMatrix->getMatrix().getNumColumns());
+        if (isInterpolating())
+            nInputChannels = juce::jmax (nInputChannels, previousMatrix->getNumInputChannels());
 
-        const int nInputChannels = juce::jmin (static_cast<int> (data.getNumChannels()),
-                                               static_cast<int> (T.getNumColumns()));
+        nInputChannels = juce::jmin (nInputChannels,
+                                     static_cast<int> (data.getNumChannels()),
+                                     buffer.getNumChannels());
         const int nSamples = static_cast<int> (data.getNumSamples());
 
         // copy input data to buffer
@@ -79,9 +121,15 @@ public:
         processNonReplacing (ab, data, false);
     }
 
+    /**
+     Applies the current matrix to the input and writes the result to the output. While a new
+     matrix is faded in, the previous matrix gets applied to previousMatrixInput if it is set,
+     otherwise to inputBlock as well.
+     */
     void processNonReplacing (const juce::dsp::AudioBlock<float> inputBlock,
                               juce::dsp::AudioBlock<float> outputBlock,
-                              const bool checkNewMatrix = true)
+                              const bool checkNewMatrix = true,
+                              const juce::dsp::AudioBlock<float>* previousMatrixInput = nullptr)
     {
         // you should call the processReplacing instead, it will buffer the input data
         // this is a weak check, as e.g. if number channels differ, it won't trigger
@@ -99,15 +147,274 @@ public:
             return;
         }
 
-        auto& T = retainedCurrentMatrix->getMatrix();
+        processMatrix (*retainedCurrentMatrix, inputBlock, outputBlock);
+
+        if (isInterpolating())
+        {
+            const int nSamples = static_cast<int> (outputBlock.getNumSamples());
+            const int nChannels =
+                juce::jmin (static_cast<int> (outputBlock.getNumChannels()),
+                            fadeBuffer.getNumChannels());
+            jassert (nSamples <= fadeBuffer.getNumSamples());
+
+            juce::dsp::AudioBlock<float> fadeBlock (fadeBuffer.getArrayOfWritePointers(),
+                                                    nChannels,
+                                                    0,
+                                                    nSamples);
+            processMatrix (*previousMatrix,
+                           previousMatrixInput != nullptr ? *previousMatrixInput : inputBlock,
+                           fadeBlock);
+            crossfade (fadeBlock, outputBlock);
+        }
+    }
+
+    /**
+     Takes over a new matrix set with setMatrix(). During a running crossfade, the new matrix
+     waits until it's finished, as the previous matrix is still audible. It also waits if the
+     replaced matrices can't be retired yet, see releaseRetiredMatrices().
+     */
+    const bool checkIfNewMatrixAvailable()
+    {
+        if (newMatrixAvailable && ! isInterpolating() && preparedNumChannels > 0)
+        {
+            if (newMatrix != nullptr && ! fitsPreparedSize (*newMatrix))
+            {
+                DBG ("MatrixTransformer: Matrix larger than prepared for, ignoring it.");
+                if (canRetire (1))
+                {
+                    newMatrixAvailable = false;
+                    retireMatrix (newMatrix);
+                }
+                return false;
+            }
+
+            if (! canRetire (2)) // previous and current matrix
+                return false;
+
+            newMatrixAvailable = false;
+            retireMatrix (previousMatrix);
+
+            if (fadeLength > 0 && currentMatrix != nullptr && newMatrix != nullptr)
+            {
+                std::swap (previousMatrix, currentMatrix);
+                fadeSamplesDone = 0;
+            }
+            else
+                retireMatrix (currentMatrix);
+
+            currentMatrix = newMatrix;
+            newMatrix = nullptr;
+
+            if (currentMatrix != nullptr)
+                DBG ("MatrixTransformer: New matrix with name '" << currentMatrix->getName()
+                                                                 << "' set.");
+
+            return true;
+        }
+        return false;
+    };
+
+    /** Sets a new matrix, which is faded in with the next block. If force is set, it's taken over
+        right away, also ending a running crossfade. */
+    void setMatrix (ReferenceCountedMatrix::Ptr newMatrixToUse, bool force = false)
+    {
+        newMatrix = newMatrixToUse;
+        newMatrixAvailable = true;
+        if (force)
+        {
+            fadeSamplesDone = fadeLength;
+            checkIfNewMatrixAvailable();
+        }
+    }
+
+    /** Returns true if the matrix fits into the buffers allocated by prepare(). */
+    bool fitsPreparedSize (ReferenceCountedMatrix& matrix) const
+    {
+        return matrix.getNumInputChannels() <= preparedNumChannels
+               && static_cast<int> (matrix.getMatrix().getNumRows()) <= preparedNumChannels
+               && matrix.getNumOutputChannels() <= preparedNumChannels;
+    }
+
+    /** Returns true if the given number of matrices can be retired without blocking. */
+    bool canRetire (const int numMatrices) const
+    {
+        return retiredFifo.getFreeSpace() >= numMatrices;
+    }
+
+    /**
+     Hands over a reference to a matrix the audio thread doesn't use anymore, so it doesn't get
+     deleted there. The reference is released with the next call of releaseRetiredMatrices().
+     If there's no space left, the matrix is kept and false is returned, so it can be retired
+     later on.
+     */
+    template <typename MatrixPtr>
+    bool retireMatrix (MatrixPtr& matrix)
+    {
+        if (matrix == nullptr)
+            return true;
+
+        int start1, size1, start2, size2;
+        retiredFifo.prepareToWrite (1, start1, size1, start2, size2);
+        if (size1 == 0)
+            return false; // releaseRetiredMatrices() isn't called often enough
+
+        retiredMatrices[start1] = matrix.get();
+        retiredFifo.finishedWrite (1);
+        matrix = nullptr;
+        return true;
+    }
+
+    /** Releases the retired matrices, has to be called from a non-realtime thread, e.g. after
+        setting a new matrix. */
+    void releaseRetiredMatrices()
+    {
+        int start1, size1, start2, size2;
+        retiredFifo.prepareToRead (retiredFifo.getNumReady(), start1, size1, start2, size2);
+
+        for (int i = 0; i < size1; ++i)
+            retiredMatrices[start1 + i] = nullptr;
+        for (int i = 0; i < size2; ++i)
+            retiredMatrices[start2 + i] = nullptr;
+
+        retiredFifo.finishedRead (size1 + size2);
+    }
+
+    ReferenceCountedMatrix::Ptr getMatrix() { return currentMatrix; }
+
+    /** Enables or disables the blocked and structured kernels. If disabled, the matrix is applied
+        row by row regardless of its structure, which can be used as a reference for verification.
+     */
+    void setUseOptimizedKernels (const bool shouldUseOptimizedKernels)
+    {
+        useOptimizedKernels = shouldUseOptimizedKernels;
+    }
+
+private:
+    /** Applies the matrix with the fastest kernel available and clears unused output channels. */
+    void processMatrix (ReferenceCountedMatrix& matrix,
+                        const juce::dsp::AudioBlock<float>& inputBlock,
+                        juce::dsp::AudioBlock<float>& outputBlock)
+    {
+        const int nInputChannels =
+            juce::jmin (static_cast<int> (inputBlock.getNumChannels()),
+                        static_cast<int> (matrix.getMatrix().getNumColumns()));
+
+        if (! useOptimizedKernels)
+            processRowByRow (matrix, inputBlock, outputBlock, nInputChannels);
+        else
+        {
+            switch (matrix.getStructure().getType())
+            {
+                case MatrixStructure::Type::diagonal:
+                case MatrixStructure::Type::permutation:
+                case MatrixStructure::Type::sparse:
+                    processSparse (matrix, inputBlock, outputBlock, nInputChannels);
+                    break;
+                case MatrixStructure::Type::blockDiagonal:
+                    processBlockDiagonal (matrix, inputBlock, outputBlock, nInputChannels);
+                    break;
+                default:
+                    processDense (matrix, inputBlock, outputBlock, nInputChannels);
+                    break;
+            }
+        }
+
+        clearUnusedChannels (matrix, outputBlock);
+    }
+
+    void clearUnusedChannels (ReferenceCountedMatrix& matrix,
+                              juce::dsp::AudioBlock<float>& outputBlock)
+    {
+        auto& routing = matrix.getRoutingArrayReference();
+        if (routing.size() > sortedRouting.getNumAllocated())
+        {
+            jassertfalse; // should have been allocated already
+            return;
+        }
+
+        sortedRouting.clearQuick();
+        sortedRouting.addArray (routing);
+        sortedRouting.sort();
+
+        int lastDest = -1;
+        const int nElements = sortedRouting.size();
+        for (int i = 0; i < nElements; ++i)
+        {
+            const int destCh = sortedRouting[i];
+            for (; ++lastDest < destCh;)
+                if (lastDest < outputBlock.getNumChannels())
+                    juce::FloatVectorOperations::clear (outputBlock.getChannelPointer (lastDest),
+                                                        (int) outputBlock.getNumSamples());
+            lastDest = destCh;
+        }
+
+        for (int ch = sortedRouting.getLast() + 1; ch < outputBlock.getNumChannels(); ++ch)
+            juce::FloatVectorOperations::clear (outputBlock.getChannelPointer (ch),
+                                                (int) outputBlock.getNumSamples());
+    }
+
+    /** Fades linearly from the previous matrix' output (oldBlock) to outputBlock. */
+    void crossfade (const juce::dsp::AudioBlock<float>& oldBlock,
+                    juce::dsp::AudioBlock<float>& outputBlock)
+    {
+        const int nSamples = juce::jmin (static_cast<int> (outputBlock.getNumSamples()),
+                                         fadeLength - fadeSamplesDone);
+        const int nChannels = static_cast<int> (outputBlock.getNumChannels());
+        const int nOldChannels = static_cast<int> (oldBlock.getNumChannels());
+
+        float* newGains = fadeGains.getWritePointer (0);
+        float* oldGains = fadeGains.getWritePointer (1);
+        const float step = 1.0f / fadeLength;
+        for (int i = 0; i < nSamples; ++i)
+        {
+            newGains[i] = (fadeSamplesDone + i + 1) * step;
+            oldGains[i] = 1.0f - newGains[i];
+        }
+
+        for (int ch = 0; ch < nChannels; ++ch)
+        {
+            float* dest = outputBlock.getChannelPointer (ch);
+            juce::FloatVectorOperations::multiply (dest, newGains, nSamples);
+            if (ch < nOldChannels)
+                juce::FloatVectorOperations::addWithMultiply (dest,
+                                                              oldBlock.getChannelPointer (ch),
+                                                              oldGains,
+                                                              nSamples);
+        }
+
+        fadeSamplesDone += nSamples;
+        if (fadeSamplesDone >= fadeLength)
+            retireMatrix (previousMatrix);
+    }
+
+    void updateInterpolationLength()
+    {
+        if (spec.sampleRate > 0)
+            fadeLength = juce::roundToInt (interpolationTime * spec.sampleRate);
+    }
+
+    void allocateForMatrixSize (const int rows, const int cols)
+    {
+        kernel.prepare (cols);
+        coefficientRowPointers.ensureStorageAllocated (rows);
+        destinationPointers.ensureStorageAllocated (rows);
+        sortedRouting.ensureStorageAllocated (rows);
+        inputPointers.ensureStorageAllocated (cols);
+    }
 
-        const int nInputChannels = juce::jmin (static_cast<int> (inputBlock.getNumChannels()),
-                                               static_cast<int> (T.getNumColumns()));
+    void processRowByRow (ReferenceCountedMatrix& matrix,
+                          const juce::dsp::AudioBlock<float>& inputBlock,
+                          juce::dsp::AudioBlock<float>& outputBlock,
+                          const int nInputChannels)
+    {
+        auto& T = matrix.getMatrix();
+        auto& routing = matrix.getRoutingArrayReference();
+        const int nRows = static_cast<int> (T.getNumRows());
         const int nSamples = static_cast<int> (inputBlock.getNumSamples());
 
-        for (int row = 0; row < T.getNumRows(); ++row)
+        for (int row = 0; row < nRows; ++row)
         {
-            const int destCh = retainedCurrentMatrix->getRoutingArrayReference().getUnchecked (row);
+            const int destCh = routing.getUnchecked (row);
             if (destCh < outputBlock.getNumChannels())
             {
                 float* dest = outputBlock.getChannelPointer (destCh);
@@ -122,67 +429,186 @@ public:
                                                                   nSamples);
             }
         }
+    }
 
-        juce::Array<int> routingCopy (retainedCurrentMatrix->getRoutingArrayReference());
-        routingCopy.sort();
-        int lastDest = -1;
-        const int nElements = routingCopy.size();
-        for (int i = 0; i < nElements; ++i)
+    void processDense (ReferenceCountedMatrix& matrix,
+                       const juce::dsp::AudioBlock<float>& inputBlock,
+                       juce::dsp::AudioBlock<float>& outputBlock,
+                       const int nInputChannels)
+    {
+        auto& T = matrix.getMatrix();
+        const int nRows = static_cast<int> (T.getNumRows());
+
+        if (nRows < DenseMatrixKernel::tileRows || nInputChannels < DenseMatrixKernel::tileRows
+            || ! canUseKernel (nRows, nInputChannels))
         {
-            const int destCh = routingCopy[i];
-            for (; ++lastDest < destCh;)
-                if (lastDest < outputBlock.getNumChannels())
-                    juce::FloatVectorOperations::clear (outputBlock.getChannelPointer (lastDest),
-                                                        (int) outputBlock.getNumSamples());
-            lastDest = destCh;
+            processRowByRow (matrix, inputBlock, outputBlock, nInputChannels);
+            return;
         }
 
-        for (int ch = routingCopy.getLast() + 1; ch < outputBlock.getNumChannels(); ++ch)
-            juce::FloatVectorOperations::clear (outputBlock.getChannelPointer (ch),
-                                                (int) outputBlock.getNumSamples());
+        processDenseBlock (matrix, inputBlock, outputBlock, 0, nRows, 0, nInputChannels);
     }
 
-    const bool checkIfNewMatrixAvailable()
+    void processBlockDiagonal (ReferenceCountedMatrix& matrix,
+                               const juce::dsp::AudioBlock<float>& inputBlock,
+                               juce::dsp::AudioBlock<float>& outputBlock,
+                               const int nInputChannels)
     {
-        if (newMatrixAvailable)
+        auto& T = matrix.getMatrix();
+        if (! canUseKernel (static_cast<int> (T.getNumRows()), nInputChannels))
         {
-            newMatrixAvailable = false;
-            currentMatrix = newMatrix;
-            newMatrix = nullptr;
+            processRowByRow (matrix, inputBlock, outputBlock, nInputChannels);
+            return;
+        }
 
-            if (currentMatrix != nullptr)
+        for (auto& block : matrix.getStructure().getBlocks())
+        {
+            const int nColumns =
+                juce::jmin (block.numColumns, nInputChannels - block.firstColumn);
+            processDenseBlock (matrix,
+                               inputBlock,
+                               outputBlock,
+                               block.firstRow,
+                               block.numRows,
+                               block.firstColumn,
+                               nColumns);
+        }
+    }
+
+    /** Applies the sub-matrix starting at (firstRow, firstColumn) using the blocked kernel.
+        Rows without any (available) columns are cleared.
+     */
+    void processDenseBlock (ReferenceCountedMatrix& matrix,
+                            const juce::dsp::AudioBlock<float>& inputBlock,
+                            juce::dsp::AudioBlock<float>& outputBlock,
+                            const int firstRow,
+                            const int numRows,
+                            const int firstColumn,
+                            const int numColumns)
+    {
+        auto& T = matrix.getMatrix();
+        auto& routing = matrix.getRoutingArrayReference();
+        const int nColumnsTotal = static_cast<int> (T.getNumColumns());
+        const int nSamples = static_cast<int> (inputBlock.getNumSamples());
+
+        coefficientRowPointers.clearQuick();
+        destinationPointers.clearQuick();
+        inputPointers.clearQuick();
+
+        const float* coefficients = T.getRawDataPointer();
+        for (int row = firstRow; row < firstRow + numRows; ++row)
+        {
+            const int destCh = routing.getUnchecked (row);
+            if (destCh < outputBlock.getNumChannels())
             {
-                DBG ("MatrixTransformer: New matrix with name '" << currentMatrix->getName()
-                                                                 << "' set.");
-                const int cols = (int) currentMatrix->getMatrix().getNumColumns();
-                buffer.setSize (cols, buffer.getNumSamples());
-                DBG ("MatrixTransformer: buffer resized to " << buffer.getNumChannels() << "x"
-                                                             << buffer.getNumSamples());
+                if (numColumns <= 0)
+                {
+                    juce::FloatVectorOperations::clear (outputBlock.getChannelPointer (destCh),
+                                                        nSamples);
+                    continue;
+                }
+                coefficientRowPointers.add (coefficients + row * nColumnsTotal + firstColumn);
+                destinationPointers.add (outputBlock.getChannelPointer (destCh));
             }
-
-            return true;
         }
-        return false;
-    };
 
-    void setMatrix (ReferenceCountedMatrix::Ptr newMatrixToUse, bool force = false)
+        if (coefficientRowPointers.isEmpty())
+            return;
+
+        for (int i = 0; i < numColumns; ++i)
+            inputPointers.add (inputBlock.getChannelPointer (firstColumn + i));
+
+        kernel.process (coefficientRowPointers.getRawDataPointer(),
+                        destinationPointers.getRawDataPointer(),
+                        coefficientRowPointers.size(),
+                        inputPointers.getRawDataPointer(),
+                        numColumns,
+                        nSamples);
+    }
+
+    /** Applies the matrix using its compressed sparse row representation. Also covers the
+        diagonal and permutation types, where each row has at most one non-zero element.
+     */
+    void processSparse (ReferenceCountedMatrix& matrix,
+                        const juce::dsp::AudioBlock<float>& inputBlock,
+                        juce::dsp::AudioBlock<float>& outputBlock,
+                        const int nInputChannels)
     {
-        newMatrix = newMatrixToUse;
-        newMatrixAvailable = true;
-        if (force)
-            checkIfNewMatrixAvailable();
+        auto& T = matrix.getMatrix();
+        auto& routing = matrix.getRoutingArrayReference();
+        auto& structure = matrix.getStructure();
+        const int* rowStart = structure.getRowStartArray().begin();
+        const int* columnIndices = structure.getColumnIndexArray().begin();
+        const int nRows = static_cast<int> (T.getNumRows());
+        const int nColumns = static_cast<int> (T.getNumColumns());
+        const int nSamples = static_cast<int> (inputBlock.getNumSamples());
+        const float* coefficients = T.getRawDataPointer();
+
+        for (int row = 0; row < nRows; ++row)
+        {
+            const int destCh = routing.getUnchecked (row);
+            if (destCh >= outputBlock.getNumChannels())
+                continue;
+
+            float* dest = outputBlock.getChannelPointer (destCh);
+            bool isFirst = true;
+            for (int k = rowStart[row]; k < rowStart[row + 1]; ++k)
+            {
+                const int col = columnIndices[k];
+                if (col >= nInputChannels)
+                    break;
+
+                const float value = coefficients[row * nColumns + col];
+                const float* src = inputBlock.getChannelPointer (col);
+                if (! isFirst)
+                    juce::FloatVectorOperations::addWithMultiply (dest, src, value, nSamples);
+                else if (value == 1.0f)
+                    juce::FloatVectorOperations::copy (dest, src, nSamples);
+                else
+                    juce::FloatVectorOperations::multiply (dest, src, value, nSamples);
+
+                isFirst = false;
+            }
+
+            if (isFirst) // no non-zero elements
+                juce::FloatVectorOperations::clear (dest, nSamples);
+        }
     }
 
-    ReferenceCountedMatrix::Ptr getMatrix() { return currentMatrix; }
+    bool canUseKernel (const int nRows, const int nInputChannels)
+    {
+        return nInputChannels <= kernel.getMaximumNumInputs()
+               && nRows <= coefficientRowPointers.getNumAllocated();
+    }
 
-private:
     //==============================================================================
     juce::dsp::ProcessSpec spec = { -1, 0, 0 };
     ReferenceCountedMatrix::Ptr currentMatrix { nullptr };
     ReferenceCountedMatrix::Ptr newMatrix { nullptr };
+    ReferenceCountedMatrix::Ptr previousMatrix { nullptr };
 
     juce::AudioBuffer<float> buffer;
     bool bufferPrepared { false };
 
     bool newMatrixAvailable { false };
+
+    // matrices which aren't used anymore, released on a non-realtime thread
+    static constexpr int maxNumChannels = 64;
+    int preparedNumChannels { 0 };
+
+    static constexpr int numRetiredMatrices = 16;
+    ReferenceCountedMatrix::Ptr retiredMatrices[numRetiredMatrices];
+    juce::AbstractFifo retiredFifo { numRetiredMatrices };
+
+    // crossfading
+    float interpolationTime { 0.0f };
+    int fadeLength { 0 };
+    int fadeSamplesDone { 0 };
+    juce::AudioBuffer<float> fadeBuffer, fadeGains;
+
+    DenseMatrixKernel kernel;
+    bool useOptimizedKernels { true };
+    juce::Array<const float*> coefficientRowPointers, inputPointers;
+    juce::Array<float*> destinationPointers;
+    juce::Array<int> sortedRouting;
 };
@@ -0,0 +1,217 @@
+/*
+ ==============================================================================
+ This file is part of the IEM plug-in suite.
+ Author: Daniel Rudrich
+ Copyright (c) 2024 - Institute of Electronic Music and Acoustics (IEM)
+ https://iem.at
+
+ The IEM plug-in suite is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ The IEM plug-in suite is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this software.  If not, see <https://www.gnu.org/licenses/>.
+ ==============================================================================
+ */
+
+#pragma once
+
+/**
+ Describes the sparsity structure of a matrix, so the MatrixMultiplication can choose a
+ kernel whose cost scales with the number of non-zero elements instead of rows * columns.
+
+ Only the structure (positions of the non-zero elements) is stored, the values are still read
+ from the dense matrix. Therefore, the values may change (e.g. by removing decoder weights),
+ as long as no zero elements become non-zero. In that case analyse() has to be called again.
+ */
+class MatrixStructure
+{
+public:
+    enum class Type
+    {
+        dense, // no exploitable structure, or not analysed
+        diagonal, // non-zero elements only on the main diagonal
+        permutation, // at most one non-zero element per row and column (channel routing)
+        blockDiagonal, // independent dense blocks along the diagonal
+        sparse // compressed sparse row (CSR) representation
+    };
+
+    struct Block
+    {
+        int firstRow, numRows;
+        int firstColumn, numColumns;
+    };
+
+    MatrixStructure() {}
+
+    /**
+     Analyses the matrix and chooses the cheapest representation.
+     Has to be called from a non-realtime thread as it allocates.
+     */
+    void analyse (const juce::dsp::Matrix<float>& matrix)
+    {
+        clear();
+
+        const int nRows = static_cast<int> (matrix.getNumRows());
+        const int nCols = static_cast<int> (matrix.getNumColumns());
+        if (nRows == 0 || nCols == 0)
+            return;
+
+        const float* data = matrix.getRawDataPointer();
+
+        // CSR representation, needed for the diagonal, permutation and sparse types
+        bool onlyDiagonal = true;
+        bool maxOnePerRow = true;
+        juce::Array<int> entriesPerColumn;
+        entriesPerColumn.insertMultiple (0, 0, nCols);
+
+        rowStart.ensureStorageAllocated (nRows + 1);
+        rowStart.add (0);
+        for (int r = 0; r < nRows; ++r)
+        {
+            int nInRow = 0;
+            for (int c = 0; c < nCols; ++c)
+            {
+                if (data[r * nCols + c] != 0.0f)
+                {
+                    columnIndices.add (c);
+                    entriesPerColumn.getReference (c)++;
+                    ++nInRow;
+
+                    if (r != c)
+                        onlyDiagonal = false;
+                }
+            }
+
+            if (nInRow > 1)
+                maxOnePerRow = false;
+
+            rowStart.add (columnIndices.size());
+        }
+
+        numNonZeros = columnIndices.size();
+
+        bool maxOnePerColumn = true;
+        for (int c = 0; c < nCols; ++c)
+            if (entriesPerColumn[c] > 1)
+                maxOnePerColumn = false;
+
+        if (onlyDiagonal)
+            type = Type::diagonal;
+        else if (maxOnePerRow && maxOnePerColumn)
+            type = Type::permutation;
+        else if (findBlocks (data, nRows, nCols))
+            type = Type::blockDiagonal;
+        else if (numNonZeros <= sparseThreshold * nRows * nCols)
+            type = Type::sparse;
+        else
+            clear();
+    }
+
+    void clear()
+    {
+        type = Type::dense;
+        numNonZeros = 0;
+        rowStart.clearQuick();
+        columnIndices.clearQuick();
+        blocks.clearQuick();
+    }
+
+    Type getType() const { return type; }
+
+    int getNumNonZeros() const { return numNonZeros; }
+
+    /** CSR row pointers (numRows + 1 entries), valid for all types except blockDiagonal. */
+    const juce::Array<int>& getRowStartArray() const { return rowStart; }
+
+    /** CSR column indices (numNonZeros entries), valid for all types except blockDiagonal. */
+    const juce::Array<int>& getColumnIndexArray() const { return columnIndices; }
+
+    /** The dense blocks, valid for the blockDiagonal type. */
+    const juce::Array<Block>& getBlocks() const { return blocks; }
+
+    juce::String getTypeString() const
+    {
+        switch (type)
+        {
+            case Type::diagonal:
+                return "diagonal";
+            case Type::permutation:
+                return "permutation";
+            case Type::blockDiagonal:
+                return "block-diagonal (" + juce::String (blocks.size()) + " blocks)";
+            case Type::sparse:
+                return "sparse (" + juce::String (numNonZeros) + " non-zeros)";
+            default:
+                return "dense";
+        }
+    }
+
+private:
+    /**
+     Splits the matrix into contiguous blocks along the diagonal. A block ends after row r, if
+     all rows up to r only use columns left of the columns used by all following rows.
+     Returns true if at least two blocks are found and they cover at most half of the matrix.
+     */
+    bool findBlocks (const float* data, const int nRows, const int nCols)
+    {
+        juce::Array<int> minColumn, maxColumn;
+        for (int r = 0; r < nRows; ++r)
+        {
+            int minC = nCols, maxC = -1;
+            for (int c = 0; c < nCols; ++c)
+                if (data[r * nCols + c] != 0.0f)
+                {
+                    minC = juce::jmin (minC, c);
+                    maxC = juce::jmax (maxC, c);
+                }
+            minColumn.add (minC);
+            maxColumn.add (maxC);
+        }
+
+        // minimum column used by the rows r ... nRows - 1
+        juce::Array<int> suffixMinColumn;
+        suffixMinColumn.insertMultiple (0, nCols, nRows + 1);
+        for (int r = nRows; --r >= 0;)
+            suffixMinColumn.set (r, juce::jmin (minColumn[r], suffixMinColumn[r + 1]));
+
+        int firstRow = 0, firstColumn = 0, maxColumnSoFar = -1;
+        int area = 0;
+        for (int r = 0; r < nRows; ++r)
+        {
+            maxColumnSoFar = juce::jmax (maxColumnSoFar, maxColumn[r]);
+            if (r == nRows - 1 || maxColumnSoFar < suffixMinColumn[r + 1])
+            {
+                const int lastColumn = r == nRows - 1 ? nCols - 1 : maxColumnSoFar;
+                Block block {
+                    firstRow, r - firstRow + 1, firstColumn, lastColumn - firstColumn + 1
+                };
+                blocks.add (block);
+                area += block.numRows * juce::jmax (0, block.numColumns);
+
+                firstRow = r + 1;
+                firstColumn = lastColumn + 1;
+            }
+        }
+
+        if (blocks.size() > 1 && 2 * area <= nRows * nCols)
+            return true;
+
+        blocks.clearQuick();
+        return false;
+    }
+
+    //==============================================================================
+    static constexpr float sparseThreshold = 0.25f;
+
+    Type type = Type::dense;
+    int numNonZeros = 0;
+    juce::Array<int> rowStart, columnIndices;
+    juce::Array<Block> blocks;
+};
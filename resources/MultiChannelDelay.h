@@ -22,13 +22,24 @@
 
 #pragma once
 #include "../JuceLibraryCode/JuceHeader.h"
+#include "Delay.h"
 
 using namespace juce::dsp;
 
+/**
+ Delays each channel by its own amount. The line is allocated in prepare() for the maximum delay
+ time, so setDelayTime() doesn't allocate or clear anything and can be called while playing:
+ process() crossfades each changed channel from its old to its new delay across the next block.
+ Optionally, fractional delays are read with linear interpolation, otherwise delay times are
+ truncated to whole samples. Like Delay, the target delays are atomic, as they're usually set from
+ another thread than the audio thread, for up to maxNumChannels channels.
+ */
 template <typename FloatType>
 class MultiChannelDelay : private ProcessorBase
 {
 public:
+    static constexpr int maxNumChannels = 64;
+
     MultiChannelDelay() {}
     ~MultiChannelDelay() {}
 
@@ -38,16 +49,9 @@ public:
 
         if (channel < numChannels)
         {
-            if (delayTimeInSeconds <= 0.0f)
-            {
-                delayInSeconds.setUnchecked (channel, 0.0f);
-            }
-            else
-            {
-                delayInSeconds.setUnchecked (channel, delayTimeInSeconds);
-            }
-            delayInSamples.setUnchecked (channel,
-                                         delayInSeconds.getUnchecked (channel) * spec.sampleRate);
+            delayInSeconds[channel] = juce::jlimit (0.0f, maxDelay, delayTimeInSeconds);
+            delayInSamples[channel].store (toSamples (delayInSeconds[channel]),
+                                           std::memory_order_relaxed);
         }
     }
 
@@ -55,24 +59,38 @@ public:
     {
         jassert (channel < numChannels);
         if (channel < numChannels)
-            return delayInSamples[channel];
+            return static_cast<int> (delayInSamples[channel].load (std::memory_order_relaxed));
         else
             return 0;
     }
 
-    void setMaxDelayTime (const int maxDelayTimeInSeconds) { maxDelay = maxDelayTimeInSeconds; }
+    /** Sets the delay time the line is allocated for with the next prepare() call. */
+    void setMaxDelayTime (const float maxDelayTimeInSeconds) { maxDelay = maxDelayTimeInSeconds; }
+
+    /** Enables fractional delays, which are read with linear interpolation. Takes effect with
+        the next setDelayTime() or prepare() call. */
+    void setFractionalDelays (bool shouldUseFractionalDelays)
+    {
+        fractionalDelays = shouldUseFractionalDelays;
+    }
 
     void prepare (const juce::dsp::ProcessSpec& specs) override
     {
+        jassert (specs.numChannels <= maxNumChannels);
         spec = specs;
 
-        const int maxDelayInSamples = specs.sampleRate * maxDelay;
-        buffer.setSize (specs.numChannels, specs.maximumBlockSize + maxDelayInSamples);
+        // one more sample for the interpolation
+        const int maxDelayInSamples = static_cast<int> (std::ceil (specs.sampleRate * maxDelay));
+        buffer.setSize (specs.numChannels, specs.maximumBlockSize + maxDelayInSamples + 1);
         buffer.clear();
         writePosition = 0;
-        numChannels = specs.numChannels;
-        delayInSeconds.resize (numChannels);
-        delayInSamples.resize (numChannels);
+        numChannels = juce::jmin (static_cast<int> (specs.numChannels), maxNumChannels);
+
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            currentDelayInSamples[ch] = toSamples (delayInSeconds[ch]);
+            delayInSamples[ch].store (currentDelayInSamples[ch], std::memory_order_relaxed);
+        }
     }
 
     void process (const juce::dsp::ProcessContextReplacing<FloatType>& context) override
@@ -82,11 +100,12 @@ public:
         auto abIn = context.getInputBlock();
         auto abOut = context.getOutputBlock();
         auto L = abIn.getNumSamples();
-        auto nCh = abIn.getNumChannels();
+        auto nCh = juce::jmin (numChannels, (int) abIn.getNumChannels());
 
         // write in delay line
         int startIndex, blockSize1, blockSize2;
         getWritePositions ((int) L, startIndex, blockSize1, blockSize2);
+        const int blockStart = startIndex;
 
         for (int ch = 0; ch < nCh; ch++)
             buffer.copyFrom (ch, startIndex, abIn.getChannelPointer (ch), blockSize1);
@@ -98,6 +117,23 @@ public:
         // read from delay line
         for (int ch = 0; ch < nCh; ch++)
         {
+            const float currentDelay = currentDelayInSamples[ch];
+            const float targetDelay = delayInSamples[ch].load (std::memory_order_relaxed);
+
+            if (currentDelay != targetDelay || targetDelay != std::floor (targetDelay))
+            {
+                // changed or fractional delay
+                Delay::readCrossfaded (buffer.getReadPointer (ch),
+                                       buffer.getNumSamples(),
+                                       blockStart,
+                                       currentDelay,
+                                       targetDelay,
+                                       abOut.getChannelPointer (ch),
+                                       (int) L);
+                currentDelayInSamples[ch] = targetDelay;
+                continue;
+            }
+
             int startIndex, blockSize1, blockSize2;
             getReadPositions (ch, (int) L, startIndex, blockSize1, blockSize2);
 
@@ -148,9 +184,9 @@ public:
                            int& blockSize1,
                            int& blockSize2)
     {
-        jassert (channel < delayInSamples.size());
+        jassert (channel < numChannels);
         const int L = buffer.getNumSamples();
-        int pos = writePosition - delayInSamples.getUnchecked (channel);
+        int pos = writePosition - static_cast<int> (currentDelayInSamples[channel]);
 
         if (pos < 0)
             pos = pos + L;
@@ -174,13 +210,21 @@ public:
     }
 
 private:
+    float toSamples (const float seconds) const
+    {
+        const double samples = seconds * spec.sampleRate;
+        return static_cast<float> (fractionalDelays ? samples : std::floor (samples));
+    }
+
     //==============================================================================
     juce::dsp::ProcessSpec spec = { -1, 0, 0 };
 
-    juce::Array<float> delayInSeconds;
-    juce::Array<int> delayInSamples;
+    std::array<float, maxNumChannels> delayInSeconds {};
+    std::array<std::atomic<float>, maxNumChannels> delayInSamples {}; // set by setDelayTime()
+    std::array<float, maxNumChannels> currentDelayInSamples {}; // of the last processed block
 
     float maxDelay = 1.0f;
+    bool fractionalDelays = false;
     int numChannels = 0;
 
     int writePosition = 0;
@@ -0,0 +1,174 @@
+/*
+ ==============================================================================
+ This file is part of the IEM plug-in suite.
+ Author: Daniel Rudrich
+ Copyright (c) 2024 - Institute of Electronic Music and Acoustics (IEM)
+ https://iem.at
+
+ The IEM plug-in suite is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ The IEM plug-in suite is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this software.  If not, see <https://www.gnu.org/licenses/>.
+ ==============================================================================
+ */
+
+#pragma once
+
+#include <JuceHeader.h>
+
+/**
+ Delay line for many channels sharing the same, per-sample modulated delay time, e.g. all
+ channels of an Ambisonic signal. The fractional delay is read with third-order Lagrange
+ interpolation, like juce::dsp::DelayLine with DelayLineInterpolationTypes::Lagrange3rd.
+
+ The delay memory is stored interleaved, i.e. all channels of one sample are contiguous, so the
+ interpolation weights are computed once per sample and applied to all channels with SIMD
+ registers.
+ */
+class MultiChannelModulatedDelay
+{
+#if JUCE_USE_SIMD
+    using SIMDfloat = juce::dsp::SIMDRegister<float>;
+    static constexpr int SIMDfloat_elements = juce::dsp::SIMDRegister<float>::size();
+#else /* !JUCE_USE_SIMD */
+    using SIMDfloat = float;
+    static constexpr int SIMDfloat_elements = 1;
+#endif /* JUCE_USE_SIMD */
+
+public:
+    MultiChannelModulatedDelay() {}
+
+    /** Allocates the delay memory, has to be called from a non-realtime thread. */
+    void prepare (const int numberOfChannels, const int maximumDelayInSamples)
+    {
+        numChannels = numberOfChannels;
+        maxDelay = maximumDelayInSamples;
+        channelVectors = (numChannels + SIMDfloat_elements - 1) / SIMDfloat_elements;
+
+        // the interpolation reads up to three samples beyond the maximum delay
+        numRows = maxDelay + 4;
+
+        const int numVectors = juce::jmax (1, numRows * channelVectors + 2 * channelVectors);
+        juce::dsp::AudioBlock<SIMDfloat> block (lineData, 1, (size_t) numVectors);
+        line = block.getChannelPointer (0);
+        inputRow = line + numRows * channelVectors;
+        outputRow = inputRow + channelVectors;
+
+        reset();
+    }
+
+    /** Clears the delay memory. */
+    void reset()
+    {
+        juce::FloatVectorOperations::clear (reinterpret_cast<float*> (line),
+                                            numRows * channelVectors * SIMDfloat_elements);
+        juce::FloatVectorOperations::clear (reinterpret_cast<float*> (inputRow),
+                                            2 * channelVectors * SIMDfloat_elements);
+        writeRow = 0;
+        numActiveChannels = 0;
+    }
+
+    int getMaximumDelayInSamples() const { return maxDelay; }
+
+    /**
+     Writes the inputs into the delay line and reads the outputs, with the delay time (in
+     samples) of each sample given by delaysInSamples. Inputs and outputs may be the same.
+     */
+    void process (const float* const* inputs,
+                  float* const* outputs,
+                  const float* delaysInSamples,
+                  const int numChannelsToProcess,
+                  const int numSamples)
+    {
+        jassert (numChannelsToProcess <= numChannels);
+
+        // channels which haven't been processed before start with a cleared line
+        if (numChannelsToProcess > numActiveChannels)
+        {
+            for (int row = 0; row < numRows; ++row)
+            {
+                float* rowData = reinterpret_cast<float*> (line + row * channelVectors);
+                juce::FloatVectorOperations::clear (rowData + numActiveChannels,
+                                                    numChannelsToProcess - numActiveChannels);
+            }
+        }
+        numActiveChannels = numChannelsToProcess;
+
+        const int nVectors = (numChannelsToProcess + SIMDfloat_elements - 1) / SIMDfloat_elements;
+        float* in = reinterpret_cast<float*> (inputRow);
+        float* out = reinterpret_cast<float*> (outputRow);
+
+        for (int n = 0; n < numSamples; ++n)
+        {
+            // interleave the input sample
+            for (int ch = 0; ch < numChannelsToProcess; ++ch)
+                in[ch] = inputs[ch][n];
+
+            SIMDfloat* row = line + writeRow * channelVectors;
+            for (int v = 0; v < nVectors; ++v)
+                row[v] = inputRow[v];
+
+            // Lagrange weights, the integer delay is reduced by one to center the
+            // interpolation points around the fractional delay
+            const float delay =
+                juce::jlimit (0.0f, static_cast<float> (maxDelay), delaysInSamples[n]);
+            int delayInt = static_cast<int> (delay);
+            float delayFrac = delay - static_cast<float> (delayInt);
+            if (delayInt >= 1)
+            {
+                delayFrac += 1.0f;
+                --delayInt;
+            }
+
+            const float d1 = delayFrac - 1.0f;
+            const float d2 = delayFrac - 2.0f;
+            const float d3 = delayFrac - 3.0f;
+            const SIMDfloat w1 (-d1 * d2 * d3 / 6.0f);
+            const SIMDfloat w2 (delayFrac * d2 * d3 * 0.5f);
+            const SIMDfloat w3 (-delayFrac * d1 * d3 * 0.5f);
+            const SIMDfloat w4 (delayFrac * d1 * d2 / 6.0f);
+
+            const SIMDfloat* r1 = getRow (writeRow - delayInt);
+            const SIMDfloat* r2 = getRow (writeRow - delayInt - 1);
+            const SIMDfloat* r3 = getRow (writeRow - delayInt - 2);
+            const SIMDfloat* r4 = getRow (writeRow - delayInt - 3);
+
+            for (int v = 0; v < nVectors; ++v)
+                outputRow[v] = w1 * r1[v] + w2 * r2[v] + w3 * r3[v] + w4 * r4[v];
+
+            // de-interleave the output sample
+            for (int ch = 0; ch < numChannelsToProcess; ++ch)
+                outputs[ch][n] = out[ch];
+
+            if (++writeRow == numRows)
+                writeRow = 0;
+        }
+    }
+
+private:
+    const SIMDfloat* getRow (int row) const
+    {
+        if (row < 0)
+            row += numRows;
+        return line + row * channelVectors;
+    }
+
+    //==============================================================================
+    int numChannels = 0, maxDelay = 0;
+    int channelVectors = 0, numRows = 0;
+    int writeRow = 0;
+    int numActiveChannels = 0; // number of channels processed with the last call
+
+    juce::HeapBlock<char> lineData;
+    SIMDfloat* line = nullptr; // numRows rows of channelVectors vectors each
+    SIMDfloat* inputRow = nullptr;
+    SIMDfloat* outputRow = nullptr;
+};
@@ -0,0 +1,527 @@
+/*
+ ==============================================================================
+ This file is part of the IEM plug-in suite.
+ Author: Daniel Rudrich
+ Copyright (c) 2024 - Institute of Electronic Music and Acoustics (IEM)
+ https://iem.at
+
+ The IEM plug-in suite is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ The IEM plug-in suite is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this software.  If not, see <https://www.gnu.org/licenses/>.
+ ==============================================================================
+ */
+
+#pragma once
+
+#include <JuceHeader.h>
+
+/**
+ Uniformly partitioned overlap-save convolution of several input channels, each filtered with
+ its own impulse response and summed into one of several output channels.
+
+ The impulse responses are split into partitions of `partitionSize` samples, which are
+ transformed with FFTs of twice the partition size. The spectra of the past input partitions
+ are kept in a frequency-domain delay line, so each input partition is only transformed once,
+ independent of the host block size. The spectra are stored as separate real and imaginary
+ parts in aligned memory, so the complex multiply-accumulate runs on SIMD registers.
+
+ The convolution has no latency. Each input partition is transformed once it's complete.
+ While a partition is incomplete, the contribution of all previous partitions is transformed
+ back once, and the one of the current partition's samples is added in the time domain with
+ the first partitionSize taps of each filter. If that direct-form head gets more expensive
+ than transforming the incomplete partition, e.g. for small blocks late in a partition, the
+ partition is transformed instead.
+ */
+class PartitionedConvolution
+{
+#if JUCE_USE_SIMD
+    using SIMDfloat = juce::dsp::SIMDRegister<float>;
+    static constexpr int SIMDfloat_elements = juce::dsp::SIMDRegister<float>::size();
+#else /* !JUCE_USE_SIMD */
+    using SIMDfloat = float;
+    static constexpr int SIMDfloat_elements = 1;
+#endif /* JUCE_USE_SIMD */
+
+public:
+    PartitionedConvolution() {}
+
+    /**
+     Allocates all buffers, has to be called from a non-realtime thread. All filters are
+     cleared afterwards, so setFilter() has to be called for each input channel.
+     */
+    void prepare (const int numInputChannels,
+                  const int numOutputChannels,
+                  const int newPartitionSize,
+                  const int maximumIRLength)
+    {
+        jassert (juce::isPowerOfTwo (newPartitionSize));
+
+        numInputs = numInputChannels;
+        numOutputs = numOutputChannels;
+        partitionSize = newPartitionSize;
+        numPartitions = juce::jmax (1, (maximumIRLength + partitionSize - 1) / partitionSize);
+
+        const int fftSize = 2 * partitionSize;
+        fftOrder = static_cast<int> (std::log2 (fftSize));
+        fft = std::make_unique<juce::dsp::FFT> (fftOrder);
+        fftBuffer.setSize (1, 2 * fftSize);
+
+        numBins = partitionSize + 1;
+        binVectors = (numBins + SIMDfloat_elements - 1) / SIMDfloat_elements;
+        const int spectrumVectors = 2 * binVectors; // real and imaginary part
+
+        filters = allocate (filtersData, numInputs * numPartitions * spectrumVectors);
+        fdl = allocate (fdlData, numInputs * numPartitions * spectrumVectors);
+        tailAccumulator = allocate (tailAccumulatorData, numOutputs * spectrumVectors);
+        accumulator = allocate (accumulatorData, numOutputs * spectrumVectors);
+
+        segments.setSize (numInputs, fftSize);
+        heads.setSize (numInputs, partitionSize);
+        heads.clear();
+        tailOutput.setSize (numOutputs, partitionSize);
+        inputSpectrum = allocate (inputSpectrumData, spectrumVectors);
+        outputForInput.clearQuick();
+        outputForInput.insertMultiple (0, -1, numInputs);
+
+        reset();
+    }
+
+    /** Clears the input history, e.g. when the playback starts. */
+    void reset()
+    {
+        segments.clear();
+        clear (fdl, numInputs * numPartitions * 2 * binVectors);
+        clear (tailAccumulator, numOutputs * 2 * binVectors);
+        fdlPosition = 0;
+        partitionPosition = 0;
+        tailOutputComputed = false;
+    }
+
+    /**
+     Sets the impulse response of an input channel, which will be added to the given output
+     channel. An output index of -1 mutes the input. Has to be called from a non-realtime
+     thread, irLength must not exceed the maximum length passed to prepare().
+     */
+    void setFilter (const int input, const int output, const float* ir, const int irLength)
+    {
+        jassert (input < numInputs && output < numOutputs);
+        jassert (irLength <= numPartitions * partitionSize);
+
+        outputForInput.set (input, output);
+
+        heads.clear (input, 0, partitionSize);
+        heads.copyFrom (input, 0, ir, juce::jmin (irLength, partitionSize));
+
+        for (int k = 0; k < numPartitions; ++k)
+        {
+            float* fftData = fftBuffer.getWritePointer (0);
+            juce::FloatVectorOperations::clear (fftData, fftBuffer.getNumSamples());
+
+            const int start = k * partitionSize;
+            const int length = juce::jlimit (0, partitionSize, irLength - start);
+            if (length > 0)
+                juce::FloatVectorOperations::copy (fftData, ir + start, length);
+
+            fft->performRealOnlyForwardTransform (fftData);
+            deinterleave (fftData, getFilter (input, k));
+        }
+    }
+
+    /**
+     Filters the inputs and writes the sums into the outputs (overwriting them). Inputs and
+     outputs must not overlap. The number of samples is arbitrary.
+     */
+    void process (const float* const* inputs, float* const* outputs, const int numSamples)
+    {
+        int done = 0;
+        while (done < numSamples)
+        {
+            const int n = juce::jmin (numSamples - done, partitionSize - partitionPosition);
+
+            for (int i = 0; i < numInputs; ++i)
+                if (outputForInput.getUnchecked (i) >= 0)
+                    juce::FloatVectorOperations::copy (segments.getWritePointer (i)
+                                                           + partitionSize + partitionPosition,
+                                                       inputs[i] + done,
+                                                       n);
+
+            if (partitionPosition + n < partitionSize && isDirectHeadCheaper (n))
+                processDirectHead (outputs, done, n);
+            else
+                processTransformed (outputs, done, n);
+
+            done += n;
+            partitionPosition += n;
+
+            if (partitionPosition == partitionSize)
+                finishPartition();
+        }
+    }
+
+    /**
+     Writes the filter spectra and the output assignment to a stream, e.g. to cache them on disk.
+     The data doesn't depend on the SIMD register size or the byte order of the machine, all
+     values are stored little endian.
+     */
+    bool writeFilters (juce::OutputStream& stream) const
+    {
+        bool ok = stream.writeInt (numInputs) && stream.writeInt (numOutputs)
+                  && stream.writeInt (partitionSize) && stream.writeInt (numPartitions);
+
+        for (int i = 0; i < numInputs; ++i)
+            ok = ok && stream.writeInt (outputForInput[i]);
+
+        for (int i = 0; i < numInputs; ++i)
+            for (int k = 0; k < numPartitions; ++k)
+            {
+                const SIMDfloat* spectrum = getFilter (i, k);
+                ok = ok && writeFloats (stream, spectrum, numBins)
+                     && writeFloats (stream, spectrum + binVectors, numBins);
+            }
+
+        return ok;
+    }
+
+    /**
+     Prepares the convolution with the dimensions stored in the stream, and reads the filters
+     written by writeFilters(). Has to be called from a non-realtime thread. Returns false if
+     the stream doesn't contain valid data.
+     */
+    bool readFilters (juce::InputStream& stream)
+    {
+        const int nIn = stream.readInt();
+        const int nOut = stream.readInt();
+        const int newPartitionSize = stream.readInt();
+        const int nPartitions = stream.readInt();
+
+        if (nIn <= 0 || nOut <= 0 || nPartitions <= 0 || ! juce::isPowerOfTwo (newPartitionSize))
+            return false;
+
+        // the sizes are computed with 64 bits, as the stream might contain arbitrary values
+        const juce::int64 filterLength = static_cast<juce::int64> (nPartitions) * newPartitionSize;
+        if (filterLength > std::numeric_limits<int>::max())
+            return false;
+
+        const auto floatSize = static_cast<juce::int64> (sizeof (float));
+        const juce::int64 numBytes = (static_cast<juce::int64> (newPartitionSize) + 1) * floatSize;
+        const juce::int64 bytesPerInput =
+            static_cast<juce::int64> (sizeof (int)) + 2 * nPartitions * numBytes;
+        if (stream.getNumBytesRemaining() / nIn < bytesPerInput)
+            return false;
+
+        prepare (nIn, nOut, newPartitionSize, static_cast<int> (filterLength));
+
+        for (int i = 0; i < numInputs; ++i)
+        {
+            const int output = stream.readInt();
+            if (output < -1 || output >= numOutputs)
+                return false;
+            outputForInput.set (i, output);
+        }
+
+        for (int i = 0; i < numInputs; ++i)
+            for (int k = 0; k < numPartitions; ++k)
+            {
+                SIMDfloat* spectrum = getFilter (i, k);
+                if (! readFloats (stream, spectrum, numBins)
+                    || ! readFloats (stream, spectrum + binVectors, numBins))
+                    return false;
+            }
+
+        // the direct-form heads are the first partition of the filters
+        for (int i = 0; i < numInputs; ++i)
+        {
+            float* fftData = fftBuffer.getWritePointer (0);
+            interleave (getFilter (i, 0), fftData);
+            fft->performRealOnlyInverseTransform (fftData);
+            heads.copyFrom (i, 0, fftData, partitionSize);
+        }
+
+        return true;
+    }
+
+    int getNumInputs() const { return numInputs; }
+
+    int getPartitionSize() const { return partitionSize; }
+
+    int getNumPartitions() const { return numPartitions; }
+
+private:
+    /** Transforms the current partition of each input and writes the outputs of the chunk. */
+    void processTransformed (float* const* outputs, const int offset, const int n)
+    {
+        for (int i = 0; i < numInputs; ++i)
+        {
+            if (outputForInput.getUnchecked (i) < 0)
+                continue;
+
+            float* fftData = fftBuffer.getWritePointer (0);
+            juce::FloatVectorOperations::copy (fftData,
+                                               segments.getReadPointer (i),
+                                               2 * partitionSize);
+            fft->performRealOnlyForwardTransform (fftData);
+            deinterleave (fftData, getFDL (i, fdlPosition));
+        }
+
+        // add the current partition's contribution to the ones of the previous partitions
+        juce::FloatVectorOperations::copy (reinterpret_cast<float*> (accumulator),
+                                           reinterpret_cast<const float*> (tailAccumulator),
+                                           numOutputs * 2 * binVectors * SIMDfloat_elements);
+        for (int i = 0; i < numInputs; ++i)
+        {
+            const int o = outputForInput.getUnchecked (i);
+            if (o >= 0)
+                multiplyAccumulate (getFDL (i, fdlPosition), getFilter (i, 0), getAccumulator (o));
+        }
+
+        for (int o = 0; o < numOutputs; ++o)
+        {
+            float* fftData = fftBuffer.getWritePointer (0);
+            interleave (getAccumulator (o), fftData);
+            fft->performRealOnlyInverseTransform (fftData);
+            juce::FloatVectorOperations::copy (outputs[o] + offset,
+                                               fftData + partitionSize + partitionPosition,
+                                               n);
+        }
+    }
+
+    /** Writes the outputs of the chunk using the transformed contribution of the previous
+        partitions and the direct-form head for the samples of the current partition. */
+    void processDirectHead (float* const* outputs, const int offset, const int n)
+    {
+        if (! tailOutputComputed)
+            computeTailOutput();
+
+        for (int o = 0; o < numOutputs; ++o)
+            juce::FloatVectorOperations::copy (outputs[o] + offset,
+                                               tailOutput.getReadPointer (o, partitionPosition),
+                                               n);
+
+        const int end = partitionPosition + n;
+        for (int i = 0; i < numInputs; ++i)
+        {
+            const int o = outputForInput.getUnchecked (i);
+            if (o < 0)
+                continue;
+
+            const float* x = segments.getReadPointer (i, partitionSize);
+            const float* h = heads.getReadPointer (i);
+            float* y = outputs[o] + offset;
+
+            // each sample of the current partition adds its response to the chunk
+            for (int m = 0; m < end; ++m)
+            {
+                const int first = juce::jmax (partitionPosition, m);
+                juce::FloatVectorOperations::addWithMultiply (y + first - partitionPosition,
+                                                              h + first - m,
+                                                              x[m],
+                                                              end - first);
+            }
+        }
+    }
+
+    /** Transforms the contribution of the previous partitions to the current one back into
+        the time domain, once per partition. */
+    void computeTailOutput()
+    {
+        juce::FloatVectorOperations::copy (reinterpret_cast<float*> (accumulator),
+                                           reinterpret_cast<const float*> (tailAccumulator),
+                                           numOutputs * 2 * binVectors * SIMDfloat_elements);
+
+        // the previous partition filtered with the first filter partition, without the
+        // samples of the current one
+        for (int i = 0; i < numInputs; ++i)
+        {
+            const int o = outputForInput.getUnchecked (i);
+            if (o < 0)
+                continue;
+
+            float* fftData = fftBuffer.getWritePointer (0);
+            juce::FloatVectorOperations::copy (fftData, segments.getReadPointer (i), partitionSize);
+            juce::FloatVectorOperations::clear (fftData + partitionSize, partitionSize);
+            fft->performRealOnlyForwardTransform (fftData);
+            deinterleave (fftData, inputSpectrum);
+            multiplyAccumulate (inputSpectrum, getFilter (i, 0), getAccumulator (o));
+        }
+
+        for (int o = 0; o < numOutputs; ++o)
+        {
+            float* fftData = fftBuffer.getWritePointer (0);
+            interleave (getAccumulator (o), fftData);
+            fft->performRealOnlyInverseTransform (fftData);
+            tailOutput.copyFrom (o, 0, fftData + partitionSize, partitionSize);
+        }
+
+        tailOutputComputed = true;
+    }
+
+    /** Compares the multiply-adds of the direct-form head for a chunk of n samples with a rough
+        estimate of transforming the incomplete partition, both per input. */
+    bool isDirectHeadCheaper (const int n) const
+    {
+        const int directCost = n * (2 * partitionPosition + n + 1) / 2;
+        const int transformCost = 2 * partitionSize * fftOrder;
+        return directCost < transformCost;
+    }
+
+    /** Shifts the input segments and the delay line, and sums up the contributions of all
+        previous partitions for the next partition. */
+    void finishPartition()
+    {
+        for (int i = 0; i < numInputs; ++i)
+        {
+            float* segment = segments.getWritePointer (i);
+            juce::FloatVectorOperations::copy (segment, segment + partitionSize, partitionSize);
+            juce::FloatVectorOperations::clear (segment + partitionSize, partitionSize);
+        }
+
+        partitionPosition = 0;
+        fdlPosition = (fdlPosition + 1) % numPartitions;
+        tailOutputComputed = false;
+
+        clear (tailAccumulator, numOutputs * 2 * binVectors);
+        for (int i = 0; i < numInputs; ++i)
+        {
+            const int o = outputForInput.getUnchecked (i);
+            if (o < 0)
+                continue;
+
+            SIMDfloat* acc = tailAccumulator + o * 2 * binVectors;
+            for (int k = 1; k < numPartitions; ++k)
+            {
+                const int slot = (fdlPosition - k + numPartitions) % numPartitions;
+                multiplyAccumulate (getFDL (i, slot), getFilter (i, k), acc);
+            }
+        }
+    }
+
+    /** acc += x * h, with real and imaginary parts stored one after another. */
+    void multiplyAccumulate (const SIMDfloat* x, const SIMDfloat* h, SIMDfloat* acc)
+    {
+        const SIMDfloat* xRe = x;
+        const SIMDfloat* xIm = x + binVectors;
+        const SIMDfloat* hRe = h;
+        const SIMDfloat* hIm = h + binVectors;
+        SIMDfloat* accRe = acc;
+        SIMDfloat* accIm = acc + binVectors;
+
+        for (int v = 0; v < binVectors; ++v)
+        {
+            accRe[v] += xRe[v] * hRe[v] - xIm[v] * hIm[v];
+            accIm[v] += xRe[v] * hIm[v] + xIm[v] * hRe[v];
+        }
+    }
+
+    void deinterleave (const float* interleaved, SIMDfloat* spectrum)
+    {
+        float* re = reinterpret_cast<float*> (spectrum);
+        float* im = reinterpret_cast<float*> (spectrum + binVectors);
+        for (int b = 0; b < numBins; ++b)
+        {
+            re[b] = interleaved[2 * b];
+            im[b] = interleaved[2 * b + 1];
+        }
+    }
+
+    void interleave (const SIMDfloat* spectrum, float* interleaved)
+    {
+        const float* re = reinterpret_cast<const float*> (spectrum);
+        const float* im = reinterpret_cast<const float*> (spectrum + binVectors);
+        for (int b = 0; b < numBins; ++b)
+        {
+            interleaved[2 * b] = re[b];
+            interleaved[2 * b + 1] = im[b];
+        }
+    }
+
+    SIMDfloat* getFilter (const int input, const int partition) const
+    {
+        return filters + (input * numPartitions + partition) * 2 * binVectors;
+    }
+
+    SIMDfloat* getFDL (const int input, const int slot) const
+    {
+        return fdl + (input * numPartitions + slot) * 2 * binVectors;
+    }
+
+    SIMDfloat* getAccumulator (const int output) { return accumulator + output * 2 * binVectors; }
+
+    static SIMDfloat* allocate (juce::HeapBlock<char>& data, const int numVectors)
+    {
+        juce::dsp::AudioBlock<SIMDfloat> block (data, 1, (size_t) juce::jmax (1, numVectors));
+        SIMDfloat* ptr = block.getChannelPointer (0);
+        clear (ptr, numVectors);
+        return ptr;
+    }
+
+    static void clear (SIMDfloat* ptr, const int numVectors)
+    {
+        juce::FloatVectorOperations::clear (reinterpret_cast<float*> (ptr),
+                                            numVectors * SIMDfloat_elements);
+    }
+
+    /** Writes the floats little endian, like the integers written by juce::OutputStream. */
+    static bool writeFloats (juce::OutputStream& stream, const SIMDfloat* data, const int numValues)
+    {
+        const float* values = reinterpret_cast<const float*> (data);
+#if JUCE_BIG_ENDIAN
+        for (int i = 0; i < numValues; ++i)
+            if (! stream.writeFloat (values[i]))
+                return false;
+        return true;
+#else
+        return stream.write (values, static_cast<size_t> (numValues) * sizeof (float));
+#endif
+    }
+
+    /** Reads floats written by writeFloats(). */
+    static bool readFloats (juce::InputStream& stream, SIMDfloat* data, const int numValues)
+    {
+        float* values = reinterpret_cast<float*> (data);
+        const int numBytes = numValues * static_cast<int> (sizeof (float));
+#if JUCE_BIG_ENDIAN
+        if (stream.getNumBytesRemaining() < numBytes)
+            return false;
+        for (int i = 0; i < numValues; ++i)
+            values[i] = stream.readFloat();
+        return true;
+#else
+        return stream.read (values, numBytes) == numBytes;
+#endif
+    }
+
+    //==============================================================================
+    int numInputs = 0, numOutputs = 0;
+    int partitionSize = 0, numPartitions = 0;
+    int numBins = 0, binVectors = 0;
+
+    int fftOrder = 0;
+    int fdlPosition = 0; // slot of the current partition in the frequency-domain delay line
+    int partitionPosition = 0; // number of samples of the current partition
+    bool tailOutputComputed = false; // tailOutput is valid for the current partition
+
+    std::unique_ptr<juce::dsp::FFT> fft;
+    juce::AudioBuffer<float> fftBuffer;
+    juce::AudioBuffer<float> segments; // previous and current partition of each input
+    juce::AudioBuffer<float> heads; // first partitionSize taps of each filter
+    juce::AudioBuffer<float> tailOutput; // contribution of the previous partitions
+
+    juce::Array<int> outputForInput;
+
+    juce::HeapBlock<char> filtersData, fdlData, tailAccumulatorData, accumulatorData,
+        inputSpectrumData;
+    SIMDfloat* filters = nullptr;
+    SIMDfloat* fdl = nullptr;
+    SIMDfloat* tailAccumulator = nullptr;
+    SIMDfloat* accumulator = nullptr;
+    SIMDfloat* inputSpectrum = nullptr; // temporary spectrum of an input
+};
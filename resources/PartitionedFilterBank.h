@@ -0,0 +1,541 @@
+/*
+ ==============================================================================
+ This file is part of the IEM plug-in suite.
+ Author: Daniel Rudrich
+ Copyright (c) 2024 - Institute of Electronic Music and Acoustics (IEM)
+ https://iem.at
+
+ The IEM plug-in suite is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ The IEM plug-in suite is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this software.  If not, see <https://www.gnu.org/licenses/>.
+ ==============================================================================
+ */
+
+#pragma once
+
+#include <JuceHeader.h>
+
+/**
+ Non-uniformly partitioned overlap-save filter bank: each channel is filtered with all filters
+ of the bank, which are shared by all channels, e.g. the FIR filters of a crossover.
+
+ Contrary to PartitionedConvolution, the frequency-domain delay lines are shared by all
+ filters, so each input partition is transformed only once per channel, and only one inverse
+ transform per filter and channel is needed. The spectra are stored as separate real and
+ imaginary parts in aligned memory, so the complex multiply-accumulate runs on SIMD registers.
+
+ The first taps of the filters are processed with short partitions of `partitionSize` samples,
+ which add no latency: for an incomplete partition, the contribution of all previous
+ partitions is computed once when the partition starts. For long filters, the taps after the
+ first two long partitions are processed with long partitions, which needs a fraction of the
+ multiply-accumulates. A long partition is transformed once it is complete, and its output is
+ needed one long partition later, so the contributions of the previous long partitions and the
+ inverse transforms are spread over the short partitions, and the load is distributed evenly
+ over the blocks.
+ */
+class PartitionedFilterBank
+{
+#if JUCE_USE_SIMD
+    using SIMDfloat = juce::dsp::SIMDRegister<float>;
+    static constexpr int SIMDfloat_elements = juce::dsp::SIMDRegister<float>::size();
+#else /* !JUCE_USE_SIMD */
+    using SIMDfloat = float;
+    static constexpr int SIMDfloat_elements = 1;
+#endif /* JUCE_USE_SIMD */
+
+public:
+    PartitionedFilterBank() {}
+
+    /**
+     Allocates all buffers, has to be called from a non-realtime thread. All filters are
+     cleared afterwards, so setFilter() has to be called for each filter. The size of the long
+     partitions is chosen for the least estimated work, long partitions aren't used if they
+     don't save any.
+     */
+    void prepare (const int numberOfChannels,
+                  const int numberOfFilters,
+                  const int newPartitionSize,
+                  const int maximumFilterLength)
+    {
+        jassert (juce::isPowerOfTwo (newPartitionSize));
+
+        numChannels = numberOfChannels;
+        numFilters = numberOfFilters;
+        partitionSize = newPartitionSize;
+
+        // the long partitions take over after the taps of the first two long partitions
+        longPartitionSize = 0;
+        double leastCost = estimateCost (partitionSize, maximumFilterLength);
+        for (int size = 2 * partitionSize; 2 * size < maximumFilterLength; size *= 2)
+        {
+            const double cost = estimateCost (partitionSize, 2 * size)
+                                + estimateCost (size, maximumFilterLength - 2 * size);
+            if (cost < leastCost)
+            {
+                leastCost = cost;
+                longPartitionSize = size;
+            }
+        }
+
+        useLongPartitions = longPartitionSize > 0;
+        const int shortFilterLength =
+            useLongPartitions ? 2 * longPartitionSize : juce::jmax (1, maximumFilterLength);
+
+        shortStage.prepare (numChannels, numFilters, partitionSize, shortFilterLength, 1);
+        shortAccumulator = allocate (shortAccumulatorData, 2 * shortStage.binVectors);
+
+        if (useLongPartitions)
+        {
+            // two sets: one is summed up while the other one is transformed back
+            longStage.prepare (numChannels,
+                               numFilters,
+                               longPartitionSize,
+                               maximumFilterLength - 2 * longPartitionSize,
+                               2);
+            longOutputs.setSize (2 * numChannels * numFilters, longPartitionSize);
+        }
+
+        reset();
+    }
+
+    /** Clears the input history, e.g. when the playback starts. */
+    void reset()
+    {
+        for (int ch = 0; ch < numChannels; ++ch)
+            clearChannel (ch);
+
+        shortStage.fdlPosition = 0;
+        longStage.fdlPosition = 0;
+        partitionPosition = 0;
+        longPartitionPosition = 0;
+        longSet = 0;
+        numActiveChannels = 0;
+    }
+
+    /**
+     Sets the impulse response of a filter, irLength must not exceed the maximum length passed to
+     prepare(). Doesn't allocate, so it can be called from the audio thread, but not while
+     process() is running. The new filter is used for the tail of the current partition only
+     from the next partition on, and for the contributions of previous long partitions, which
+     are already summed up, after the next two long partitions.
+     */
+    void setFilter (const int filter, const float* ir, const int irLength)
+    {
+        jassert (filter < numFilters);
+        jassert (irLength <= shortStage.getMaximumLength() + longStage.getMaximumLength());
+
+        const int shortLength = juce::jmin (irLength, shortStage.getMaximumLength());
+        shortStage.setFilter (filter, ir, shortLength);
+
+        if (useLongPartitions)
+            longStage.setFilter (filter,
+                                 ir + shortLength,
+                                 juce::jmax (0, irLength - shortLength));
+    }
+
+    /**
+     Filters the first numChannelsToProcess input channels with all filters, outputs[f][ch]
+     receives the input channel ch filtered by filter f (overwriting it). Inputs and outputs
+     must not overlap. The number of samples is arbitrary.
+     */
+    void process (const float* const* inputs,
+                  float* const* const* outputs,
+                  const int numChannelsToProcess,
+                  const int numSamples)
+    {
+        jassert (numChannelsToProcess <= numChannels);
+
+        // channels which haven't been processed before start with a cleared history
+        for (int ch = numActiveChannels; ch < numChannelsToProcess; ++ch)
+            clearChannel (ch);
+        numActiveChannels = numChannelsToProcess;
+
+        int done = 0;
+        while (done < numSamples)
+        {
+            const int n = juce::jmin (numSamples - done, partitionSize - partitionPosition);
+            float* fftData = shortStage.fftBuffer.getWritePointer (0);
+
+            for (int ch = 0; ch < numActiveChannels; ++ch)
+            {
+                // transform the current (incomplete) partition once for all filters
+                float* segment = shortStage.segments.getWritePointer (ch);
+                juce::FloatVectorOperations::copy (segment + partitionSize + partitionPosition,
+                                                   inputs[ch] + done,
+                                                   n);
+                shortStage.transformSegment (ch);
+                const SIMDfloat* x = shortStage.getFDL (ch, shortStage.fdlPosition);
+
+                for (int f = 0; f < numFilters; ++f)
+                {
+                    juce::FloatVectorOperations::copy (
+                        reinterpret_cast<float*> (shortAccumulator),
+                        reinterpret_cast<const float*> (shortStage.getAccumulator (ch, f)),
+                        2 * shortStage.binVectors * SIMDfloat_elements);
+                    shortStage.multiplyAccumulate (x,
+                                                   shortStage.getFilter (f, 0),
+                                                   shortAccumulator);
+
+                    shortStage.interleave (shortAccumulator, fftData);
+                    shortStage.fft->performRealOnlyInverseTransform (fftData);
+                    juce::FloatVectorOperations::copy (outputs[f][ch] + done,
+                                                       fftData + partitionSize + partitionPosition,
+                                                       n);
+                }
+            }
+
+            if (useLongPartitions)
+                processLongPartitions (inputs, outputs, done, n);
+
+            done += n;
+            partitionPosition += n;
+
+            if (partitionPosition == partitionSize)
+                finishPartition();
+        }
+    }
+
+    int getNumChannels() const { return numChannels; }
+
+    int getNumFilters() const { return numFilters; }
+
+    int getPartitionSize() const { return partitionSize; }
+
+    /** Returns the size of the long partitions, or 0 if the filters are short enough to be
+        processed with short partitions only. */
+    int getLongPartitionSize() const { return longPartitionSize; }
+
+private:
+    /** Rough number of operations per sample and channel for filters of the given length with
+        partitions of the given size: the complex multiply-accumulates of all partitions, and one
+        forward and one inverse transform per filter, each about 5 N log2 (N) operations for
+        N = 2 * size, as real signals are transformed as complex ones without FFTW or IPP. */
+    double estimateCost (const int size, const int length) const
+    {
+        const int numPartitions = (length + size - 1) / size;
+        return 8.0 * numFilters * numPartitions + 10.0 * (1 + numFilters) * std::log2 (2.0 * size);
+    }
+
+    /**
+     Buffers the input of the current long partition and adds the output of the long
+     partitions, which has been transformed back during the previous long partition.
+     */
+    void processLongPartitions (const float* const* inputs,
+                                float* const* const* outputs,
+                                const int offset,
+                                const int n)
+    {
+        const int position = longPartitionPosition + partitionPosition;
+        for (int ch = 0; ch < numActiveChannels; ++ch)
+        {
+            juce::FloatVectorOperations::copy (longStage.segments.getWritePointer (ch)
+                                                   + longPartitionSize + position,
+                                               inputs[ch] + offset,
+                                               n);
+
+            for (int f = 0; f < numFilters; ++f)
+                juce::FloatVectorOperations::add (
+                    outputs[f][ch] + offset,
+                    longOutputs.getReadPointer (getLongOutput (longSet, ch, f), position),
+                    n);
+        }
+    }
+
+    /** Shifts the input segments and the delay line, and sums up the contributions of all
+        previous partitions for the next partition. */
+    void finishPartition()
+    {
+        shortStage.shiftSegments (numActiveChannels);
+        partitionPosition = 0;
+
+        for (int ch = 0; ch < numActiveChannels; ++ch)
+            for (int f = 0; f < numFilters; ++f)
+            {
+                SIMDfloat* acc = shortStage.getAccumulator (ch, f);
+                clear (acc, 2 * shortStage.binVectors);
+                shortStage.accumulatePreviousPartitions (ch, f, 1, shortStage.numPartitions, acc);
+            }
+
+        if (useLongPartitions)
+        {
+            // during the current long partition, the sums of the previous one are transformed
+            // back and the previous long partitions are summed up, both in equal shares
+            const int numSteps = longPartitionSize / partitionSize;
+            const int step = longPartitionPosition / partitionSize;
+            const int previousSet = 1 - longSet;
+            float* fftData = longStage.fftBuffer.getWritePointer (0);
+
+            const int numPairs = numActiveChannels * numFilters;
+            for (int i = step * numPairs / numSteps; i < (step + 1) * numPairs / numSteps; ++i)
+            {
+                const int ch = i / numFilters;
+                const int f = i % numFilters;
+                SIMDfloat* acc = longStage.getAccumulator (ch, f, previousSet);
+                longStage.interleave (acc, fftData);
+                longStage.fft->performRealOnlyInverseTransform (fftData);
+                longOutputs.copyFrom (getLongOutput (previousSet, ch, f),
+                                      0,
+                                      fftData + longPartitionSize,
+                                      longPartitionSize);
+                clear (acc, 2 * longStage.binVectors);
+            }
+
+            const int numPrevious = longStage.numPartitions - 1;
+            const int first = 1 + step * numPrevious / numSteps;
+            const int last = 1 + (step + 1) * numPrevious / numSteps;
+            for (int ch = 0; ch < numActiveChannels; ++ch)
+                for (int f = 0; f < numFilters; ++f)
+                    longStage.accumulatePreviousPartitions (
+                        ch, f, first, last, longStage.getAccumulator (ch, f, longSet));
+
+            longPartitionPosition += partitionSize;
+            if (longPartitionPosition == longPartitionSize)
+                finishLongPartition();
+        }
+    }
+
+    /** Adds the complete long partition to the summed up contributions of the previous ones,
+        which are transformed back during the next long partition. */
+    void finishLongPartition()
+    {
+        for (int ch = 0; ch < numActiveChannels; ++ch)
+        {
+            longStage.transformSegment (ch);
+            const SIMDfloat* x = longStage.getFDL (ch, longStage.fdlPosition);
+
+            for (int f = 0; f < numFilters; ++f)
+                longStage.multiplyAccumulate (x,
+                                              longStage.getFilter (f, 0),
+                                              longStage.getAccumulator (ch, f, longSet));
+        }
+
+        longStage.shiftSegments (numActiveChannels);
+        longPartitionPosition = 0;
+        longSet = 1 - longSet;
+    }
+
+    int getLongOutput (const int set, const int ch, const int f) const
+    {
+        return (set * numChannels + ch) * numFilters + f;
+    }
+
+    void clearChannel (const int ch)
+    {
+        shortStage.clearChannel (ch, numFilters);
+        if (useLongPartitions)
+        {
+            longStage.clearChannel (ch, numFilters);
+            for (int set = 0; set < 2; ++set)
+                for (int f = 0; f < numFilters; ++f)
+                    longOutputs.clear (getLongOutput (set, ch, f), 0, longPartitionSize);
+        }
+    }
+
+    static SIMDfloat* allocate (juce::HeapBlock<char>& data, const int numVectors)
+    {
+        juce::dsp::AudioBlock<SIMDfloat> block (data, 1, (size_t) juce::jmax (1, numVectors));
+        SIMDfloat* ptr = block.getChannelPointer (0);
+        clear (ptr, numVectors);
+        return ptr;
+    }
+
+    static void clear (SIMDfloat* ptr, const int numVectors)
+    {
+        juce::FloatVectorOperations::clear (reinterpret_cast<float*> (ptr),
+                                            numVectors * SIMDfloat_elements);
+    }
+
+    //==============================================================================
+    /** Filter spectra, frequency-domain delay lines and summed up contributions of the previous
+        partitions for one partition size. */
+    struct Stage
+    {
+        void prepare (const int numChannels,
+                      const int numFilters,
+                      const int newPartitionSize,
+                      const int filterLength,
+                      const int numAccumulatorSets)
+        {
+            size = newPartitionSize;
+            numPartitions = juce::jmax (1, (filterLength + size - 1) / size);
+
+            const int fftSize = 2 * size;
+            fft = std::make_unique<juce::dsp::FFT> (static_cast<int> (std::log2 (fftSize)));
+            fftBuffer.setSize (1, 2 * fftSize);
+
+            numBins = size + 1;
+            binVectors = (numBins + SIMDfloat_elements - 1) / SIMDfloat_elements;
+            const int spectrumVectors = 2 * binVectors; // real and imaginary part
+
+            filters = allocate (filtersData, numFilters * numPartitions * spectrumVectors);
+            fdl = allocate (fdlData, numChannels * numPartitions * spectrumVectors);
+            accumulators = allocate (accumulatorsData,
+                                     numAccumulatorSets * numChannels * numFilters
+                                         * spectrumVectors);
+            numChannelsPerSet = numChannels;
+            numFiltersPerChannel = numFilters;
+            numSets = numAccumulatorSets;
+
+            segments.setSize (numChannels, fftSize);
+            fdlPosition = 0;
+        }
+
+        int getMaximumLength() const { return numPartitions * size; }
+
+        void setFilter (const int filter, const float* ir, const int irLength)
+        {
+            for (int k = 0; k < numPartitions; ++k)
+            {
+                float* fftData = fftBuffer.getWritePointer (0);
+                juce::FloatVectorOperations::clear (fftData, fftBuffer.getNumSamples());
+
+                const int start = k * size;
+                const int length = juce::jlimit (0, size, irLength - start);
+                if (length > 0)
+                    juce::FloatVectorOperations::copy (fftData, ir + start, length);
+
+                fft->performRealOnlyForwardTransform (fftData);
+                deinterleave (fftData, getFilter (filter, k));
+            }
+        }
+
+        /** Transforms the previous and the current partition of a channel into the current slot
+            of the frequency-domain delay line. */
+        void transformSegment (const int ch)
+        {
+            float* fftData = fftBuffer.getWritePointer (0);
+            juce::FloatVectorOperations::copy (fftData, segments.getReadPointer (ch), 2 * size);
+            fft->performRealOnlyForwardTransform (fftData);
+            deinterleave (fftData, getFDL (ch, fdlPosition));
+        }
+
+        /** Moves the current partitions to the previous ones and advances the delay line. */
+        void shiftSegments (const int numChannelsToShift)
+        {
+            for (int ch = 0; ch < numChannelsToShift; ++ch)
+            {
+                float* segment = segments.getWritePointer (ch);
+                juce::FloatVectorOperations::copy (segment, segment + size, size);
+                juce::FloatVectorOperations::clear (segment + size, size);
+            }
+
+            fdlPosition = (fdlPosition + 1) % numPartitions;
+        }
+
+        /** acc += the contributions of the partitions [first, last) before the current one. */
+        void accumulatePreviousPartitions (const int ch,
+                                           const int f,
+                                           const int first,
+                                           const int last,
+                                           SIMDfloat* acc)
+        {
+            for (int k = first; k < last; ++k)
+            {
+                const int slot = (fdlPosition - k + numPartitions) % numPartitions;
+                multiplyAccumulate (getFDL (ch, slot), getFilter (f, k), acc);
+            }
+        }
+
+        void clearChannel (const int ch, const int numFilters)
+        {
+            juce::FloatVectorOperations::clear (segments.getWritePointer (ch), 2 * size);
+            clear (getFDL (ch, 0), numPartitions * 2 * binVectors);
+            for (int set = 0; set < numSets; ++set)
+                clear (getAccumulator (ch, 0, set), numFilters * 2 * binVectors);
+        }
+
+        /** acc += x * h, with real and imaginary parts stored one after another. */
+        void multiplyAccumulate (const SIMDfloat* x, const SIMDfloat* h, SIMDfloat* acc)
+        {
+            const SIMDfloat* xRe = x;
+            const SIMDfloat* xIm = x + binVectors;
+            const SIMDfloat* hRe = h;
+            const SIMDfloat* hIm = h + binVectors;
+            SIMDfloat* accRe = acc;
+            SIMDfloat* accIm = acc + binVectors;
+
+            for (int v = 0; v < binVectors; ++v)
+            {
+                accRe[v] += xRe[v] * hRe[v] - xIm[v] * hIm[v];
+                accIm[v] += xRe[v] * hIm[v] + xIm[v] * hRe[v];
+            }
+        }
+
+        void deinterleave (const float* interleaved, SIMDfloat* spectrum)
+        {
+            float* re = reinterpret_cast<float*> (spectrum);
+            float* im = reinterpret_cast<float*> (spectrum + binVectors);
+            for (int b = 0; b < numBins; ++b)
+            {
+                re[b] = interleaved[2 * b];
+                im[b] = interleaved[2 * b + 1];
+            }
+        }
+
+        void interleave (const SIMDfloat* spectrum, float* interleaved)
+        {
+            const float* re = reinterpret_cast<const float*> (spectrum);
+            const float* im = reinterpret_cast<const float*> (spectrum + binVectors);
+            for (int b = 0; b < numBins; ++b)
+            {
+                interleaved[2 * b] = re[b];
+                interleaved[2 * b + 1] = im[b];
+            }
+        }
+
+        SIMDfloat* getFilter (const int filter, const int partition) const
+        {
+            return filters + (filter * numPartitions + partition) * 2 * binVectors;
+        }
+
+        SIMDfloat* getFDL (const int channel, const int slot) const
+        {
+            return fdl + (channel * numPartitions + slot) * 2 * binVectors;
+        }
+
+        SIMDfloat* getAccumulator (const int channel, const int filter, const int set = 0) const
+        {
+            return accumulators
+                   + ((set * numChannelsPerSet + channel) * numFiltersPerChannel + filter) * 2
+                         * binVectors;
+        }
+
+        int size = 0, numPartitions = 0;
+        int numBins = 0, binVectors = 0;
+        int numChannelsPerSet = 0, numFiltersPerChannel = 0, numSets = 0;
+        int fdlPosition = 0; // slot of the current partition in the frequency-domain delay line
+
+        std::unique_ptr<juce::dsp::FFT> fft;
+        juce::AudioBuffer<float> fftBuffer;
+        juce::AudioBuffer<float> segments; // previous and current partition of each channel
+
+        juce::HeapBlock<char> filtersData, fdlData, accumulatorsData;
+        SIMDfloat* filters = nullptr;
+        SIMDfloat* fdl = nullptr;
+        SIMDfloat* accumulators = nullptr; // contributions of the previous partitions
+    };
+
+    //==============================================================================
+    int numChannels = 0, numFilters = 0;
+    int partitionSize = 0, longPartitionSize = 0;
+    bool useLongPartitions = false;
+    int numActiveChannels = 0; // number of channels processed with the last call
+
+    int partitionPosition = 0; // number of samples of the current partition
+    int longPartitionPosition = 0; // samples of the current long partition, in whole partitions
+    int longSet = 0; // accumulators and outputs of the current long partition
+
+    Stage shortStage, longStage;
+    juce::HeapBlock<char> shortAccumulatorData;
+    SIMDfloat* shortAccumulator = nullptr;
+    juce::AudioBuffer<float> longOutputs; // output of the long partitions, for each filter
+};
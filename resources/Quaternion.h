@@ -86,6 +86,69 @@ public:
         return Quaternion (w * scalar, x * scalar, y * scalar, z * scalar);
     }
 
+    Type dot (const Quaternion& q) const { return w * q.w + x * q.x + y * q.y + z * q.z; }
+
+    /**
+     Returns the angle of the rotation from this to the other (unit) quaternion in radians.
+     */
+    Type getAngleTo (const Quaternion& q) const
+    {
+        const Type d = std::abs (dot (q));
+        return Type (2.0) * std::acos (d > Type (1.0) ? Type (1.0) : d);
+    }
+
+    /**
+     Spherical linear interpolation between the unit quaternions a (t = 0) and b (t = 1),
+     taking the shortest path on the rotation group.
+     */
+    static Quaternion slerp (const Quaternion& a, Quaternion b, const Type t)
+    {
+        Type cosOmega = a.dot (b);
+        if (cosOmega < Type (0.0))
+        {
+            b = b.scale (Type (-1.0));
+            cosOmega = -cosOmega;
+        }
+
+        Type wa, wb;
+        if (cosOmega > Type (0.9995)) // almost parallel, linear interpolation is fine
+        {
+            wa = Type (1.0) - t;
+            wb = t;
+        }
+        else
+        {
+            const Type omega = std::acos (cosOmega);
+            const Type sinOmega = std::sin (omega);
+            wa = std::sin ((Type (1.0) - t) * omega) / sinOmega;
+            wb = std::sin (t * omega) / sinOmega;
+        }
+
+        Quaternion ret = a.scale (wa) + b.scale (wb);
+        ret.normalize();
+        return ret;
+    }
+
+    /**
+     Writes the 3x3 matrix rotating cartesian vectors (x, y, z) by this unit quaternion.
+     */
+    void toRotationMatrix (juce::dsp::Matrix<Type>& rotMat) const
+    {
+        jassert (rotMat.getNumRows() == 3 && rotMat.getNumColumns() == 3);
+
+        rotMat (0, 0) = Type (1.0) - Type (2.0) * (y * y + z * z);
+        rotMat (0, 1) = Type (2.0) * (x * y - w * z);
+        rotMat (0, 2) = Type (2.0) * (x * z + w * y);
+
+        rotMat (1, 0) = Type (2.0) * (x * y + w * z);
+        rotMat (1, 1) = Type (1.0) - Type (2.0) * (x * x + z * z);
+        rotMat (1, 2) = Type (2.0) * (y * z - w * x);
+
+        rotMat (2, 0) = Type (2.0) * (x * z - w * y);
+        rotMat (2, 1) = Type (2.0) * (y * z + w * x);
+        rotMat (2, 2) = Type (1.0) - Type (2.0) * (x * x + y * y);
+    }
+
     juce::Vector3D<Type> rotateVector (juce::Vector3D<Type> vec)
     { // has to be tested!
         iem::Quaternion<Type> t (0, vec.x, vec.y, vec.z);
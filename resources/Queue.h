@@ -22,8 +22,10 @@
 
 #pragma once
 
+#include <JuceHeader.h>
+
 // A simple queue of arbitrary sample type (SampleType) with fixed numbers of samples (BufferSize).
-// A good thing to transfer data between processor and editoras it should be lock-free.
+// A good thing to transfer data between processor and editor as it should be lock-free.
 // IMPORTANT INFORMATION: If this queue is full, new data WON'T be inserted!
 // The two methods return the number of actually written or read samples.
 
@@ -61,7 +63,7 @@ public:
                 outputBuffer[i] = buffer[start1 + i];
         if (size2 > 0)
             for (int i = 0; i < size2; ++i)
-                outputBuffer[start1 + i] = buffer[i];
+                outputBuffer[size1 + i] = buffer[i];
 
         abstractFifo.finishedRead (size1 + size2);
 
@@ -69,6 +71,6 @@ public:
     }
 
 private:
-    AbstractFifo abstractFifo;
+    juce::AbstractFifo abstractFifo;
     std::array<SampleType, BufferSize> buffer;
 };
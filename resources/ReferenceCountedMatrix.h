@@ -21,6 +21,7 @@
  */
 
 #pragma once
+#include "MatrixStructure.h"
 
 class ReferenceCountedMatrix : public juce::ReferenceCountedObject
 {
@@ -73,10 +74,24 @@ public:
 
     juce::Array<int>& getRoutingArrayReference() { return routingArray; }
 
+    /**
+     Analyses the sparsity structure of the matrix, so the MatrixMultiplication can use a
+     specialized kernel. Call this after the matrix has been filled and before handing it to the
+     audio thread. Matrices which are never analysed are treated as dense.
+     */
+    void analyseStructure()
+    {
+        structure.analyse (matrix);
+        DBG ("Matrix named '" + name + "' analysed: " + structure.getTypeString());
+    }
+
+    const MatrixStructure& getStructure() const { return structure; }
+
 protected:
     juce::String name;
     juce::String description;
     juce::dsp::Matrix<float> matrix;
     juce::Array<int> routingArray;
+    MatrixStructure structure;
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ReferenceCountedMatrix)
 };
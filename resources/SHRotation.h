@@ -0,0 +1,314 @@
+/*
+ ==============================================================================
+ This file is part of the IEM plug-in suite.
+ Author: Daniel Rudrich
+ Copyright (c) 2024 - Institute of Electronic Music and Acoustics (IEM)
+ https://iem.at
+
+ The IEM plug-in suite is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ The IEM plug-in suite is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this software.  If not, see <https://www.gnu.org/licenses/>.
+ ==============================================================================
+ */
+
+/*
+ The computation of Ambisonic rotation matrices is done by the recursive method
+ of Ivanic and Ruedenberg:
+
+    Ivanic, J., Ruedenberg, K. (1996). Rotation Matrices for Real Spherical
+    Harmonics. Direct Determination by Recursion. The Journal of Physical
+    Chemistry, 100(15), 6342?6347.
+
+ Including their corrections:
+
+    Ivanic, J., Ruedenberg, K. (1998). Rotation Matrices for Real Spherical
+    Harmonics. Direct Determination by Recursion Page: Additions and
+    Corrections. Journal of Physical Chemistry A, 102(45), 9099?9100.
+
+ It also follows the implementations of Archontis Politis (Spherical Harmonic
+ Transform Toolbox) and Matthias Kronlachner (AmbiX Plug-in Suite).
+ */
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include "DenseMatrixKernel.h"
+
+/**
+ Rotates Ambisonic signals in place. The rotation matrix is block-diagonal, with one
+ (2l + 1) x (2l + 1) block per order l, and each block is applied with the DenseMatrixKernel.
+
+ When the rotation changes, the matrix entries are interpolated linearly over the next block,
+ which is done by applying the previous matrix and adding the linearly faded difference
+ matrix. Orders whose matrix hasn't changed are processed without any interpolation.
+ */
+template <int maxOrder = 7>
+class SHRotation
+{
+public:
+    SHRotation()
+    {
+        for (int l = 0; l <= maxOrder; ++l)
+        {
+            const int nCh = 2 * l + 1;
+            orderMatrices.add (new juce::dsp::Matrix<float> (nCh, nCh))->clear();
+            currentMatrices.add (new juce::dsp::Matrix<float> (nCh, nCh))->clear();
+            differenceMatrices.add (new juce::dsp::Matrix<float> (nCh, nCh))->clear();
+        }
+
+        kernel.prepare (maxBlockChannels);
+    }
+
+    /** Allocates the buffers for the interpolation, must not be called from the audio thread.
+     */
+    void prepare (const int maximumBlockSize)
+    {
+        maxBlockSize = juce::jmax (1, maximumBlockSize);
+        differenceBuffer.setSize (maxBlockChannels, maxBlockSize);
+        ramp.setSize (1, maxBlockSize);
+    }
+
+    /**
+     Calculates the rotation matrices up to the given order from a 3x3 rotation matrix, which
+     rotates cartesian coordinates (x, y, z). The new rotation will be faded in during the next
+     call of process().
+     */
+    void setRotationMatrix (const juce::dsp::Matrix<float>& rotMat, const int order)
+    {
+        auto Rl = orderMatrices[1];
+
+        Rl->operator() (0, 0) = rotMat (1, 1);
+        Rl->operator() (0, 1) = rotMat (1, 2);
+        Rl->operator() (0, 2) = rotMat (1, 0);
+        Rl->operator() (1, 0) = rotMat (2, 1);
+        Rl->operator() (1, 1) = rotMat (2, 2);
+        Rl->operator() (1, 2) = rotMat (2, 0);
+        Rl->operator() (2, 0) = rotMat (0, 1);
+        Rl->operator() (2, 1) = rotMat (0, 2);
+        Rl->operator() (2, 2) = rotMat (0, 0);
+
+        for (int l = 2; l <= juce::jmin (order, maxOrder); ++l)
+        {
+            auto Rone = orderMatrices[1];
+            auto Rlm1 = orderMatrices[l - 1];
+            auto Rl = orderMatrices[l];
+            for (int m = -l; m <= l; ++m)
+            {
+                for (int n = -l; n <= l; ++n)
+                {
+                    const int d = (m == 0) ? 1 : 0;
+                    double denom;
+                    if (abs (n) == l)
+                        denom = (2 * l) * (2 * l - 1);
+                    else
+                        denom = l * l - n * n;
+
+                    double u = sqrt ((l * l - m * m) / denom);
+                    double v = sqrt ((1.0 + d) * (l + abs (m) - 1.0) * (l + abs (m)) / denom)
+                               * (1.0 - 2.0 * d) * 0.5;
+                    double w =
+                        sqrt ((l - abs (m) - 1.0) * (l - abs (m)) / denom) * (1.0 - d) * (-0.5);
+
+                    if (u != 0.0)
+                        u *= U (l, m, n, *Rone, *Rlm1);
+                    if (v != 0.0)
+                        v *= V (l, m, n, *Rone, *Rlm1);
+                    if (w != 0.0)
+                        w *= W (l, m, n, *Rone, *Rlm1);
+
+                    Rl->operator() (m + l, n + l) = u + v + w;
+                }
+            }
+        }
+    }
+
+    /** Skips the interpolation, so the next call of process() uses the latest rotation matrices
+        right away. */
+    void reset()
+    {
+        for (int l = 1; l <= maxOrder; ++l)
+            juce::FloatVectorOperations::copy (currentMatrices[l]->getRawDataPointer(),
+                                               orderMatrices[l]->getRawDataPointer(),
+                                               juce::square (2 * l + 1));
+    }
+
+    /**
+     Rotates the first (order + 1)^2 channels of the block in place. The zeroth order channel
+     is left untouched, all other channels are overwritten.
+     */
+    void process (const juce::dsp::AudioBlock<float>& block, const int order)
+    {
+        jassert (order <= maxOrder);
+        jassert (static_cast<int> (block.getNumChannels()) >= juce::square (order + 1));
+
+        // call prepare() first!
+        jassert (maxBlockSize > 0);
+        if (maxBlockSize == 0)
+            return;
+
+        const int numSamples = static_cast<int> (block.getNumSamples());
+
+        for (int l = 1; l <= order; ++l)
+        {
+            const int offset = l * l;
+            const int nCh = 2 * l + 1;
+
+            float* current = currentMatrices[l]->getRawDataPointer();
+            const float* target = orderMatrices[l]->getRawDataPointer();
+
+            if (std::equal (target, target + nCh * nCh, current))
+            {
+                applyMatrix (*currentMatrices[l], block, offset, 0, numSamples, nullptr);
+                continue;
+            }
+
+            juce::FloatVectorOperations::subtract (differenceMatrices[l]->getRawDataPointer(),
+                                                   target,
+                                                   current,
+                                                   nCh * nCh);
+
+            for (int start = 0; start < numSamples; start += maxBlockSize)
+            {
+                const int L = juce::jmin (maxBlockSize, numSamples - start);
+
+                // the difference matrix is applied first, as the input is overwritten afterwards
+                float* differenceChannels[maxBlockChannels];
+                for (int ch = 0; ch < nCh; ++ch)
+                    differenceChannels[ch] = differenceBuffer.getWritePointer (ch);
+
+                applyMatrix (*differenceMatrices[l], block, offset, start, L, differenceChannels);
+                applyMatrix (*currentMatrices[l], block, offset, start, L, nullptr);
+
+                float* rampPtr = ramp.getWritePointer (0);
+                for (int i = 0; i < L; ++i)
+                    rampPtr[i] = static_cast<float> (start + i) / numSamples;
+
+                for (int ch = 0; ch < nCh; ++ch)
+                    juce::FloatVectorOperations::addWithMultiply (
+                        block.getChannelPointer (offset + ch) + start,
+                        differenceChannels[ch],
+                        rampPtr,
+                        L);
+            }
+
+            juce::FloatVectorOperations::copy (current, target, nCh * nCh);
+        }
+    }
+
+private:
+    /** Applies the matrix to the channels offset ... offset + 2l of the block, and writes the
+        result either to the outputs, or back into the block if outputs is a nullptr. */
+    void applyMatrix (juce::dsp::Matrix<float>& matrix,
+                      const juce::dsp::AudioBlock<float>& block,
+                      const int offset,
+                      const int startSample,
+                      const int numSamples,
+                      float* const* outputs)
+    {
+        const int nCh = static_cast<int> (matrix.getNumRows());
+
+        const float* rows[maxBlockChannels];
+        float* channels[maxBlockChannels];
+        for (int ch = 0; ch < nCh; ++ch)
+        {
+            rows[ch] = matrix.getRawDataPointer() + ch * nCh;
+            channels[ch] = block.getChannelPointer (offset + ch) + startSample;
+        }
+
+        // in-place processing is fine, as the kernel packs each chunk before writing it
+        kernel.process (rows,
+                        outputs != nullptr ? outputs : channels,
+                        nCh,
+                        channels,
+                        nCh,
+                        numSamples);
+    }
+
+    double
+        P (int i, int l, int a, int b, juce::dsp::Matrix<float>& R1, juce::dsp::Matrix<float>& Rlm1)
+    {
+        double ri1 = R1 (i + 1, 2);
+        double rim1 = R1 (i + 1, 0);
+        double ri0 = R1 (i + 1, 1);
+
+        if (b == -l)
+            return ri1 * Rlm1 (a + l - 1, 0) + rim1 * Rlm1 (a + l - 1, 2 * l - 2);
+        else if (b == l)
+            return ri1 * Rlm1 (a + l - 1, 2 * l - 2) - rim1 * Rlm1 (a + l - 1, 0);
+        else
+            return ri0 * Rlm1 (a + l - 1, b + l - 1);
+    };
+
+    double U (int l, int m, int n, juce::dsp::Matrix<float>& Rone, juce::dsp::Matrix<float>& Rlm1)
+    {
+        return P (0, l, m, n, Rone, Rlm1);
+    }
+
+    double V (int l, int m, int n, juce::dsp::Matrix<float>& Rone, juce::dsp::Matrix<float>& Rlm1)
+    {
+        if (m == 0)
+        {
+            auto p0 = P (1, l, 1, n, Rone, Rlm1);
+            auto p1 = P (-1, l, -1, n, Rone, Rlm1);
+            return p0 + p1;
+        }
+        else if (m > 0)
+        {
+            auto p0 = P (1, l, m - 1, n, Rone, Rlm1);
+            if (m == 1) // d = 1;
+                return p0 * sqrt (2);
+            else // d = 0;
+                return p0 - P (-1, l, 1 - m, n, Rone, Rlm1);
+        }
+        else
+        {
+            auto p1 = P (-1, l, -m - 1, n, Rone, Rlm1);
+            if (m == -1) // d = 1;
+                return p1 * sqrt (2);
+            else // d = 0;
+                return p1 + P (1, l, m + 1, n, Rone, Rlm1);
+        }
+    }
+
+    double W (int l, int m, int n, juce::dsp::Matrix<float>& Rone, juce::dsp::Matrix<float>& Rlm1)
+    {
+        if (m > 0)
+        {
+            auto p0 = P (1, l, m + 1, n, Rone, Rlm1);
+            auto p1 = P (-1, l, -m - 1, n, Rone, Rlm1);
+            return p0 + p1;
+        }
+        else if (m < 0)
+        {
+            auto p0 = P (1, l, m - 1, n, Rone, Rlm1);
+            auto p1 = P (-1, l, 1 - m, n, Rone, Rlm1);
+            return p0 - p1;
+        }
+
+        return 0.0;
+    }
+
+    //==============================================================================
+    static constexpr int maxBlockChannels = 2 * maxOrder + 1;
+
+    int maxBlockSize = 0;
+
+    // latest matrices, the ones currently applied, and the difference for interpolation
+    juce::OwnedArray<juce::dsp::Matrix<float>> orderMatrices;
+    juce::OwnedArray<juce::dsp::Matrix<float>> currentMatrices;
+    juce::OwnedArray<juce::dsp::Matrix<float>> differenceMatrices;
+
+    DenseMatrixKernel kernel;
+    juce::AudioBuffer<float> differenceBuffer;
+    juce::AudioBuffer<float> ramp;
+};
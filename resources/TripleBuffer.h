@@ -0,0 +1,81 @@
+/*
+ ==============================================================================
+ This file is part of the IEM plug-in suite.
+ Author: Daniel Rudrich
+ Copyright (c) 2024 - Institute of Electronic Music and Acoustics (IEM)
+ https://iem.at
+
+ The IEM plug-in suite is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ The IEM plug-in suite is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this software.  If not, see <https://www.gnu.org/licenses/>.
+ ==============================================================================
+ */
+
+#pragma once
+
+#include <JuceHeader.h>
+
+/**
+ Lock-free triple buffer for handing data from one writer thread to one reader thread, e.g.
+ from a worker thread to the audio thread. The writer fills the write buffer and publishes it,
+ the reader picks up the latest published buffer with update(). Neither of them ever waits,
+ and the reader always sees a complete buffer, although intermediate ones might be skipped.
+
+ All three buffers are allocated in the constructor, so Type should be default constructible
+ and shouldn't allocate when being written to.
+ */
+template <typename Type>
+class TripleBuffer
+{
+public:
+    TripleBuffer()
+    {
+        for (int i = 0; i < 3; ++i)
+            buffers.add (new Type());
+    }
+
+    /** Returns the buffer the writer is allowed to fill. */
+    Type& getWriteBuffer() { return *buffers.getUnchecked (writeIndex); }
+
+    /** Makes the write buffer available to the reader. The writer gets a new write buffer,
+        which might contain data from any previously published one. */
+    void publish()
+    {
+        writeIndex = middle.exchange (writeIndex | newDataFlag, std::memory_order_acq_rel)
+                     & indexMask;
+    }
+
+    /** Swaps in the latest published buffer, returns true if there was one. Has to be called
+        by the reader before accessing the read buffer. */
+    bool update()
+    {
+        if ((middle.load (std::memory_order_relaxed) & newDataFlag) == 0)
+            return false;
+
+        readIndex = middle.exchange (readIndex, std::memory_order_acq_rel) & indexMask;
+        return true;
+    }
+
+    /** Returns the buffer the reader is allowed to read from. */
+    const Type& getReadBuffer() const { return *buffers.getUnchecked (readIndex); }
+
+private:
+    static constexpr int indexMask = 3;
+    static constexpr int newDataFlag = 4;
+
+    juce::OwnedArray<Type> buffers;
+    int writeIndex = 0;
+    int readIndex = 1;
+    std::atomic<int> middle { 2 };
+
+    JUCE_DECLARE_NON_COPYABLE (TripleBuffer)
+};
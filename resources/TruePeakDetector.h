@@ -0,0 +1,115 @@
+/*
+ ==============================================================================
+ This file is part of the IEM plug-in suite.
+ Author: Daniel Rudrich
+ Copyright (c) 2024 - Institute of Electronic Music and Acoustics (IEM)
+ https://iem.at
+
+ The IEM plug-in suite is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ The IEM plug-in suite is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this software.  If not, see <https://www.gnu.org/licenses/>.
+ ==============================================================================
+ */
+
+#pragma once
+
+#include <JuceHeader.h>
+
+/**
+ True-peak detector for compressor side chains: the signal is upsampled four times with the
+ polyphase interpolation filter of ITU-R BS.1770-4 (Annex 2), and for each input sample the
+ largest magnitude of the four interpolated samples is written to the output, which can be
+ passed to iem::Compressor as side chain signal.
+
+ With SSE, the four phases of the filter are computed at once in the lanes of a SIMD register.
+ The output is delayed by getLatencyInSamples() with respect to the input, so the audio signal
+ has to be delayed by the same amount to stay aligned with the gains.
+ */
+class TruePeakDetector
+{
+public:
+    static constexpr int numPhases = 4;
+    static constexpr int numTaps = 12; // per phase
+
+    TruePeakDetector() { reset(); }
+
+    /** Delay of the detected peaks, the phases of the interpolation filter delay the signal by
+        5.125 to 5.875 samples, so the gains are rather early than late. */
+    static constexpr int getLatencyInSamples() { return 6; }
+
+    /** Clears the filter's history. */
+    void reset()
+    {
+        std::fill (std::begin (state), std::end (state), 0.0f);
+        position = 0;
+    }
+
+    /** Writes the true-peak magnitudes of source into destination, which may be the same. */
+    void process (const float* source, float* destination, const int numSamples)
+    {
+        for (int i = 0; i < numSamples; ++i)
+        {
+            // the history is stored twice, so the window of the last numTaps samples is
+            // always contiguous, with the newest sample first
+            state[position] = state[position + numTaps] = source[i];
+            const float* window = state + position;
+
+#if JUCE_USE_SSE_INTRINSICS
+            __m128 sum = _mm_setzero_ps();
+            for (int k = 0; k < numTaps; ++k)
+                sum = _mm_add_ps (sum,
+                                  _mm_mul_ps (_mm_set1_ps (window[k]),
+                                              _mm_load_ps (coefficients[k])));
+
+            // absolute values and maximum of the four lanes
+            sum = _mm_andnot_ps (_mm_set1_ps (-0.0f), sum);
+            sum = _mm_max_ps (sum, _mm_shuffle_ps (sum, sum, _MM_SHUFFLE (1, 0, 3, 2)));
+            sum = _mm_max_ps (sum, _mm_shuffle_ps (sum, sum, _MM_SHUFFLE (2, 3, 0, 1)));
+            destination[i] = _mm_cvtss_f32 (sum);
+#else /* !JUCE_USE_SSE_INTRINSICS */
+            float peak = 0.0f;
+            for (int p = 0; p < numPhases; ++p)
+            {
+                float sum = 0.0f;
+                for (int k = 0; k < numTaps; ++k)
+                    sum += window[k] * coefficients[k][p];
+
+                peak = juce::jmax (peak, std::abs (sum));
+            }
+            destination[i] = peak;
+#endif /* JUCE_USE_SSE_INTRINSICS */
+
+            position = position == 0 ? numTaps - 1 : position - 1;
+        }
+    }
+
+private:
+    /** Coefficients of the four phases of the interpolation filter, stored per tap, so the
+        coefficients of one tap fill a SIMD register. */
+    alignas (16) static constexpr float coefficients[numTaps][numPhases] = {
+        { 0.0017089843750f, -0.0291748046875f, -0.0189208984375f, -0.0083007812500f },
+        { 0.0109863281250f, 0.0292968750000f, 0.0330810546875f, 0.0148925781250f },
+        { -0.0196533203125f, -0.0517578125000f, -0.0582275390625f, -0.0266113281250f },
+        { 0.0332031250000f, 0.0891113281250f, 0.1015625000000f, 0.0476074218750f },
+        { -0.0594482421875f, -0.1665039062500f, -0.2003173828125f, -0.1022949218750f },
+        { 0.1373291015625f, 0.4650878906250f, 0.7797851562500f, 0.9721679687500f },
+        { 0.9721679687500f, 0.7797851562500f, 0.4650878906250f, 0.1373291015625f },
+        { -0.1022949218750f, -0.2003173828125f, -0.1665039062500f, -0.0594482421875f },
+        { 0.0476074218750f, 0.1015625000000f, 0.0891113281250f, 0.0332031250000f },
+        { -0.0266113281250f, -0.0582275390625f, -0.0517578125000f, -0.0196533203125f },
+        { 0.0148925781250f, 0.0330810546875f, 0.0292968750000f, 0.0109863281250f },
+        { -0.0083007812500f, -0.0189208984375f, -0.0291748046875f, 0.0017089843750f }
+    };
+
+    float state[2 * numTaps];
+    int position = 0;
+};
@@ -113,3 +113,155 @@ inline void SHEval (const int N,
 {
     SHEval (N, position.x, position.y, position.z, pSH, doEncode);
 }
+
+//==============================================================================
+/**
+ Constants of the recurrence used by SHEvalBatch(). The normalisation and sign convention are
+ the same as those of the SHEval0 ... SHEval7 functions (N3D, no Condon-Shortley phase).
+ */
+struct SHEvalBatchConstants
+{
+    static constexpr int maxOrder = 7;
+
+    SHEvalBatchConstants()
+    {
+        for (int m = 0; m <= maxOrder; ++m)
+        {
+            // sqrt ((2m + 1) / (4 pi) / (2m)!) * (2m - 1)!!, times sqrt (2) for m > 0
+            double k = (2 * m + 1) / (4.0 * juce::MathConstants<double>::pi);
+            for (int i = 2; i <= 2 * m; ++i)
+                k /= i;
+
+            double doubleFactorial = 1.0;
+            for (int i = 2 * m - 1; i > 1; i -= 2)
+                doubleFactorial *= i;
+
+            sectoral[m] =
+                static_cast<float> (std::sqrt (m > 0 ? 2.0 * k : k) * doubleFactorial);
+
+            for (int l = m + 1; l <= maxOrder; ++l)
+            {
+                const double l2m2 = l * l - m * m;
+                a[l][m] = static_cast<float> (std::sqrt ((4.0 * l * l - 1.0) / l2m2));
+                b[l][m] = l == m + 1
+                              ? 0.0f
+                              : static_cast<float> (-std::sqrt (((l - 1) * (l - 1) - m * m)
+                                                                * (2.0 * l + 1.0)
+                                                                / ((2.0 * l - 3.0) * l2m2)));
+            }
+        }
+    }
+
+    float sectoral[maxOrder + 1];
+    float a[maxOrder + 1][maxOrder + 1];
+    float b[maxOrder + 1][maxOrder + 1];
+};
+
+/**
+ Evaluates the (unscaled) spherical harmonics up to order N for a single direction or, if
+ FloatType is a SIMDRegister, for several directions at once.
+ */
+template <typename FloatType>
+inline void SHEvalRecurrence (const int N,
+                              const FloatType fX,
+                              const FloatType fY,
+                              const FloatType fZ,
+                              FloatType* SHcoeffs)
+{
+    static const SHEvalBatchConstants constants;
+
+    FloatType fC (1.0f), fS (0.0f); // cos (m phi) and sin (m phi), scaled by sin^m (theta)
+    for (int m = 0; m <= N; ++m)
+    {
+        FloatType pPrev (0.0f);
+        FloatType p (constants.sectoral[m]);
+        for (int l = m; l <= N; ++l)
+        {
+            if (l > m)
+            {
+                const FloatType pNext = fZ * p * constants.a[l][m] + pPrev * constants.b[l][m];
+                pPrev = p;
+                p = pNext;
+            }
+
+            const int centre = l * l + l;
+            if (m == 0)
+                SHcoeffs[centre] = p;
+            else
+            {
+                SHcoeffs[centre + m] = p * fC;
+                SHcoeffs[centre - m] = p * fS;
+            }
+        }
+
+        const FloatType fCNext = fX * fC - fY * fS;
+        fS = fX * fS + fY * fC;
+        fC = fCNext;
+    }
+}
+
+/**
+ Evaluates the spherical harmonics up to order N (max. 7) for numDirections directions at once,
+ computing several directions in parallel if SIMD is available.
+
+ The directions are passed as separate x, y, and z arrays. The coefficients are written as one
+ row per ambisonic channel: coefficient ch of direction i is written to
+ SHcoeffs[ch * coeffsStride + i]. The results match those of SHEval() within floating point
+ tolerance, including the encoding / decoding scaling.
+ */
+inline void SHEvalBatch (const int N,
+                         const float* fX,
+                         const float* fY,
+                         const float* fZ,
+                         const int numDirections,
+                         float* SHcoeffs,
+                         const int coeffsStride,
+                         const bool doEncode = true)
+{
+    jassert (N >= 0 && N <= SHEvalBatchConstants::maxOrder);
+    jassert (coeffsStride >= numDirections);
+
+    const int nCh = (N + 1) * (N + 1);
+    const float scale = doEncode ? sqrt4PI : decodeCorrection (N);
+
+#if JUCE_USE_SIMD
+    using SIMDfloat = juce::dsp::SIMDRegister<float>;
+    constexpr int nElements = static_cast<int> (SIMDfloat::size());
+
+    alignas (sizeof (SIMDfloat)) float x[nElements], y[nElements], z[nElements];
+    alignas (sizeof (SIMDfloat)) float result[nElements];
+    SIMDfloat coeffs[64];
+
+    for (int i = 0; i < numDirections; i += nElements)
+    {
+        const int n = juce::jmin (nElements, numDirections - i);
+        for (int k = 0; k < nElements; ++k)
+        {
+            // the last chunk is padded with the z-axis
+            x[k] = k < n ? fX[i + k] : 0.0f;
+            y[k] = k < n ? fY[i + k] : 0.0f;
+            z[k] = k < n ? fZ[i + k] : 1.0f;
+        }
+
+        SHEvalRecurrence (N,
+                          SIMDfloat::fromRawArray (x),
+                          SIMDfloat::fromRawArray (y),
+                          SIMDfloat::fromRawArray (z),
+                          coeffs);
+
+        for (int ch = 0; ch < nCh; ++ch)
+        {
+            (coeffs[ch] * scale).copyToRawArray (result);
+            juce::FloatVectorOperations::copy (SHcoeffs + ch * coeffsStride + i, result, n);
+        }
+    }
+#else /* !JUCE_USE_SIMD */
+    float coeffs[64];
+    for (int i = 0; i < numDirections; ++i)
+    {
+        SHEvalRecurrence (N, fX[i], fY[i], fZ[i], coeffs);
+        for (int ch = 0; ch < nCh; ++ch)
+            SHcoeffs[ch * coeffsStride + i] = coeffs[ch] * scale;
+    }
+#endif /* JUCE_USE_SIMD */
+}